@@ -112,6 +112,10 @@ SOURCE=..\src\lex.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\src\number.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\src\parse.c
 # End Source File
 # Begin Source File
@@ -145,10 +149,6 @@ SOURCE=.\StdAfx.h
 # End Source File
 # Begin Source File
 
-SOURCE=..\src\symbol.h
-# End Source File
-# Begin Source File
-
 SOURCE=.\win32_config.h
 # End Source File
 # Begin Source File
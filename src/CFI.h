@@ -174,6 +174,14 @@ extern	"C"	{
 #define	CFI_ATTRIBUTES		(0x41545452)
 #define	CFI_SECTION		(0x53454354)
 
+/*
+ * Masks of the CFI_node_t discriminators, for cfi_search_begin():
+ */
+#define	CFI_WORD_MASK		((unsigned)(1<<0))
+#define	CFI_ATTRIBUTES_MASK	((unsigned)(1<<1))
+#define	CFI_SECTION_MASK	((unsigned)(1<<2))
+#define	CFI_ANY_MASK		((unsigned)(7))
+
 /*
  * Some symbolic names for CFI attributes:
  */
@@ -239,6 +247,133 @@ typedef int CFI_CHECK_UINT32_2[sizeof(int32_t)-4];
 typedef  struct S_sym_t*   CFI_sym_t;
 typedef  struct S_attr_t*  CFI_attr_t;
 typedef  struct S_node_t*  CFI_node_t;
+typedef  struct S_parser_t* CFI_parser_t;
+typedef  struct S_path_t*  CFI_path_t;
+typedef  struct S_cursor_t* CFI_cursor_t;
+
+/*
+ * The event parse, cfi_parse_events(), makes no nodes; it hands each item of
+ * the document to these functions as it is parsed.  Any of the functions may
+ * be NULL.  A function that returns non-zero stops the parse.
+ *
+ * The words, and the text of word and string values, point into the input
+ * and are not '\0' terminated; they are good only until the function returns.
+ * String text is as it is in the input, between the quotes and with any '\'
+ * escapes; cfi_string_encode() converts it.
+ */
+typedef struct S_value_t
+   {
+   int         type; /* CFI_WORD_ATTRIBUTE, etc., or CFI_HEX_FORMAT, etc. */
+   const char* text; /* word or string text                              */
+   size_t      leng; /* length of the word or string text                */
+   double      real; /* real number                                      */
+   int32_t     num;  /* integer number                                   */
+   }
+   CFI_value_t;
+
+typedef struct S_events_t
+   {
+   int (*begin_section) (
+                        void*              user,
+                        const char*        word,
+                        size_t             leng,
+                        const CFI_value_t* param /* or NULL */
+                        );
+   int (*word) (void* user, const char* word, size_t leng);
+   int (*attribute_node) (
+                         void*              user,
+                         const char*        word,
+                         size_t             leng,
+                         const CFI_value_t* values,
+                         size_t             count
+                         );
+   int (*end_section) (void* user);
+   }
+   CFI_events_t;
+
+/*
+ * An edit of a document's text, for cfi_reparse(): "oldLeng" bytes at
+ * "offset" in the old text became "newLeng" bytes at the same offset in the
+ * new text, and the rest of the text is the same.
+ */
+typedef struct S_edit_t
+   {
+   size_t offset;  /* where the edit starts                  */
+   size_t oldLeng; /* length of the edited text, before it   */
+   size_t newLeng; /* length of the edited text, after it    */
+   }
+   CFI_edit_t;
+
+/*
+ * The memory of a document that was parsed into an arena, from
+ * cfi_arena_stats(); "used" is the part of "size" that the document took,
+ * and the rest is unused space at the ends of the blocks.
+ */
+typedef struct S_arena_stats_t
+   {
+   size_t blocks; /* blocks of the arena                   */
+   size_t size;   /* bytes in the blocks                   */
+   size_t used;   /* bytes used by the document            */
+   size_t nodes;  /* nodes in the arena that aren't deleted */
+   }
+   CFI_arena_stats_t;
+
+/*
+ * The memory functions that libcfi calls instead of malloc(), calloc(),
+ * realloc() and free(), from cfi_set_allocator(), or for the documents of one
+ * parser from cfi_parser_allocator(); "user" is handed to each of them.
+ */
+typedef struct S_allocator_t
+   {
+   void* (*malloc_hook) (void* user, size_t size);
+   void* (*calloc_hook) (void* user, size_t count, size_t size);
+   void* (*realloc_hook) (void* user, void* ptr, size_t size);
+   void  (*free_hook) (void* user, void* ptr);
+   void*   user;
+   }
+   CFI_allocator_t;
+
+/*
+ * The memory of a document, from cfi_memory_usage(): the objects of each kind
+ * and the bytes they take.  "overhead" is the rest of "total": the headers the
+ * allocator puts on each of the "allocations", as glibc's malloc() would, and
+ * the space of the document's arenas that its objects don't take.
+ */
+typedef struct S_memory_t
+   {
+   size_t nodes;          /* nodes                                  */
+   size_t nodeBytes;
+   size_t attributes;     /* attributes                             */
+   size_t attributeBytes;
+   size_t texts;          /* attribute text kept apart from its     */
+   size_t textBytes;      /* attribute, which is longer than 23     */
+   size_t words;          /* words of nodes; a key is counted once  */
+   size_t wordBytes;
+   size_t links;          /* arrays of links to attributes          */
+   size_t linkBytes;
+   size_t sources;        /* lazy sections, and their input text    */
+   size_t sourceBytes;
+   size_t indexes;        /* indexes of sections' contents          */
+   size_t indexBytes;
+   size_t allocations;    /* allocations from the heap              */
+   size_t overhead;       /* see above                              */
+   size_t total;          /* all of the bytes of the document       */
+   }
+   CFI_memory_t;
+
+/*
+ * The live memory of libcfi, in all of its documents and parsers, from
+ * cfi_memory_live().
+ */
+typedef struct S_live_t
+   {
+   size_t allocations; /* allocations not freed                    */
+   size_t arenas;      /* arenas of documents                      */
+   size_t arenaBytes;  /* bytes of the blocks of the arenas        */
+   size_t nodes;       /* nodes from the heap, not from an arena   */
+   size_t attributes;  /* attributes from the heap, likewise       */
+   }
+   CFI_live_t;
 
 
 /* ************************************************************************* */
@@ -272,6 +407,8 @@ extern DECLS const char* DECLC cfi_conf_cflags (void);
 extern DECLS const char* DECLC cfi_conf_shared_libs (void);
 extern DECLS const char* DECLC cfi_conf_static_libs (void);
 extern DECLS unsigned DECLC cfi_conf_debug (unsigned flags);
+extern DECLS unsigned DECLC cfi_conf_threads (unsigned threads);
+CFI_FUNC cfi_set_allocator (const CFI_allocator_t* const allocator);
 
 /* -- CFI Initialization Function Prototypes */
 
@@ -285,11 +422,64 @@ extern DECLS char* DECLC cfi_string_encode (const char* text, size_t* leng);
 extern DECLS char* DECLC cfi_string_octal  (char* const a_buff, long a_item);
 extern DECLS char* DECLC cfi_string_binary (char* const a_buff, long a_item);
 
+/* -- CFI Number Function Prototypes */
+
+CFI_FUNC cfi_number_integer (
+                            const char* text,
+                            size_t      leng,
+                            int         base,
+                            int32_t*    num
+                            );
+CFI_FUNC cfi_number_real (const char* text, size_t leng, double* real);
+
 /* -- CFI I/O Function Prototypes */
 
 extern DECLS const char* DECLC cfi_get (int fd, CFI_node_t* const node);
 extern DECLS const char* DECLC cfi_put (int fd, CFI_node_t  const node);
 
+/* -- CFI Parser Function Prototypes */
+
+CFI_FUNC cfi_parser_new (CFI_parser_t* const parser);
+CFI_FUNC cfi_parser_del (CFI_parser_t* const parser);
+CFI_FUNC cfi_parser_get (
+                        CFI_parser_t const parser,
+                        int                fd,
+                        CFI_node_t*  const node
+                        );
+extern DECLS int DECLC cfi_parser_line (CFI_parser_t const parser);
+CFI_FUNC cfi_parser_lazy (CFI_parser_t const parser, int lazy);
+CFI_FUNC cfi_parser_threads (CFI_parser_t const parser, unsigned threads);
+CFI_FUNC cfi_parser_arena (CFI_parser_t const parser, size_t blockSize);
+CFI_FUNC cfi_parser_allocator (
+                              CFI_parser_t           const parser,
+                              const CFI_allocator_t* const allocator
+                              );
+CFI_FUNC cfi_reparse (
+                     CFI_node_t* const       root,
+                     const char*             old_text,
+                     const char*             new_text,
+                     const CFI_edit_t* const edit
+                     );
+
+/* -- CFI Event Parse Function Prototypes */
+
+CFI_FUNC cfi_parse_events (
+                          int                       fd,
+                          const CFI_events_t* const events,
+                          void*                     user
+                          );
+CFI_FUNC cfi_parse_events_text (
+                               const char*               text,
+                               const CFI_events_t* const events,
+                               void*                     user
+                               );
+CFI_FUNC cfi_parser_events (
+                           CFI_parser_t        const parser,
+                           int                       fd,
+                           const CFI_events_t* const events,
+                           void*                     user
+                           );
+
 /* -- CFI Allocation, Deallocation Function Prototypes */
 
 CFI_FUNC cfi_node_new (CFI_node_t* const node);
@@ -307,6 +497,16 @@ extern DECLS CFI_node_t DECLC cfi_node_join (
                                             CFI_node_t const node1,
                                             CFI_node_t const node2
                                             );
+CFI_FUNC cfi_node_span (
+                       CFI_node_t const node,
+                       size_t* const    start,
+                       size_t* const    leng
+                       );
+CFI_FUNC cfi_node_lazy_error (CFI_node_t const node);
+CFI_FUNC cfi_arena_stats (
+                         CFI_node_t         const node,
+                         CFI_arena_stats_t* const stats
+                         );
 
 /* -- CFI Node Word Manipulation Function Prototypes */
 
@@ -361,16 +561,70 @@ extern DECLS CFI_node_t DECLC cfi_search (
                                          const char*      word,
                                          int              type
                                          );
+extern DECLS CFI_node_t DECLC cfi_search_peek (
+                                              CFI_node_t const node,
+                                              const char*      word,
+                                              int              type
+                                              );
 extern DECLS CFI_node_t DECLC cfi_search_flat (
                                               CFI_node_t const node,
                                               const char*      word,
                                               int              type
                                               );
+extern DECLS CFI_node_t DECLC cfi_search_flat_peek (
+                                                   CFI_node_t const node,
+                                                   const char*      word,
+                                                   int              type
+                                                   );
+extern DECLS CFI_node_t DECLC cfi_lookup (
+                                         CFI_node_t const root,
+                                         const char*      path,
+                                         int              type
+                                         );
+extern DECLS CFI_node_t DECLC cfi_lookup_peek (
+                                              CFI_node_t const root,
+                                              const char*      path,
+                                              int              type
+                                              );
+CFI_FUNC cfi_path_compile (const char* text, CFI_path_t* const path);
+extern DECLS CFI_node_t DECLC cfi_path_lookup (
+                                              CFI_node_t const root,
+                                              CFI_path_t const path,
+                                              int              type
+                                              );
+extern DECLS CFI_node_t DECLC cfi_path_lookup_peek (
+                                                   CFI_node_t const root,
+                                                   CFI_path_t const path,
+                                                   int              type
+                                                   );
+CFI_FUNC cfi_path_del (CFI_path_t* const path);
+CFI_FUNC cfi_lookup_many (
+                         CFI_node_t  const root,
+                         const char* const keys[],
+                         const int         types[],
+                         size_t            count,
+                         CFI_node_t        results[]
+                         );
+CFI_FUNC cfi_search_begin (
+                          CFI_node_t    const root,
+                          const char*         word,
+                          unsigned            types,
+                          int                 depth,
+                          CFI_cursor_t* const cursor
+                          );
+extern DECLS CFI_node_t DECLC cfi_search_next (CFI_cursor_t const cursor);
+CFI_FUNC cfi_search_end (CFI_cursor_t* const cursor);
 extern DECLS CFI_node_t  DECLC cfi_retain (CFI_node_t node);
 extern DECLS const char* DECLC cfi_release (CFI_node_t node);
 extern DECLS const char* DECLC cfi_delete (CFI_node_t node);
 extern DECLS const char* DECLC cfi_delete_chain (CFI_node_t node);
 extern DECLS int DECLC cfi_node_is_deleted (CFI_node_t node);
+CFI_FUNC cfi_pin (CFI_node_t const node);
+CFI_FUNC cfi_unpin (CFI_node_t const node);
+CFI_FUNC cfi_freeze (CFI_node_t const root, CFI_node_t* const frozen);
+CFI_FUNC cfi_memory_usage (CFI_node_t const root, CFI_memory_t* const stats);
+extern DECLS void DECLC cfi_memory_live (CFI_live_t* const live);
+extern DECLS int DECLC cfi_node_is_frozen (CFI_node_t node);
 
 /* -- CFI Query Attribute Function Prototypes */
 
@@ -379,15 +633,82 @@ extern DECLS char*   DECLC cfi_attribute_word_get (CFI_attr_t const attr);
 extern DECLS char*   DECLC cfi_attribute_string_get (CFI_attr_t const attr);
 extern DECLS double  DECLC cfi_attribute_real_get (CFI_attr_t const attr);
 extern DECLS int32_t DECLC cfi_attribute_int_get (CFI_attr_t const attr);
+extern DECLS const char* DECLC cfi_attribute_word_peek (
+                                                       CFI_attr_t const attr,
+                                                       size_t*    const leng
+                                                       );
+extern DECLS const char* DECLC cfi_attribute_string_peek (
+                                                         CFI_attr_t const attr,
+                                                         size_t*    const leng
+                                                         );
+CFI_FUNC cfi_attribute_text_copy (
+                                 CFI_attr_t const attr,
+                                 char*      const buff,
+                                 size_t           size,
+                                 size_t*    const leng
+                                 );
 
 /* -- CFI Parse's Function Prototypes (DON'T USE THESE) */
 
+struct S_lazy_t;
+struct S_arena_t;
 extern CFI_node_t _cfi_node_join (CFI_node_t, CFI_node_t);
-extern CFI_node_t _cfi_node_word_new (char*);
-extern CFI_node_t _cfi_node_attribute_new (char*, CFI_attr_t);
-extern CFI_node_t _cfi_node_section_new (char*, CFI_attr_t, CFI_node_t);
+extern CFI_node_t _cfi_node_word_new (struct S_arena_t*, char*);
+extern CFI_node_t _cfi_node_attribute_new (
+                                          struct S_arena_t*,
+                                          char*,
+                                          CFI_attr_t
+                                          );
+extern CFI_node_t _cfi_node_section_new (
+                                        struct S_arena_t*,
+                                        char*,
+                                        CFI_attr_t,
+                                        CFI_node_t
+                                        );
+extern CFI_node_t _cfi_node_lazy_new (
+                                     struct S_arena_t*,
+                                     char*,
+                                     CFI_attr_t,
+                                     struct S_lazy_t*
+                                     );
+extern const char* _cfi_lazy_parse (
+                                   struct S_arena_t*,
+                                   struct S_lazy_t*,
+                                   size_t,
+                                   CFI_node_t*
+                                   );
+extern void       _cfi_lazy_del (struct S_lazy_t*);
+extern void       _cfi_node_span_set (CFI_node_t, size_t, size_t, size_t);
+extern const char* _cfi_span_parse (
+                                   struct S_arena_t*,
+                                   const char*,
+                                   size_t,
+                                   size_t,
+                                   CFI_node_t*
+                                   );
 extern CFI_attr_t _cfi_attribute_join (CFI_attr_t, CFI_attr_t);
-extern CFI_attr_t _cfi_attribute_new (void*, int);
+extern CFI_attr_t _cfi_attribute_new (struct S_arena_t*, void*, int);
+extern CFI_attr_t _cfi_attribute_text (
+                                      struct S_arena_t*,
+                                      const char*,
+                                      size_t,
+                                      int
+                                      );
+extern CFI_attr_t _cfi_attribute_heap (CFI_attr_t);
+extern size_t     _cfi_attribute_size (CFI_attr_t);
+extern CFI_attr_t _cfi_attribute_copy (struct S_arena_t*, CFI_attr_t);
+extern char*      _cfi_string_encode (const char*, size_t, char*, size_t*);
+extern size_t     _cfi_string_escape (const char*, size_t, char*);
+extern const CFI_allocator_t* _cfi_allocator (void);
+extern void*      _cfi_malloc (size_t);
+extern void*      _cfi_calloc (size_t, size_t);
+extern void*      _cfi_realloc (void*, size_t);
+extern void       _cfi_free (void*);
+extern void*      _cfi_caller_calloc (size_t, size_t);
+extern void       _cfi_caller_free (void*);
+extern void       _cfi_memory_heap (CFI_memory_t*, size_t);
+extern size_t     _cfi_attribute_usage (CFI_attr_t, CFI_memory_t*);
+extern void       _cfi_lazy_usage (struct S_lazy_t*, CFI_memory_t*, void**);
 
 #undef	CFI_FUNC
 
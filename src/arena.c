@@ -0,0 +1,588 @@
+/*
+ * This file is part of the CFI software.
+ * The license which this software falls under is as follows:
+ *
+ * Copyright (C) 1999-2005 Douglas Jerome <douglas@ttylinux.org>
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+/* *****************************************************************************
+
+FILE NAME
+
+	Name:     arena.c
+	Revision: 1.0
+
+PROGRAM INFORMATION
+
+	Developed by:	CFI project
+
+FILE DESCRIPTION
+
+	Configuration File Interface: Document Arena
+
+	This file makes, grows and frees the document arenas described in
+	"arena.h".  The arena is used by one thread at a time: the parse that
+	makes the document, and then whoever has the document.
+
+***************************************************************************** */
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      F e a t u r e   S w i t c h e s                                      */
+/*                                                                           */
+/* ************************************************************************* */
+
+/*
+ * Select these feature by moving them from the `if UNDEF' into the `else'
+ * section.
+ */
+#ifdef	UNDEF
+#   define	_BSD_SOURCE	1	/* 4.3+bsd subsystems           */
+#   define	_POSIX_SOURCE	1	/* posix.1                      */
+#   define	_POSIX_C_SOURCE	199309L	/* posix.1 and posix.4          */
+#   define	_POSIX_C_SOURCE	199506L	/* posix.1 and posix.4 and MORE */
+#else
+#   define	_POSIX_C_SOURCE	200112L	/* posix.1 and posix.4 and MORE */
+#   undef	_REENTRANT
+#   define	_REENTRANT		/* thread-safe for glibc        */
+#endif
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      I n c l u d e d   F i l e s                                          */
+/*                                                                           */
+/* ************************************************************************* */
+
+/*
+ * OS Specific Header Files
+ */
+#ifdef	WIN32
+#   include	"stdafx.h"
+#endif
+
+/*
+ * Standard C (ANSI) Header Files
+ */
+#include	<stdlib.h>
+#include	<string.h>
+
+/*
+ * Posix Header Files
+ */
+#ifndef	WIN32
+#   include	<unistd.h> /* always first amongst POSIX header files */
+#endif
+
+/*
+ * Project Specific Header Files
+ */
+#include	"arena.h"
+#include	"live.h"
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      C o n s t a n t s                                                    */
+/*                                                                           */
+/* ************************************************************************* */
+
+/* (none) */
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      E x e c u t a b l e   C o d e   (Locally Used Functions)             */
+/*                                                                           */
+/* ************************************************************************* */
+
+
+/*****************************************************************************
+ * Private Function Prototypes
+ *****************************************************************************/
+
+static __inline__ void* arena_malloc (S_arena_t* arena, size_t size);
+static __inline__ void arena_free (S_arena_t* arena, void* ptr);
+static void blocks_del (S_arena_t* arena, S_block_t* block);
+static void blocks_adopt (S_block_t** chain, S_block_t** other);
+static int keys_grow (S_arena_t* arena);
+static size_t keys_usage (S_arena_t* arena, CFI_memory_t* stats, size_t used);
+
+
+/*****************************************************************************
+ * Private Functions arena_malloc, arena_free
+ *****************************************************************************
+ *
+ * An arena's blocks and key table are from the allocator of the arena.
+ *
+ *****************************************************************************/
+
+static __inline__ void* arena_malloc (S_arena_t* a_arena, size_t a_size)
+   {
+   return (*a_arena->allocator.malloc_hook) (a_arena->allocator.user, a_size);
+   }
+
+static __inline__ void arena_free (S_arena_t* a_arena, void* a_ptr)
+   {
+   (*a_arena->allocator.free_hook) (a_arena->allocator.user, a_ptr);
+   }
+
+
+/*****************************************************************************
+ * Private Function blocks_del
+ *****************************************************************************/
+
+static void blocks_del (S_arena_t* a_arena, S_block_t* a_block)
+   {
+   S_block_t* next;
+
+   while (a_block != NULL)
+      {
+      next = a_block->next;
+      CFI_LIVE_SUB (arenaBytes, sizeof(S_block_t) + a_block->size);
+      arena_free (a_arena, a_block);
+      a_block = next;
+      }
+   }
+
+
+/*****************************************************************************
+ * Private Function blocks_adopt
+ *****************************************************************************
+ *
+ * This function moves the chain of blocks "a_other" into "a_chain", behind
+ * its newest block, which is still the one that is filled.
+ *
+ *****************************************************************************/
+
+static void blocks_adopt (S_block_t** a_chain, S_block_t** a_other)
+   {
+   S_block_t* last;
+
+   if (*a_other == NULL) return;
+
+   for (last = *a_other ; last->next != NULL ; last = last->next) ;
+   if (*a_chain == NULL)
+      *a_chain = *a_other;
+   else
+      {
+      last->next = (*a_chain)->next;
+      (*a_chain)->next = *a_other;
+      }
+   *a_other = NULL;
+   }
+
+
+/*****************************************************************************
+ * Private Function keys_usage
+ *****************************************************************************
+ *
+ * This function counts the keys of the key table of an arena in the words of
+ * a document, and adds their bytes to "a_used", which it gives back.
+ *
+ *****************************************************************************/
+
+static size_t keys_usage (
+                         S_arena_t*    a_arena,
+                         CFI_memory_t* a_stats,
+                         size_t        a_used
+                         )
+   {
+   size_t size;
+   size_t i;
+
+   for (i = 0 ; i < a_arena->keySlots ; i++)
+      {
+      if (a_arena->keys[i] == NULL) continue;
+      size = CFI_ARENA_ROUND (sizeof(S_key_t) + a_arena->keys[i]->leng + 1);
+      a_stats->words     += 1;
+      a_stats->wordBytes += size;
+      a_used             += size;
+      }
+
+   return a_used;
+   }
+
+
+/*****************************************************************************
+ * Private Function keys_grow
+ *****************************************************************************
+ *
+ * This function doubles the slots of the key table of an arena, or makes its
+ * first slots; the table is kept at most half full.
+ *
+ *****************************************************************************/
+
+static int keys_grow (S_arena_t* a_arena)
+   {
+   size_t    slots = a_arena->keySlots == 0 ? CFI_ARENA_KEYS :
+                     2 * a_arena->keySlots;
+   S_key_t** keys  = (S_key_t**)arena_malloc (
+                                              a_arena,
+                                              slots*sizeof(S_key_t*)
+                                              );
+   size_t    i;
+   size_t    j;
+
+   if (keys == NULL) return -1;
+
+   for (i = 0 ; i < slots ; i++) keys[i] = NULL;
+
+   for (i = 0 ; i < a_arena->keySlots ; i++)
+      {
+      if (a_arena->keys[i] == NULL) continue;
+      j = a_arena->keys[i]->hash & (slots-1);
+      while (keys[j] != NULL) j = (j+1) & (slots-1);
+      keys[j] = a_arena->keys[i];
+      }
+
+   if (a_arena->keys != NULL) arena_free (a_arena, a_arena->keys);
+   a_arena->keys     = keys;
+   a_arena->keySlots = slots;
+
+   return 0;
+   }
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      E x e c u t a b l e   C o d e   (External Interface Functions)       */
+/*                                                                           */
+/* ************************************************************************* */
+
+
+/*****************************************************************************
+ * Public Function cfi_arena_new
+ *****************************************************************************
+ *
+ * This function makes an empty arena that gets blocks of "a_blockSize" bytes
+ * as it needs them, from "a_allocator", or from the allocator of libcfi if it
+ * is NULL; the arena is busy until cfi_arena_done().
+ *
+ *****************************************************************************/
+
+S_arena_t* (cfi_arena_new) (
+                           size_t                 a_blockSize,
+                           const CFI_allocator_t* a_allocator
+                           )
+   {
+   S_arena_t* arena;
+
+   if (a_allocator == NULL) a_allocator = _cfi_allocator ();
+   arena = (S_arena_t*)(*a_allocator->malloc_hook) (
+                                                   a_allocator->user,
+                                                   sizeof(S_arena_t)
+                                                   );
+   if (arena == NULL) return NULL;
+   CFI_LIVE_ADD (arenas, 1);
+
+   arena->block     = NULL;
+   arena->pool      = NULL;
+   arena->owner     = NULL;
+   arena->adopted   = NULL;
+   arena->next      = NULL;
+   arena->blockSize = CFI_ARENA_ROUND (a_blockSize);
+   arena->blocks    = 0;
+   arena->size      = 0;
+   arena->used      = 0;
+   arena->nodes     = 0;
+   arena->retains   = 0;
+   arena->mixed     = 0;
+   arena->busy      = 1;
+   arena->root      = NULL;
+   arena->keys      = NULL;
+   arena->keySlots  = 0;
+   arena->keyCount  = 0;
+   arena->allocator = *a_allocator;
+
+   arena->pins.count     = 0;
+   arena->pins.lock      = 0;
+   arena->pins.kept      = NULL;
+   arena->pins.keptCount = 0;
+   arena->pins.keptSpace = 0;
+
+   return arena;
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_arena_del
+ *****************************************************************************
+ *
+ * This function frees all of the blocks of an arena, the arenas it took over,
+ * and the arena itself, with its key table.
+ *
+ *****************************************************************************/
+
+void (cfi_arena_del) (S_arena_t* a_arena)
+   {
+   S_arena_t* adopted;
+
+   blocks_del (a_arena, a_arena->block);
+   blocks_del (a_arena, a_arena->pool);
+
+   while (a_arena->adopted != NULL)
+      {
+      adopted = a_arena->adopted;
+      a_arena->adopted = adopted->next;
+      cfi_arena_del (adopted);
+      }
+
+   if (a_arena->keys != NULL) arena_free (a_arena, a_arena->keys);
+   arena_free (a_arena, a_arena);
+   CFI_LIVE_SUB (arenas, 1);
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_arena_grow
+ *****************************************************************************
+ *
+ * This function is cfi_arena_take() for "a_size" bytes, already rounded up,
+ * that don't fit in the newest block of "a_chain".  They get a new block, and
+ * it becomes the newest block; but if they are more than a block, they get a
+ * block of their own, behind the newest block, which is still used.
+ *
+ *****************************************************************************/
+
+void* (cfi_arena_grow) (
+                       S_arena_t*  a_arena,
+                       S_block_t** a_chain,
+                       size_t      a_size
+                       )
+   {
+   S_block_t* block;
+   size_t     size = a_size > a_arena->blockSize ? a_size : a_arena->blockSize;
+
+   block = (S_block_t*)arena_malloc (a_arena, sizeof(S_block_t) + size);
+   if (block == NULL) return NULL;
+   CFI_LIVE_ADD (arenaBytes, sizeof(S_block_t) + size);
+
+   block->size = size;
+   block->used = a_size;
+   if ((a_size > a_arena->blockSize) && (*a_chain != NULL))
+      {
+      block->next = (*a_chain)->next;
+      (*a_chain)->next = block;
+      }
+   else
+      {
+      block->next = *a_chain;
+      *a_chain    = block;
+      }
+
+   a_arena->blocks += 1;
+   a_arena->size   += size;
+   a_arena->used   += a_size;
+
+   return block + 1;
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_arena_adopt
+ *****************************************************************************
+ *
+ * This function makes "a_arena" the owner of the blocks and the nodes of
+ * "a_other", which is kept, empty, until "a_arena" is freed, for the nodes
+ * and keys that point to it; its key table is kept too.
+ *
+ *****************************************************************************/
+
+void (cfi_arena_adopt) (S_arena_t* a_arena, S_arena_t* a_other)
+   {
+   blocks_adopt (&a_arena->block, &a_other->block);
+   blocks_adopt (&a_arena->pool, &a_other->pool);
+
+   a_arena->blocks  += a_other->blocks;
+   a_arena->size    += a_other->size;
+   a_arena->used    += a_other->used;
+   a_arena->nodes   += a_other->nodes;
+   a_arena->retains += a_other->retains;
+   a_arena->mixed   |= a_other->mixed;
+
+   a_other->owner   = a_arena;
+   a_other->next    = a_arena->adopted;
+   a_other->busy    = 0;
+   a_arena->adopted = a_other;
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_arena_usage
+ *****************************************************************************
+ *
+ * This function counts an arena, and the arenas it took over, in the memory of
+ * a document: the keys of their key tables are words of the document, and the
+ * rest of the arena that is not in "a_used", the bytes of the arena that the
+ * other objects of the document take, is overhead.
+ *
+ *****************************************************************************/
+
+void (cfi_arena_usage) (
+                       S_arena_t*    a_arena,
+                       CFI_memory_t* a_stats,
+                       size_t        a_used
+                       )
+   {
+   S_arena_t* arena;
+   size_t     size = 0;
+
+   if (a_arena->owner == NULL)
+      {
+      size   = a_arena->blocks*sizeof(S_block_t) + a_arena->size;
+      a_used = keys_usage (a_arena, a_stats, a_used);
+      }
+   else
+      a_used = 0;
+
+   size += sizeof(S_arena_t) + a_arena->keySlots*sizeof(S_key_t*);
+   for (arena = a_arena->adopted ; arena != NULL ; arena = arena->next)
+      {
+      a_used = keys_usage (arena, a_stats, a_used);
+      cfi_arena_usage (arena, a_stats, 0);
+      }
+
+   a_stats->overhead += size - a_used;
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_arena_done
+ *****************************************************************************
+ *
+ * This function ends the parse that makes nodes from the arena; "a_root" is
+ * the chain of nodes it made.  The arena is freed if there are no nodes.
+ *
+ *****************************************************************************/
+
+void (cfi_arena_done) (S_arena_t* a_arena, CFI_node_t a_root)
+   {
+   a_arena->busy = 0;
+   a_arena->root = a_root;
+   if (a_arena->nodes == 0) cfi_arena_del (a_arena);
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_arena_release
+ *****************************************************************************
+ *
+ * This function is called for each node from the arena that is deallocated;
+ * the arena is freed with the last of its nodes, unless a parse is still
+ * making nodes from it.
+ *
+ *****************************************************************************/
+
+void (cfi_arena_release) (S_arena_t* a_arena)
+   {
+   a_arena->nodes -= 1;
+   if ((a_arena->nodes == 0) && !a_arena->busy) cfi_arena_del (a_arena);
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_arena_key
+ *****************************************************************************
+ *
+ * This function gives the key of "a_leng" bytes of text, which need not be
+ * '\0' terminated, from the key table of the arena; a new key is made from
+ * the arena.  NULL is returned if there is no memory.
+ *
+ *****************************************************************************/
+
+char* (cfi_arena_key) (S_arena_t* a_arena, const char* a_text, size_t a_leng)
+   {
+   size_t   hash = cfi_arena_hash (a_text, a_leng);
+   S_key_t* key;
+   size_t   i;
+
+   if (((a_arena->keyCount+1) * 2 > a_arena->keySlots) &&
+       (keys_grow(a_arena) != 0))
+      {
+      return NULL;
+      }
+
+   for (
+       i = hash & (a_arena->keySlots-1) ;
+       (key = a_arena->keys[i]) != NULL ;
+       i = (i+1) & (a_arena->keySlots-1)
+       )
+      {
+      if ((key->hash == hash) && (key->leng == a_leng) &&
+          (memcmp(key+1,a_text,a_leng) == 0))
+         {
+         return (char*)(key+1);
+         }
+      }
+
+   key = (S_key_t*)cfi_arena_alloc (a_arena, sizeof(S_key_t) + a_leng+1);
+   if (key == NULL) return NULL;
+   key->arena = a_arena;
+   key->hash  = hash;
+   key->leng  = a_leng;
+   (void)memcpy (key+1, a_text, a_leng);
+   ((char*)(key+1))[a_leng] = '\0';
+
+   a_arena->keys[i]   = key;
+   a_arena->keyCount += 1;
+
+   return (char*)(key+1);
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_arena_key_find
+ *****************************************************************************
+ *
+ * This function gives the key of the text from the key table of the arena,
+ * or NULL if the table doesn't have it; "a_hash" is from cfi_arena_hash().
+ *
+ *****************************************************************************/
+
+const char* (cfi_arena_key_find) (
+                                 S_arena_t*  a_arena,
+                                 const char* a_text,
+                                 size_t      a_leng,
+                                 size_t      a_hash
+                                 )
+   {
+   S_key_t* key;
+   size_t   i;
+
+   if (a_arena->keySlots == 0) return NULL;
+
+   for (
+       i = a_hash & (a_arena->keySlots-1) ;
+       (key = a_arena->keys[i]) != NULL ;
+       i = (i+1) & (a_arena->keySlots-1)
+       )
+      {
+      if ((key->hash == a_hash) && (key->leng == a_leng) &&
+          (memcmp(key+1,a_text,a_leng) == 0))
+         {
+         return (const char*)(key+1);
+         }
+      }
+
+   return NULL;
+   }
+
+
+/* end of file */
@@ -0,0 +1,344 @@
+/*
+ * This file is part of the CFI software.
+ * The license which this software falls under is as follows:
+ *
+ * Copyright (C) 1999-2005 Douglas Jerome <douglas@ttylinux.org>
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+/* *****************************************************************************
+
+FILE NAME
+
+	Name:     arena.h
+	Revision: 1.0
+
+PROGRAM INFORMATION
+
+	Developed by:	CFI project
+
+FILE DESCRIPTION
+
+	Configuration File Interface:
+
+	This file exports the interface to the document arena, the memory that
+	a parse can make the nodes, attributes and strings of one document
+	from.
+
+	The arena is a chain of blocks, and the memory is handed out from the
+	newest block in order; nothing is given back to the arena until all of
+	it is freed at once.  A node from the arena has a pointer to it.  The
+	arena counts the nodes from it that are not deleted, and it is freed
+	with the last of them, so the whole document goes in one step when its
+	root chain is deleted.
+
+	The nodes are made from blocks of their own, the node pool, apart from
+	the attributes and strings, so the nodes of a document are together in
+	the order they were made, and a walk of the tree reads one node after
+	another rather than skipping over the rest of the document.
+
+	The arena has a key table for the words of the nodes: each word is
+	made once, as a key, and every node with that word points to it, so
+	two nodes from the arena have the same word if they have the same
+	pointer.
+
+***************************************************************************** */
+
+
+#ifndef CFI_ARENA_H
+#define CFI_ARENA_H 1
+
+
+#ifdef	__cplusplus
+extern	"C"	{
+#endif
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      I n c l u d e d   F i l e s                                          */
+/*                                                                           */
+/* ************************************************************************* */
+
+#include	<stddef.h>
+#include	"CFI.h"
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      M a n i f e s t   C o n s t a n t s                                  */
+/*                                                                           */
+/* ************************************************************************* */
+
+#define	CFI_ARENA_ALIGN	(8)     /* every allocation is a multiple of this */
+#define	CFI_ARENA_KEYS	(64)    /* first number of slots of a key table    */
+#define	CFI_ARENA_BLOCK	(65536) /* block size, if the parser has none      */
+
+/*
+ * The bytes of the arena that an allocation of "size" bytes takes.
+ */
+#define	CFI_ARENA_ROUND(size) \
+	(((size) + (CFI_ARENA_ALIGN-1)) & ~(size_t)(CFI_ARENA_ALIGN-1))
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      D a t a   T y p e s   a n d   S t r u c t u r e s                    */
+/*                                                                           */
+/* ************************************************************************* */
+
+typedef struct S_block_t
+   {
+   struct S_block_t* next; /* the block that was filled before this one */
+   size_t            size; /* bytes in the block, after this header     */
+   size_t            used; /* bytes of the block that are handed out    */
+   }
+   S_block_t;
+
+/*
+ * A key is kept after this header, with a '\0'; the header tells which arena
+ * has the key in its table, since the nodes of a document can have keys from
+ * the arenas of the parts of the document too.
+ */
+typedef struct S_key_t
+   {
+   struct S_arena_t* arena; /* the arena with the key in its key table */
+   size_t            hash;  /* hash of the key, from cfi_arena_hash()  */
+   size_t            leng;  /* bytes of the key, without its '\0'      */
+   }
+   S_key_t;
+
+/*
+ * The pins of a document, from cfi_pin(), and the nodes of it that were
+ * deleted while there were any, which are kept until the last pin is taken
+ * off and are then freed in the order they were deleted; a kept node with an
+ * arena is the root of a whole document, and the arena is freed (data_node.c).
+ */
+typedef struct S_kept_t
+   {
+   CFI_node_t        node;
+   struct S_arena_t* arena; /* the arena of a whole document, or NULL */
+   }
+   S_kept_t;
+
+typedef struct S_pins_t
+   {
+   size_t    count;     /* pins, or PIN_FREEING              */
+   int       lock;      /* a thread is putting nodes in kept */
+   S_kept_t* kept;      /* the kept nodes, from the heap     */
+   size_t    keptCount; /* kept nodes                        */
+   size_t    keptSpace; /* room for kept nodes               */
+   }
+   S_pins_t;
+
+/*
+ * An arena of a part of a document that was parsed by a thread of its own is
+ * taken over by the arena of the document, which then owns its blocks; the
+ * nodes from the part still point to the part's arena, and get to the arena
+ * of the document through "owner".
+ */
+typedef struct S_arena_t
+   {
+   S_block_t*        block;     /* the newest block, and then the others   */
+   S_block_t*        pool;      /* the newest block of nodes, and others   */
+   struct S_arena_t* owner;     /* the arena that took this one over       */
+   struct S_arena_t* adopted;   /* the arenas this one took over           */
+   struct S_arena_t* next;      /* the next arena taken over by the owner  */
+   size_t            blockSize; /* size of a new block                     */
+   size_t            blocks;    /* number of blocks                        */
+   size_t            size;      /* bytes in the blocks                     */
+   size_t            used;      /* bytes handed out                        */
+   size_t            nodes;     /* nodes from the arena, not deleted       */
+   size_t            retains;   /* retain counts of the nodes              */
+   int               mixed;     /* the document has memory of the heap too */
+   int               busy;      /* a parse is making nodes from the arena  */
+   CFI_node_t        root;      /* the first node of the document          */
+   S_key_t**         keys;      /* the key table, hashed, from the heap    */
+   size_t            keySlots;  /* slots of the key table, a power of two  */
+   size_t            keyCount;  /* keys in the key table                   */
+   CFI_allocator_t   allocator; /* what the memory of the arena is from    */
+   S_pins_t          pins;      /* the pins of the document                */
+   }
+   S_arena_t;
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      F u n c t i o n   P r o t o t y p e s                                */
+/*                                                                           */
+/* ************************************************************************* */
+
+extern S_arena_t* cfi_arena_new (
+                                 size_t                 blockSize,
+                                 const CFI_allocator_t* allocator
+                                 );
+extern void cfi_arena_del (S_arena_t* arena);
+extern void* cfi_arena_grow (
+                             S_arena_t*  arena,
+                             S_block_t** chain,
+                             size_t      size
+                             );
+extern void cfi_arena_adopt (S_arena_t* arena, S_arena_t* other);
+extern void cfi_arena_done (S_arena_t* arena, CFI_node_t root);
+extern void cfi_arena_release (S_arena_t* arena);
+extern void cfi_arena_usage (
+                            S_arena_t*    arena,
+                            CFI_memory_t* stats,
+                            size_t        used
+                            );
+extern char* cfi_arena_key (S_arena_t* arena, const char* text, size_t leng);
+extern const char* cfi_arena_key_find (
+                                      S_arena_t*  arena,
+                                      const char* text,
+                                      size_t      leng,
+                                      size_t      hash
+                                      );
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      I n l i n e   F u n c t i o n s                                      */
+/*                                                                           */
+/* ************************************************************************* */
+
+
+/*****************************************************************************
+ * Inline Function Prototypes
+ *****************************************************************************/
+
+static __inline__ void* cfi_arena_take (
+                                       S_arena_t*  arena,
+                                       S_block_t** chain,
+                                       size_t      size
+                                       );
+static __inline__ void* cfi_arena_alloc (S_arena_t* arena, size_t size);
+static __inline__ void* cfi_arena_node (S_arena_t* arena, size_t size);
+static __inline__ S_arena_t* cfi_arena_owner (S_arena_t* arena);
+static __inline__ size_t cfi_arena_hash (const char* text, size_t leng);
+static __inline__ S_arena_t* cfi_arena_key_arena (const char* key);
+
+
+/*****************************************************************************
+ * Inline Function cfi_arena_take
+ *****************************************************************************
+ *
+ * This function hands out "a_size" bytes from the newest block of a chain of
+ * blocks of the arena, or from a new block if they don't fit; the memory is
+ * not cleared.
+ *
+ *****************************************************************************/
+
+static __inline__ void* cfi_arena_take (
+                                       S_arena_t*  a_arena,
+                                       S_block_t** a_chain,
+                                       size_t      a_size
+                                       )
+   {
+   S_block_t* block = *a_chain;
+   void*      p;
+
+   a_size = CFI_ARENA_ROUND (a_size);
+   if ((block == NULL) || ((block->size - block->used) < a_size))
+      {
+      return cfi_arena_grow (a_arena, a_chain, a_size);
+      }
+
+   p = (char*)(block + 1) + block->used;
+   block->used   += a_size;
+   a_arena->used += a_size;
+
+   return p;
+   }
+
+
+/*****************************************************************************
+ * Inline Functions cfi_arena_alloc, cfi_arena_node
+ *****************************************************************************
+ *
+ * These functions hand out "a_size" bytes for attributes, strings and the
+ * like, and for a node from the node pool.
+ *
+ *****************************************************************************/
+
+static __inline__ void* cfi_arena_alloc (S_arena_t* a_arena, size_t a_size)
+   {
+   return cfi_arena_take (a_arena, &a_arena->block, a_size);
+   }
+
+static __inline__ void* cfi_arena_node (S_arena_t* a_arena, size_t a_size)
+   {
+   return cfi_arena_take (a_arena, &a_arena->pool, a_size);
+   }
+
+
+/*****************************************************************************
+ * Inline Function cfi_arena_owner
+ *****************************************************************************/
+
+static __inline__ S_arena_t* cfi_arena_owner (S_arena_t* a_arena)
+   {
+   while (a_arena->owner != NULL) a_arena = a_arena->owner;
+   return a_arena;
+   }
+
+
+/*****************************************************************************
+ * Inline Function cfi_arena_hash
+ *****************************************************************************
+ *
+ * This function is the FNV-1a hash of "a_leng" bytes of text, for the key
+ * tables.
+ *
+ *****************************************************************************/
+
+static __inline__ size_t cfi_arena_hash (const char* a_text, size_t a_leng)
+   {
+   size_t hash = (size_t)2166136261UL;
+
+   while (a_leng-- > 0)
+      {
+      hash ^= (unsigned char)*a_text++;
+      hash *= (size_t)16777619UL;
+      }
+
+   return hash;
+   }
+
+
+/*****************************************************************************
+ * Inline Function cfi_arena_key_arena
+ *****************************************************************************
+ *
+ * This function gives the arena with a key from cfi_arena_key() in its table.
+ *
+ *****************************************************************************/
+
+static __inline__ S_arena_t* cfi_arena_key_arena (const char* a_key)
+   {
+   return ((const S_key_t*)a_key - 1)->arena;
+   }
+
+
+#ifdef	__cplusplus
+}
+#endif
+
+
+#endif
+
+
+/* end of file */
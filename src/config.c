@@ -90,7 +90,7 @@ CHANGE LOG
 /*
  * Standard C (ANSI) Header Files
  */
-/* (none) */
+#include	<stdlib.h>
 
 /*
  * Posix Header Files
@@ -98,6 +98,9 @@ CHANGE LOG
 #ifndef	WIN32
 #   include	<unistd.h> /* always first amongst POSIX header files */
 #endif
+#ifdef	_unix
+#   include	<pthread.h>
+#endif
 
 /*
  * Project Specific Header Files
@@ -112,6 +115,7 @@ CHANGE LOG
 #   error  ***** Unknown build configuration.
 #endif
 #include	"CFI.h"
+#include	"live.h"
 
 
 /* ************************************************************************* */
@@ -138,7 +142,19 @@ CHANGE LOG
 /*                                                                           */
 /* ************************************************************************* */
 
-/* (none) */
+#if	CFI_LIVE_THREADS
+/*
+ * The live memory that one thread counted; the tallies of the threads that
+ * are running are in a list, and the tally of a thread that ends is added to
+ * _cfi_live.
+ */
+typedef struct S_tally_t
+   {
+   CFI_live_t        live; /* first, for _cfi_tally */
+   struct S_tally_t* next;
+   }
+   S_tally_t;
+#endif
 
 
 /* ************************************************************************* */
@@ -150,6 +166,12 @@ CHANGE LOG
 int CFI_debugLexical;
 int CFI_debugGrammar;
 
+CFI_live_t _cfi_live; /* the live memory of libcfi, for cfi_memory_live() */
+
+#if	CFI_LIVE_THREADS
+__thread CFI_live_t* _cfi_tally; /* the tally of the thread, or NULL */
+#endif
+
 
 /* ************************************************************************* */
 /*                                                                           */
@@ -157,7 +179,46 @@ int CFI_debugGrammar;
 /*                                                                           */
 /* ************************************************************************* */
 
-/* (none) */
+/*
+ * The C library's memory functions, as allocator hooks.
+ */
+static void* std_malloc (void* user, size_t size);
+static void* std_calloc (void* user, size_t count, size_t size);
+static void* std_realloc (void* user, void* ptr, size_t size);
+static void std_free (void* user, void* ptr);
+static void live_add (CFI_live_t* live, const CFI_live_t* tally);
+#if	CFI_LIVE_THREADS
+static void tally_key (void);
+static void tally_end (void* tally);
+#endif
+
+static unsigned g_threads = 1; /* threads for a parse by a new parser */
+
+#if	CFI_LIVE_THREADS
+static pthread_mutex_t g_tallyLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t  g_tallyOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t   g_tallyKey;      /* ends the tally of a thread */
+static int             g_tallyKeyed;    /* g_tallyKey was made        */
+static S_tally_t*      g_tallies;       /* of the running threads     */
+#endif
+
+static const CFI_allocator_t g_stdAllocator =
+   {
+   std_malloc,
+   std_calloc,
+   std_realloc,
+   std_free,
+   NULL
+   };
+
+static CFI_allocator_t g_allocator = /* what libcfi allocates memory with */
+   {
+   std_malloc,
+   std_calloc,
+   std_realloc,
+   std_free,
+   NULL
+   };
 
 
 /* ************************************************************************* */
@@ -171,14 +232,99 @@ int CFI_debugGrammar;
  * Private Function Prototypes
  *****************************************************************************/
 
-/* (none) */
+/* (with the private global variables) */
 
 
 /*****************************************************************************
- * Private Function
+ * Private Functions std_malloc, std_calloc, std_realloc, std_free
+ *****************************************************************************
+ *
+ * These are the C library's memory functions, as allocator hooks.
+ *
  *****************************************************************************/
 
-/* (none) */
+static void* std_malloc (void* a_user, size_t a_size)
+   {
+   (void)a_user;
+   return malloc (a_size);
+   }
+
+static void* std_calloc (void* a_user, size_t a_count, size_t a_size)
+   {
+   (void)a_user;
+   return calloc (a_count, a_size);
+   }
+
+static void* std_realloc (void* a_user, void* a_ptr, size_t a_size)
+   {
+   (void)a_user;
+   return realloc (a_ptr, a_size);
+   }
+
+static void std_free (void* a_user, void* a_ptr)
+   {
+   (void)a_user;
+   free (a_ptr);
+   }
+
+
+/*****************************************************************************
+ * Private Function live_add
+ *****************************************************************************
+ *
+ * This function adds the counts of a tally to the live memory; the counts
+ * are unsigned, so a tally that freed more than it allocated is added right.
+ *
+ *****************************************************************************/
+
+static void live_add (CFI_live_t* a_live, const CFI_live_t* a_tally)
+   {
+   a_live->allocations += CFI_LIVE_GET (&a_tally->allocations);
+   a_live->arenas      += CFI_LIVE_GET (&a_tally->arenas);
+   a_live->arenaBytes  += CFI_LIVE_GET (&a_tally->arenaBytes);
+   a_live->nodes       += CFI_LIVE_GET (&a_tally->nodes);
+   a_live->attributes  += CFI_LIVE_GET (&a_tally->attributes);
+   }
+
+
+#if	CFI_LIVE_THREADS
+
+/*****************************************************************************
+ * Private Functions tally_key, tally_end
+ *****************************************************************************
+ *
+ * The key of the tallies ends the tally of a thread when the thread ends: the
+ * counts are added to _cfi_live, and the tally is freed.
+ *
+ *****************************************************************************/
+
+static void tally_key (void)
+   {
+   g_tallyKeyed = pthread_key_create (&g_tallyKey, tally_end) == 0;
+   }
+
+static void tally_end (void* a_tally)
+   {
+   S_tally_t*  tally = (S_tally_t*)a_tally;
+   S_tally_t** link;
+
+   (void)pthread_mutex_lock (&g_tallyLock);
+   for (link = &g_tallies ; *link != NULL ; link = &(*link)->next)
+      {
+      if (*link == tally)
+         {
+         *link = tally->next;
+         break;
+         }
+      }
+   live_add (&_cfi_live, &tally->live);
+   (void)pthread_mutex_unlock (&g_tallyLock);
+
+   _cfi_tally = NULL;
+   free (tally);
+   }
+
+#endif
 
 
 /* ************************************************************************* */
@@ -216,6 +362,206 @@ unsigned (cfi_conf_debug) (unsigned a_flags)
    return flags;
    }
 
+unsigned (cfi_conf_threads) (unsigned a_threads)
+   {
+   unsigned threads = g_threads;
+
+   if (a_threads != 0) g_threads = a_threads;
+
+   return threads;
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_set_allocator
+ *****************************************************************************
+ *
+ * This function sets the memory functions that libcfi allocates and frees
+ * its memory with; NULL is for the C library's.  It isn't thread-safe, and
+ * must be called when libcfi has no memory allocated.
+ *
+ *****************************************************************************/
+
+const char* (cfi_set_allocator) (const CFI_allocator_t* const a_allocator)
+   {
+   if (a_allocator == NULL)
+      {
+      g_allocator = g_stdAllocator;
+      return NULL;
+      }
+
+   if ((a_allocator->malloc_hook == NULL) ||
+       (a_allocator->calloc_hook == NULL) ||
+       (a_allocator->realloc_hook == NULL) ||
+       (a_allocator->free_hook == NULL))
+      {
+      return "missing allocator function";
+      }
+
+   g_allocator = *a_allocator;
+
+   return NULL;
+   }
+
+
+/*****************************************************************************
+ * Public Functions _cfi_allocator, _cfi_malloc, _cfi_calloc, _cfi_realloc,
+ *                  _cfi_free
+ *****************************************************************************
+ *
+ * libcfi gets and frees all of its memory with these functions, which call
+ * the allocator from cfi_set_allocator().
+ *
+ *****************************************************************************/
+
+const CFI_allocator_t* (_cfi_allocator) (void)
+   {
+   return &g_allocator;
+   }
+
+void* (_cfi_malloc) (size_t a_size)
+   {
+   void* p = (*g_allocator.malloc_hook) (g_allocator.user, a_size);
+
+   if (p != NULL) CFI_LIVE_ADD (allocations, 1);
+
+   return p;
+   }
+
+void* (_cfi_calloc) (size_t a_count, size_t a_size)
+   {
+   void* p = (*g_allocator.calloc_hook) (g_allocator.user, a_count, a_size);
+
+   if (p != NULL) CFI_LIVE_ADD (allocations, 1);
+
+   return p;
+   }
+
+void* (_cfi_realloc) (void* a_ptr, size_t a_size)
+   {
+   void* p = (*g_allocator.realloc_hook) (g_allocator.user, a_ptr, a_size);
+
+   if ((a_ptr == NULL) && (p != NULL)) CFI_LIVE_ADD (allocations, 1);
+
+   return p;
+   }
+
+void (_cfi_free) (void* a_ptr)
+   {
+   if (a_ptr == NULL) return;
+   (*g_allocator.free_hook) (g_allocator.user, a_ptr);
+
+   CFI_LIVE_SUB (allocations, 1);
+   }
+
+
+/*****************************************************************************
+ * Public Functions _cfi_caller_calloc, _cfi_caller_free
+ *****************************************************************************
+ *
+ * These functions get memory that libcfi hands to the caller, and free memory
+ * that the caller hands to libcfi, with the allocator from
+ * cfi_set_allocator(); the memory is the caller's, so it isn't counted in the
+ * live memory of libcfi.
+ *
+ *****************************************************************************/
+
+void* (_cfi_caller_calloc) (size_t a_count, size_t a_size)
+   {
+   return (*g_allocator.calloc_hook) (g_allocator.user, a_count, a_size);
+   }
+
+void (_cfi_caller_free) (void* a_ptr)
+   {
+   if (a_ptr == NULL) return;
+   (*g_allocator.free_hook) (g_allocator.user, a_ptr);
+   }
+
+
+/*****************************************************************************
+ * Public Function _cfi_memory_heap
+ *****************************************************************************
+ *
+ * This function counts one allocation of "a_size" bytes from the heap in the
+ * memory of a document, with the header that glibc's malloc() puts on it and
+ * the rounding of its size; the caller counts the "a_size" bytes.
+ *
+ *****************************************************************************/
+
+void (_cfi_memory_heap) (CFI_memory_t* a_stats, size_t a_size)
+   {
+   size_t align = 2 * sizeof(size_t);
+   size_t chunk = (a_size + sizeof(size_t) + align-1) & ~(align-1);
+
+   if (chunk < 2*align) chunk = 2*align;
+
+   a_stats->allocations += 1;
+   a_stats->overhead    += chunk - a_size;
+   }
+
+
+#if	CFI_LIVE_THREADS
+
+/*****************************************************************************
+ * Public Function _cfi_tally_new
+ *****************************************************************************
+ *
+ * This function makes the tally of the live memory of the thread, the first
+ * time the thread counts any; the tally is from the C library, not from the
+ * allocator, since it outlasts the allocator that is set.  Without memory for
+ * a tally, the thread counts in _cfi_live, which isn't thread-safe.
+ *
+ *****************************************************************************/
+
+CFI_live_t* (_cfi_tally_new) (void)
+   {
+   S_tally_t* tally;
+
+   (void)pthread_once (&g_tallyOnce, tally_key);
+
+   tally = (S_tally_t*)calloc (1, sizeof(S_tally_t));
+   if (tally == NULL) return &_cfi_live;
+
+   (void)pthread_mutex_lock (&g_tallyLock);
+   tally->next = g_tallies;
+   g_tallies   = tally;
+   (void)pthread_mutex_unlock (&g_tallyLock);
+   if (g_tallyKeyed) (void)pthread_setspecific (g_tallyKey, tally);
+
+   _cfi_tally = &tally->live;
+   return _cfi_tally;
+   }
+
+#endif
+
+
+/*****************************************************************************
+ * Public Function cfi_memory_live
+ *****************************************************************************
+ *
+ * This function gives the live memory of libcfi, the sum of the tallies of
+ * the threads; the counts are each right, but when other threads are using
+ * libcfi they are not all of one moment.
+ *
+ *****************************************************************************/
+
+void (cfi_memory_live) (CFI_live_t* const a_live)
+   {
+#if	CFI_LIVE_THREADS
+   S_tally_t* tally;
+
+   (void)pthread_mutex_lock (&g_tallyLock);
+   *a_live = _cfi_live;
+   for (tally = g_tallies ; tally != NULL ; tally = tally->next)
+      {
+      live_add (a_live, &tally->live);
+      }
+   (void)pthread_mutex_unlock (&g_tallyLock);
+#else
+   *a_live = _cfi_live;
+#endif
+   }
+
 
 /*****************************************************************************
  * Public Function cfi_init
@@ -110,6 +110,7 @@ CHANGE LOG
  * Standard C (ANSI) Header Files
  */
 #include	<stdlib.h>
+#include	<string.h>
 
 /*
  * Posix Header Files
@@ -122,7 +123,8 @@ CHANGE LOG
  * Project Specific Header Files
  */
 #include	"CFI.h"
-#include	"symbol.h"
+#include	"arena.h"
+#include	"live.h"
 
 
 /* ************************************************************************* */
@@ -131,7 +133,7 @@ CHANGE LOG
 /*                                                                           */
 /* ************************************************************************* */
 
-/* (none) */
+#define	ATTR_TEXT	(24) /* text, with its '\0', kept in an attribute */
 
 
 /* ************************************************************************* */
@@ -149,10 +151,33 @@ CHANGE LOG
 /*                                                                           */
 /* ************************************************************************* */
 
+typedef struct S_spill_t
+   {
+   char*  text; /* from the heap, or from the arena of the attribute */
+   size_t size; /* bytes of the text, with its '\0'                   */
+   }
+   S_spill_t;
+
+/*
+ * The text of a word or string attribute, with its '\0', is kept in the
+ * attribute itself when it fits in ATTR_TEXT bytes, and "size" is its size;
+ * longer text is spilled to memory of its own, and "size" is zero.  Numbers
+ * are always kept in the attribute.
+ */
 typedef struct S_attr_t
    {
    struct S_attr_t* next;
-   S_sym_t*         symbol;
+   unsigned char    type;  /* CFI_WORD_ATTRIBUTE, ..., or CFI_HEX_FORMAT, ... */
+   unsigned char    arena; /* the attribute is in a document arena           */
+   unsigned char    size;  /* size of the text in "value.text", or zero      */
+   union
+      {
+      int32_t   integer;
+      double    real;
+      char      text[ATTR_TEXT];
+      S_spill_t spill;
+      }
+      value;
    }
    S_attr_t;
 
@@ -186,14 +211,67 @@ typedef struct S_attr_t
  * Private Function Prototypes
  *****************************************************************************/
 
-/* (none) */
+static S_attr_t* attr_make (S_arena_t* arena, int type);
+static __inline__ int attr_is_text (S_attr_t* attribute);
+static __inline__ const char* attr_text (S_attr_t* attribute);
+static __inline__ size_t attr_size (S_attr_t* attribute);
 
 
 /*****************************************************************************
- * Private Function
+ * Private Function attr_make
+ *****************************************************************************
+ *
+ * This function makes an attribute of the type "a_type" from the arena, if
+ * there is one, or from the heap; it has no value.
+ *
  *****************************************************************************/
 
-/* (none) */
+static S_attr_t* attr_make (S_arena_t* a_arena, int a_type)
+   {
+   S_attr_t* attribute;
+
+   if (a_arena == NULL)
+      attribute = (S_attr_t*)_cfi_malloc (sizeof(S_attr_t));
+   else
+      attribute = (S_attr_t*)cfi_arena_alloc (a_arena, sizeof(S_attr_t));
+   if (attribute == NULL) return NULL;
+   if (a_arena == NULL) CFI_LIVE_ADD (attributes, 1);
+
+   attribute->next             = NULL;
+   attribute->type             = (unsigned char)a_type;
+   attribute->arena            = a_arena != NULL;
+   attribute->size             = 0;
+   attribute->value.spill.text = NULL;
+   attribute->value.spill.size = 0;
+
+   return attribute;
+   }
+
+
+/*****************************************************************************
+ * Private Inline Functions attr_is_text, attr_text, attr_size
+ *****************************************************************************
+ *
+ * These functions get to the text of a word or string attribute, wherever it
+ * is kept; the size includes the '\0'.
+ *
+ *****************************************************************************/
+
+static __inline__ int attr_is_text (S_attr_t* a_attr)
+   {
+   return (a_attr->type == CFI_WORD_ATTRIBUTE) ||
+          (a_attr->type == CFI_STRING_ATTRIBUTE);
+   }
+
+static __inline__ const char* attr_text (S_attr_t* a_attr)
+   {
+   return a_attr->size != 0 ? a_attr->value.text : a_attr->value.spill.text;
+   }
+
+static __inline__ size_t attr_size (S_attr_t* a_attr)
+   {
+   return a_attr->size != 0 ? a_attr->size : a_attr->value.spill.size;
+   }
 
 
 /* ************************************************************************* */
@@ -215,95 +293,99 @@ CFI_attr_t (_cfi_attribute_join) (CFI_attr_t a_attr1, CFI_attr_t a_attr2)
 
 
 /*****************************************************************************
- * Public Function _cfi_attribute_new
+ * Public Function _cfi_attribute_text
+ *****************************************************************************
+ *
+ * This function makes a word or string attribute from "a_leng" bytes of text,
+ * which need not be '\0' terminated, such as a token in the input; the '\'
+ * escapes are converted straight into the attribute's own copy of the text.
+ * Short text is put in the attribute; longer text, and the attribute, are
+ * made from the arena, if there is one.
+ *
  *****************************************************************************/
 
-CFI_attr_t (_cfi_attribute_new) (void* a_data, int a_type)
+CFI_attr_t (_cfi_attribute_text) (
+                                 S_arena_t*  a_arena,
+                                 const char* a_text,
+                                 size_t      a_leng,
+                                 int         a_type
+                                 )
    {
-   S_attr_t* attribute = (S_attr_t*)calloc (1, sizeof(S_attr_t));
-   CFI_sym_t symbol    = sym_new();
+   S_attr_t* attribute = attr_make (a_arena, a_type);
+   char*     text      = NULL;
+   size_t    size;
+
+   if (attribute == NULL) return NULL;
+
+   /*
+    * The converted text is never longer than "a_text", so it fits in the
+    * attribute when "a_text" and a '\0' do.
+    */
+   if (a_leng < ATTR_TEXT)
+      {
+      (void)_cfi_string_encode (a_text, a_leng, attribute->value.text, &size);
+      attribute->size = (unsigned char)size;
+      return attribute;
+      }
 
-   if ((attribute == NULL) || (symbol == NULL))
+   if (a_arena != NULL)
       {
-      if (attribute != NULL) free (attribute);
-      if (symbol    != NULL) sym_del (symbol);
+      text = (char*)cfi_arena_alloc (a_arena, a_leng+1);
+      if (text == NULL) return NULL;
+      }
+   text = _cfi_string_encode (a_text, a_leng, text, &size);
+   if (text == NULL)
+      {
+      (void)cfi_attribute_del (&attribute);
       return NULL;
       }
 
-   attribute->symbol = symbol;
+   attribute->value.spill.text = text;
+   attribute->value.spill.size = size;
+
+   return attribute;
+   }
+
+
+/*****************************************************************************
+ * Public Function _cfi_attribute_new
+ *****************************************************************************/
+
+CFI_attr_t (_cfi_attribute_new) (S_arena_t* a_arena, void* a_data, int a_type)
+   {
+   S_attr_t* attribute;
 
    switch (a_type)
       {
 
       default:
          {
-         free (attribute);
-         sym_del (symbol);
          return NULL;
          }
 
       case CFI_WORD_ATTRIBUTE:
-         {
-         size_t l;
-         char* s = cfi_string_encode (a_data, &l);
-         if (s == NULL)
-            {
-            free (attribute);
-            sym_del (symbol);
-            return NULL;
-            }
-         sym_type_set (symbol, CFI_WORD_ATTRIBUTE);
-         sym_ptr_set (symbol, s, l);
-         break;
-         }
-
       case CFI_STRING_ATTRIBUTE:
          {
-         size_t l;
-         char* s = cfi_string_encode (a_data, &l);
-         if (s == NULL)
-            {
-            free (attribute);
-            sym_del (symbol);
-            return NULL;
-            }
-         sym_type_set (symbol, CFI_STRING_ATTRIBUTE);
-         sym_ptr_set (symbol, s, l);
-         break;
+         if (a_data == NULL) return NULL;
+         return _cfi_attribute_text (a_arena, a_data, strlen(a_data), a_type);
          }
 
       case CFI_REAL_ATTRIBUTE:
          {
-         sym_type_set (symbol, CFI_REAL_ATTRIBUTE);
-         sym_real_set (symbol, *(double*)a_data);
+         attribute = attr_make (a_arena, a_type);
+         if (attribute == NULL) return NULL;
+         attribute->value.real = *(double*)a_data;
          break;
          }
 
       case CFI_HEX_FORMAT:
-         {
-         sym_type_set (symbol, CFI_HEX_FORMAT);
-         sym_int_set (symbol, *(int32_t*)a_data);
-         break;
-         }
-
       case CFI_DEC_FORMAT:
-         {
-         sym_type_set (symbol, CFI_DEC_FORMAT);
-         sym_int_set (symbol, *(int32_t*)a_data);
-         break;
-         }
-
       case CFI_OCT_FORMAT:
-         {
-         sym_type_set (symbol, CFI_OCT_FORMAT);
-         sym_int_set (symbol, *(int32_t*)a_data);
-         break;
-         }
-
       case CFI_BIN_FORMAT:
          {
-         sym_type_set (symbol, CFI_BIN_FORMAT);
-         sym_int_set (symbol, *(int32_t*)a_data);
+         attribute = attr_make (a_arena, a_type);
+         if (attribute == NULL) return NULL;
+         attribute->value.integer = *(int32_t*)a_data;
          break;
          }
 
@@ -323,7 +405,7 @@ const char* (cfi_attribute_new) (
                                 int               a_type
                                 )
    {
-   S_attr_t* attribute = _cfi_attribute_new ((void*)a_data, a_type);
+   S_attr_t* attribute = _cfi_attribute_new (NULL, (void*)a_data, a_type);
 
    if (attribute == NULL) return "can't allocate memory";
    *a_attr = attribute;
@@ -332,18 +414,166 @@ const char* (cfi_attribute_new) (
    }
 
 
+/*****************************************************************************
+ * Public Function _cfi_attribute_heap
+ *****************************************************************************
+ *
+ * This function is for an attribute that is taken out of its node; it gives
+ * the attribute itself, or, for an attribute in a document arena, a copy of
+ * it with memory of its own; only spilled text needs to be copied apart from
+ * the attribute.
+ *
+ *****************************************************************************/
+
+CFI_attr_t (_cfi_attribute_heap) (CFI_attr_t a_attr)
+   {
+   S_attr_t* attribute;
+   char*     text;
+
+   if (!a_attr->arena) return a_attr;
+
+   attribute = attr_make (NULL, a_attr->type);
+   if (attribute == NULL) return NULL;
+
+   *attribute = *a_attr;
+   attribute->arena = 0;
+
+   if (attr_is_text(attribute) && (attribute->size == 0))
+      {
+      text = (char*)_cfi_malloc (attribute->value.spill.size);
+      if (text == NULL)
+         {
+         _cfi_free (attribute);
+         CFI_LIVE_SUB (attributes, 1);
+         return NULL;
+         }
+      (void)memcpy (text, a_attr->value.spill.text, a_attr->value.spill.size);
+      attribute->value.spill.text = text;
+      }
+
+   return attribute;
+   }
+
+
+/*****************************************************************************
+ * Public Function _cfi_attribute_size
+ *****************************************************************************
+ *
+ * This function gives the bytes of an arena that _cfi_attribute_copy() takes
+ * for a copy of an attribute.
+ *
+ *****************************************************************************/
+
+size_t (_cfi_attribute_size) (CFI_attr_t a_attr)
+   {
+   size_t size = CFI_ARENA_ROUND (sizeof(S_attr_t));
+
+   if (attr_is_text(a_attr) && (a_attr->size == 0))
+      {
+      size += CFI_ARENA_ROUND (a_attr->value.spill.size);
+      }
+
+   return size;
+   }
+
+
+/*****************************************************************************
+ * Public Function _cfi_attribute_copy
+ *****************************************************************************
+ *
+ * This function copies one attribute, with its text, into an arena; the copy
+ * is not in a list.
+ *
+ *****************************************************************************/
+
+CFI_attr_t (_cfi_attribute_copy) (S_arena_t* a_arena, CFI_attr_t a_attr)
+   {
+   S_attr_t* attribute = (S_attr_t*)cfi_arena_alloc(a_arena,sizeof(S_attr_t));
+   char*     text;
+
+   if (attribute == NULL) return NULL;
+
+   *attribute = *a_attr;
+   attribute->next  = NULL;
+   attribute->arena = 1;
+
+   if (attr_is_text(attribute) && (attribute->size == 0))
+      {
+      text = (char*)cfi_arena_alloc (a_arena, a_attr->value.spill.size);
+      if (text == NULL) return NULL;
+      (void)memcpy (text, a_attr->value.spill.text, a_attr->value.spill.size);
+      attribute->value.spill.text = text;
+      }
+
+   return attribute;
+   }
+
+
+/*****************************************************************************
+ * Public Function _cfi_attribute_usage
+ *****************************************************************************
+ *
+ * This function counts an attribute, and its text, in the memory of a
+ * document; it gives the bytes of them that are in an arena.
+ *
+ *****************************************************************************/
+
+size_t (_cfi_attribute_usage) (CFI_attr_t a_attr, CFI_memory_t* a_stats)
+   {
+   size_t size  = sizeof(S_attr_t);
+   size_t arena = 0;
+
+   if (a_attr->arena)
+      {
+      size  = CFI_ARENA_ROUND (size);
+      arena = size;
+      }
+   else
+      _cfi_memory_heap (a_stats, size);
+   a_stats->attributes     += 1;
+   a_stats->attributeBytes += size;
+
+   if (attr_is_text(a_attr) && (a_attr->size == 0) &&
+       (a_attr->value.spill.text != NULL))
+      {
+      size = a_attr->value.spill.size;
+      if (a_attr->arena)
+         {
+         size   = CFI_ARENA_ROUND (size);
+         arena += size;
+         }
+      else
+         _cfi_memory_heap (a_stats, size);
+      a_stats->texts     += 1;
+      a_stats->textBytes += size;
+      }
+
+   return arena;
+   }
+
+
 /*****************************************************************************
  * Public Function cfi_attribute_del
+ *****************************************************************************
+ *
+ * An attribute in a document arena is not deallocated; its memory goes with
+ * the arena.  Text in the attribute goes with the attribute.
+ *
  *****************************************************************************/
 
 const char* (cfi_attribute_del) (CFI_attr_t* const a_attr)
    {
    S_attr_t* attribute = *a_attr;
-   CFI_sym_t symbol    = attribute->symbol;
 
-   if (sym_valptr(symbol) != NULL) free (sym_valptr(symbol));
-   sym_del (symbol);
-   free (attribute);
+   if (attribute->arena) return NULL;
+
+   if (attr_is_text(attribute) && (attribute->size == 0))
+      {
+      if (attribute->value.spill.text != NULL)
+         _cfi_free (attribute->value.spill.text);
+      }
+   _cfi_free (attribute);
+   CFI_LIVE_SUB (attributes, 1);
 
    return NULL;
    }
@@ -391,7 +621,7 @@ CFI_attr_t (cfi_attribute_join) (
 
 int (cfi_attribute_type_get) (CFI_attr_t const a_attr)
    {
-   return sym_type (a_attr->symbol);
+   return a_attr->type;
    }
 
 
@@ -401,11 +631,8 @@ int (cfi_attribute_type_get) (CFI_attr_t const a_attr)
 
 char* (cfi_attribute_word_get) (CFI_attr_t const a_attr)
    {
-   if (sym_type(a_attr->symbol) != CFI_WORD_ATTRIBUTE) return NULL;
-   return cfi_string_decode (
-                            sym_valptr (a_attr->symbol),
-                            sym_valptrlen (a_attr->symbol)
-                            );
+   if (a_attr->type != CFI_WORD_ATTRIBUTE) return NULL;
+   return cfi_string_decode (attr_text(a_attr), attr_size(a_attr));
    }
 
 
@@ -416,11 +643,71 @@ char* (cfi_attribute_word_get) (CFI_attr_t const a_attr)
 char* (cfi_attribute_string_get) (CFI_attr_t const a_attr)
 
    {
-   if (a_attr->symbol->type != CFI_STRING_ATTRIBUTE) return NULL;
-   return cfi_string_decode (
-                            sym_valptr (a_attr->symbol),
-                            sym_valptrlen (a_attr->symbol)
-                            );
+   if (a_attr->type != CFI_STRING_ATTRIBUTE) return NULL;
+   return cfi_string_decode (attr_text(a_attr), attr_size(a_attr));
+   }
+
+
+/*****************************************************************************
+ * Public Functions cfi_attribute_word_peek, cfi_attribute_string_peek
+ *****************************************************************************
+ *
+ * These functions lend the caller the text of a word or string attribute as
+ * it is kept, without '\' escapes, and give its length, not counting the
+ * '\0' that ends it, in "*a_leng" (unless "a_leng" is NULL).  Nothing is
+ * allocated; the text is good until the attribute is changed or deleted.
+ *
+ *****************************************************************************/
+
+const char* (cfi_attribute_word_peek) (
+                                      CFI_attr_t const a_attr,
+                                      size_t*    const a_leng
+                                      )
+   {
+   if (a_attr->type != CFI_WORD_ATTRIBUTE) return NULL;
+   if (a_leng != NULL) *a_leng = attr_size(a_attr) - 1;
+   return attr_text (a_attr);
+   }
+
+const char* (cfi_attribute_string_peek) (
+                                        CFI_attr_t const a_attr,
+                                        size_t*    const a_leng
+                                        )
+   {
+   if (a_attr->type != CFI_STRING_ATTRIBUTE) return NULL;
+   if (a_leng != NULL) *a_leng = attr_size(a_attr) - 1;
+   return attr_text (a_attr);
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_attribute_text_copy
+ *****************************************************************************
+ *
+ * This function copies the text of a word or string attribute, as it is
+ * kept, and a '\0' into the "a_size" bytes at "a_buff", and gives the length
+ * of the text in "*a_leng" (unless "a_leng" is NULL), even if it doesn't fit.
+ *
+ *****************************************************************************/
+
+const char* (cfi_attribute_text_copy) (
+                                      CFI_attr_t const a_attr,
+                                      char*      const a_buff,
+                                      size_t           a_size,
+                                      size_t*    const a_leng
+                                      )
+   {
+   size_t size;
+
+   if (a_attr == NULL) return "no attribute";
+   if (!attr_is_text(a_attr)) return "wrong attribute type";
+
+   size = attr_size (a_attr);
+   if (a_leng != NULL) *a_leng = size - 1;
+   if ((a_buff == NULL) || (size > a_size)) return "buffer too small";
+
+   (void)memcpy (a_buff, attr_text(a_attr), size);
+   return NULL;
    }
 
 
@@ -430,8 +717,8 @@ char* (cfi_attribute_string_get) (CFI_attr_t const a_attr)
 
 double (cfi_attribute_real_get) (CFI_attr_t const a_attr)
    {
-   if (sym_type(a_attr->symbol) != CFI_REAL_ATTRIBUTE) return 0.0f;
-   return sym_valreal (a_attr->symbol);
+   if (a_attr->type != CFI_REAL_ATTRIBUTE) return 0.0f;
+   return a_attr->value.real;
    }
 
 
@@ -441,11 +728,11 @@ double (cfi_attribute_real_get) (CFI_attr_t const a_attr)
 
 int32_t (cfi_attribute_int_get) (CFI_attr_t const a_attr)
    {
-   if ((sym_type(a_attr->symbol) & CFI_INT_ATTRIBUTE) != CFI_INT_ATTRIBUTE)
+   if ((a_attr->type & CFI_INT_ATTRIBUTE) != CFI_INT_ATTRIBUTE)
       {
       return 0;
       }
-   return sym_valint (a_attr->symbol);
+   return a_attr->value.integer;
    }
 
 
@@ -110,6 +110,7 @@ CHANGE LOG
  * Standard C (ANSI) Header Files
  */
 #include	<stdlib.h>
+#include	<string.h>
 
 /*
  * Posix Header Files
@@ -117,11 +118,16 @@ CHANGE LOG
 #ifndef	WIN32
 #   include	<unistd.h> /* always first amongst POSIX header files */
 #endif
+#ifdef	_unix
+#   include	<sched.h>
+#endif
 
 /*
  * Project Specific Header Files
  */
 #include	"CFI.h"
+#include	"arena.h"
+#include	"live.h"
 
 
 /* ************************************************************************* */
@@ -130,7 +136,38 @@ CHANGE LOG
 /*                                                                           */
 /* ************************************************************************* */
 
-/* (none) */
+#define	OWN_WORD	(1) /* the word is in the node's arena             */
+#define	OWN_LINK	(2) /* the attribute links are in the node's arena */
+#define	OWN_KEY		(4) /* the word is a key from cfi_arena_key()      */
+#define	OWN_FROZEN	(8) /* the node is in a frozen document            */
+#define	OWN_INDEX	(16) /* the node is in the index of its section    */
+#define	OWN_KEPT	(32) /* the node is kept by the pins, to be freed  */
+#define	OWN_GIVEN	(64) /* the word is from cfi_node_word_set()       */
+
+#define	LINK_SPACE	(4) /* first number of attribute links from the heap */
+#define	INDEX_MIN	(64) /* nodes a search passes before it makes an index */
+#define	PATH_STEPS	(16)  /* steps of a path that cfi_lookup() keeps on the */
+#define	PATH_TEXT	(256) /* stack, and bytes of its text                   */
+#define	PIN_SPACE	(16) /* first number of nodes kept by the pins */
+#define	PIN_SPINS	(64) /* tries of a busy pin before the CPU is given up */
+#define	CURSOR_LEVELS	(8) /* first number of levels of a search cursor */
+#define	PIN_FREEING	((size_t)-1) /* the pins while the kept nodes are freed */
+#define	LAZY_SYNTAX	(1) /* the body of a lazy section has a syntax error */
+#define	LAZY_MEMORY	(2) /* the body of a lazy section couldn't be parsed */
+#define	LAZY_BODY	(3) /* the body of a lazy section isn't parsed yet   */
+
+/*
+ * The pin count is changed by all of the threads that read documents, and
+ * the pins of a heap document are made by the first of them that pins it.
+ */
+#if	defined(__GNUC__)
+#   define	PIN_CAS(p,old,new)	__sync_bool_compare_and_swap(p,old,new)
+#   define	PIN_GET(p)		__sync_fetch_and_add(p,0)
+#else
+#   define	PIN_CAS(p,old,new)	\
+	(*(p) == (old) ? (*(p) = (new), 1) : 0)
+#   define	PIN_GET(p)		(*(p))
+#endif
 
 
 /* ************************************************************************* */
@@ -148,24 +185,189 @@ CHANGE LOG
 /*                                                                           */
 /* ************************************************************************* */
 
+/*
+ * The fields of a node that few nodes have, or that only a reparse or the
+ * search of a big section reads: the source span, the lazy body, the index of
+ * the contents, and the pins of a document from the heap.  A node has them
+ * once they are first set, from its arena, or else from the heap; the flag of
+ * the heap is in them, not in the node, as a reader may make them for pins.
+ */
+typedef struct S_cold_t
+   {
+   size_t            spanStart;
+   size_t            spanLeng;
+   size_t            spanBody;
+   struct S_lazy_t*  lazy;  /* while the node's lazy flag is LAZY_BODY */
+   struct S_index_t* index; /* the index of the contents, or NULL      */
+   S_pins_t*         pins;  /* of a document from the heap, its root   */
+   int               heap;  /* made on their own, from the heap        */
+   }
+   S_cold_t;
+
+/*
+ * The fields that a walk of the tree reads, such as a search, are first, in
+ * 32 bytes, so that a node visited by a walk costs one or two cache lines;
+ * the attributes and the counts of a node come after them, and the rest is
+ * in its cold fields.  The first attribute of the list is the first link.
+ */
 typedef struct S_node_t
    {
-   struct S_node_t*  pred;
    struct S_node_t*  next;
-   int               discriminator;
+   struct S_node_t*  contents;
    char*             word;
-   size_t            attributeCount;
-   CFI_attr_t        attributeList;
+   int               discriminator;
+   unsigned char     owned;
+   unsigned char     changed;
+   unsigned char     deleted;
+   unsigned char     lazy; /* LAZY_BODY, LAZY_SYNTAX, LAZY_MEMORY, or zero */
+   struct S_node_t*  pred;
    CFI_attr_t*       attributeLink;
-   struct S_node_t*  contents;
-   int               changed;
-   int               deleted;
+   unsigned          attributeCount;
+   unsigned          attributeSpace;
    size_t            retainCount;
+   S_arena_t*        arena;
+   S_cold_t*         cold; /* or NULL */
    }
    S_node_t;
 
 typedef int (*CFI_callback_t) (S_node_t* const);
 
+/*
+ * The hash index of the contents of a section, that cfi_search_flat() makes
+ * once a search of them passes INDEX_MIN nodes: the first node of each word
+ * and type, in a power of 2 slots with linear probing.  Each node of the
+ * contents has OWN_INDEX, and a change to any of them drops the index.
+ */
+typedef struct S_slot_t
+   {
+   S_node_t* node;
+   size_t    hash; /* of the word and the type of the node */
+   }
+   S_slot_t;
+
+typedef struct S_index_t
+   {
+   size_t    mask; /* slots - 1                         */
+   S_slot_t* slot; /* the slots, right after the index  */
+   int       heap; /* the index is from the heap        */
+   }
+   S_index_t;
+
+/*
+ * A path from cfi_path_compile(): a step for each word of it, with the value
+ * of the step's predicate, if it has one; the words and values are '\0'
+ * terminated in a copy of the text after the steps.  A lookup doesn't change
+ * a path, so threads can share one.
+ */
+typedef struct S_step_t
+   {
+   const char* word;
+   size_t      leng;      /* bytes of the word              */
+   size_t      hash;      /* of the word, cfi_arena_hash()  */
+   const char* value;     /* value of the predicate, or NULL */
+   size_t      valueLeng;
+   }
+   S_step_t;
+
+typedef struct S_path_t
+   {
+   size_t    count; /* steps                         */
+   S_step_t* step;  /* the steps, right after the path */
+   }
+   S_path_t;
+
+/*
+ * The keys of cfi_lookup_many(), hashed by word and type, in a power of 2
+ * slots with linear probing; a slot has the index of its key, plus 1, or 0
+ * if it is empty.
+ */
+typedef struct S_want_t
+   {
+   size_t hash; /* of the word and the type of the key */
+   size_t key;
+   }
+   S_want_t;
+
+typedef struct S_many_t
+   {
+   const char* const* keys;
+   const int*         types;
+   CFI_node_t*        results;
+   S_want_t*          slot;
+   size_t             mask;  /* slots - 1                   */
+   size_t             left;  /* keys not found yet          */
+   unsigned           masks; /* mask of the types of the keys */
+   }
+   S_many_t;
+
+/*
+ * A copy of a document for cfi_freeze(): the nodes are made in order from one
+ * array in the arena.
+ */
+typedef struct S_freeze_t
+   {
+   S_arena_t* arena;
+   S_node_t*  table; /* the array of nodes          */
+   size_t     nodes; /* nodes made, or to be made   */
+   size_t     size;  /* bytes of the arena it takes */
+   }
+   S_freeze_t;
+
+/*
+ * The arenas that cfi_memory_usage() finds the nodes of a document in, and the
+ * bytes of each that the document's objects take.
+ */
+typedef struct S_used_t
+   {
+   S_arena_t* arena;
+   size_t     used;
+   }
+   S_used_t;
+
+typedef struct S_usage_t
+   {
+   CFI_memory_t* stats;
+   S_used_t*     arenas; /* the arenas, from the heap */
+   size_t        count;  /* arenas found              */
+   size_t        space;  /* room for arenas           */
+   void*         source; /* the last lazy input text  */
+   int           failed; /* no memory for the arenas  */
+   }
+   S_usage_t;
+
+/*
+ * The word that is searched for; its key is looked up in the key table of the
+ * arena of the last node with a key, and again only when a node with a key
+ * from another arena is reached.
+ */
+typedef struct S_word_t
+   {
+   const char* text;
+   size_t      leng;  /* bytes of the text, or -1 until it's hashed */
+   size_t      hash;
+   S_arena_t*  arena; /* the arena of the key table last looked in  */
+   const char* key;   /* the key of the text in it, or NULL         */
+   }
+   S_word_t;
+
+/*
+ * A search from cfi_search_begin(): the node to look at next, and, for each
+ * section the search is in, the node after it, where the search goes on when
+ * the section's contents are done.  The word is copied after the cursor.
+ */
+typedef struct S_cursor_t
+   {
+   S_node_t*  node;   /* the next node, or NULL at the end of a chain */
+   S_word_t   word;   /* the word, with a NULL text for any word      */
+   unsigned   types;  /* mask of the types                            */
+   int        depth;  /* the deepest level, or -1                     */
+   size_t     level;  /* sections the search is in                    */
+   S_node_t** next;   /* the node after each of them, from the heap   */
+   size_t     space;  /* room for levels                              */
+   int        failed; /* no memory for a level                        */
+   }
+   S_cursor_t;
+
 
 /* ************************************************************************* */
 /*                                                                           */
@@ -196,14 +398,358 @@ typedef int (*CFI_callback_t) (S_node_t* const);
  * Private Function Prototypes
  *****************************************************************************/
 
+static __inline__ void node_init (S_node_t* const node);
+static __inline__ void cold_init (S_cold_t* const cold);
+static __inline__ S_arena_t* node_arena (S_node_t* const node);
+static __inline__ void node_mix (S_node_t* const node);
+static S_cold_t* node_cold (S_node_t* const node);
+static __inline__ int node_spanned (S_node_t* const node);
+static __inline__ CFI_attr_t node_attribute (S_node_t* const node);
+static S_node_t* node_make (S_arena_t* arena, char* word);
+static const char* node_links (
+                              S_node_t* const node,
+                              CFI_attr_t      attr,
+                              S_arena_t*      arena
+                              );
+static const char* node_room (S_node_t* const node);
 static int node_delete (S_node_t* const node);
 static int node_release (S_node_t* const node);
 static int node_retain (S_node_t* const node);
 static __inline__ int node_whack (S_node_t* const node);
+static void node_expand (S_node_t* const node);
+static S_node_t* node_parent (S_node_t* node);
+static void span_shift (S_node_t* node, size_t delta);
+static __inline__ void word_init (S_word_t* word, const char* text);
+static __inline__ int word_is (S_node_t* const node, S_word_t* word);
+static S_node_t* node_search (
+                             S_node_t* node,
+                             S_word_t* word,
+                             int       type,
+                             int       expand
+                             );
+static __inline__ S_index_t* node_index (S_node_t* const node);
+static __inline__ size_t index_hash (size_t hash, int type);
+static void index_make (S_node_t* section);
+static S_node_t* index_find (S_index_t* index, S_word_t* word, int type);
+static void index_drop (S_node_t* section);
+static __inline__ void index_touch (S_node_t* node);
+static S_node_t* node_scan (
+                           S_node_t* node,
+                           S_word_t* word,
+                           int       type,
+                           size_t*   seen
+                           );
+static S_node_t* node_find (
+                           S_node_t* node,
+                           S_word_t* word,
+                           int       type,
+                           int       make
+                           );
+static int node_value_is (S_node_t* node, S_step_t* step);
+static size_t path_steps (char* text, S_step_t* step);
+static S_node_t* path_walk (
+                           S_node_t* root,
+                           S_path_t* path,
+                           int       type,
+                           int       make
+                           );
+static S_node_t* node_lookup (
+                             S_node_t*   root,
+                             const char* path,
+                             int         type,
+                             int         make
+                             );
+static __inline__ unsigned node_mask (S_node_t* const node);
+static __inline__ size_t node_hash (S_node_t* const node);
+static void many_match (S_node_t* node, S_many_t* many);
+static void many_walk (S_node_t* node, S_many_t* many);
+static void pin_wait (unsigned* spins);
+static S_pins_t* node_pins (S_node_t* node, int make);
+static int pins_keep (S_pins_t* pins, S_node_t* node, S_arena_t* arena);
+static int node_defer (S_node_t* node, S_arena_t* arena, int chain);
+static int pins_unpin (S_pins_t* pins);
+static void pins_free (S_pins_t* pins);
+static void freeze_size (S_node_t* node, S_freeze_t* freeze);
+static size_t* usage_arena (S_usage_t* usage, S_arena_t* arena);
+static void node_usage (S_node_t* node, S_usage_t* usage);
+static const char* freeze_copy (
+                               S_node_t*   node,
+                               S_node_t*   pred,
+                               S_freeze_t* freeze,
+                               S_node_t**  copy
+                               );
 
 static int cfi_traverse (S_node_t* const node, CFI_callback_t cbfn);
 
-static __inline__ void cfi_whack (S_node_t* const node);
+static void cfi_whack (S_node_t* const node);
+
+
+/*****************************************************************************
+ * Private Function node_init
+ *****************************************************************************/
+
+static __inline__ void node_init (S_node_t* const a_node)
+   {
+   a_node->next           = NULL;
+   a_node->contents       = NULL;
+   a_node->word           = NULL;
+   a_node->discriminator  = CFI_WORD;
+   a_node->owned          = 0;
+   a_node->changed        = 0;
+   a_node->deleted        = 0;
+   a_node->lazy           = 0;
+   a_node->pred           = NULL;
+   a_node->attributeLink  = NULL;
+   a_node->attributeCount = 0;
+   a_node->attributeSpace = 0;
+   a_node->retainCount    = 0;
+   a_node->arena          = NULL;
+   a_node->cold           = NULL;
+   }
+
+
+/*****************************************************************************
+ * Private Function cold_init
+ *****************************************************************************/
+
+static __inline__ void cold_init (S_cold_t* const a_cold)
+   {
+   a_cold->spanStart = 0;
+   a_cold->spanLeng  = 0;
+   a_cold->spanBody  = 0;
+   a_cold->lazy      = NULL;
+   a_cold->index     = NULL;
+   a_cold->pins      = NULL;
+   a_cold->heap      = 0;
+   }
+
+
+/*****************************************************************************
+ * Private Function node_arena
+ *****************************************************************************
+ *
+ * This function finds the arena that owns a node's memory, or NULL for a node
+ * from the heap; the node is made to point right to it.
+ *
+ *****************************************************************************/
+
+static __inline__ S_arena_t* node_arena (S_node_t* const a_node)
+   {
+   if (a_node->arena == NULL) return NULL;
+   if (a_node->arena->owner != NULL)
+      {
+      a_node->arena = cfi_arena_owner (a_node->arena);
+      }
+   return a_node->arena;
+   }
+
+
+/*****************************************************************************
+ * Private Function node_mix
+ *****************************************************************************
+ *
+ * This function notes that the document of a node from an arena is changed in
+ * a way that may put memory from the heap into it, or take nodes out of it;
+ * the document can't then be freed all at once, only node by node.
+ *
+ *****************************************************************************/
+
+static __inline__ void node_mix (S_node_t* const a_node)
+   {
+   S_arena_t* arena = node_arena (a_node);
+   if (arena != NULL) arena->mixed = 1;
+   }
+
+
+/*****************************************************************************
+ * Private Function node_cold
+ *****************************************************************************
+ *
+ * This function gives the cold fields of a node, which are made the first
+ * time they are wanted: from the arena of a node from an arena, which is then
+ * the node's to the end, or else from the heap.  It returns NULL if there is
+ * no memory for them.
+ *
+ *****************************************************************************/
+
+static S_cold_t* node_cold (S_node_t* const a_node)
+   {
+   S_arena_t* arena;
+   S_cold_t*  cold;
+
+   if (a_node->cold != NULL) return a_node->cold;
+
+   arena = node_arena (a_node);
+   if (arena != NULL)
+      cold = (S_cold_t*)cfi_arena_alloc (arena, sizeof(S_cold_t));
+   else
+      cold = (S_cold_t*)_cfi_malloc (sizeof(S_cold_t));
+   if (cold == NULL) return NULL;
+
+   cold_init (cold);
+   cold->heap   = arena == NULL;
+   a_node->cold = cold;
+
+   return cold;
+   }
+
+
+/*****************************************************************************
+ * Private Function node_spanned
+ *****************************************************************************/
+
+static __inline__ int node_spanned (S_node_t* const a_node)
+   {
+   return (a_node->cold != NULL) && (a_node->cold->spanLeng != 0);
+   }
+
+
+/*****************************************************************************
+ * Private Function node_attribute
+ *****************************************************************************/
+
+static __inline__ CFI_attr_t node_attribute (S_node_t* const a_node)
+   {
+   return a_node->attributeCount != 0 ? a_node->attributeLink[0] : NULL;
+   }
+
+
+/*****************************************************************************
+ * Private Function node_make
+ *****************************************************************************
+ *
+ * This function makes a node for the parser, from the arena if there is one,
+ * with its word; a word for a node from an arena is a key of the arena.  The
+ * parser gives each node a span, so a node from the heap is made with its
+ * cold fields, in one allocation.
+ *
+ *****************************************************************************/
+
+static S_node_t* node_make (S_arena_t* a_arena, char* a_word)
+   {
+   S_node_t* node;
+
+   if (a_arena == NULL)
+      {
+      node = (S_node_t*)_cfi_malloc (sizeof(S_node_t) + sizeof(S_cold_t));
+      if (node == NULL) return NULL;
+      CFI_LIVE_ADD (nodes, 1);
+      node_init (node);
+      node->cold = (S_cold_t*)(node + 1);
+      cold_init (node->cold);
+      }
+   else
+      {
+      node = (S_node_t*)cfi_arena_node (a_arena, sizeof(S_node_t));
+      if (node == NULL) return NULL;
+      node_init (node);
+      node->arena     = a_arena;
+      node->owned     = a_word != NULL ? OWN_WORD | OWN_KEY : OWN_WORD;
+      a_arena->nodes += 1;
+      }
+
+   node->word = a_word;
+
+   return node;
+   }
+
+
+/*****************************************************************************
+ * Private Function node_links
+ *****************************************************************************
+ *
+ * This function makes the array of links to the attributes of a node, which
+ * are already in its list, from the arena if there is one.
+ *
+ *****************************************************************************/
+
+static const char* node_links (
+                              S_node_t* const a_node,
+                              CFI_attr_t      a_attr,
+                              S_arena_t*      a_arena
+                              )
+   {
+   CFI_attr_t* attrArray;
+   CFI_attr_t  attr;
+   size_t      i;
+
+   attr = a_attr;
+   i    = 0;
+   while (attr != NULL)
+      {
+      i += 1;
+      attr = cfi_attribute_next (attr);
+      }
+
+   if (a_arena == NULL)
+      attrArray = (CFI_attr_t*)_cfi_calloc (i, sizeof(CFI_attr_t));
+   else
+      attrArray = (CFI_attr_t*)cfi_arena_alloc (a_arena, i*sizeof(CFI_attr_t));
+   if (attrArray == NULL) return "can't allocate memory";
+
+   attr = a_attr;
+   i    = 0;
+   while (attr != NULL)
+      {
+      attrArray[i++] = attr;
+      attr = cfi_attribute_next (attr);
+      }
+
+   a_node->attributeCount = (unsigned)i;
+   a_node->attributeLink  = attrArray;
+   a_node->attributeSpace = (unsigned)i;
+   if (a_arena != NULL) a_node->owned |= OWN_LINK;
+
+   return NULL;
+   }
+
+
+/*****************************************************************************
+ * Private Function node_room
+ *****************************************************************************
+ *
+ * This function makes room for one more link in the array of links to the
+ * attributes of a node; a full array is doubled, so a list of attributes made
+ * one at a time is copied only a few times.  A full array from an arena is
+ * copied to the heap, since it can't be made bigger where it is.
+ *
+ *****************************************************************************/
+
+static const char* node_room (S_node_t* const a_node)
+   {
+   CFI_attr_t* attrArray;
+   size_t      space;
+
+   if (a_node->attributeCount < a_node->attributeSpace) return NULL;
+
+   space = 2 * a_node->attributeSpace;
+   if (space < LINK_SPACE) space = LINK_SPACE;
+
+   if ((a_node->owned & OWN_LINK) == 0)
+      {
+      attrArray = (CFI_attr_t*)_cfi_realloc (
+                                       a_node->attributeLink,
+                                       space * sizeof(CFI_attr_t)
+                                       );
+      if (attrArray == NULL) return "can't allocate memory";
+      }
+   else
+      {
+      attrArray = (CFI_attr_t*)_cfi_malloc (space * sizeof(CFI_attr_t));
+      if (attrArray == NULL) return "can't allocate memory";
+      (void)memcpy (
+                   attrArray,
+                   a_node->attributeLink,
+                   a_node->attributeCount * sizeof(CFI_attr_t)
+                   );
+      a_node->owned &= ~OWN_LINK;
+      }
+
+   a_node->attributeLink  = attrArray;
+   a_node->attributeSpace = (unsigned)space;
+
+   return NULL;
+   }
 
 
 /*****************************************************************************
@@ -254,7 +800,11 @@ static int node_delete (S_node_t* const a_node)
 
 static int node_release (S_node_t* const a_node)
    {
-   if (a_node->retainCount > 0) a_node->retainCount -= 1;
+   if (a_node->retainCount > 0)
+      {
+      a_node->retainCount -= 1;
+      if (a_node->arena != NULL) node_arena(a_node)->retains -= 1;
+      }
    if (a_node->retainCount == 0) return 1;
    return 0;
    }
@@ -281,6 +831,7 @@ static int node_retain (S_node_t* const a_node)
    {
    if (a_node->deleted) return 0;
    a_node->retainCount += 1;
+   if (a_node->arena != NULL) node_arena(a_node)->retains += 1;
    return 1;
    }
 
@@ -296,7 +847,8 @@ static int node_retain (S_node_t* const a_node)
 
 static __inline__ int node_whack (S_node_t* const a_node)
    {
-   S_node_t* node = (S_node_t*)a_node;
+   S_node_t*  node  = (S_node_t*)a_node;
+   S_arena_t* arena = node_arena (node);
 
    /*
     * 1.  unlink node
@@ -310,7 +862,10 @@ static __inline__ int node_whack (S_node_t* const a_node)
     *
     * [c] If the predessor's next node is this node, then make the predessor's
     *     next node be this node's next node.
+    *
+    * The index of the section the node is in goes first.
     */
+   index_touch (node);
    if (node->next != NULL) node->next->pred = node->pred; /* [a] */
    if (node->pred != NULL)
       {
@@ -323,10 +878,14 @@ static __inline__ int node_whack (S_node_t* const a_node)
          node->pred->next = node->next;
          }
       }
+   if ((arena != NULL) && (arena->root == node)) arena->root = node->next;
 
    /*
-    * 2.  deallocate node
+    * 2.  deallocate node; the memory of a node from an arena is not given
+    *     back, but the arena is freed with its last node.
     */
+   if (node->lazy == LAZY_BODY) _cfi_lazy_del (node->cold->lazy);
+   index_drop (node);
    (void)cfi_node_attribute_del (node); /* Deallocate any attributes. */
    (void)cfi_node_word_del(node); /* Deallocate the word. */
    (void)cfi_node_del (&node); /* Deallocate the node. */
@@ -336,591 +895,2634 @@ static __inline__ int node_whack (S_node_t* const a_node)
 
 
 /*****************************************************************************
- * Private Function cfi_traverse
+ * Private Function node_expand
+ *****************************************************************************
+ *
+ * This function parses the body of a lazy section, which becomes the contents
+ * of the section, from the arena of the section.  If the body can't be parsed
+ * the section is empty, and cfi_node_lazy_error() tells why.
+ *
  *****************************************************************************/
 
-static int cfi_traverse (S_node_t* const a_node, CFI_callback_t a_cbfn)
+static void node_expand (S_node_t* const a_node)
    {
-   int       stat = 0;
-   S_node_t* node;
-
-   node = a_node;
-   while (node != NULL)
+   S_cold_t*        cold = a_node->cold;
+   struct S_lazy_t* lazy = cold->lazy;
+   CFI_node_t       contents;
+   const char*      msg;
+
+   a_node->lazy = 0;
+   cold->lazy   = NULL;
+   msg = _cfi_lazy_parse (
+                         a_node->arena,
+                         lazy,
+                         cold->spanStart + cold->spanBody,
+                         &contents
+                         );
+   if (msg != NULL)
       {
-      if (node->contents != NULL) stat &= cfi_traverse (node->contents, a_cbfn);
-      stat &= (*a_cbfn)(node);
-      node = node->next;
+      a_node->lazy = strcmp(msg,"syntax error") == 0 ? LAZY_SYNTAX :
+                                                       LAZY_MEMORY;
       }
-
-   return stat;
+   a_node->contents = contents;
+   if (a_node->contents != NULL) a_node->contents->pred = a_node;
    }
 
 
 /*****************************************************************************
- * Private Function cfi_whack
+ * Private Function node_parent
  *****************************************************************************
  *
- * This function removes a node from the tree and deallocates all allocated
- * memory associated with the node.  If the node is a "section", then ALL of
- * the nodes that are the contents are also whacked.
+ * This function finds the section that a node is in, or NULL for a node at
+ * the top level; only the first node of a section's contents has the section
+ * for its predecessor.
  *
  *****************************************************************************/
 
-static __inline__ void cfi_whack (S_node_t* const a_node)
+static S_node_t* node_parent (S_node_t* a_node)
    {
-   S_node_t* node = a_node->contents;
-   S_node_t* p;
-
-   (void)node_whack (a_node);
-
-   while (node != NULL)
+   while ((a_node->pred != NULL) && (a_node->pred->contents != a_node))
       {
-      p = node->next;
-      (void)node_whack (node);
-      node = p;
+      a_node = a_node->pred;
       }
-
-   return;
+   return a_node->pred;
    }
 
 
-/* ************************************************************************* */
-/*                                                                           */
-/*      E x e c u t a b l e   C o d e   (External Interface Functions)       */
-/*                                                                           */
-/* ************************************************************************* */
-
-
 /*****************************************************************************
- * Public Function _cfi_node_join
+ * Private Function span_shift
+ *****************************************************************************
+ *
+ * This function moves the source spans of a chain of nodes, and of all of
+ * their contents, by "a_delta" bytes; the arithmetic is unsigned, so a move
+ * back is a very large "a_delta".
+ *
  *****************************************************************************/
 
-CFI_node_t
-__attribute__ ((visibility("hidden")))
+static void span_shift (S_node_t* a_node, size_t a_delta)
+   {
+   for ( ; a_node != NULL ; a_node = a_node->next)
+      {
+      if (node_spanned(a_node)) a_node->cold->spanStart += a_delta;
+      if (a_node->contents != NULL) span_shift (a_node->contents, a_delta);
+      }
+   }
+
+
+/*****************************************************************************
+ * Private Function word_init
+ *****************************************************************************/
+
+static __inline__ void word_init (S_word_t* a_word, const char* a_text)
+   {
+   a_word->text  = a_text;
+   a_word->leng  = (size_t)-1;
+   a_word->hash  = 0;
+   a_word->arena = NULL;
+   a_word->key   = NULL;
+   }
+
+
+/*****************************************************************************
+ * Private Function word_is
+ *****************************************************************************
+ *
+ * This function tells if a node has the word that is searched for; a node
+ * with a key has it if its word is the key, with no compare of the text.
+ *
+ *****************************************************************************/
+
+static __inline__ int word_is (S_node_t* const a_node, S_word_t* a_word)
+   {
+   S_arena_t* arena;
+
+   if ((a_node->owned & OWN_KEY) == 0)
+      {
+      return (a_node->word != NULL) && CFI_STREQ(a_node->word,a_word->text);
+      }
+
+   arena = cfi_arena_key_arena (a_node->word);
+   if (arena != a_word->arena)
+      {
+      if (a_word->leng == (size_t)-1)
+         {
+         a_word->leng = strlen (a_word->text);
+         a_word->hash = cfi_arena_hash (a_word->text, a_word->leng);
+         }
+      a_word->arena = arena;
+      a_word->key   = cfi_arena_key_find (
+                                         arena,
+                                         a_word->text,
+                                         a_word->leng,
+                                         a_word->hash
+                                         );
+      }
+
+   return a_node->word == a_word->key;
+   }
+
+
+/*****************************************************************************
+ * Private Function node_search
+ *****************************************************************************
+ *
+ * This function is cfi_search() without the retain, for a word that may
+ * already have its key.  A lazy section whose body isn't parsed is parsed if
+ * "a_expand" is set, or else passed over.
+ *
+ *****************************************************************************/
+
+static S_node_t* node_search (
+                             S_node_t* a_node,
+                             S_word_t* a_word,
+                             int       a_type,
+                             int       a_expand
+                             )
+   {
+   S_node_t* node = a_node;
+   S_node_t* item = NULL;
+
+   while (node != NULL)
+      {
+      if ((node->discriminator == a_type) && word_is(node,a_word))
+         item = !node->deleted ? node : NULL;
+      else
+         {
+         if (node->discriminator == CFI_SECTION)
+            {
+            if ((node->lazy == LAZY_BODY) && a_expand) node_expand (node);
+            item = node_search (node->contents, a_word, a_type, a_expand);
+            }
+         }
+      if (item != NULL)
+         node = NULL;
+      else
+         node = node->next;
+      }
+
+   return item;
+   }
+
+
+/*****************************************************************************
+ * Private Function node_index
+ *****************************************************************************/
+
+static __inline__ S_index_t* node_index (S_node_t* const a_node)
+   {
+   return a_node->cold != NULL ? a_node->cold->index : NULL;
+   }
+
+
+/*****************************************************************************
+ * Private Function index_hash
+ *****************************************************************************/
+
+static __inline__ size_t index_hash (size_t a_hash, int a_type)
+   {
+   return a_hash ^ ((size_t)a_type * (size_t)2654435761UL);
+   }
+
+
+/*****************************************************************************
+ * Private Function index_make
+ *****************************************************************************
+ *
+ * This function makes the index of the contents of a section; without the
+ * memory for it, the section just has no index.  The index of a section of a
+ * document in an arena that isn't changed is from the arena, and is freed
+ * with it; else it is from the heap, and is freed when it is dropped.
+ *
+ *****************************************************************************/
+
+static void index_make (S_node_t* a_section)
+   {
+   S_arena_t* arena;
+   S_cold_t*  cold;
+   S_index_t* index;
+   S_slot_t*  slot;
+   S_node_t*  node;
+   size_t     size;
+   size_t     count = 0;
+   size_t     slots = 16;
+   size_t     hash;
+   size_t     i;
+
+   for (node = a_section->contents ; node != NULL ; node = node->next)
+      count += 1;
+   while (slots < 2*count) slots *= 2;
+
+   cold = node_cold (a_section);
+   if (cold == NULL) return;
+   size  = sizeof(S_index_t) + slots*sizeof(S_slot_t);
+   arena = node_arena (a_section);
+   if ((arena != NULL) && !arena->mixed)
+      {
+      index = (S_index_t*)cfi_arena_alloc (arena, size);
+      if (index == NULL) return;
+      (void)memset (index, 0, size);
+      }
+   else
+      {
+      index = (S_index_t*)_cfi_calloc (1, size);
+      if (index == NULL) return;
+      index->heap = 1;
+      }
+   index->mask = slots - 1;
+   index->slot = (S_slot_t*)(index + 1);
+
+   for (node = a_section->contents ; node != NULL ; node = node->next)
+      {
+      node->owned |= OWN_INDEX;
+      if (node->word == NULL) continue;
+      hash = index_hash (
+                        cfi_arena_hash(node->word,strlen(node->word)),
+                        node->discriminator
+                        );
+      for (i = hash & index->mask ; ; i = (i+1) & index->mask)
+         {
+         slot = &index->slot[i];
+         if (slot->node == NULL)
+            {
+            slot->node = node;
+            slot->hash = hash;
+            break;
+            }
+         if ((slot->hash == hash) &&
+             (slot->node->discriminator == node->discriminator) &&
+             CFI_STREQ(slot->node->word,node->word))
+            {
+            break; /* a node before it has the word */
+            }
+         }
+      }
+
+   cold->index = index;
+   }
+
+
+/*****************************************************************************
+ * Private Function index_find
+ *****************************************************************************
+ *
+ * This function finds the first node of the contents of a section that has
+ * the word and the type, or NULL.
+ *
+ *****************************************************************************/
+
+static S_node_t* index_find (S_index_t* a_index, S_word_t* a_word, int a_type)
+   {
+   S_slot_t* slot;
+   size_t    hash;
+   size_t    i;
+
+   if (a_word->leng == (size_t)-1)
+      {
+      a_word->leng = strlen (a_word->text);
+      a_word->hash = cfi_arena_hash (a_word->text, a_word->leng);
+      }
+   hash = index_hash (a_word->hash, a_type);
+
+   for (i = hash & a_index->mask ; ; i = (i+1) & a_index->mask)
+      {
+      slot = &a_index->slot[i];
+      if (slot->node == NULL) return NULL;
+      if ((slot->hash == hash) &&
+          (slot->node->discriminator == a_type) &&
+          CFI_STREQ(slot->node->word,a_word->text))
+         {
+         return slot->node;
+         }
+      }
+   }
+
+
+/*****************************************************************************
+ * Private Function index_drop
+ *****************************************************************************/
+
+static void index_drop (S_node_t* a_section)
+   {
+   S_node_t* node;
+
+   if ((a_section == NULL) || (node_index(a_section) == NULL)) return;
+
+   for (node = a_section->contents ; node != NULL ; node = node->next)
+      node->owned &= ~OWN_INDEX;
+   if (a_section->cold->index->heap) _cfi_free (a_section->cold->index);
+   a_section->cold->index = NULL;
+   }
+
+
+/*****************************************************************************
+ * Private Function index_touch
+ *****************************************************************************
+ *
+ * This function drops the index that a node is in, if it is in one, before
+ * the node, or the chain it is in, is changed.
+ *
+ *****************************************************************************/
+
+static __inline__ void index_touch (S_node_t* a_node)
+   {
+   if (a_node->owned & OWN_INDEX) index_drop (node_parent(a_node));
+   }
+
+
+/*****************************************************************************
+ * Private Function node_scan
+ *****************************************************************************
+ *
+ * This function walks a chain from "a_node" to the first node with the word
+ * and the type that isn't deleted, and counts the nodes it passes in "*a_seen"
+ * (unless "a_seen" is NULL).
+ *
+ *****************************************************************************/
+
+static S_node_t* node_scan (
+                           S_node_t* a_node,
+                           S_word_t* a_word,
+                           int       a_type,
+                           size_t*   a_seen
+                           )
+   {
+   for ( ; a_node != NULL ; a_node = a_node->next)
+      {
+      if (a_seen != NULL) *a_seen += 1;
+      if ((a_node->discriminator == a_type) && !a_node->deleted &&
+          word_is(a_node,a_word))
+         {
+         return a_node;
+         }
+      }
+   return NULL;
+   }
+
+
+/*****************************************************************************
+ * Private Function node_find
+ *****************************************************************************
+ *
+ * This function is cfi_search_flat() without the retain.  A search from the
+ * first node of a section's contents can use the index of the section, or
+ * make it, if "a_make" is set, when the search is long; the index gives the
+ * first node with the word, and the search goes on from it only if that node
+ * is deleted.  A frozen document is never written to.
+ *
+ *****************************************************************************/
+
+static S_node_t* node_find (
+                           S_node_t* a_node,
+                           S_word_t* a_word,
+                           int       a_type,
+                           int       a_make
+                           )
+   {
+   S_node_t* parent = NULL;
+   S_node_t* item;
+   size_t    seen   = 0;
+
+   if ((a_node != NULL) && (a_node->pred != NULL) &&
+       (a_node->pred->contents == a_node) &&
+       ((a_node->owned & OWN_FROZEN) == 0))
+      {
+      parent = a_node->pred;
+      if (node_index(parent) != NULL)
+         {
+         item = index_find (parent->cold->index, a_word, a_type);
+         if ((item == NULL) || !item->deleted) return item;
+         return node_scan (item->next, a_word, a_type, NULL);
+         }
+      }
+
+   item = node_scan (a_node, a_word, a_type, &seen);
+   if (a_make && (parent != NULL) && (seen > INDEX_MIN)) index_make (parent);
+
+   return item;
+   }
+
+
+/*****************************************************************************
+ * Private Function node_value_is
+ *****************************************************************************
+ *
+ * This function tells if the first attribute of a node is a word or string
+ * with the value of the predicate of a step.
+ *
+ *****************************************************************************/
+
+static int node_value_is (S_node_t* a_node, S_step_t* a_step)
+   {
+   CFI_attr_t  attr = node_attribute (a_node);
+   const char* text;
+   size_t      leng;
+
+   if (attr == NULL) return 0;
+   text = cfi_attribute_string_peek (attr, &leng);
+   if (text == NULL) text = cfi_attribute_word_peek (attr, &leng);
+   return (text != NULL) && (leng == a_step->valueLeng) &&
+          (memcmp(text,a_step->value,leng) == 0);
+   }
+
+
+/*****************************************************************************
+ * Private Function path_steps
+ *****************************************************************************
+ *
+ * This function reads the steps of a path, "word.word(value).word", in which
+ * a value is a word or a string in '"'s, and gives the number of them, or 0
+ * if the path is not good.  If "a_step" is not NULL, the steps are put there,
+ * and the '.', '(', ')' and '"'s of "a_text" are made '\0's.
+ *
+ *****************************************************************************/
+
+static size_t path_steps (char* a_text, S_step_t* a_step)
+   {
+#define	PATH_CHAR(ch)	(((ch) != '\0') && ((ch) != '.') && ((ch) != '(') && \
+			 ((ch) != ')') && ((ch) != '"'))
+
+   char*  word;
+   char*  wordEnd;
+   char*  value;
+   char*  valueEnd = NULL;
+   size_t count    = 0;
+   int    last;
+
+   for (;;)
+      {
+      for (word = a_text ; PATH_CHAR(*a_text) ; a_text++) ;
+      if (a_text == word) return 0;
+      wordEnd = a_text;
+      value   = NULL;
+
+      if (*a_text == '(')
+         {
+         if (*++a_text == '"')
+            {
+            for (value = ++a_text ; *a_text && (*a_text != '"') ; a_text++) ;
+            if (*a_text != '"') return 0;
+            valueEnd = a_text++;
+            }
+         else
+            {
+            for (value = a_text ; PATH_CHAR(*a_text) ; a_text++) ;
+            if (a_text == value) return 0;
+            valueEnd = a_text;
+            }
+         if (*a_text++ != ')') return 0;
+         }
+      if ((*a_text != '\0') && (*a_text != '.')) return 0;
+      last = *a_text++ == '\0';
+
+      if (a_step != NULL)
+         {
+         a_step->word      = word;
+         a_step->leng      = wordEnd - word;
+         a_step->hash      = cfi_arena_hash (word, a_step->leng);
+         a_step->value     = value;
+         a_step->valueLeng = value != NULL ? valueEnd - value : 0;
+         a_step++;
+         *wordEnd = '\0';
+         if (value != NULL) *valueEnd = '\0';
+         }
+      count += 1;
+
+      if (last) return count;
+      }
+
+#undef	PATH_CHAR
+   }
+
+
+/*****************************************************************************
+ * Private Function path_walk
+ *****************************************************************************
+ *
+ * This function follows a path from a chain of nodes: each step but the last
+ * is a section, whose contents the next step is found in, and the last step
+ * is a node of the type.  A step with a predicate is the first node with its
+ * word whose first attribute is the value.  Nothing is retained, and an index
+ * is made, or a lazy section parsed, only if "a_make" is set; without it, the
+ * path isn't followed into a lazy section whose body isn't parsed.
+ *
+ *****************************************************************************/
+
+static S_node_t* path_walk (
+                           S_node_t* a_root,
+                           S_path_t* a_path,
+                           int       a_type,
+                           int       a_make
+                           )
+   {
+   S_node_t* node = a_root;
+   S_step_t* step;
+   S_word_t  word;
+   size_t    i;
+   int       type;
+
+   for (i = 0 ; (i < a_path->count) && (node != NULL) ; i++)
+      {
+      step = &a_path->step[i];
+      type = i+1 < a_path->count ? CFI_SECTION : a_type;
+      if (i > 0)
+         {
+         if (node->lazy == LAZY_BODY)
+            {
+            if (!a_make) return NULL;
+            node_expand (node);
+            }
+         node = node->contents;
+         }
+
+      word.text  = step->word;
+      word.leng  = step->leng;
+      word.hash  = step->hash;
+      word.arena = NULL;
+      word.key   = NULL;
+
+      node = node_find (node, &word, type, a_make);
+      while ((node != NULL) && (step->value != NULL) &&
+             !node_value_is(node,step))
+         {
+         node = node_scan (node->next, &word, type, NULL);
+         }
+      }
+
+   return node;
+   }
+
+
+/*****************************************************************************
+ * Private Function node_lookup
+ *****************************************************************************
+ *
+ * This function is cfi_lookup() without the retain; a path of up to
+ * PATH_STEPS steps, there is a step for each '.' and one more at most, and
+ * PATH_TEXT bytes is kept on the stack, and a longer one is compiled for the
+ * one lookup.
+ *
+ *****************************************************************************/
+
+static S_node_t* node_lookup (
+                             S_node_t*   a_root,
+                             const char* a_path,
+                             int         a_type,
+                             int         a_make
+                             )
+   {
+   S_path_t    path;
+   S_step_t    step[PATH_STEPS];
+   char        text[PATH_TEXT];
+   CFI_path_t  heapPath;
+   S_node_t*   node;
+   const char* dot;
+   size_t      leng;
+   size_t      steps = 1;
+
+   if ((a_root == NULL) || (a_path == NULL)) return NULL;
+
+   leng = strlen (a_path);
+   for (dot = a_path ; (dot = strchr(dot,'.')) != NULL ; dot++) steps += 1;
+
+   if ((steps > PATH_STEPS) || (leng >= PATH_TEXT))
+      {
+      if (cfi_path_compile(a_path,&heapPath) != NULL) return NULL;
+      node = path_walk (a_root, heapPath, a_type, a_make);
+      (void)cfi_path_del (&heapPath);
+      return node;
+      }
+
+   (void)memcpy (text, a_path, leng+1);
+   path.step  = step;
+   path.count = path_steps (text, step);
+   if (path.count == 0) return NULL;
+
+   return path_walk (a_root, &path, a_type, a_make);
+   }
+
+
+/*****************************************************************************
+ * Private Function node_mask
+ *****************************************************************************
+ *
+ * This function gives the mask of the type of a node, from CFI_ANY_MASK.
+ *
+ *****************************************************************************/
+
+static __inline__ unsigned node_mask (S_node_t* const a_node)
+   {
+   switch (a_node->discriminator)
+      {
+      case CFI_WORD:       return CFI_WORD_MASK;
+      case CFI_ATTRIBUTES: return CFI_ATTRIBUTES_MASK;
+      case CFI_SECTION:    return CFI_SECTION_MASK;
+      }
+   return 0;
+   }
+
+
+/*****************************************************************************
+ * Private Function node_hash
+ *****************************************************************************
+ *
+ * This function gives cfi_arena_hash() of the word of a node; the hash of a
+ * key is kept with it.
+ *
+ *****************************************************************************/
+
+static __inline__ size_t node_hash (S_node_t* const a_node)
+   {
+   if (a_node->owned & OWN_KEY) return ((const S_key_t*)a_node->word - 1)->hash;
+   return cfi_arena_hash (a_node->word, strlen(a_node->word));
+   }
+
+
+/*****************************************************************************
+ * Private Function many_match
+ *****************************************************************************
+ *
+ * This function gives a node to each key of cfi_lookup_many() with its word
+ * and type that has no node yet.
+ *
+ *****************************************************************************/
+
+static void many_match (S_node_t* a_node, S_many_t* a_many)
+   {
+   S_want_t* slot;
+   size_t    hash = index_hash (node_hash(a_node), a_node->discriminator);
+   size_t    key;
+   size_t    i;
+
+   for (i = hash & a_many->mask ; ; i = (i+1) & a_many->mask)
+      {
+      slot = &a_many->slot[i];
+      if (slot->key == 0) return;
+      key = slot->key - 1;
+      if ((slot->hash == hash) && (a_many->results[key] == NULL) &&
+          (a_many->types[key] == a_node->discriminator) &&
+          CFI_STREQ(a_node->word,a_many->keys[key]))
+         {
+         a_many->results[key] = a_node;
+         a_many->left -= 1;
+         }
+      }
+   }
+
+
+/*****************************************************************************
+ * Private Function many_walk
+ *****************************************************************************
+ *
+ * This function walks a chain of nodes and their contents, as cfi_search()
+ * does, until every key of cfi_lookup_many() has its node; the contents of a
+ * deleted section are deleted too, and are passed over.
+ *
+ *****************************************************************************/
+
+static void many_walk (S_node_t* a_node, S_many_t* a_many)
+   {
+   for ( ; (a_node != NULL) && (a_many->left > 0) ; a_node = a_node->next)
+      {
+      if (a_node->deleted) continue;
+      if ((a_node->word != NULL) && (node_mask(a_node) & a_many->masks))
+         {
+         many_match (a_node, a_many);
+         }
+      if (a_node->discriminator == CFI_SECTION)
+         {
+         if (a_node->lazy == LAZY_BODY) node_expand (a_node);
+         many_walk (a_node->contents, a_many);
+         }
+      }
+   }
+
+
+/*****************************************************************************
+ * Private Function pin_wait
+ *****************************************************************************
+ *
+ * This function waits a little for another thread that has the pins of a
+ * document busy: it tries again at once the first PIN_SPINS times, and then
+ * gives up the CPU before each try, so that the other thread can run.
+ *
+ *****************************************************************************/
+
+static void pin_wait (unsigned* a_spins)
+   {
+   if (*a_spins < PIN_SPINS)
+      {
+      *a_spins += 1;
+      return;
+      }
+#ifdef	_unix
+   (void)sched_yield ();
+#endif
+   }
+
+
+/*****************************************************************************
+ * Private Function node_pins
+ *****************************************************************************
+ *
+ * This function finds the pins of the document of a node: those of the arena
+ * of the document, or of its root, the first node of its top chain, for a
+ * document from the heap.  A node from the heap goes up to the root, to see
+ * if it is in an arena.  The pins of a root from the heap are made for the
+ * first pin, if "a_make" is set, or else NULL is returned if they aren't.
+ *
+ *****************************************************************************/
+
+static S_pins_t* node_pins (S_node_t* a_node, int a_make)
+   {
+   S_arena_t* arena;
+   S_cold_t*  cold;
+   S_pins_t*  pins;
+
+   if (a_node == NULL) return NULL;
+   while ((a_node->arena == NULL) && (a_node->pred != NULL))
+      {
+      a_node = a_node->pred;
+      }
+   arena = node_arena (a_node);
+   if (arena != NULL) return &arena->pins;
+
+   cold = PIN_GET (&a_node->cold);
+   if (cold == NULL)
+      {
+      if (!a_make) return NULL;
+      cold = (S_cold_t*)_cfi_malloc (sizeof(S_cold_t));
+      if (cold == NULL) return NULL;
+      cold_init (cold);
+      cold->heap = 1;
+      if (!PIN_CAS(&a_node->cold,(S_cold_t*)NULL,cold))
+         {
+         _cfi_free (cold); /* Another thread made them. */
+         cold = PIN_GET (&a_node->cold);
+         }
+      }
+
+   pins = PIN_GET (&cold->pins);
+   if ((pins == NULL) && a_make)
+      {
+      pins = (S_pins_t*)_cfi_calloc (1, sizeof(S_pins_t));
+      if (pins == NULL) return NULL;
+      if (!PIN_CAS(&cold->pins,(S_pins_t*)NULL,pins))
+         {
+         _cfi_free (pins); /* Another thread made them. */
+         pins = PIN_GET (&cold->pins);
+         }
+      }
+
+   return pins;
+   }
+
+
+/*****************************************************************************
+ * Private Function pins_keep
+ *****************************************************************************
+ *
+ * This function puts a node on the list of the nodes kept by the pins; if
+ * there is no memory for the list, the node is never freed.
+ *
+ *****************************************************************************/
+
+static int pins_keep (S_pins_t* a_pins, S_node_t* a_node, S_arena_t* a_arena)
+   {
+   S_kept_t* kept;
+   size_t    space;
+
+   if (a_pins->keptCount == a_pins->keptSpace)
+      {
+      space = a_pins->keptSpace > 0 ? 2*a_pins->keptSpace : PIN_SPACE;
+      kept  = (S_kept_t*)_cfi_realloc (a_pins->kept, space*sizeof(S_kept_t));
+      if (kept == NULL) return 0;
+      a_pins->kept      = kept;
+      a_pins->keptSpace = space;
+      }
+
+   a_node->owned |= OWN_KEPT;
+   a_pins->kept[a_pins->keptCount].node  = a_node;
+   a_pins->kept[a_pins->keptCount].arena = a_arena;
+   a_pins->keptCount += 1;
+
+   return 1;
+   }
+
+
+/*****************************************************************************
+ * Private Function node_defer
+ *****************************************************************************
+ *
+ * This function keeps a node that is to be freed, and, if "a_chain" is set,
+ * the nodes after it, when its document has pins; a node that is already
+ * kept, or is in a section that is, is freed with it.  "a_arena" is the arena
+ * of a whole document that is freed with its root.  The thread holds a pin of
+ * its own while it puts the nodes in the list, so the list isn't freed
+ * meanwhile.
+ *
+ * Return Value
+ *
+ *     0 - Indicates that there are no pins, and the node is to be freed now.
+ *
+ *     1 - Indicates that the node is freed when the last pin is taken off.
+ *
+ *****************************************************************************/
+
+static int node_defer (S_node_t* a_node, S_arena_t* a_arena, int a_chain)
+   {
+   S_pins_t* pins;
+   S_node_t* node;
+   size_t    count;
+   unsigned  spins = 0;
+
+   pins = a_arena != NULL ? &a_arena->pins : node_pins (a_node, 0);
+   if (pins == NULL) return 0;
+
+   for (;;)
+      {
+      count = PIN_GET (&pins->count);
+      if (count == 0) return 0;
+      if ((count != PIN_FREEING) && PIN_CAS(&pins->count,count,count+1))
+         {
+         break;
+         }
+      pin_wait (&spins);
+      }
+   spins = 0;
+   while (!PIN_CAS(&pins->lock,0,1)) pin_wait (&spins);
+
+   node = a_node;
+   while ((node != NULL) && ((node->owned & OWN_KEPT) == 0))
+      {
+      node = node_parent (node);
+      }
+   if (node == NULL)
+      {
+      for (node = a_node ; node != NULL ; node = a_chain ? node->next : NULL)
+         {
+         if (!pins_keep (pins, node, a_arena)) break;
+         }
+      }
+
+   (void)PIN_CAS (&pins->lock, 1, 0);
+   (void)pins_unpin (pins);
+
+   return 1;
+   }
+
+
+/*****************************************************************************
+ * Private Function pins_unpin
+ *****************************************************************************
+ *
+ * This function takes off a pin; the thread that takes off the last one frees
+ * the nodes that were kept.  It returns 0 if there was no pin.
+ *
+ *****************************************************************************/
+
+static int pins_unpin (S_pins_t* a_pins)
+   {
+   size_t   count;
+   unsigned spins = 0;
+
+   for (;;)
+      {
+      count = PIN_GET (&a_pins->count);
+      if ((count == 0) || (count == PIN_FREEING)) return 0;
+      if (PIN_CAS(&a_pins->count,count,count-1)) break;
+      pin_wait (&spins);
+      }
+
+   if ((count == 1) && (a_pins->keptCount > 0) &&
+       PIN_CAS(&a_pins->count,0,PIN_FREEING))
+      {
+      pins_free (a_pins);
+      }
+
+   return 1;
+   }
+
+
+/*****************************************************************************
+ * Private Function pins_free
+ *****************************************************************************
+ *
+ * This function frees the nodes kept by the pins, in the order they were
+ * deleted, so that a node is freed before the section it is in, and then lets
+ * the pins be taken again.  The root or the arena that has the pins in it, if
+ * it was kept, is freed last, after the pins are let go.
+ *
+ *****************************************************************************/
+
+static void pins_free (S_pins_t* a_pins)
+   {
+   S_kept_t* kept  = a_pins->kept;
+   size_t    count = a_pins->keptCount;
+   S_kept_t  last;
+   size_t    i;
+
+   a_pins->kept      = NULL;
+   a_pins->keptCount = 0;
+   a_pins->keptSpace = 0;
+
+   last.node  = NULL;
+   last.arena = NULL;
+   for (i = 0 ; i < count ; i++)
+      {
+      if ((kept[i].arena != NULL) && (&kept[i].arena->pins == a_pins))
+         last = kept[i];
+      else if ((kept[i].arena == NULL) && (kept[i].node->cold != NULL) &&
+               (kept[i].node->cold->pins == a_pins))
+         last = kept[i];
+      else if (kept[i].arena != NULL)
+         cfi_arena_del (kept[i].arena);
+      else
+         cfi_whack (kept[i].node);
+      }
+
+   _cfi_free (kept);
+   (void)PIN_CAS (&a_pins->count, PIN_FREEING, 0);
+
+   if (last.arena != NULL)
+      cfi_arena_del (last.arena);
+   else if (last.node != NULL)
+      cfi_whack (last.node);
+   }
+
+
+/*****************************************************************************
+ * Private Function freeze_size
+ *****************************************************************************
+ *
+ * This function counts the nodes of a chain and of all of their contents, and
+ * the bytes of the arena that their links and attributes take; the words are
+ * put in the key table of the arena, to be counted.  Lazy sections are parsed.
+ * A deleted node that is still retained, and its contents, aren't counted.
+ *
+ *****************************************************************************/
+
+static void freeze_size (S_node_t* a_node, S_freeze_t* a_freeze)
+   {
+   CFI_attr_t attr;
+
+   for ( ; a_node != NULL ; a_node = a_node->next)
+      {
+      if (a_node->deleted) continue;
+      a_freeze->nodes += 1;
+      if (a_node->word != NULL)
+         {
+         (void)cfi_arena_key (
+                             a_freeze->arena,
+                             a_node->word,
+                             strlen(a_node->word)
+                             );
+         }
+      if (a_node->attributeCount != 0)
+         {
+         a_freeze->size += CFI_ARENA_ROUND (
+                                           a_node->attributeCount *
+                                           sizeof(CFI_attr_t)
+                                           );
+         }
+      for (attr = node_attribute(a_node) ; attr != NULL ; )
+         {
+         a_freeze->size += _cfi_attribute_size (attr);
+         attr = cfi_attribute_next (attr);
+         }
+      if (node_spanned(a_node))
+         {
+         a_freeze->size += CFI_ARENA_ROUND (sizeof(S_cold_t));
+         }
+      if (a_node->discriminator == CFI_SECTION)
+         {
+         if (a_node->lazy == LAZY_BODY) node_expand (a_node);
+         freeze_size (a_node->contents, a_freeze);
+         }
+      }
+   }
+
+
+/*****************************************************************************
+ * Private Function freeze_copy
+ *****************************************************************************
+ *
+ * This function copies a chain of nodes, and all of their contents, into the
+ * next nodes of the array, in order: each section is followed by its contents
+ * and then by the node after it.  "a_pred" is the node before the chain.
+ * Deleted nodes are left out, as freeze_size() leaves them out.
+ *
+ *****************************************************************************/
+
+static const char* freeze_copy (
+                               S_node_t*   a_node,
+                               S_node_t*   a_pred,
+                               S_freeze_t* a_freeze,
+                               S_node_t**  a_copy
+                               )
+   {
+   S_node_t*   node;
+   S_node_t*   last = NULL;
+   CFI_attr_t  attr;
+   CFI_attr_t* link;
+   size_t      i;
+
+   *a_copy = NULL;
+
+   for ( ; a_node != NULL ; a_node = a_node->next)
+      {
+      if (a_node->deleted) continue;
+      node = &a_freeze->table[a_freeze->nodes++];
+      node_init (node);
+      node->discriminator = a_node->discriminator;
+      node->arena         = a_freeze->arena;
+      node->owned         = OWN_WORD | OWN_LINK | OWN_FROZEN;
+      node->pred          = last == NULL ? a_pred : last;
+      if (last == NULL)
+         *a_copy = node;
+      else
+         last->next = node;
+      last = node;
+
+      if (a_node->word != NULL)
+         {
+         node->word = cfi_arena_key (
+                                    a_freeze->arena,
+                                    a_node->word,
+                                    strlen(a_node->word)
+                                    );
+         if (node->word == NULL) return "can't allocate memory";
+         node->owned |= OWN_KEY;
+         }
+
+      if (node_spanned(a_node))
+         {
+         if (node_cold(node) == NULL) return "can't allocate memory";
+         node->cold->spanStart = a_node->cold->spanStart;
+         node->cold->spanLeng  = a_node->cold->spanLeng;
+         node->cold->spanBody  = a_node->cold->spanBody;
+         }
+
+      if (a_node->attributeCount != 0)
+         {
+         link = (CFI_attr_t*)cfi_arena_alloc (
+                                             a_freeze->arena,
+                                             a_node->attributeCount *
+                                             sizeof(CFI_attr_t)
+                                             );
+         if (link == NULL) return "can't allocate memory";
+         attr = node_attribute (a_node);
+         for (i = 0 ; attr != NULL ; i++, attr = cfi_attribute_next(attr))
+            {
+            link[i] = _cfi_attribute_copy (a_freeze->arena, attr);
+            if (link[i] == NULL) return "can't allocate memory";
+            if (i > 0) (void)_cfi_attribute_join (link[i-1], link[i]);
+            }
+         node->attributeCount = (unsigned)i;
+         node->attributeSpace = (unsigned)i;
+         node->attributeLink  = link;
+         }
+
+      if (a_node->contents != NULL)
+         {
+         if (freeze_copy(a_node->contents,node,a_freeze,&node->contents) !=
+             NULL)
+            {
+            return "can't allocate memory";
+            }
+         }
+      }
+
+   return NULL;
+   }
+
+
+/*****************************************************************************
+ * Private Function usage_arena
+ *****************************************************************************
+ *
+ * This function gives the bytes of an arena that the objects of a document
+ * take, as counted so far; the arena is added to those that are found.
+ *
+ *****************************************************************************/
+
+static size_t* usage_arena (S_usage_t* a_usage, S_arena_t* a_arena)
+   {
+   S_used_t* arenas;
+   size_t    i;
+
+   for (i = 0 ; i < a_usage->count ; i++)
+      {
+      if (a_usage->arenas[i].arena == a_arena) return &a_usage->arenas[i].used;
+      }
+
+   if (a_usage->count == a_usage->space)
+      {
+      arenas = (S_used_t*)_cfi_realloc (
+                                       a_usage->arenas,
+                                       (2*a_usage->space+4)*sizeof(S_used_t)
+                                       );
+      if (arenas == NULL)
+         {
+         a_usage->failed = 1;
+         return NULL;
+         }
+      a_usage->arenas = arenas;
+      a_usage->space  = 2*a_usage->space + 4;
+      }
+
+   a_usage->arenas[i].arena = a_arena;
+   a_usage->arenas[i].used  = 0;
+   a_usage->count += 1;
+
+   return &a_usage->arenas[i].used;
+   }
+
+
+/*****************************************************************************
+ * Private Function node_usage
+ *****************************************************************************
+ *
+ * This function counts a chain of nodes, and all of their contents, in the
+ * memory of a document.  The nodes aren't changed; lazy sections are counted
+ * as they are, not parsed.
+ *
+ *****************************************************************************/
+
+static void node_usage (S_node_t* a_node, S_usage_t* a_usage)
+   {
+   CFI_memory_t* stats = a_usage->stats;
+   size_t*       used;
+   size_t        dummy;
+   size_t        size;
+   CFI_attr_t    attr;
+
+   for ( ; a_node != NULL ; a_node = a_node->next)
+      {
+      used = &dummy;
+      if (a_node->arena != NULL)
+         {
+         used = usage_arena (a_usage, cfi_arena_owner(a_node->arena));
+         if (used == NULL) used = &dummy;
+         }
+
+      stats->nodes += 1;
+      if (a_node->arena != NULL)
+         {
+         size = CFI_ARENA_ROUND (sizeof(S_node_t));
+         if (a_node->cold != NULL) size += CFI_ARENA_ROUND (sizeof(S_cold_t));
+         stats->nodeBytes += size;
+         *used            += size;
+         }
+      else
+         {
+         size = sizeof(S_node_t);
+         if ((a_node->cold != NULL) && !a_node->cold->heap)
+            {
+            size += sizeof(S_cold_t); /* made with the node */
+            }
+         stats->nodeBytes += size;
+         _cfi_memory_heap (stats, size);
+         }
+      if ((a_node->cold != NULL) && a_node->cold->heap)
+         {
+         stats->nodeBytes += sizeof(S_cold_t);
+         _cfi_memory_heap (stats, sizeof(S_cold_t));
+         }
+
+      if ((a_node->word != NULL) && ((a_node->owned & OWN_KEY) == 0))
+         {
+         size = strlen (a_node->word) + 1;
+         stats->words += 1;
+         if (a_node->owned & OWN_WORD)
+            {
+            stats->wordBytes += CFI_ARENA_ROUND (size);
+            *used            += CFI_ARENA_ROUND (size);
+            }
+         else
+            {
+            stats->wordBytes += size;
+            _cfi_memory_heap (stats, size);
+            }
+         }
+
+      if (a_node->attributeLink != NULL)
+         {
+         size = a_node->attributeSpace * sizeof(CFI_attr_t);
+         stats->links += 1;
+         if (a_node->owned & OWN_LINK)
+            {
+            stats->linkBytes += CFI_ARENA_ROUND (size);
+            *used            += CFI_ARENA_ROUND (size);
+            }
+         else
+            {
+            stats->linkBytes += size;
+            _cfi_memory_heap (stats, size);
+            }
+         }
+
+      for (attr = node_attribute(a_node) ; attr != NULL ; )
+         {
+         *used += _cfi_attribute_usage (attr, stats);
+         attr = cfi_attribute_next (attr);
+         }
+
+      if (node_index(a_node) != NULL)
+         {
+         size = sizeof(S_index_t) +
+                (a_node->cold->index->mask + 1) * sizeof(S_slot_t);
+         stats->indexes    += 1;
+         stats->indexBytes += size;
+         if (a_node->cold->index->heap)
+            _cfi_memory_heap (stats, size);
+         else
+            *used += CFI_ARENA_ROUND (size);
+         }
+
+      if (a_node->lazy == LAZY_BODY)
+         {
+         _cfi_lazy_usage (a_node->cold->lazy, stats, &a_usage->source);
+         }
+      node_usage (a_node->contents, a_usage);
+      }
+   }
+
+
+/*****************************************************************************
+ * Private Function cfi_traverse
+ *****************************************************************************/
+
+static int cfi_traverse (S_node_t* const a_node, CFI_callback_t a_cbfn)
+   {
+   int       stat = 1;
+   S_node_t* node;
+
+   node = a_node;
+   while (node != NULL)
+      {
+      if (node->contents != NULL) stat &= cfi_traverse (node->contents, a_cbfn);
+      stat &= (*a_cbfn)(node);
+      node = node->next;
+      }
+
+   return stat;
+   }
+
+
+/*****************************************************************************
+ * Private Function cfi_whack
+ *****************************************************************************
+ *
+ * This function removes a node from the tree and deallocates all allocated
+ * memory associated with the node.  If the node is a "section", then ALL of
+ * the nodes that are the contents are also whacked, before the node itself
+ * because they are unlinked from it.
+ *
+ *****************************************************************************/
+
+static void cfi_whack (S_node_t* const a_node)
+   {
+   S_node_t* node = a_node->contents;
+   S_node_t* p;
+
+   while (node != NULL)
+      {
+      p = node->next;
+      cfi_whack (node);
+      node = p;
+      }
+
+   (void)node_whack (a_node);
+
+   return;
+   }
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      E x e c u t a b l e   C o d e   (External Interface Functions)       */
+/*                                                                           */
+/* ************************************************************************* */
+
+
+/*****************************************************************************
+ * Public Function _cfi_node_join
+ *****************************************************************************/
+
+CFI_node_t
+__attribute__ ((visibility("hidden")))
 (_cfi_node_join) (CFI_node_t a_node1, CFI_node_t a_node2)
    {
-   if (a_node2 != NULL) a_node2->pred = a_node1;
-   if (a_node1 != NULL) a_node1->next = a_node2;
-   return a_node1;
+   if (a_node2 != NULL) a_node2->pred = a_node1;
+   if (a_node1 != NULL) a_node1->next = a_node2;
+   return a_node1;
+   }
+
+
+/*****************************************************************************
+ * Public Function _cfi_node_span_set
+ *****************************************************************************/
+
+void (_cfi_node_span_set) (
+                          CFI_node_t a_node,
+                          size_t     a_start,
+                          size_t     a_leng,
+                          size_t     a_body
+                          )
+   {
+   S_cold_t* cold;
+
+   if (a_node == NULL) return;
+   if ((cold = node_cold(a_node)) == NULL) return; /* The node has no span. */
+   cold->spanStart = a_start;
+   cold->spanLeng  = a_leng;
+   cold->spanBody  = a_body;
+   }
+
+
+/*****************************************************************************
+ * Public Function _cfi_node_word_new
+ *****************************************************************************/
+
+CFI_node_t (_cfi_node_word_new) (S_arena_t* a_arena, char* a_word)
+   {
+   return node_make (a_arena, a_word);
+   }
+
+
+/*****************************************************************************
+ * Public Function _cfi_node_attribute_new
+ *****************************************************************************/
+
+CFI_node_t (_cfi_node_attribute_new) (
+                                     S_arena_t* a_arena,
+                                     char*      a_word,
+                                     CFI_attr_t a_attr
+                                     )
+   {
+   S_node_t* node = node_make (a_arena, a_word);
+
+   if (node == NULL) return NULL; /* Dynamic memory allocation failure. */
+
+   node->discriminator = CFI_ATTRIBUTES;
+   if (a_attr != NULL) (void)node_links (node, a_attr, a_arena);
+
+   return node;
+   }
+
+
+/*****************************************************************************
+ * Public Function _cfi_node_section_new
+ *****************************************************************************/
+
+CFI_node_t (_cfi_node_section_new) (
+                                   S_arena_t* a_arena,
+                                   char*      a_word,
+                                   CFI_attr_t a_attr,
+                                   CFI_node_t a_contents
+                                   )
+   {
+   S_node_t* node = node_make (a_arena, a_word);
+
+   if (node == NULL) return NULL; /* Dynamic memory allocation failure. */
+
+   node->discriminator = CFI_SECTION;
+   if (a_attr != NULL) (void)node_links (node, a_attr, a_arena);
+   node->contents = a_contents;
+   if (a_contents != NULL) a_contents->pred = node;
+
+   return node;
+   }
+
+
+/*****************************************************************************
+ * Public Function _cfi_node_lazy_new
+ *****************************************************************************
+ *
+ * This function makes a section whose body is parsed when the contents are
+ * first wanted; the lazy section belongs to the node, or is deleted if the
+ * node can't be made.  The contents are not made from the arena, so the
+ * document is freed node by node.
+ *
+ *****************************************************************************/
+
+CFI_node_t (_cfi_node_lazy_new) (
+                                S_arena_t*       a_arena,
+                                char*            a_word,
+                                CFI_attr_t       a_attr,
+                                struct S_lazy_t* a_lazy
+                                )
+   {
+   S_node_t* node = _cfi_node_section_new (a_arena, a_word, a_attr, NULL);
+
+   if (node == NULL)
+      _cfi_lazy_del (a_lazy);
+   else if (node_cold(node) == NULL)
+      {
+      _cfi_lazy_del (a_lazy);
+      node->lazy = LAZY_MEMORY;
+      }
+   else
+      {
+      node->cold->lazy = a_lazy;
+      node->lazy       = LAZY_BODY;
+      node_mix (node);
+      }
+
+   return node;
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_node_new
+ *****************************************************************************/
+
+const char* (cfi_node_new) (CFI_node_t* const a_node)
+   {
+   S_node_t* node = (S_node_t*)_cfi_calloc (1, sizeof(S_node_t));
+
+   if (node == NULL) return "can't allocate memory";
+   CFI_LIVE_ADD (nodes, 1);
+
+   node_init (node);
+
+   *a_node = node;
+
+   return NULL;
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_node_del
+ *****************************************************************************/
+
+const char* (cfi_node_del) (CFI_node_t* const a_node)
+   {
+   S_arena_t* arena;
+
+   if ((*a_node)->owned & OWN_FROZEN) return "node is frozen";
+
+   if (((*a_node)->cold != NULL) && ((*a_node)->arena == NULL))
+      {
+      _cfi_free ((*a_node)->cold->pins);
+      }
+   if (((*a_node)->cold != NULL) && (*a_node)->cold->heap)
+      {
+      _cfi_free ((*a_node)->cold);
+      }
+   arena = node_arena (*a_node);
+   if (arena == NULL)
+      {
+      _cfi_free (*a_node);
+      CFI_LIVE_SUB (nodes, 1);
+      }
+   else
+      cfi_arena_release (arena);
+
+   return NULL;
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_node_type_get
+ *****************************************************************************/
+
+int (cfi_node_type_get) (CFI_node_t const a_node)
+   {
+   return a_node->discriminator;
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_node_type_set
+ *****************************************************************************/
+
+const char* (cfi_node_type_set) (CFI_node_t const a_node, int a_type)
+   {
+   if ((a_type != CFI_WORD) &&
+       (a_type != CFI_ATTRIBUTES) &&
+       (a_type != CFI_SECTION))
+      {
+      return "invalid type";
+      }
+   if (a_node->owned & OWN_FROZEN) return "node is frozen";
+   index_touch (a_node);
+   a_node->discriminator = a_type;
+   return NULL;
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_node_break
+ *****************************************************************************/
+
+CFI_node_t (cfi_node_break) (CFI_node_t const a_node)
+   {
+   S_node_t* next = a_node->next;
+   if (a_node->owned & OWN_FROZEN) return NULL;
+   index_touch (a_node);
+   a_node->next = NULL;
+   node_mix (a_node);
+   return next;
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_node_next
+ *****************************************************************************/
+
+CFI_node_t (cfi_node_next) (CFI_node_t const a_node)
+   {
+   return a_node->next;
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_node_join
+ *****************************************************************************/
+
+CFI_node_t (cfi_node_join) (CFI_node_t const a_node1, CFI_node_t const a_node2)
+   {
+   if ((a_node1 != NULL) && (a_node1->owned & OWN_FROZEN)) return NULL;
+   if ((a_node2 != NULL) && (a_node2->owned & OWN_FROZEN)) return NULL;
+   if (a_node1 != NULL) index_touch (a_node1);
+   if (a_node2 != NULL) index_touch (a_node2);
+   if (a_node2 != NULL)
+      {
+      a_node2->pred = (CFI_node_t)a_node1;
+      node_mix (a_node2);
+      }
+   if (a_node1 != NULL)
+      {
+      a_node1->next = (CFI_node_t)a_node2;
+      node_mix (a_node1);
+      }
+   return a_node1;
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_node_span
+ *****************************************************************************/
+
+const char* (cfi_node_span) (
+                            CFI_node_t const a_node,
+                            size_t* const    a_start,
+                            size_t* const    a_leng
+                            )
+   {
+   if (!node_spanned(a_node)) return "no source span";
+   *a_start = a_node->cold->spanStart;
+   *a_leng  = a_node->cold->spanLeng;
+   return NULL;
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_node_lazy_error
+ *****************************************************************************
+ *
+ * This function tells why the body of a lazy section couldn't be parsed when
+ * it was first used, or it returns NULL; a section whose body wasn't parsed
+ * yet has no error.
+ *
+ *****************************************************************************/
+
+const char* (cfi_node_lazy_error) (CFI_node_t const a_node)
+   {
+   switch (a_node->lazy)
+      {
+      case LAZY_SYNTAX: return "syntax error in the section body";
+      case LAZY_MEMORY: return "can't allocate memory";
+      default:          return NULL;
+      }
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_arena_stats
+ *****************************************************************************/
+
+const char* (cfi_arena_stats) (
+                              CFI_node_t         const a_node,
+                              CFI_arena_stats_t* const a_stats
+                              )
+   {
+   S_arena_t* arena = node_arena (a_node);
+
+   if (arena == NULL) return "no arena";
+   a_stats->blocks = arena->blocks;
+   a_stats->size   = arena->size;
+   a_stats->used   = arena->used;
+   a_stats->nodes  = arena->nodes;
+   return NULL;
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_node_word
+ *****************************************************************************/
+
+char* (cfi_node_word) (CFI_node_t const a_node)
+   {
+   return a_node->word;
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_node_word_get
+ *****************************************************************************/
+
+const char* (cfi_node_word_get) (CFI_node_t const a_node, char** const a_word)
+   {
+   *a_word = a_node->word;
+   return NULL;
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_node_word_set
+ *****************************************************************************/
+
+const char* (cfi_node_word_set) (CFI_node_t const a_node, char* const a_word)
+   {
+   if (a_node->deleted) return "node is already deleted";
+   if (a_node->owned & OWN_FROZEN) return "node is frozen";
+   if (a_node->word != NULL) return "word already set";
+   index_touch (a_node);
+   a_node->word = a_word;
+   if (a_word != NULL) a_node->owned |= OWN_GIVEN;
+   node_mix (a_node);
+   return NULL;
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_node_word_del
+ *****************************************************************************/
+
+const char* (cfi_node_word_del) (CFI_node_t const a_node)
+   {
+   if (a_node->word == NULL) return "there is no word";
+   if (a_node->owned & OWN_FROZEN) return "node is frozen";
+   index_touch (a_node);
+   if (a_node->owned & OWN_GIVEN)
+      _cfi_caller_free (a_node->word);
+   else if ((a_node->owned & OWN_WORD) == 0)
+      _cfi_free (a_node->word);
+   a_node->word   = NULL;
+   a_node->owned &= ~(OWN_WORD | OWN_KEY | OWN_GIVEN);
+   return NULL;
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_node_attribute_count
+ *****************************************************************************/
+
+size_t (cfi_node_attribute_count) (CFI_node_t const a_node)
+   {
+   return a_node->attributeCount;
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_node_attribute
+ *****************************************************************************/
+
+CFI_attr_t (cfi_node_attribute) (CFI_node_t const a_node)
+   {
+   return node_attribute (a_node);
    }
 
 
 /*****************************************************************************
- * Public Function _cfi_node_word_new
+ * Public Function cfi_node_attribute_get
  *****************************************************************************/
 
-CFI_node_t (_cfi_node_word_new) (char* a_word)
+const char* (cfi_node_attribute_get) (
+                                     CFI_node_t  const a_node,
+                                     CFI_attr_t* const a_attr
+                                     )
    {
-   S_node_t*   node;
-   const char* stat;
+   *a_attr = node_attribute (a_node);
+   return NULL;
+   }
 
-   stat = cfi_node_new (&node);
-   if (stat != NULL) return NULL; /* Dynamic memory allocation failure. */
 
-   (void)cfi_node_word_set (node, a_word); /* Since the node was just created */
-                                           /* this should not fail.  See the  */
-                                           /* function below.                 */
+/*****************************************************************************
+ * Public Function cfi_node_attribute_set
+ *****************************************************************************/
 
-   return node;
+const char* (cfi_node_attribute_set) (
+                                     CFI_node_t const a_node,
+                                     CFI_attr_t const a_attr
+                                     )
+   {
+   if (a_node->deleted) return "node is already deleted";
+   if (a_node->owned & OWN_FROZEN) return "node is frozen";
+   if (a_node->discriminator == CFI_WORD) return "wrong node type";
+   if (a_node->attributeCount != 0) return "attribute already set";
+   if (a_attr == NULL) return NULL;
+
+   if (node_links(a_node,a_attr,NULL) != NULL) return "can't allocate memory";
+   node_mix (a_node);
+
+   return NULL;
    }
 
 
 /*****************************************************************************
- * Public Function _cfi_node_attribute_new
+ * Public Function cfi_node_attribute_del
  *****************************************************************************/
 
-CFI_node_t (_cfi_node_attribute_new) (char* a_word, CFI_attr_t a_attr)
+const char* (cfi_node_attribute_del) (CFI_node_t const a_node)
    {
-   S_node_t*   node;
-   const char* stat;
+   CFI_attr_t attr;
+   CFI_attr_t next;
 
-   stat = cfi_node_new (&node);
-   if (stat != NULL) return NULL; /* Dynamic memory allocation failure. */
+   if (a_node->attributeCount == 0) return "there is no attribute";
+   if (a_node->owned & OWN_FROZEN) return "node is frozen";
 
-   (void)cfi_node_type_set (node, CFI_ATTRIBUTES); /* Since the node was just */
-   (void)cfi_node_word_set (node, a_word);         /* created these functions */
-   (void)cfi_node_attribute_set (node, a_attr);    /* should not fail.  See   */
-                                                   /* the functions below.    */
+   attr = node_attribute (a_node);
+   while (attr != NULL)
+      {
+      next = cfi_attribute_next (attr);
+      (void)cfi_attribute_del (&attr);
+      attr = next;
+      }
 
-   return node;
+   if ((a_node->owned & OWN_LINK) == 0) _cfi_free (a_node->attributeLink);
+
+   a_node->attributeCount = 0;
+   a_node->attributeLink  = NULL;
+   a_node->attributeSpace = 0;
+   a_node->owned         &= ~OWN_LINK;
+
+   return NULL;
    }
 
 
 /*****************************************************************************
- * Public Function _cfi_node_section_new
+ * Public Function cfi_node_attribute_insert
+ *****************************************************************************
+ *
+ * The attribute is put in the list, after the one it follows, and its link is
+ * moved into the array of links, which is made bigger only when it is full.
+ *
  *****************************************************************************/
 
-CFI_node_t (_cfi_node_section_new) (
-                                   char*      a_word,
-                                   CFI_attr_t a_attr,
-                                   CFI_node_t a_contents
-                                   )
+const char* (cfi_node_attribute_insert) (
+                                        CFI_node_t const a_node,
+                                        size_t           a_offset,
+                                        CFI_attr_t const a_attr
+                                        )
    {
-   S_node_t*   node;
-   const char* stat;
+   CFI_attr_t p;
 
-   stat = cfi_node_new (&node);
-   if (stat != NULL) return NULL; /* Dynamic memory allocation failure. */
+   if (a_node->deleted) return "node is already deleted";
+   if (a_node->owned & OWN_FROZEN) return "node is frozen";
+   if (a_node->discriminator == CFI_WORD) return "wrong node type";
+   if (a_offset > a_node->attributeCount) return "offset too big";
 
-   (void)cfi_node_type_set (node, CFI_SECTION);   /* Since the node was just */
-   (void)cfi_node_word_set (node, a_word);        /* created these functions */
-   (void)cfi_node_attribute_set (node, a_attr);   /* should not fail.  See   */
-   (void)cfi_node_section_set (node, a_contents); /* the functions below.    */
+   if (node_room(a_node) != NULL) return "can't allocate memory";
 
-   return node;
+   if (a_offset == 0)
+      {
+      (void)cfi_attribute_join (a_attr, node_attribute(a_node));
+      }
+   else
+      {
+      p = a_node->attributeLink[a_offset-1];
+      (void)cfi_attribute_join (a_attr, cfi_attribute_next(p));
+      (void)cfi_attribute_join (p, a_attr);
+      }
+
+   (void)memmove (
+                 &a_node->attributeLink[a_offset+1],
+                 &a_node->attributeLink[a_offset],
+                 (a_node->attributeCount - a_offset) * sizeof(CFI_attr_t)
+                 );
+   a_node->attributeLink[a_offset] = a_attr;
+   a_node->attributeCount += 1;
+   node_mix (a_node);
+
+   return NULL;
    }
 
 
+
 /*****************************************************************************
- * Public Function cfi_node_new
+ * Public Function cfi_node_attribute_remove
+ *****************************************************************************
+ *
+ * An attribute in a document arena is copied, so the attribute that is handed
+ * back can be deleted, and outlasts the document.  The links after it are
+ * moved down in the array of links, which stays the same size until the last
+ * attribute is taken out.
+ *
  *****************************************************************************/
 
-const char* (cfi_node_new) (CFI_node_t* const a_node)
+const char* (cfi_node_attribute_remove) (
+                                        CFI_node_t  const a_node,
+                                        size_t            a_offset,
+                                        CFI_attr_t* const a_attr
+                                        )
    {
-   S_node_t* node = (S_node_t*)calloc (1, sizeof(S_node_t));
+   CFI_attr_t attr;
+   CFI_attr_t p;
 
-   if (node == NULL) return "can't allocate memory";
+   if (a_node->deleted) return "node is already deleted";
+   if (a_node->owned & OWN_FROZEN) return "node is frozen";
+   if (a_node->discriminator == CFI_WORD) return "wrong node type";
+   if (a_offset >= a_node->attributeCount) return "offset too big";
 
-   node->pred           = NULL;
-   node->next           = NULL;
-   node->discriminator  = CFI_WORD;
-   node->word           = NULL;
-   node->attributeCount = 0;
-   node->attributeList  = NULL;
-   node->attributeLink  = NULL;
-   node->contents       = NULL;
-   node->changed        = 0;
-   node->deleted        = 0;
-   node->retainCount    = 0;
+   attr = _cfi_attribute_heap (a_node->attributeLink[a_offset]);
+   if (attr == NULL) return "can't allocate memory";
 
-   *a_node = node;
+   if (a_offset == 0)
+      {
+      *a_attr = a_node->attributeLink[0];
+      }
+   else
+      {
+      p = a_node->attributeLink[a_offset-1];
+      *a_attr = cfi_attribute_next (p);
+      (void)cfi_attribute_join (p, cfi_attribute_next(cfi_attribute_next(p)));
+      }
+
+   a_node->attributeCount -= 1;
+   (void)memmove (
+                 &a_node->attributeLink[a_offset],
+                 &a_node->attributeLink[a_offset+1],
+                 (a_node->attributeCount - a_offset) * sizeof(CFI_attr_t)
+                 );
+   if (a_node->attributeCount == 0)
+      {
+      if ((a_node->owned & OWN_LINK) == 0) _cfi_free (a_node->attributeLink);
+      a_node->attributeLink  = NULL;
+      a_node->attributeSpace = 0;
+      a_node->owned         &= ~OWN_LINK;
+      }
+   node_mix (a_node);
+
+   (void)cfi_attribute_break (attr);
+   *a_attr = attr;
 
    return NULL;
    }
 
 
 /*****************************************************************************
- * Public Function cfi_node_del
+ * Public Function cfi_node_section
  *****************************************************************************/
 
-const char* (cfi_node_del) (CFI_node_t* const a_node)
+CFI_node_t (cfi_node_section) (CFI_node_t const a_node)
    {
-   free (*a_node);
-   return NULL;
+   if (a_node->lazy == LAZY_BODY) node_expand (a_node);
+   return a_node->contents;
    }
 
 
 /*****************************************************************************
- * Public Function cfi_node_type_get
+ * Public Function cfi_node_section_get
  *****************************************************************************/
 
-int (cfi_node_type_get) (CFI_node_t const a_node)
+const char* (cfi_node_section_get) (
+                                   CFI_node_t  const a_node,
+                                   CFI_node_t* const a_contents
+                                   )
    {
-   return a_node->discriminator;
+   if (a_node->lazy == LAZY_BODY) node_expand (a_node);
+   *a_contents = a_node->contents;
+   return NULL;
    }
 
 
 /*****************************************************************************
- * Public Function cfi_node_type_set
+ * Public Function cfi_node_section_set
  *****************************************************************************/
 
-const char* (cfi_node_type_set) (CFI_node_t const a_node, int a_type)
+const char* (cfi_node_section_set) (
+                                   CFI_node_t const a_node,
+                                   CFI_node_t const a_contents
+                                   )
    {
-   if ((a_type != CFI_WORD) &&
-       (a_type != CFI_ATTRIBUTES) &&
-       (a_type != CFI_SECTION))
-      {
-      return "invalid type";
-      }
-   a_node->discriminator = a_type;
+   if (a_node->deleted) return "node is already deleted";
+   if (a_node->owned & OWN_FROZEN) return "node is frozen";
+   if (a_node->lazy == LAZY_BODY) node_expand (a_node);
+   if (a_node->contents != NULL) return "section already set";
+   if (a_contents == NULL) return NULL;
+
+   index_touch (a_contents);
+   a_node->contents = a_contents;
+   a_contents->pred = a_node;
+   node_mix (a_node);
+
    return NULL;
    }
 
 
 /*****************************************************************************
- * Public Function cfi_node_break
+ * Public Function cfi_search
  *****************************************************************************/
 
-CFI_node_t (cfi_node_break) (CFI_node_t const a_node)
+CFI_node_t (cfi_search) (
+                        CFI_node_t const a_node,
+                        const char*      a_word,
+                        int              a_type
+                        )
    {
-   S_node_t* next = a_node->next;
-   a_node->next = NULL;
-   return next;
+   S_node_t* item;
+   S_word_t  word;
+
+   word_init (&word, a_word);
+   item = node_search (a_node, &word, a_type, 1);
+   return item != NULL ? cfi_retain (item) : NULL;
    }
 
 
 /*****************************************************************************
- * Public Function cfi_node_next
+ * Public Function cfi_search_peek
+ *****************************************************************************
+ *
+ * This function is cfi_search() without the retain: the node is lent to the
+ * caller, and nothing of the document is written, so a lazy section whose
+ * body isn't parsed yet is passed over.
+ *
  *****************************************************************************/
 
-CFI_node_t (cfi_node_next) (CFI_node_t const a_node)
+CFI_node_t (cfi_search_peek) (
+                             CFI_node_t const a_node,
+                             const char*      a_word,
+                             int              a_type
+                             )
    {
-   return a_node->next;
+   S_word_t word;
+
+   word_init (&word, a_word);
+   return node_search (a_node, &word, a_type, 0);
    }
 
 
 /*****************************************************************************
- * Public Function cfi_node_join
+ * Public Function cfi_search_flat
  *****************************************************************************/
 
-CFI_node_t (cfi_node_join) (CFI_node_t const a_node1, CFI_node_t const a_node2)
+CFI_node_t (cfi_search_flat) (
+                             CFI_node_t const a_node,
+                             const char*      a_word,
+                             int              a_type
+                             )
    {
-   if (a_node2 != NULL) a_node2->pred = (CFI_node_t)a_node1;
-   if (a_node1 != NULL) a_node1->next = (CFI_node_t)a_node2;
-   return a_node1;
+   S_node_t* item;
+   S_word_t  word;
+
+   word_init (&word, a_word);
+   item = node_find (a_node, &word, a_type, 1);
+   return item != NULL ? cfi_retain (item) : NULL;
    }
 
 
 /*****************************************************************************
- * Public Function cfi_node_word
+ * Public Function cfi_search_flat_peek
+ *****************************************************************************
+ *
+ * This function is cfi_search_flat() without the retain; it uses the index
+ * of the section, if there is one, but doesn't make one.
+ *
  *****************************************************************************/
 
-char* (cfi_node_word) (CFI_node_t const a_node)
+CFI_node_t (cfi_search_flat_peek) (
+                                  CFI_node_t const a_node,
+                                  const char*      a_word,
+                                  int              a_type
+                                  )
    {
-   return a_node->word;
+   S_word_t word;
+
+   word_init (&word, a_word);
+   return node_find (a_node, &word, a_type, 0);
    }
 
 
 /*****************************************************************************
- * Public Function cfi_node_word_get
+ * Public Function cfi_lookup
+ *****************************************************************************
+ *
+ * This function is cfi_path_lookup() of a path that is read for the one
+ * lookup.
+ *
  *****************************************************************************/
 
-const char* (cfi_node_word_get) (CFI_node_t const a_node, char** const a_word)
+CFI_node_t (cfi_lookup) (
+                        CFI_node_t const a_root,
+                        const char*      a_path,
+                        int              a_type
+                        )
    {
-   *a_word = a_node->word;
-   return NULL;
+   CFI_node_t node;
+
+   node = node_lookup (a_root, a_path, a_type, 1);
+   return node != NULL ? cfi_retain (node) : NULL;
    }
 
 
 /*****************************************************************************
- * Public Function cfi_node_word_set
+ * Public Function cfi_lookup_peek
+ *****************************************************************************
+ *
+ * This function is cfi_lookup() without the retain, like cfi_search_peek().
+ *
  *****************************************************************************/
 
-const char* (cfi_node_word_set) (CFI_node_t const a_node, char* const a_word)
+CFI_node_t (cfi_lookup_peek) (
+                             CFI_node_t const a_root,
+                             const char*      a_path,
+                             int              a_type
+                             )
    {
-   if (a_node->deleted) return "node is already deleted";
-   if (a_node->word != NULL) return "word already set";
-   a_node->word = a_word;
-   return NULL;
+   return node_lookup (a_root, a_path, a_type, 0);
    }
 
 
 /*****************************************************************************
- * Public Function cfi_node_word_del
+ * Public Function cfi_path_compile
  *****************************************************************************/
 
-const char* (cfi_node_word_del) (CFI_node_t const a_node)
+const char* (cfi_path_compile) (const char* a_text, CFI_path_t* const a_path)
    {
-   if (a_node->word == NULL) return "there is no word";
-   free (a_node->word);
-   a_node->word = NULL;
+   S_path_t* path;
+   char*     text;
+   size_t    count;
+   size_t    leng;
+
+   *a_path = NULL;
+
+   if (a_text == NULL) return "invalid path";
+   count = path_steps ((char*)a_text, NULL);
+   if (count == 0) return "invalid path";
+
+   leng = strlen (a_text);
+   path = (S_path_t*)_cfi_malloc (
+                                 sizeof(S_path_t) +
+                                 count*sizeof(S_step_t) +
+                                 leng + 1
+                                 );
+   if (path == NULL) return "can't allocate memory";
+   path->count = count;
+   path->step  = (S_step_t*)(path + 1);
+   text        = (char*)(path->step + count);
+   (void)memcpy (text, a_text, leng+1);
+   (void)path_steps (text, path->step);
+
+   *a_path = path;
+
    return NULL;
    }
 
 
 /*****************************************************************************
- * Public Function cfi_node_attribute_count
+ * Public Function cfi_path_lookup
  *****************************************************************************/
 
-size_t (cfi_node_attribute_count) (CFI_node_t const a_node)
+CFI_node_t (cfi_path_lookup) (
+                             CFI_node_t const a_root,
+                             CFI_path_t const a_path,
+                             int              a_type
+                             )
    {
-   return a_node->attributeCount;
+   CFI_node_t node;
+
+   if ((a_root == NULL) || (a_path == NULL)) return NULL;
+   node = path_walk (a_root, a_path, a_type, 1);
+   return node != NULL ? cfi_retain (node) : NULL;
    }
 
 
 /*****************************************************************************
- * Public Function cfi_node_attribute
+ * Public Function cfi_path_lookup_peek
  *****************************************************************************/
 
-CFI_attr_t (cfi_node_attribute) (CFI_node_t const a_node)
+CFI_node_t (cfi_path_lookup_peek) (
+                                  CFI_node_t const a_root,
+                                  CFI_path_t const a_path,
+                                  int              a_type
+                                  )
    {
-   return a_node->attributeList;
+   if ((a_root == NULL) || (a_path == NULL)) return NULL;
+   return path_walk (a_root, a_path, a_type, 0);
    }
 
 
 /*****************************************************************************
- * Public Function cfi_node_attribute_get
+ * Public Function cfi_path_del
  *****************************************************************************/
 
-const char* (cfi_node_attribute_get) (
-                                     CFI_node_t  const a_node,
-                                     CFI_attr_t* const a_attr
-                                     )
+const char* (cfi_path_del) (CFI_path_t* const a_path)
    {
-   *a_attr = a_node->attributeList;
+   _cfi_free (*a_path);
+   *a_path = NULL;
    return NULL;
    }
 
 
 /*****************************************************************************
- * Public Function cfi_node_attribute_set
+ * Public Function cfi_search_begin
+ *****************************************************************************
+ *
+ * This function starts a search of a chain of nodes and all of their
+ * contents for every node with the word, or with any word if "a_word" is
+ * NULL, and one of the types in "a_types"; the sections are searched down to
+ * "a_depth" levels below the chain, or all of them if "a_depth" is negative.
+ *
  *****************************************************************************/
 
-const char* (cfi_node_attribute_set) (
-                                     CFI_node_t const a_node,
-                                     CFI_attr_t const a_attr
-                                     )
+const char* (cfi_search_begin) (
+                               CFI_node_t    const a_root,
+                               const char*         a_word,
+                               unsigned            a_types,
+                               int                 a_depth,
+                               CFI_cursor_t* const a_cursor
+                               )
    {
-   CFI_attr_t* attrArray;
-   CFI_attr_t  attr;
-   int        i;
-
-   if (a_node->deleted) return "node is already deleted";
-   if (a_node->discriminator == CFI_WORD) return "wrong node type";
-   if (a_node->attributeList != NULL) return "attribute already set";
-   if (a_attr == NULL) return NULL;
-
-   attr = a_attr;
-   i    = 0;
-   while (attr != NULL)
+   S_cursor_t* cursor;
+   size_t      leng = a_word != NULL ? strlen (a_word) + 1 : 0;
+
+   *a_cursor = NULL;
+
+   if ((a_types & CFI_ANY_MASK) == 0) return "no types";
+   cursor = (S_cursor_t*)_cfi_malloc (sizeof(S_cursor_t) + leng);
+   if (cursor == NULL) return "can't allocate memory";
+
+   cursor->node   = a_root;
+   cursor->types  = a_types;
+   cursor->depth  = a_depth < 0 ? -1 : a_depth;
+   cursor->level  = 0;
+   cursor->next   = NULL;
+   cursor->space  = 0;
+   cursor->failed = 0;
+   word_init (&cursor->word, NULL);
+   if (a_word != NULL)
       {
-      i += 1;
-      attr = cfi_attribute_next (attr);
-      }
-
-   attrArray = (CFI_attr_t*)calloc (i, sizeof(CFI_attr_t));
-   if (attrArray == NULL) return "can't allocate memory";
-
-   attr = a_attr;
-   i    = 0;
-   while (attr != NULL)
-      {
-      attrArray[i] = attr;
-      attr = cfi_attribute_next (attr);
+      (void)memcpy (cursor + 1, a_word, leng);
+      cursor->word.text = (const char*)(cursor + 1);
       }
 
-   a_node->attributeCount = i;
-   a_node->attributeList  = a_attr;
-   a_node->attributeLink  = attrArray;
+   *a_cursor = cursor;
 
    return NULL;
    }
 
 
 /*****************************************************************************
- * Public Function cfi_node_attribute_del
+ * Public Function cfi_search_next
+ *****************************************************************************
+ *
+ * This function gives the next node that a search finds, in the order of a
+ * walk of the tree: a section comes before its contents, which come before
+ * the nodes after it.  The node is lent, as it is by cfi_search_peek().  A
+ * deleted node, and its contents, are passed over.  NULL is returned when
+ * there are no more nodes.
+ *
  *****************************************************************************/
 
-const char* (cfi_node_attribute_del) (CFI_node_t const a_node)
+CFI_node_t (cfi_search_next) (CFI_cursor_t const a_cursor)
    {
-   CFI_attr_t attr;
+   S_node_t*  node;
+   S_node_t** next;
+   size_t     space;
 
-   if (a_node->attributeList == NULL) return "there is no attribute";
+   if (a_cursor == NULL) return NULL;
 
-   attr = a_node->attributeList;
-   while (attr != NULL)
+   for (;;)
       {
-      attr = cfi_attribute_next (attr);
-      (void)cfi_attribute_del (&attr);
-      }
+      while (a_cursor->node == NULL)
+         {
+         if (a_cursor->level == 0) return NULL;
+         a_cursor->level -= 1;
+         a_cursor->node   = a_cursor->next[a_cursor->level];
+         }
 
-   free (a_node->attributeLink);
+      node = a_cursor->node;
+      a_cursor->node = node->next;
+      if (node->deleted) continue;
 
-   a_node->attributeCount = 0;
-   a_node->attributeList  = NULL;
-   a_node->attributeLink  = NULL;
+      if ((node->discriminator == CFI_SECTION) &&
+          ((a_cursor->depth < 0) ||
+           (a_cursor->level < (size_t)a_cursor->depth)))
+         {
+         if (node->lazy == LAZY_BODY) node_expand (node);
+         if ((node->contents != NULL) && (a_cursor->level == a_cursor->space))
+            {
+            space = a_cursor->space > 0 ? 2*a_cursor->space : CURSOR_LEVELS;
+            next  = (S_node_t**)_cfi_realloc (
+                                             a_cursor->next,
+                                             space*sizeof(S_node_t*)
+                                             );
+            if (next == NULL)
+               {
+               a_cursor->failed = 1;
+               a_cursor->node   = NULL;
+               a_cursor->level  = 0;
+               return NULL;
+               }
+            a_cursor->next  = next;
+            a_cursor->space = space;
+            }
+         if (node->contents != NULL)
+            {
+            a_cursor->next[a_cursor->level] = a_cursor->node;
+            a_cursor->level += 1;
+            a_cursor->node   = node->contents;
+            }
+         }
 
-   return NULL;
+      if ((node_mask(node) & a_cursor->types) &&
+          ((a_cursor->word.text == NULL) || word_is(node,&a_cursor->word)))
+         {
+         return node;
+         }
+      }
    }
 
 
 /*****************************************************************************
- * Public Function cfi_node_attribute_insert
+ * Public Function cfi_search_end
+ *****************************************************************************
+ *
+ * This function frees a search; it returns an error if the search stopped
+ * early for want of memory.
+ *
  *****************************************************************************/
 
-const char* (cfi_node_attribute_insert) (
-                                        CFI_node_t const a_node,
-                                        size_t           a_offset,
-                                        CFI_attr_t const a_attr
-                                        )
+const char* (cfi_search_end) (CFI_cursor_t* const a_cursor)
    {
-   CFI_attr_t* attrArray;
-   CFI_attr_t  p;
-   int         i;
+   int failed;
 
-   if (a_node->deleted) return "node is already deleted";
-   if (a_node->discriminator == CFI_WORD) return "wrong node type";
-   if (a_offset > a_node->attributeCount) return "offset too big";
+   if (*a_cursor == NULL) return NULL;
+   failed = (*a_cursor)->failed;
+   _cfi_free ((*a_cursor)->next);
+   _cfi_free (*a_cursor);
+   *a_cursor = NULL;
 
-   attrArray = (CFI_attr_t*)calloc(a_node->attributeCount+1,sizeof(CFI_attr_t));
-   if (attrArray == NULL) return "can't allocate memory";
+   return failed ? "can't allocate memory" : NULL;
+   }
 
-   if (a_offset == 0)
-      {
-      (void)cfi_attribute_join (a_attr, a_node->attributeList);
-      a_node->attributeList = a_attr;
-      }
-   else
-      {
-      p = a_node->attributeLink[a_offset-1];
-      (void)cfi_attribute_join (a_attr, cfi_attribute_next(p));
-      (void)cfi_attribute_join (p, a_attr);
-      }
 
-   for (p=a_node->attributeList, i=0 ; p!=NULL ; p=cfi_attribute_next(p))
+/*****************************************************************************
+ * Public Function cfi_lookup_many
+ *****************************************************************************
+ *
+ * This function is cfi_search() of "a_count" words, "a_keys[i]" of the type
+ * "a_types[i]", from "a_root", in one walk of the tree instead of one walk
+ * for each: the keys are hashed once, and each node that is passed is looked
+ * up in them.  "a_results[i]" is the node that cfi_search() would give for
+ * the key, retained, or NULL.
+ *
+ *****************************************************************************/
+
+const char* (cfi_lookup_many) (
+                              CFI_node_t  const a_root,
+                              const char* const a_keys[],
+                              const int         a_types[],
+                              size_t            a_count,
+                              CFI_node_t        a_results[]
+                              )
+   {
+   S_many_t many;
+   S_want_t want;
+   size_t   slots = 8;
+   size_t   i;
+   size_t   j;
+
+   for (i = 0 ; i < a_count ; i++) a_results[i] = NULL;
+   if (a_count == 0) return NULL;
+
+   while (slots < 2*a_count) slots *= 2;
+   many.slot = (S_want_t*)_cfi_calloc (slots, sizeof(S_want_t));
+   if (many.slot == NULL) return "can't allocate memory";
+   many.keys    = a_keys;
+   many.types   = a_types;
+   many.results = a_results;
+   many.mask    = slots - 1;
+   many.left    = 0;
+   many.masks   = 0;
+
+   for (i = 0 ; i < a_count ; i++)
       {
-      attrArray[i++] = p;
+      if (a_keys[i] == NULL) continue;
+      want.hash = index_hash (
+                             cfi_arena_hash (a_keys[i], strlen(a_keys[i])),
+                             a_types[i]
+                             );
+      want.key  = i + 1;
+      for (j = want.hash & many.mask ; many.slot[j].key != 0 ; )
+         {
+         j = (j+1) & many.mask;
+         }
+      many.slot[j] = want;
+      many.left   += 1;
+      switch (a_types[i])
+         {
+         case CFI_WORD:       many.masks |= CFI_WORD_MASK;       break;
+         case CFI_ATTRIBUTES: many.masks |= CFI_ATTRIBUTES_MASK; break;
+         case CFI_SECTION:    many.masks |= CFI_SECTION_MASK;    break;
+         }
       }
 
-   free (a_node->attributeLink);
-   a_node->attributeLink = attrArray;
+   many_walk (a_root, &many);
+   _cfi_free (many.slot);
 
-   a_node->attributeCount += 1;
+   for (i = 0 ; i < a_count ; i++)
+      {
+      if (a_results[i] != NULL) a_results[i] = cfi_retain (a_results[i]);
+      }
 
    return NULL;
    }
 
 
-
 /*****************************************************************************
- * Public Function cfi_node_attribute_remove
+ * Public Function cfi_reparse
+ *****************************************************************************
+ *
+ * This function goes down to the innermost section whose body holds all of
+ * the edit; in that body, the items that the edit touches, with the space and
+ * comments around them up to the untouched items, are parsed again from the
+ * new text.  The new nodes take the place of the touched ones, which are
+ * deleted.  Every other node stays where it is, and the source spans after
+ * the edit are moved.  Nothing is changed if the span doesn't parse.
+ *
+ * An item is untouched if it ends at or before the start of the edit, or if
+ * it starts after the end of the edit; an item that starts right at the end
+ * of the edit is touched, since the edit could run into its word.
+ *
  *****************************************************************************/
 
-const char* (cfi_node_attribute_remove) (
-                                        CFI_node_t  const a_node,
-                                        size_t            a_offset,
-                                        CFI_attr_t* const a_attr
-                                        )
+const char* (cfi_reparse) (
+                          CFI_node_t* const       a_root,
+                          const char*             a_old,
+                          const char*             a_new,
+                          const CFI_edit_t* const a_edit
+                          )
    {
-   CFI_attr_t* attrArray;
-   CFI_attr_t  p;
-   size_t      i;
+   S_arena_t*  arena  = NULL;
+   S_node_t*   parent = NULL;
+   S_node_t*   before = NULL;
+   S_node_t*   after;
+   S_node_t*   first;
+   S_node_t*   node;
+   S_node_t*   next;
+   CFI_node_t  nodes;
+   size_t      edit   = a_edit->offset + a_edit->oldLeng;
+   size_t      delta  = a_edit->newLeng - a_edit->oldLeng;
+   size_t      body   = 0;
+   size_t      end;
+   size_t      start;
+   const char* msg;
 
-   if (a_node->deleted) return "node is already deleted";
-   if (a_node->discriminator == CFI_WORD) return "wrong node type";
-   if (a_offset >= a_node->attributeCount) return "offset too big";
+   /*
+    * Go down to the innermost body that holds the edit, and find the first
+    * item that doesn't end before the edit.
+    */
+   if ((*a_root != NULL) && ((*a_root)->owned & OWN_FROZEN))
+      {
+      return "node is frozen";
+      }
+   node = *a_root;
+   while (node != NULL)
+      {
+      if (!node_spanned(node)) return "no source spans";
+      end = node->cold->spanStart + node->cold->spanLeng;
+      if (end <= a_edit->offset)
+         {
+         before = node;
+         node   = node->next;
+         continue;
+         }
+      if ((node->cold->spanBody == 0) ||
+          (a_edit->offset < (node->cold->spanStart + node->cold->spanBody)) ||
+          (edit > (end - 1)))
+         {
+         break;
+         }
+      body = node->cold->spanStart + node->cold->spanBody;
+      if ((a_old[body-1] != '{') ||
+          (a_old[end-1] != '}'))
+         {
+         return "the nodes are not from the old text";
+         }
+      if (node->lazy == LAZY_BODY) node_expand (node);
+      parent = node;
+      before = NULL;
+      node   = node->contents;
+      }
+   first = node;
 
-   attrArray = (CFI_attr_t*)calloc(a_node->attributeCount-1,sizeof(CFI_attr_t));
-   if (attrArray == NULL) return "can't allocate memory";
+   /*
+    * The touched items.
+    */
+   while (node != NULL)
+      {
+      if (!node_spanned(node)) return "no source spans";
+      if (node->cold->spanStart > edit) break;
+      node = node->next;
+      }
+   after = node;
 
-   if (a_offset == 0)
+   /*
+    * The span of the new text to parse.
+    */
+   if (before != NULL)
       {
-      *a_attr = a_node->attributeList;
-      a_node->attributeList = cfi_attribute_next (a_node->attributeList);
+      start = before->cold->spanStart + before->cold->spanLeng;
+      if ((a_old[start-1] != ';') && (a_old[start-1] != '}'))
+         {
+         return "the nodes are not from the old text";
+         }
       }
    else
+      start = body;
+   if (after != NULL)
+      end = after->cold->spanStart + delta;
+   else if (parent != NULL)
+      end = parent->cold->spanStart + parent->cold->spanLeng - 1 + delta;
+   else
+      end = start + strlen (&a_new[start]);
+   if (end < (a_edit->offset + a_edit->newLeng))
       {
-      p = a_node->attributeLink[a_offset-1];
-      *a_attr = cfi_attribute_next (p);
-      (void)cfi_attribute_join (p, cfi_attribute_next(cfi_attribute_next(p)));
+      return "the edit is not in the text";
       }
 
-   for (p=a_node->attributeList, i=0 ; p!=NULL ; p=cfi_attribute_next(p))
+   if (*a_root != NULL) arena = node_arena (*a_root);
+   msg = _cfi_span_parse (arena, &a_new[start], end-start, start, &nodes);
+   if (msg != NULL) return msg;
+
+   /*
+    * Delete the touched items, one at a time, so that any that are retained
+    * are kept until they are released; the index of the body goes first.
+    */
+   if (parent != NULL) index_drop (parent);
+   for (node = first ; node != after ; node = next)
       {
-      attrArray[i++] = p;
+      next       = node->next;
+      node->pred = NULL;
+      node->next = NULL;
+      (void)cfi_delete (node);
       }
 
-   free (a_node->attributeLink);
-   a_node->attributeLink = attrArray;
+   /*
+    * Put in the new items.
+    */
+   if (nodes == NULL)
+      nodes = after;
+   else
+      {
+      for (node = nodes ; node->next != NULL ; node = node->next) ;
+      node->next = after;
+      if (after != NULL) after->pred = node;
+      }
+   if (before != NULL)
+      before->next = nodes;
+   else if (parent != NULL)
+      parent->contents = nodes;
+   else
+      *a_root = nodes;
+   if (nodes != NULL) nodes->pred = before != NULL ? before : parent;
+   if ((*a_root != NULL) && ((*a_root)->arena != NULL))
+      {
+      node_arena(*a_root)->root = *a_root;
+      }
 
-   a_node->attributeCount -= 1;
+   /*
+    * Move the spans after the edit.
+    */
+   span_shift (after, delta);
+   for (node = parent ; node != NULL ; node = node_parent(node))
+      {
+      node->cold->spanLeng += delta;
+      span_shift (node->next, delta);
+      }
 
    return NULL;
    }
 
 
 /*****************************************************************************
- * Public Function cfi_node_section
- *****************************************************************************/
-
-CFI_node_t (cfi_node_section) (CFI_node_t const a_node)
-   {
-   return a_node->contents;
-   }
-
-
-/*****************************************************************************
- * Public Function cfi_node_section_get
+ * Public Function cfi_freeze
+ *****************************************************************************
+ *
+ * This function copies a chain of nodes, "a_root" and the nodes after it, and
+ * all of their contents into one block of a new arena: first the nodes, in
+ * order, then the links, attributes and words.  The copy can't be changed; it
+ * is deleted with cfi_delete_chain() of "*a_frozen", all at once.  The arena
+ * is from the allocator of the arena of "a_root", if it has one.  Nodes that
+ * are deleted but still retained are left out; "*a_frozen" is NULL if all of
+ * the nodes are.
+ *
  *****************************************************************************/
 
-const char* (cfi_node_section_get) (
-                                   CFI_node_t  const a_node,
-                                   CFI_node_t* const a_contents
-                                   )
+const char* (cfi_freeze) (CFI_node_t const a_root, CFI_node_t* const a_frozen)
    {
-   *a_contents = a_node->contents;
-   return NULL;
-   }
-
+   S_freeze_t             freeze;
+   S_arena_t*             arena;
+   const CFI_allocator_t* allocator;
+   S_node_t*              node;
+   size_t                 size;
+   const char*            msg;
 
-/*****************************************************************************
- * Public Function cfi_node_section_set
- *****************************************************************************/
+   *a_frozen = NULL;
+   if (a_root == NULL) return NULL;
 
-const char* (cfi_node_section_set) (
-                                   CFI_node_t const a_node,
-                                   CFI_node_t const a_contents
-                                   )
-   {
-   if (a_node->deleted) return "node is already deleted";
-   if (a_node->contents != NULL) return "section already set";
-   if (a_contents == NULL) return NULL;
+   /*
+    * Count the nodes and the bytes they need; the words are put in the key
+    * table of an arena of their own, to count them once each.
+    */
+   arena = node_arena (a_root);
+   allocator = arena != NULL ? &cfi_arena_owner(arena)->allocator : NULL;
+   freeze.arena = cfi_arena_new (CFI_ARENA_KEYS * 64, allocator);
+   if (freeze.arena == NULL) return "can't allocate memory";
+   freeze.table = NULL;
+   freeze.nodes = 0;
+   freeze.size  = 0;
+   freeze_size (a_root, &freeze);
+   size = CFI_ARENA_ROUND (freeze.nodes*sizeof(S_node_t)) + freeze.size +
+          freeze.arena->used;
+   cfi_arena_del (freeze.arena);
+   if (freeze.nodes == 0) return NULL; /* All of the nodes are deleted. */
 
-   a_node->contents = a_contents;
-   a_contents->pred = a_node;
+   /*
+    * Make the nodes from one array, so that they can't be deleted one by one,
+    * and copy the document into it.
+    */
+   freeze.arena = cfi_arena_new (size, allocator);
+   if (freeze.arena == NULL) return "can't allocate memory";
+   freeze.table = (S_node_t*)cfi_arena_alloc (
+                                             freeze.arena,
+                                             freeze.nodes*sizeof(S_node_t)
+                                             );
+   if (freeze.table == NULL)
+      {
+      cfi_arena_del (freeze.arena);
+      return "can't allocate memory";
+      }
+   freeze.arena->nodes = freeze.nodes;
+   freeze.nodes = 0;
+   msg = freeze_copy (a_root, NULL, &freeze, &node);
+   if (msg != NULL)
+      {
+      cfi_arena_del (freeze.arena);
+      return msg;
+      }
+   cfi_arena_done (freeze.arena, node);
 
+   *a_frozen = node;
    return NULL;
    }
 
 
 /*****************************************************************************
- * Public Function cfi_search
+ * Public Function cfi_memory_usage
+ *****************************************************************************
+ *
+ * This function counts the memory of a chain of nodes, "a_root" and the nodes
+ * after it, and all of their contents: the objects of each kind, the bytes
+ * they take, and the overhead of the allocator and of the arenas that they
+ * are in.  The whole of each such arena is counted.
+ *
  *****************************************************************************/
 
-CFI_node_t (cfi_search) (
-                        CFI_node_t const a_node,
-                        const char*      a_word,
-                        int              a_type
-                        )
+const char* (cfi_memory_usage) (
+                               CFI_node_t    const a_root,
+                               CFI_memory_t* const a_stats
+                               )
    {
-   S_node_t* node = a_node;
-   S_node_t* item = NULL;
-
-   while (node != NULL)
-      {
-      if (CFI_STREQ(node->word,a_word) && (node->discriminator == a_type))
-         item = cfi_retain (node) == node ? node : NULL;
-      else
-         {
-         if (node->discriminator == CFI_SECTION)
-            item = cfi_search (node->contents, a_word, a_type);
-         }
-      if (item != NULL)
-         node = NULL;
-      else
-         node = node->next;
-      }
-
-   return item;
-   }
-
+   S_usage_t usage;
+   size_t    i;
 
-/*****************************************************************************
- * Public Function cfi_search_flat
- *****************************************************************************/
+   (void)memset (a_stats, 0, sizeof(CFI_memory_t));
 
-CFI_node_t (cfi_search_flat) (
-                             CFI_node_t const a_node,
-                             const char*      a_word,
-                             int              a_type
-                             )
-   {
-   S_node_t* node = a_node;
-   S_node_t* item = NULL;
+   usage.stats  = a_stats;
+   usage.arenas = NULL;
+   usage.count  = 0;
+   usage.space  = 0;
+   usage.source = NULL;
+   usage.failed = 0;
+   node_usage (a_root, &usage);
 
-   while (node != NULL)
+   for (i = 0 ; i < usage.count ; i++)
       {
-      if (CFI_STREQ(node->word,a_word) && (node->discriminator == a_type))
-         {
-         item = cfi_retain (node) == node ? node : NULL;
-         }
-      if (item != NULL)
-         node = NULL;
-      else
-         node = node->next;
+      cfi_arena_usage (usage.arenas[i].arena, a_stats, usage.arenas[i].used);
       }
+   _cfi_free (usage.arenas);
 
-   return item;
+   a_stats->total = a_stats->nodeBytes + a_stats->attributeBytes +
+                    a_stats->textBytes + a_stats->wordBytes +
+                    a_stats->linkBytes + a_stats->sourceBytes +
+                    a_stats->indexBytes + a_stats->overhead;
+
+   return usage.failed ? "can't allocate memory" : NULL;
    }
 
 
@@ -935,10 +3537,12 @@ CFI_node_t (cfi_search_flat) (
 
 CFI_node_t (cfi_retain) (CFI_node_t a_node)
    {
+   if (a_node->owned & OWN_FROZEN) return a_node;
    if (a_node->deleted) return NULL;
    if (a_node->discriminator == CFI_SECTION)
       (void)cfi_traverse (a_node->contents, node_retain);
    a_node->retainCount += 1;
+   if (a_node->arena != NULL) node_arena(a_node)->retains += 1;
    return a_node;
    }
 
@@ -954,9 +3558,11 @@ const char* (cfi_release) (CFI_node_t a_node)
                              /* released.  This happens when their retain */
                              /* count becomes zero upon being released.   */
 
+   if (a_node->owned & OWN_FROZEN) return NULL;
    if (a_node->retainCount == 0) return "not retained";
 
    a_node->retainCount -= 1;
+   if (a_node->arena != NULL) node_arena(a_node)->retains -= 1;
    if (a_node->retainCount == 0) allNodesReleased = 1;
 
    if (a_node->discriminator == CFI_SECTION)
@@ -964,7 +3570,10 @@ const char* (cfi_release) (CFI_node_t a_node)
       allNodesReleased &= cfi_traverse (a_node->contents, node_release);
       }
 
-   if (allNodesReleased && (a_node->deleted)) cfi_whack (a_node);
+   if (allNodesReleased && (a_node->deleted) && !node_defer(a_node,NULL,0))
+      {
+      cfi_whack (a_node);
+      }
 
    return NULL;
    }
@@ -981,6 +3590,7 @@ const char* (cfi_delete) (CFI_node_t a_node)
                               /* deletable.  This happens when their retain  */
                               /* count is zero upon having their delete flag */
                               /* being set.                                  */
+   if (a_node->owned & OWN_FROZEN) return "node is frozen";
    a_node->deleted = 1;
    if (a_node->retainCount == 0) allNodesDeletable = 1;
 
@@ -989,7 +3599,7 @@ const char* (cfi_delete) (CFI_node_t a_node)
       allNodesDeletable &= cfi_traverse (a_node->contents, node_delete);
       }
 
-   if (allNodesDeletable) cfi_whack (a_node);
+   if (allNodesDeletable && !node_defer(a_node,NULL,0)) cfi_whack (a_node);
 
    return NULL;
    }
@@ -997,6 +3607,13 @@ const char* (cfi_delete) (CFI_node_t a_node)
 
 /*****************************************************************************
  * Public Function cfi_delete_chain
+ *****************************************************************************
+ *
+ * The root chain of a document that was parsed into an arena is deleted by
+ * freeing the arena, when no node is retained and the document was not
+ * changed in a way that put memory of the heap into it; while there are pins,
+ * the arena is kept until the last pin is taken off.
+ *
  *****************************************************************************/
 
 const char* (cfi_delete_chain) (CFI_node_t a_node)
@@ -1007,14 +3624,27 @@ const char* (cfi_delete_chain) (CFI_node_t a_node)
                               /* count is zero upon having their delete flag */
                               /* being set.                                  */
 
-   S_node_t* node;
-   S_node_t* p;
+   S_arena_t* arena = NULL;
+   S_node_t*  node;
+   S_node_t*  p;
+
+   if (a_node != NULL) arena = node_arena (a_node);
+   if ((arena != NULL) && (arena->root == a_node) && !arena->mixed &&
+       (arena->retains == 0))
+      {
+      if (!node_defer(a_node,arena,0)) cfi_arena_del (arena);
+      return NULL;
+      }
+   if ((a_node != NULL) && (a_node->owned & OWN_FROZEN))
+      {
+      return "node is frozen";
+      }
 
    node = a_node;
    while (node != NULL)
       {
-      a_node->deleted = 1;
-      if (a_node->retainCount > 0) allNodesDeletable = 0;
+      node->deleted = 1;
+      if (node->retainCount > 0) allNodesDeletable = 0;
 
       if (node->discriminator == CFI_SECTION)
          {
@@ -1023,7 +3653,7 @@ const char* (cfi_delete_chain) (CFI_node_t a_node)
       node = node->next;
       }
 
-   if (allNodesDeletable)
+   if (allNodesDeletable && !node_defer(a_node,NULL,1))
       {
       node = a_node;
       while (node != NULL)
@@ -1038,6 +3668,67 @@ const char* (cfi_delete_chain) (CFI_node_t a_node)
    }
 
 
+/*****************************************************************************
+ * Public Function cfi_pin
+ *****************************************************************************
+ *
+ * This function pins the document of a node, so that no node of it is freed
+ * while the caller reads it: a node deleted while the document has pins is
+ * kept, marked deleted, until the last pin is taken off.  The count is the
+ * document's, in its arena or its root, so the pins of one document don't
+ * keep the nodes of another.  A pin of a document in an arena is an atomic
+ * add; for a document from the heap, the root is found first by going back
+ * through the nodes before "a_node", and the first pin makes the pins, which
+ * takes up to two allocations.  A pin is not taken while the kept nodes are
+ * being freed.
+ *
+ *****************************************************************************/
+
+const char* (cfi_pin) (CFI_node_t const a_node)
+   {
+   S_pins_t* pins;
+   size_t    count;
+   unsigned  spins = 0;
+
+   if (a_node == NULL) return "no node";
+
+   pins = node_pins (a_node, 1);
+   if (pins == NULL) return "can't allocate memory";
+
+   for (;;)
+      {
+      count = PIN_GET (&pins->count);
+      if ((count != PIN_FREEING) && PIN_CAS(&pins->count,count,count+1))
+         {
+         return NULL;
+         }
+      pin_wait (&spins);
+      }
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_unpin
+ *****************************************************************************
+ *
+ * This function takes off a pin of the document of a node; the thread that
+ * takes off the last one frees the nodes of the document that were kept.
+ *
+ *****************************************************************************/
+
+const char* (cfi_unpin) (CFI_node_t const a_node)
+   {
+   S_pins_t* pins;
+
+   if (a_node == NULL) return "no node";
+
+   pins = node_pins (a_node, 0);
+   if ((pins == NULL) || !pins_unpin(pins)) return "not pinned";
+
+   return NULL;
+   }
+
+
 /*****************************************************************************
  * Public Function cfi_node_is_deleted
  *****************************************************************************/
@@ -1048,4 +3739,14 @@ int (cfi_node_is_deleted) (CFI_node_t a_node)
    }
 
 
+/*****************************************************************************
+ * Public Function cfi_node_is_frozen
+ *****************************************************************************/
+
+int (cfi_node_is_frozen) (CFI_node_t a_node)
+   {
+   return (a_node->owned & OWN_FROZEN) != 0;
+   }
+
+
 /* end of file */
@@ -0,0 +1,841 @@
+/*
+ * This file is part of the CFI software.
+ * The license which this software falls under is as follows:
+ *
+ * Copyright (C) 1999-2005 Douglas Jerome <douglas@ttylinux.org>
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+/* *****************************************************************************
+
+FILE NAME
+
+	Name:     index.c
+	Revision: 1.0
+
+PROGRAM INFORMATION
+
+	Developed by:	CFI project
+
+FILE DESCRIPTION
+
+	Configuration File Interface: Structural Index
+
+	This file is the first stage of the hand written lexical analyzer in
+	"scan.c"; it finds the marks described in "index.h" without looking
+	at the input one character at a time.
+
+	Each 64 byte block of the input is classified into bit masks, one bit
+	per byte, with SSE2 or AVX2 compares when the processor has them, or
+	with a plain loop when it doesn't; define CFI_INDEX_SCALAR to always
+	use the plain loop.  Then the structural characters and the starts of
+	runs are taken from the masks a 64 bit word at a time, and only the
+	characters that change the state of the scan are visited one by one:
+	the '"' and comment starts in code, the end of a string or a line
+	comment, and the "/ *" and "* /" of a block comment, which nests.
+
+	A string ends at the first '"' that is not right after a '\', and a
+	'"', "#", "--", "//" or "/ *" in code always starts a string or a
+	comment, just as in "lex.l"; no CFI token can include them.
+
+***************************************************************************** */
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      F e a t u r e   S w i t c h e s                                      */
+/*                                                                           */
+/* ************************************************************************* */
+
+/*
+ * Select these feature by moving them from the `if UNDEF' into the `else'
+ * section.
+ */
+#ifdef	UNDEF
+#   define	_BSD_SOURCE	1	/* 4.3+bsd subsystems           */
+#   define	_POSIX_SOURCE	1	/* posix.1                      */
+#   define	_POSIX_C_SOURCE	199309L	/* posix.1 and posix.4          */
+#   define	_POSIX_C_SOURCE	199506L	/* posix.1 and posix.4 and MORE */
+#else
+#   define	_POSIX_C_SOURCE	200112L	/* posix.1 and posix.4 and MORE */
+#   undef	_REENTRANT
+#   define	_REENTRANT		/* thread-safe for glibc        */
+#endif
+
+#if	defined(__GNUC__) && !defined(CFI_INDEX_SCALAR) && \
+	(defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)))
+#   define	INDEX_X86	1	/* SSE2, and AVX2 if the cpu has it */
+#endif
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      I n c l u d e d   F i l e s                                          */
+/*                                                                           */
+/* ************************************************************************* */
+
+/*
+ * OS Specific Header Files
+ */
+#ifdef	WIN32
+#   include	"stdafx.h"
+#endif
+
+/*
+ * Standard C (ANSI) Header Files
+ */
+#include	<stdlib.h>
+#include	<string.h>
+
+/*
+ * Posix Header Files
+ */
+#ifndef	WIN32
+#   include	<unistd.h> /* always first amongst POSIX header files */
+#endif
+
+/*
+ * Compiler Specific Header Files
+ */
+#ifdef	INDEX_X86
+#   include	<immintrin.h>
+#endif
+
+/*
+ * Project Specific Header Files
+ */
+#include	"CFI.h"
+#include	"index.h"
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      C o n s t a n t s                                                    */
+/*                                                                           */
+/* ************************************************************************* */
+
+#define	CARRY_RUN	(1) /* the last character is part of a run in code */
+#define	CARRY_ESCAPE	(2) /* the last character is a '\'                 */
+
+#define	MASK_ALL	(~(T_mask_t)0)
+#define	MASK_FROM(n)	((n) >= 64 ? (T_mask_t)0 : MASK_ALL << (n))
+#define	MASK_BELOW(n)	(((T_mask_t)1 << (n)) - 1)
+#define	MASK_TOP(b)	((T_mask_t)((b) != 0) << 63)
+
+/*
+ * The window functions must have the block functions inlined, to build them
+ * with the instructions of their processor.
+ */
+#ifdef	__GNUC__
+#   define	BLOCK_INLINE	__inline__ __attribute__ ((always_inline))
+#else
+#   define	BLOCK_INLINE	__inline__
+#endif
+
+#ifdef	__GNUC__
+#   define	MASK_CTZ(m)	((unsigned int)__builtin_ctzll(m))
+#   define	MASK_POP(m)	((unsigned int)__builtin_popcountll(m))
+#else
+#   define	MASK_CTZ(m)	mask_ctz (m)
+#   define	MASK_POP(m)	mask_pop (m)
+#endif
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      D a t a   T y p e s   a n d   S t r u c t u r e s                    */
+/*                                                                           */
+/* ************************************************************************* */
+
+#ifdef	_MSC_VER
+typedef unsigned __int64 T_mask_t;
+#else
+typedef unsigned long long T_mask_t;
+#endif
+
+typedef struct S_block_t
+   {
+   T_mask_t quote;      /* '"'                       */
+   T_mask_t escape;     /* '\'                       */
+   T_mask_t newline;    /* '\n'                      */
+   T_mask_t hash;       /* '#'                       */
+   T_mask_t dash;       /* '-'                       */
+   T_mask_t slash;      /* '/'                       */
+   T_mask_t star;       /* '*'                       */
+   T_mask_t structural; /* '{' '}' '(' ')' '=' ',' ';' */
+   T_mask_t space;      /* ' ' '\t' '\f' '\n'        */
+   }
+   S_block_t;
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      E x e c u t a b l e   C o d e   (Locally Used Functions)             */
+/*                                                                           */
+/* ************************************************************************* */
+
+
+/*****************************************************************************
+ * Private Function Prototypes
+ *****************************************************************************/
+
+#ifndef	__GNUC__
+static unsigned int mask_ctz (T_mask_t mask);
+static unsigned int mask_pop (T_mask_t mask);
+#endif
+static BLOCK_INLINE void classify_scalar (
+                                         const unsigned char* text,
+                                         S_block_t*           block
+                                         );
+#ifdef	INDEX_X86
+static BLOCK_INLINE void classify_sse2 (
+                                       const unsigned char* text,
+                                       S_block_t*           block
+                                       );
+static BLOCK_INLINE void classify_avx2 (
+                                       const unsigned char* text,
+                                       S_block_t*           block
+                                       )
+   __attribute__ ((target("avx2")));
+#endif
+static BLOCK_INLINE void marks_add (
+                                   S_index_t*       index,
+                                   T_mask_t         bits,
+                                   const S_block_t* block,
+                                   unsigned int     offset,
+                                   unsigned int     lines
+                                   );
+static BLOCK_INLINE T_mask_t mask_strings (T_mask_t quotes);
+static BLOCK_INLINE void code_add (
+                                  S_index_t*       index,
+                                  const S_block_t* block,
+                                  T_mask_t         code,
+                                  T_mask_t         quotes,
+                                  unsigned int     from,
+                                  unsigned int     to,
+                                  unsigned int     offset,
+                                  unsigned int     lines
+                                  );
+static BLOCK_INLINE void block_index (
+                                     S_index_t*       index,
+                                     const S_block_t* block,
+                                     T_mask_t         valid,
+                                     int              next,
+                                     unsigned int     offset,
+                                     unsigned int     lines
+                                     );
+static void window_scalar (S_index_t* index, size_t end);
+#ifdef	INDEX_X86
+static void window_sse2 (S_index_t* index, size_t end);
+static void window_avx2 (S_index_t* index, size_t end)
+   __attribute__ ((target("avx2,popcnt,bmi")));
+#endif
+
+
+#ifndef	__GNUC__
+/*****************************************************************************
+ * Private Function mask_ctz
+ *****************************************************************************/
+
+static unsigned int mask_ctz (T_mask_t a_mask)
+   {
+   unsigned int n = 0;
+   while ((a_mask & 1) == 0)
+      {
+      a_mask >>= 1;
+      n++;
+      }
+   return n;
+   }
+
+
+/*****************************************************************************
+ * Private Function mask_pop
+ *****************************************************************************/
+
+static unsigned int mask_pop (T_mask_t a_mask)
+   {
+   unsigned int n = 0;
+   for ( ; a_mask != 0 ; a_mask &= a_mask - 1) n++;
+   return n;
+   }
+#endif
+
+
+/*****************************************************************************
+ * Private Function classify_scalar
+ *****************************************************************************/
+
+static BLOCK_INLINE void classify_scalar (
+                                         const unsigned char* a_text,
+                                         S_block_t*           a_block
+                                         )
+   {
+   T_mask_t bit = 1;
+   int      i;
+
+   (void)memset (a_block, 0, sizeof(S_block_t));
+
+   for (i = 0 ; i < 64 ; i++, bit <<= 1)
+      {
+      switch (a_text[i])
+         {
+         case '"':  a_block->quote   |= bit; break;
+         case '\\': a_block->escape  |= bit; break;
+         case '#':  a_block->hash    |= bit; break;
+         case '-':  a_block->dash    |= bit; break;
+         case '/':  a_block->slash   |= bit; break;
+         case '*':  a_block->star    |= bit; break;
+         case '\n': a_block->newline |= bit; /* fall through */
+         case ' ': case '\t': case '\f':
+            a_block->space |= bit;
+            break;
+         case '{': case '}': case '(': case ')': case '=': case ',': case ';':
+            a_block->structural |= bit;
+            break;
+         }
+      }
+   }
+
+
+#ifdef	INDEX_X86
+/*****************************************************************************
+ * Private Function classify_sse2
+ *****************************************************************************/
+
+#define	EQ16(v,c)	_mm_cmpeq_epi8 ((v), _mm_set1_epi8(c))
+#define	BITS16(x)	((T_mask_t)(unsigned int)_mm_movemask_epi8(x))
+
+static BLOCK_INLINE void classify_sse2 (
+                                       const unsigned char* a_text,
+                                       S_block_t*           a_block
+                                       )
+   {
+   __m128i v;
+   __m128i nl;
+   int     i;
+
+   (void)memset (a_block, 0, sizeof(S_block_t));
+
+   for (i = 0 ; i < 64 ; i += 16)
+      {
+      v  = _mm_loadu_si128 ((const __m128i*)(a_text + i));
+      nl = EQ16 (v, '\n');
+      a_block->quote   |= BITS16 (EQ16(v,'"'))  << i;
+      a_block->escape  |= BITS16 (EQ16(v,'\\')) << i;
+      a_block->newline |= BITS16 (nl)           << i;
+      a_block->hash    |= BITS16 (EQ16(v,'#'))  << i;
+      a_block->dash    |= BITS16 (EQ16(v,'-'))  << i;
+      a_block->slash   |= BITS16 (EQ16(v,'/'))  << i;
+      a_block->star    |= BITS16 (EQ16(v,'*'))  << i;
+      a_block->structural |= BITS16 (
+         _mm_or_si128 (
+            _mm_or_si128 (
+               _mm_or_si128 (EQ16(v,'{'), EQ16(v,'}')),
+               _mm_or_si128 (EQ16(v,'('), EQ16(v,')'))
+               ),
+            _mm_or_si128 (
+               _mm_or_si128 (EQ16(v,'='), EQ16(v,',')),
+               EQ16 (v, ';')
+               )
+            )
+         ) << i;
+      a_block->space |= BITS16 (
+         _mm_or_si128 (
+            _mm_or_si128 (EQ16(v,' '), EQ16(v,'\t')),
+            _mm_or_si128 (EQ16(v,'\f'), nl)
+            )
+         ) << i;
+      }
+   }
+
+
+/*****************************************************************************
+ * Private Function classify_avx2
+ *****************************************************************************/
+
+#define	EQ32(v,c)	_mm256_cmpeq_epi8 ((v), _mm256_set1_epi8(c))
+#define	BITS32(x)	((T_mask_t)(unsigned int)_mm256_movemask_epi8(x))
+
+static BLOCK_INLINE void classify_avx2 (
+                                       const unsigned char* a_text,
+                                       S_block_t*           a_block
+                                       )
+   {
+   __m256i v;
+   __m256i nl;
+   int     i;
+
+   (void)memset (a_block, 0, sizeof(S_block_t));
+
+   for (i = 0 ; i < 64 ; i += 32)
+      {
+      v  = _mm256_loadu_si256 ((const __m256i*)(a_text + i));
+      nl = EQ32 (v, '\n');
+      a_block->quote   |= BITS32 (EQ32(v,'"'))  << i;
+      a_block->escape  |= BITS32 (EQ32(v,'\\')) << i;
+      a_block->newline |= BITS32 (nl)           << i;
+      a_block->hash    |= BITS32 (EQ32(v,'#'))  << i;
+      a_block->dash    |= BITS32 (EQ32(v,'-'))  << i;
+      a_block->slash   |= BITS32 (EQ32(v,'/'))  << i;
+      a_block->star    |= BITS32 (EQ32(v,'*'))  << i;
+      a_block->structural |= BITS32 (
+         _mm256_or_si256 (
+            _mm256_or_si256 (
+               _mm256_or_si256 (EQ32(v,'{'), EQ32(v,'}')),
+               _mm256_or_si256 (EQ32(v,'('), EQ32(v,')'))
+               ),
+            _mm256_or_si256 (
+               _mm256_or_si256 (EQ32(v,'='), EQ32(v,',')),
+               EQ32 (v, ';')
+               )
+            )
+         ) << i;
+      a_block->space |= BITS32 (
+         _mm256_or_si256 (
+            _mm256_or_si256 (EQ32(v,' '), EQ32(v,'\t')),
+            _mm256_or_si256 (EQ32(v,'\f'), nl)
+            )
+         ) << i;
+      }
+   }
+#endif
+
+
+/*****************************************************************************
+ * Private Function marks_add
+ *****************************************************************************
+ *
+ * This function adds a mark for each bit in "a_bits", in order.
+ *
+ *****************************************************************************/
+
+static BLOCK_INLINE void marks_add (
+                                   S_index_t*       a_index,
+                                   T_mask_t         a_bits,
+                                   const S_block_t* a_block,
+                                   unsigned int     a_offset,
+                                   unsigned int     a_lines
+                                   )
+   {
+   S_mark_t*    mark = &a_index->marks[a_index->count];
+   unsigned int i;
+
+   for ( ; a_bits != 0 ; a_bits &= a_bits - 1, mark++)
+      {
+      i = MASK_CTZ (a_bits);
+      mark->offset = a_offset + i;
+      mark->lines  = a_lines;
+      if (a_block->newline & MASK_BELOW(i))
+         mark->lines += MASK_POP (a_block->newline & MASK_BELOW(i));
+      }
+
+   a_index->count = mark - a_index->marks;
+   }
+
+
+/*****************************************************************************
+ * Private Function mask_strings
+ *****************************************************************************
+ *
+ * This function returns the bits from each opening '"' up to its closing '"'
+ * for a mask of '"' that all open or close a string: bit n is the parity of
+ * the '"' at or before bit n.
+ *
+ *****************************************************************************/
+
+static BLOCK_INLINE T_mask_t mask_strings (T_mask_t a_quotes)
+   {
+   a_quotes ^= a_quotes << 1;
+   a_quotes ^= a_quotes << 2;
+   a_quotes ^= a_quotes << 4;
+   a_quotes ^= a_quotes << 8;
+   a_quotes ^= a_quotes << 16;
+   a_quotes ^= a_quotes << 32;
+   return a_quotes;
+   }
+
+
+/*****************************************************************************
+ * Private Function code_add
+ *****************************************************************************
+ *
+ * This function adds the marks for the code in a block from bit "a_from" up
+ * to bit "a_to"; "a_code" has the bits of the code that are not in a string
+ * and "a_quotes" has the bits of the '"' of the strings.  The marks are the
+ * structural characters, the '"' and the starts of runs of the other characters
+ * that are not whitespace.
+ *
+ *****************************************************************************/
+
+static BLOCK_INLINE void code_add (
+                                  S_index_t*       a_index,
+                                  const S_block_t* a_block,
+                                  T_mask_t         a_code,
+                                  T_mask_t         a_quotes,
+                                  unsigned int     a_from,
+                                  unsigned int     a_to,
+                                  unsigned int     a_offset,
+                                  unsigned int     a_lines
+                                  )
+   {
+   T_mask_t runs = a_code & ~(a_block->space | a_block->structural);
+   T_mask_t last = 0;
+
+   if ((a_from == 0) && (a_index->carry & CARRY_RUN)) last = 1;
+
+   marks_add (
+             a_index,
+             (a_code & a_block->structural) | a_quotes |
+             (runs & ~((runs << 1) | last)),
+             a_block,
+             a_offset,
+             a_lines
+             );
+
+   a_index->carry &= ~CARRY_RUN;
+   if ((a_to == 64) && (runs >> 63)) a_index->carry |= CARRY_RUN;
+   }
+
+
+/*****************************************************************************
+ * Private Function block_index
+ *****************************************************************************
+ *
+ * This function adds the marks for a classified block; "a_valid" has the bits
+ * of the block that are in the input, and "a_next" is the character after the
+ * block, to see the second character of a comment delimiter.
+ *
+ * In code, every '"' opens or closes a string unless one of them is right after
+ * a '\', so the strings up to the first comment are found all at once; a block
+ * with a '\' before a '"' is done one string at a time.
+ *
+ *****************************************************************************/
+
+static BLOCK_INLINE void block_index (
+                                     S_index_t*       a_index,
+                                     const S_block_t* a_block,
+                                     T_mask_t         a_valid,
+                                     int              a_next,
+                                     unsigned int     a_offset,
+                                     unsigned int     a_lines
+                                     )
+   {
+   T_mask_t     escaped;
+   T_mask_t     dashes;
+   T_mask_t     slashes;
+   T_mask_t     opens;
+   T_mask_t     closes;
+   T_mask_t     quotes;
+   T_mask_t     strings;
+   T_mask_t     ends;
+   T_mask_t     bits;
+   unsigned int pos = a_index->skip;
+   unsigned int i;
+
+   /*
+    * The '"' right after a '\', and the first character of each two character
+    * comment delimiter.
+    */
+   escaped = (a_block->escape << 1) | (a_index->carry & CARRY_ESCAPE ? 1 : 0);
+   escaped &= a_block->quote;
+   dashes  = a_block->dash  & ((a_block->dash  >> 1) | MASK_TOP(a_next=='-'));
+   slashes = a_block->slash & ((a_block->slash >> 1) | MASK_TOP(a_next=='/'));
+   opens   = a_block->slash & ((a_block->star  >> 1) | MASK_TOP(a_next=='*'));
+   closes  = a_block->star  & ((a_block->slash >> 1) | MASK_TOP(a_next=='/'));
+
+   while (pos < 64)
+      {
+      switch (a_index->state)
+         {
+         case STATE_CODE:
+            bits   = MASK_FROM(pos) & a_valid;
+            quotes = a_block->quote & bits;
+            if ((quotes & escaped) == 0)
+               {
+               strings = mask_strings (quotes);
+               ends    = a_block->hash | dashes | slashes | opens;
+               ends   &= bits & ~strings;
+               i       = ends == 0 ? 64 : MASK_CTZ (ends);
+               if (i < 64) bits &= MASK_BELOW (i);
+               code_add (
+                        a_index,
+                        a_block,
+                        bits & ~(strings | quotes),
+                        bits & quotes,
+                        pos,
+                        i,
+                        a_offset,
+                        a_lines
+                        );
+               if (i == 64)
+                  {
+                  if (strings >> 63) a_index->state = STATE_STRING;
+                  pos = 64;
+                  break;
+                  }
+               }
+            else
+               {
+               ends = quotes | a_block->hash | dashes | slashes | opens;
+               ends &= bits;
+               i    = MASK_CTZ (ends);
+               code_add (
+                        a_index,
+                        a_block,
+                        bits & MASK_BELOW(i),
+                        0,
+                        pos,
+                        i,
+                        a_offset,
+                        a_lines
+                        );
+               if (quotes & (ends & -ends))
+                  {
+                  marks_add (a_index, ends & -ends, a_block, a_offset, a_lines);
+                  a_index->state = STATE_STRING;
+                  pos = i + 1;
+                  break;
+                  }
+               }
+            bits = (T_mask_t)1 << i;
+            a_index->comment = a_index->base + a_offset + i;
+            if (a_block->hash & bits)
+               {
+               a_index->state = STATE_LINE;
+               pos = i + 1;
+               }
+            else if ((dashes | slashes) & bits)
+               {
+               a_index->state = STATE_LINE;
+               pos = i + 2;
+               }
+            else
+               {
+               a_index->state = STATE_BLOCK;
+               a_index->nest  = 1;
+               pos = i + 2;
+               }
+            break;
+
+         case STATE_STRING:
+            ends = a_block->quote & ~escaped & MASK_FROM(pos);
+            if (ends == 0)
+               {
+               pos = 64;
+               break;
+               }
+            i = MASK_CTZ (ends);
+            marks_add (a_index, ends & -ends, a_block, a_offset, a_lines);
+            a_index->state = STATE_CODE;
+            pos = i + 1;
+            break;
+
+         case STATE_LINE:
+            ends = a_block->newline & MASK_FROM(pos);
+            if (ends == 0)
+               {
+               pos = 64;
+               break;
+               }
+            a_index->state = STATE_CODE;
+            pos = MASK_CTZ (ends);
+            break;
+
+         case STATE_BLOCK:
+            bits = (opens | closes) & MASK_FROM(pos);
+            if (bits == 0)
+               {
+               pos = 64;
+               break;
+               }
+            i = MASK_CTZ (bits);
+            if (opens & (bits & -bits))
+               a_index->nest++;
+            else if (--a_index->nest == 0)
+               a_index->state = STATE_CODE;
+            pos = i + 2;
+            break;
+         }
+      }
+
+   a_index->skip = pos - 64;
+
+   a_index->carry &= ~CARRY_ESCAPE;
+   if (a_block->escape >> 63) a_index->carry |= CARRY_ESCAPE;
+   }
+
+
+/*****************************************************************************
+ * Private Functions window_scalar, window_sse2 and window_avx2
+ *****************************************************************************
+ *
+ * These functions index the window of the input up to "a_end", one block at
+ * a time.  They are the same function, made by WINDOW_INDEX with a different
+ * classify function, so that the compiler can inline each classify function
+ * and use the instructions of its processor for the whole window.
+ *
+ *****************************************************************************/
+
+#define	WINDOW_INDEX(a_name,a_classify)					\
+static void a_name (S_index_t* a_index, size_t a_end)			\
+   {									\
+   unsigned char tail[64];						\
+   S_block_t     block;							\
+   size_t        offset;						\
+   unsigned int  lines = 0;						\
+									\
+   for (offset = a_index->base ; offset < a_end ; offset += 64)		\
+      {									\
+      const unsigned char* text = (const unsigned char*)a_index->text	\
+                                + offset;				\
+      T_mask_t             valid = MASK_ALL;				\
+      int                  next  = '\0';				\
+									\
+      if (a_end - offset >= 64)						\
+         {								\
+         next = text[64]; /* This can be the '\0' after the input. */	\
+         }								\
+      else								\
+         {								\
+         (void)memset (tail, 0, sizeof(tail));				\
+         (void)memcpy (tail, text, a_end - offset);			\
+         valid = MASK_BELOW (a_end - offset);				\
+         text  = tail;							\
+         }								\
+									\
+      a_classify (text, &block);					\
+      block_index (							\
+                  a_index,						\
+                  &block,						\
+                  valid,						\
+                  next,							\
+                  (unsigned int)(offset - a_index->base),		\
+                  lines							\
+                  );							\
+      lines += MASK_POP (block.newline & valid);			\
+      }									\
+									\
+   a_index->total += lines;						\
+   }
+
+WINDOW_INDEX (window_scalar, classify_scalar)
+#ifdef	INDEX_X86
+WINDOW_INDEX (window_sse2, classify_sse2)
+WINDOW_INDEX (window_avx2, classify_avx2)
+#endif
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      E x e c u t a b l e   C o d e   (External Interface Functions)       */
+/*                                                                           */
+/* ************************************************************************* */
+
+
+/*****************************************************************************
+ * Public Function cfi_index_init
+ *****************************************************************************/
+
+const char* (cfi_index_init) (S_index_t* a_index)
+   {
+   (void)memset (a_index, 0, sizeof(S_index_t));
+
+   a_index->marks = (S_mark_t*)_cfi_malloc (
+                                           CFI_INDEX_WINDOW * sizeof(S_mark_t)
+                                           );
+   if (a_index->marks == NULL) return "can't allocate memory";
+
+   a_index->window = window_scalar;
+#ifdef	INDEX_X86
+   a_index->window = window_sse2;
+   __builtin_cpu_init ();
+   if (__builtin_cpu_supports("avx2") &&
+       __builtin_cpu_supports("popcnt") &&
+       __builtin_cpu_supports("bmi"))
+      {
+      a_index->window = window_avx2;
+      }
+#endif
+
+   return NULL;
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_index_done
+ *****************************************************************************/
+
+void (cfi_index_done) (S_index_t* a_index)
+   {
+   _cfi_free (a_index->marks);
+   a_index->marks = NULL;
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_index_start
+ *****************************************************************************/
+
+void (cfi_index_start) (S_index_t* a_index, const char* a_text, size_t a_leng)
+   {
+   a_index->text  = a_text;
+   a_index->leng  = a_leng;
+   a_index->base  = 0;
+   a_index->done  = 0;
+   a_index->lines = 0;
+   a_index->total = 0;
+   a_index->count = 0;
+   a_index->state   = STATE_CODE;
+   a_index->comment = 0;
+   a_index->nest    = 0;
+   a_index->skip  = 0;
+   a_index->carry = 0;
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_index_next
+ *****************************************************************************
+ *
+ * This function indexes the next window of the input that has any marks, and
+ * returns the number of marks; zero means the end of the input, and then the
+ * "total" member is the number of newlines in the input.
+ *
+ *****************************************************************************/
+
+size_t (cfi_index_next) (S_index_t* a_index)
+   {
+   size_t end;
+
+   a_index->count = 0;
+
+   while ((a_index->count == 0) && (a_index->done < a_index->leng))
+      {
+      a_index->base  = a_index->done;
+      a_index->lines = a_index->total;
+      end = a_index->base + CFI_INDEX_WINDOW;
+      if (end > a_index->leng) end = a_index->leng;
+      (*a_index->window) (a_index, end);
+      a_index->done = end;
+      }
+
+   return a_index->count;
+   }
+
+
+/* end of file */
@@ -0,0 +1,131 @@
+/*
+ * This file is part of the CFI software.
+ * The license which this software falls under is as follows:
+ *
+ * Copyright (C) 1999-2005 Douglas Jerome <douglas@ttylinux.org>
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+/* *****************************************************************************
+
+FILE NAME
+
+	Name:     index.h
+	Revision: 1.0
+
+PROGRAM INFORMATION
+
+	Developed by:	CFI project
+
+FILE DESCRIPTION
+
+	Configuration File Interface:
+
+	This file exports the interface to the structural index, the first
+	stage of the hand written lexical analyzer in "scan.c".
+
+	The index is built one window of the input at a time.  Each mark in
+	the window is the offset of a structural character "{}()=,;", of a
+	string's opening or closing '"', or of the start of a run of other
+	characters that are not whitespace; string interiors and comments
+	have no marks.  Each mark also has the count of newlines before it
+	in the window, so the lexical analyzer never looks at a newline.
+
+***************************************************************************** */
+
+
+#ifndef CFI_INDEX_H
+#define CFI_INDEX_H 1
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      I n c l u d e d   F i l e s                                          */
+/*                                                                           */
+/* ************************************************************************* */
+
+#include	<stddef.h>
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      M a n i f e s t   C o n s t a n t s                                  */
+/*                                                                           */
+/* ************************************************************************* */
+
+#define	CFI_INDEX_WINDOW	(16384) /* bytes indexed at a time; 64n */
+
+/*
+ * The state of the index between blocks; the input ends in a line comment if
+ * the state is STATE_LINE after the last window, and then "comment" is where
+ * the comment starts.
+ */
+#define	STATE_CODE	(0)
+#define	STATE_STRING	(1)
+#define	STATE_LINE	(2) /* in a "#", "--" or "//" comment */
+#define	STATE_BLOCK	(3) /* in a nested block comment      */
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      D a t a   T y p e s   a n d   S t r u c t u r e s                    */
+/*                                                                           */
+/* ************************************************************************* */
+
+typedef struct S_mark_t
+   {
+   unsigned int offset; /* offset of the marked character in the window */
+   unsigned int lines;  /* newlines in the window before the character  */
+   }
+   S_mark_t;
+
+typedef struct S_index_t
+   {
+   const char*   text;     /* the input text, with a '\0' after it     */
+   size_t        leng;     /* length of the input text                 */
+   size_t        base;     /* offset of the window that was indexed    */
+   size_t        done;     /* offset of the next window to index       */
+   unsigned long lines;    /* newlines before the window               */
+   unsigned long total;    /* newlines before the next window          */
+   size_t        count;    /* marks in the window                      */
+   S_mark_t*     marks;    /* CFI_INDEX_WINDOW marks                   */
+   void          (*window) (struct S_index_t* index, size_t end);
+   int           state;    /* code, string or comment, between windows */
+   size_t        comment;  /* offset of the line comment of the state  */
+   long          nest;     /* block comment nesting level              */
+   unsigned int  skip;     /* characters of the next block to skip     */
+   unsigned int  carry;    /* the last character was a run, or '\\'     */
+   }
+   S_index_t;
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      F u n c t i o n   P r o t o t y p e s                                */
+/*                                                                           */
+/* ************************************************************************* */
+
+extern const char* cfi_index_init (S_index_t* index);
+extern void cfi_index_done (S_index_t* index);
+extern void cfi_index_start (S_index_t* index, const char* text, size_t leng);
+extern size_t cfi_index_next (S_index_t* index);
+
+
+#endif
+
+
+/* end of file */
@@ -111,13 +111,13 @@ CHANGE LOG
 #   include	<fcntl.h>
 #   include	<sys/types.h>
 #   include	<sys/stat.h>
+#   include	<sys/mman.h>
 #endif
 
 /*
  * Project Specific Header Files
  */
 #include	"CFI.h"
-#include	"symbol.h"
 #include	"parse.h"
 
 
@@ -177,8 +177,42 @@ CHANGE LOG
  * Private Function Prototypes
  *****************************************************************************/
 
+static void text_fprint (FILE* ostream, const char* text, size_t leng);
 static const char* attr_fprint (FILE* ostream, CFI_attr_t attr);
 static const char* node_fprint (FILE* ostream, CFI_node_t node, int a_indent);
+#ifdef	_unix
+static char* file_map (int fd, size_t size, size_t* mapSize);
+#endif
+static void buffer_free (char* buff, size_t mapSize);
+
+
+/*****************************************************************************
+ * Private Function text_fprint
+ *****************************************************************************
+ *
+ * This function prints the text of a word or string as it is written in a
+ * document, a piece at a time through a buffer on the stack.
+ *
+ *****************************************************************************/
+
+static void text_fprint (FILE* a_ostream, const char* a_text, size_t a_leng)
+   {
+   char   buff[4*64];
+   size_t piece;
+
+   while (a_leng > 0)
+      {
+      piece = a_leng < 64 ? a_leng : 64;
+      (void)fwrite (
+                   buff,
+                   1,
+                   _cfi_string_escape (a_text, piece, buff),
+                   a_ostream
+                   );
+      a_text += piece;
+      a_leng -= piece;
+      }
+   }
 
 
 /*****************************************************************************
@@ -187,7 +221,9 @@ static const char* node_fprint (FILE* ostream, CFI_node_t node, int a_indent);
 
 static const char* attr_fprint (FILE* a_ostream, CFI_attr_t a_attr)
    {
-   char buff[(sizeof(long)*8)+4];
+   char        buff[(sizeof(long)*8)+4];
+   const char* text;
+   size_t      leng;
 
    if (a_attr == NULL)
       {
@@ -204,14 +240,16 @@ static const char* attr_fprint (FILE* a_ostream, CFI_attr_t a_attr)
          }
       case CFI_WORD_ATTRIBUTE:
          {
-         fprintf (a_ostream, "%s", cfi_attribute_word_get(a_attr));
+         text = cfi_attribute_word_peek (a_attr, &leng);
+         text_fprint (a_ostream, text, leng);
          break;
          }
       case CFI_STRING_ATTRIBUTE:
          {
-         char* s = cfi_attribute_string_get (a_attr);
-         fprintf (a_ostream, "\"%s\"", s);
-         free (s);
+         text = cfi_attribute_string_peek (a_attr, &leng);
+         fputc ('"', a_ostream);
+         text_fprint (a_ostream, text, leng);
+         fputc ('"', a_ostream);
          break;
          }
       case CFI_REAL_ATTRIBUTE:
@@ -257,6 +295,76 @@ static const char* attr_fprint (FILE* a_ostream, CFI_attr_t a_attr)
    }
 
 
+#ifdef	_unix
+/*****************************************************************************
+ * Private Function file_map
+ *****************************************************************************
+ *
+ * This function maps a regular file of "a_size" bytes into memory so that the
+ * lexical analyzer can work directly on the mapped pages.  The lexical
+ * analyzer needs two '\0' bytes after the input; the part of the last page
+ * that is past the end of the file reads as zeros, so the file is mapped only
+ * if there are at least two such bytes.  The hand written lexical analyzer
+ * never writes into its input, so the mapping is read only and its pages are
+ * the page cache's.  flex writes into its input buffer, so for it the mapping
+ * is private and writable, and each page that flex writes to is copied; then
+ * the mapping saves the read() of the file, but not much memory.
+ *
+ * Return Value
+ *
+ *     NULL     - The file cannot be mapped; read it instead.
+ *
+ *     non-NULL - The address of the mapped file; "*a_mapSize" is set to the
+ *                size to give to munmap().
+ *
+ *****************************************************************************/
+
+static char* file_map (int a_fd, size_t a_size, size_t* a_mapSize)
+   {
+   long  pageSize = sysconf (_SC_PAGESIZE);
+   int   prot     = PROT_READ;
+   void* base;
+
+   if ((pageSize <= 0) || (a_size == 0)) return NULL;
+   if ((a_size % pageSize) == 0) return NULL;
+   if ((a_size % pageSize) > (size_t)(pageSize - 2)) return NULL;
+
+   if (!cfi_lex_bounded()) prot |= PROT_WRITE;
+
+   base = mmap (NULL, a_size+2, prot, MAP_PRIVATE, a_fd, 0);
+   if (base == MAP_FAILED) return NULL;
+
+   (void)posix_madvise (base, a_size+2, POSIX_MADV_SEQUENTIAL);
+
+   *a_mapSize = a_size + 2;
+
+   return (char*)base;
+   }
+#endif
+
+
+/*****************************************************************************
+ * Private Function buffer_free
+ *****************************************************************************
+ *
+ * This function unmaps a buffer that file_map() mapped, or frees a buffer
+ * that was dynamically allocated if "a_mapSize" is zero.
+ *
+ *****************************************************************************/
+
+static void buffer_free (char* a_buff, size_t a_mapSize)
+   {
+#ifdef	_unix
+   if (a_mapSize != 0)
+      {
+      (void)munmap (a_buff, a_mapSize);
+      return;
+      }
+#endif
+   _cfi_free (a_buff);
+   }
+
+
 /*****************************************************************************
  * Private Function node_fprint
  *****************************************************************************/
@@ -369,6 +477,31 @@ static const char* node_fprint (
 
 const char* (cfi_get) (int a_fd, CFI_node_t* const a_node)
    {
+   CFI_parser_t parser;
+   const char*  msg;
+
+   msg = cfi_parser_new (&parser);
+   if (msg != NULL) return msg;
+
+   msg = cfi_parser_get (parser, a_fd, a_node);
+   if (msg == parser->message) msg = "syntax error"; /* The text goes away. */
+
+   (void)cfi_parser_del (&parser);
+
+   return msg;
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_parser_get
+ *****************************************************************************/
+
+const char* (cfi_parser_get) (
+                             CFI_parser_t const a_parser,
+                             int                a_fd,
+                             CFI_node_t*  const a_node
+                             )
+   {
 
 #ifdef	_unix
    {
@@ -382,24 +515,36 @@ const char* (cfi_get) (int a_fd, CFI_node_t* const a_node)
    if (fstatBuff.st_mode & S_IFREG)
       {
       /*
-       * The input is a file; try reading the entire file into a dynamically
-       * allocated "char" buffer.
+       * The input is a file; try mapping the file into memory and parse it in
+       * place, or else try reading the entire file into a dynamically
+       * allocated "char" buffer.  Either way, the buffer ends with the two
+       * '\0' bytes that the lexical analyzer wants, and it is not copied
+       * again.
        */
-      char* buff = (char*)calloc (1, fstatBuff.st_size+32);
-      int   size;
+      size_t leng = (size_t)fstatBuff.st_size;
+      size_t mapSize;
+      char*  buff;
+      int    size;
+      buff = file_map (a_fd, leng, &mapSize);
+      if (buff != NULL)
+         {
+         *a_node = cfi_parse_source (a_parser, buff, leng, mapSize);
+         return a_parser->errors == 0 ? NULL : a_parser->message;
+         }
+      buff = (char*)_cfi_malloc (leng+2);
       if (buff == NULL)
          {
          return "memory allocation error";
          }
-      size = read (a_fd, buff, fstatBuff.st_size);
+      size = read (a_fd, buff, leng);
       if (size == fstatBuff.st_size)
          {
-         buff[fstatBuff.st_size] = '\0';
-         *a_node = cfi_parse_text (buff); /* Load the data from the file. */
-         free (buff);
-         return NULL; /* Assumes success. */
+         buff[leng]   = '\0';
+         buff[leng+1] = '\0';
+         *a_node = cfi_parse_source (a_parser, buff, leng, 0);
+         return a_parser->errors == 0 ? NULL : a_parser->message;
          }
-      free (buff);
+      _cfi_free (buff);
       /*
        * At this point, read() didn't successfully read the entire file, so
        * try to lseek() back to the begining of the file.
@@ -422,10 +567,149 @@ const char* (cfi_get) (int a_fd, CFI_node_t* const a_node)
       {
       return "can't create input stream";
       }
-   *a_node = cfi_parse_file (istream);
+   *a_node = cfi_parse_file (a_parser, istream);
+   }
+
+   return a_parser->errors == 0 ? NULL : a_parser->message;
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_parse_events
+ *****************************************************************************/
+
+const char* (cfi_parse_events) (
+                                int                       a_fd,
+                                const CFI_events_t* const a_events,
+                                void*                     a_user
+                                )
+   {
+   CFI_parser_t parser;
+   const char*  msg;
+
+   msg = cfi_parser_new (&parser);
+   if (msg != NULL) return msg;
+
+   msg = cfi_parser_events (parser, a_fd, a_events, a_user);
+   if (msg == parser->message) msg = "syntax error"; /* The text goes away. */
+
+   (void)cfi_parser_del (&parser);
+
+   return msg;
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_parse_events_text
+ *****************************************************************************/
+
+const char* (cfi_parse_events_text) (
+                                     const char*               a_text,
+                                     const CFI_events_t* const a_events,
+                                     void*                     a_user
+                                     )
+   {
+   CFI_parser_t parser;
+   const char*  msg;
+
+   msg = cfi_parser_new (&parser);
+   if (msg != NULL) return msg;
+
+   parser->events = a_events;
+   parser->user   = a_user;
+   (void)cfi_parse_text (parser, a_text);
+   msg = parser->errors == 0 ? NULL : "syntax error";
+
+   (void)cfi_parser_del (&parser);
+
+   return msg;
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_parser_events
+ *****************************************************************************
+ *
+ * This function is cfi_parser_get() with event functions instead of nodes.
+ * A regular file is mapped into memory and parsed in place, so a file of any
+ * size is parsed with only as much dynamically allocated memory as its
+ * longest attribute list needs.
+ *
+ *****************************************************************************/
+
+const char* (cfi_parser_events) (
+                                CFI_parser_t        const a_parser,
+                                int                       a_fd,
+                                const CFI_events_t* const a_events,
+                                void*                     a_user
+                                )
+   {
+   CFI_node_t  node = NULL;
+   const char* msg;
+
+   a_parser->events = a_events;
+   a_parser->user   = a_user;
+   msg = cfi_parser_get (a_parser, a_fd, &node);
+   a_parser->events = NULL;
+   a_parser->user   = NULL;
+
+   return msg;
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_parse_source
+ *****************************************************************************
+ *
+ * This function parses a buffer in place, as cfi_parse_buffer() does, and
+ * then unmaps the buffer, if "a_mapSize" is not zero, or frees it.  A lazy
+ * parse may leave section bodies in the buffer to be parsed later, and then
+ * the buffer is kept until the last of them is parsed or deleted.
+ *
+ *****************************************************************************/
+
+CFI_node_t (cfi_parse_source) (
+                              CFI_parser_t a_parser,
+                              char*        a_buff,
+                              size_t       a_leng,
+                              size_t       a_mapSize
+                              )
+   {
+   S_source_t* source = NULL;
+   CFI_node_t  node;
+
+   if (a_parser->lazy) source = (S_source_t*)_cfi_malloc (sizeof(S_source_t));
+   if (source == NULL)
+      {
+      node = cfi_parse_buffer (a_parser, a_buff, a_leng);
+      buffer_free (a_buff, a_mapSize);
+      return node;
+      }
+
+   source->text    = a_buff;
+   source->leng    = a_leng;
+   source->mapSize = a_mapSize;
+   source->refs    = 1;
+
+   a_parser->source = source;
+   node = cfi_parse_buffer (a_parser, a_buff, a_leng);
+   a_parser->source = NULL;
+   cfi_source_release (source);
+
+   return node;
    }
 
-   return NULL; /* Assumes success. */
+
+/*****************************************************************************
+ * Public Function cfi_source_release
+ *****************************************************************************/
+
+void (cfi_source_release) (S_source_t* a_source)
+   {
+   if (--a_source->refs > 0) return;
+
+   buffer_free (a_source->text, a_source->mapSize);
+   _cfi_free (a_source);
    }
 
 
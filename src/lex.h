@@ -72,6 +72,7 @@ extern	"C"	{
 /* ************************************************************************* */
 
 #include	<stdio.h>
+#include	"CFI.h"
 
 
 /* ************************************************************************* */
@@ -107,11 +108,48 @@ typedef void (*CFI_yyerrorfn_t)(int lineNum, char* message, char* offending);
 /*                                                                           */
 /* ************************************************************************* */
 
-extern int  yylex (void);
-extern void yyerror (char* s);
-
-extern void cfi_lex_init (FILE* file, CFI_yyerrorfn_t errorfn);
-extern void cfi_lex_done (void);
+/*
+ * This interface is implemented by the flex scanner in "lex.l" or by the hand
+ * written scanner in "scan.c"; the make option SCANNER=hand selects "scan.c".
+ * Both give the parser the same tokens.
+ *
+ * cfi_lex_skip() is called right after a '{' token; it skips the section body
+ * up to and including the matching '}', and gives the body as a pointer into
+ * the input and a length.  It returns -1 if the body doesn't end.
+ *
+ * cfi_lex_split() scans a buffer on its own, and cuts it into at most "count"
+ * parts of about the same size, each of which is a list of whole top level
+ * items; the end of each part is put in "cuts", and the number of parts is
+ * returned.  A part can be parsed by itself.
+ *
+ * cfi_lex_offset() gives the offset of the current token from the start of
+ * the input, for the source spans of the nodes.
+ *
+ * cfi_lex_bounded() tells whether the lexical analyzer stops at the end of
+ * its input by itself and never writes into its input.  Then the input need
+ * not have the two '\0' bytes after it, so long as the character after it
+ * ends any token, as the ';' or '}' at a cut of cfi_lex_split() or the '}'
+ * after a section body does; otherwise the input has to be writable and end
+ * with two '\0' bytes.
+ */
+extern int  cfi_lex (void* lval, CFI_parser_t parser);
+extern void cfi_lex_error (CFI_parser_t parser, const char* message);
+extern int  cfi_lex_skip (CFI_parser_t parser, const char** body, size_t* leng);
+extern int  cfi_lex_split (
+                          CFI_parser_t parser,
+                          char*        buff,
+                          size_t       leng,
+                          size_t*      cuts,
+                          int          count
+                          );
+extern size_t cfi_lex_offset (CFI_parser_t parser);
+extern int    cfi_lex_bounded (void);
+
+extern const char* cfi_lex_init (CFI_parser_t parser);
+extern void cfi_lex_done (CFI_parser_t parser);
+extern void cfi_lex_text (CFI_parser_t parser, const char* text);
+extern void cfi_lex_buffer (CFI_parser_t parser, char* buff, size_t leng);
+extern void cfi_lex_end (CFI_parser_t parser);
 
 
 #ifdef	__cplusplus
@@ -0,0 +1,148 @@
+/*
+ * This file is part of the CFI software.
+ * The license which this software falls under is as follows:
+ *
+ * Copyright (C) 1999-2005 Douglas Jerome <douglas@ttylinux.org>
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+/* *****************************************************************************
+
+FILE NAME
+
+	Name:     live.h
+	Revision: 1.0
+
+PROGRAM INFORMATION
+
+	Developed by:	CFI project
+
+FILE DESCRIPTION
+
+	Configuration File Interface:
+
+	This file exports the interface to the counts of the live memory of
+	libcfi, that cfi_memory_live() gives.
+
+	Each thread counts the live memory in a tally of its own, so an
+	allocation costs no atomic add to a count that all of the threads
+	share; the tallies are added up by cfi_memory_live().  Without
+	threads, _cfi_live is the one tally.
+
+***************************************************************************** */
+
+
+#ifndef CFI_LIVE_H
+#define CFI_LIVE_H 1
+
+
+#ifdef	__cplusplus
+extern	"C"	{
+#endif
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      I n c l u d e d   F i l e s                                          */
+/*                                                                           */
+/* ************************************************************************* */
+
+#include	"CFI.h"
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      M a n i f e s t   C o n s t a n t s                                  */
+/*                                                                           */
+/* ************************************************************************* */
+
+/*
+ * CFI_LIVE_ADD() and CFI_LIVE_SUB() change a count of the tally of the
+ * thread, which is made the first time the thread counts anything.  Only the
+ * thread writes its tally, but cfi_memory_live() reads it from another one,
+ * so the counts are read and written with relaxed atomic loads and stores:
+ * an add is still no locked instruction, and a count is never read torn.
+ */
+#if	defined(_unix) && defined(__GNUC__)
+#   define	CFI_LIVE_THREADS	1
+#   define	CFI_LIVE_TALLY()	\
+	(_cfi_tally != NULL ? _cfi_tally : _cfi_tally_new())
+#   define	CFI_LIVE_GET(p)		__atomic_load_n (p, __ATOMIC_RELAXED)
+#   define	CFI_LIVE_PUT(p,n)	__atomic_store_n (p, n, __ATOMIC_RELAXED)
+#else
+#   define	CFI_LIVE_THREADS	0
+#   define	CFI_LIVE_TALLY()	(&_cfi_live)
+#   define	CFI_LIVE_GET(p)		(*(p))
+#   define	CFI_LIVE_PUT(p,n)	(*(p) = (n))
+#endif
+#define	CFI_LIVE_ADD(field,n)	\
+	cfi_live_move (&CFI_LIVE_TALLY()->field, (size_t)(n))
+#define	CFI_LIVE_SUB(field,n)	\
+	cfi_live_move (&CFI_LIVE_TALLY()->field, -(size_t)(n))
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      F u n c t i o n   P r o t o t y p e s                                */
+/*                                                                           */
+/* ************************************************************************* */
+
+extern CFI_live_t _cfi_live;
+
+#if	CFI_LIVE_THREADS
+extern __thread CFI_live_t* _cfi_tally;
+extern CFI_live_t* _cfi_tally_new (void);
+#endif
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      I n l i n e   F u n c t i o n s                                      */
+/*                                                                           */
+/* ************************************************************************* */
+
+/*****************************************************************************
+ * Inline Function Prototypes
+ *****************************************************************************/
+
+static __inline__ void cfi_live_move (size_t* count, size_t n);
+
+
+/*****************************************************************************
+ * Inline Function cfi_live_move
+ *****************************************************************************
+ *
+ * This function adds "a_n" to a count of the tally of the thread, or takes
+ * it away if it is the negative.
+ *
+ *****************************************************************************/
+
+static __inline__ void cfi_live_move (size_t* a_count, size_t a_n)
+   {
+   CFI_LIVE_PUT (a_count, CFI_LIVE_GET(a_count) + a_n);
+   }
+
+
+#ifdef	__cplusplus
+}
+#endif
+
+
+#endif
+
+
+/* end of file */
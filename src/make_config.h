@@ -0,0 +1,24 @@
+/*
+ * This file is generated by Makefile.src
+ * Edits to this file will be lost.
+ */
+
+#ifndef _MAKE_CONFIG_H
+#define _MAKE_CONFIG_H 1
+
+static const char* const LIBCFI_COPYRIGHT = "Copyright (C) 2005-2015 Douglas Jerome <douglas@ttylinux.org>";
+static const char* const LIBCFI_TIMESTAMP = __TIME__ ", " __DATE__;
+static const char* const LIBCFI_REVISION  = "vers. 1.1";
+
+#define CLIENT_CFLAGS   "-I/usr/local/include/cfi-1"
+#define CLIENT_SHARLIBS "-L/usr/local/lib -Wl,-rpath,/usr/local/lib -lcfi -lc -lpthread"
+#define CLIENT_STATLIBS "-L/usr/local/lib -lcfi -lc -lpthread"
+
+#define MAKE_INSTALLDIR "/usr/local"
+#define MAKE_BINDIR     "/usr/local/bin"
+#define MAKE_INCLUDEDIR "/usr/local/include/cfi-1"
+#define MAKE_LIBDIR     "/usr/local/lib"
+#define MAKE_LIBEXECDIR "/usr/local/libexec"
+#define MAKE_SHAREDIR   "/usr/local/share/cfi-1"
+
+#endif
@@ -0,0 +1,813 @@
+/*
+ * This file is part of the CFI software.
+ * The license which this software falls under is as follows:
+ *
+ * Copyright (C) 1999-2005 Douglas Jerome <douglas@ttylinux.org>
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+/* *****************************************************************************
+
+FILE NAME
+
+	Name:     number.c
+	Revision: 1.0
+
+PROGRAM INFORMATION
+
+	Developed by:	CFI project
+
+FILE DESCRIPTION
+
+	Configuration File Interface: Number Conversion
+
+	These functions convert the text of the CFI number tokens to values,
+	for both lexical analyzers.  They don't use the C library, so they
+	don't depend on the locale and they allocate nothing; a number that
+	doesn't fit is an error, not a wrapped or clamped value.
+
+	A hex, octal or binary number is a bit pattern of up to 32 bits, so
+	0xFFFFFFFF is -1; a decimal number must be in the range of int32_t.
+
+	A real number is rounded correctly, to the nearest double and to the
+	even one on a tie.  Most real numbers in configuration files have at
+	most 19 significant digits and a small exponent, and those are done
+	with one exact floating point multiply or divide; the others are done
+	exactly with big integers on the stack, which is slower but rare.  A
+	real number that is too big for a double is an error; one too small
+	becomes zero, or a denormal.
+
+***************************************************************************** */
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      F e a t u r e   S w i t c h e s                                      */
+/*                                                                           */
+/* ************************************************************************* */
+
+/*
+ * Select these feature by moving them from the `if UNDEF' into the `else'
+ * section.
+ */
+#ifdef	UNDEF
+#   define	_BSD_SOURCE	1	/* 4.3+bsd subsystems           */
+#   define	_POSIX_SOURCE	1	/* posix.1                      */
+#   define	_POSIX_C_SOURCE	199309L	/* posix.1 and posix.4          */
+#   define	_POSIX_C_SOURCE	199506L	/* posix.1 and posix.4 and MORE */
+#else
+#   define	_POSIX_C_SOURCE	200112L	/* posix.1 and posix.4 and MORE */
+#   undef	_REENTRANT
+#   define	_REENTRANT		/* thread-safe for glibc        */
+#endif
+
+/*
+ * The quick conversion of a real number needs double arithmetic that rounds
+ * to double, not to the x87 80 bit registers.
+ */
+#if	!defined(__FLT_EVAL_METHOD__) || (__FLT_EVAL_METHOD__ == 0)
+#   define	REAL_QUICK	1
+#endif
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      I n c l u d e d   F i l e s                                          */
+/*                                                                           */
+/* ************************************************************************* */
+
+/*
+ * OS Specific Header Files
+ */
+#ifdef	WIN32
+#   include	"stdafx.h"
+#endif
+
+/*
+ * Standard C (ANSI) Header Files
+ */
+#include	<stdlib.h>
+#include	<string.h>
+
+/*
+ * Posix Header Files
+ */
+#ifndef	WIN32
+#   include	<unistd.h> /* always first amongst POSIX header files */
+#endif
+
+/*
+ * Project Specific Header Files
+ */
+#include	"CFI.h"
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      C o n s t a n t s                                                    */
+/*                                                                           */
+/* ************************************************************************* */
+
+#define	REAL_DIGITS	(800)    /* digits kept exactly; a double needs 767 */
+#define	REAL_LIMBS	(128)    /* 32 bit limbs of a big integer           */
+#define	REAL_EXPONENT	(100000) /* exponents past this are all the same    */
+
+#define	MSG_RANGE	"number out of range"
+#define	MSG_NUMBER	"not a number"
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      D a t a   T y p e s   a n d   S t r u c t u r e s                    */
+/*                                                                           */
+/* ************************************************************************* */
+
+#ifdef	_MSC_VER
+typedef unsigned __int64 T_wide_t;
+typedef __int64          T_long_t; /* MSVC6 can't convert unsigned to double */
+#else
+typedef unsigned long long T_wide_t;
+typedef long long          T_long_t;
+#endif
+
+/*
+ * A big integer, least significant limb first; CFI.h checks that an int is
+ * 32 bits.
+ */
+typedef struct S_big_t
+   {
+   int          count;             /* limbs in use */
+   unsigned int limb[REAL_LIMBS];
+   }
+   S_big_t;
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      P r i v a t e   G l o b a l   V a r i a b l e s                      */
+/*                                                                           */
+/* ************************************************************************* */
+
+static const unsigned int g_pow10[10] =
+   {
+   1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+   };
+
+#ifdef	REAL_QUICK
+static const double g_real10[23] = /* all exact */
+   {
+   1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+   1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+   };
+#endif
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      E x e c u t a b l e   C o d e   (Locally Used Functions)             */
+/*                                                                           */
+/* ************************************************************************* */
+
+
+/*****************************************************************************
+ * Private Function Prototypes
+ *****************************************************************************/
+
+static void big_small (S_big_t* big, unsigned int mul, unsigned int add);
+static void big_pow10 (S_big_t* big, long power);
+static void big_shift (S_big_t* big, long bits);
+static long big_bits (const S_big_t* big);
+static int big_cmp (const S_big_t* big1, const S_big_t* big2);
+static void big_sub (S_big_t* big1, const S_big_t* big2);
+static T_wide_t big_top (const S_big_t* big, long bits, int* sticky);
+static T_wide_t big_div (S_big_t* big1, const S_big_t* big2, int* sticky);
+static int real_make (
+                     T_wide_t mant,
+                     long     exp2,
+                     int      sticky,
+                     int      neg,
+                     double*  real
+                     );
+static int real_big (
+                    const char* text,
+                    const char* end,
+                    long        digits,
+                    long        exp10,
+                    int         neg,
+                    double*     real
+                    );
+
+
+/*****************************************************************************
+ * Private Function big_small
+ *****************************************************************************
+ *
+ * This function sets "a_big" to a_big * a_mul + a_add.
+ *
+ *****************************************************************************/
+
+static void big_small (S_big_t* a_big, unsigned int a_mul, unsigned int a_add)
+   {
+   T_wide_t carry = a_add;
+   int      i;
+
+   for (i = 0 ; i < a_big->count ; i++)
+      {
+      carry += (T_wide_t)a_big->limb[i] * a_mul;
+      a_big->limb[i] = (unsigned int)carry;
+      carry >>= 32;
+      }
+   if (carry != 0) a_big->limb[a_big->count++] = (unsigned int)carry;
+   }
+
+
+/*****************************************************************************
+ * Private Function big_pow10
+ *****************************************************************************/
+
+static void big_pow10 (S_big_t* a_big, long a_power)
+   {
+   for ( ; a_power >= 9 ; a_power -= 9) big_small (a_big, g_pow10[9], 0);
+   if (a_power > 0) big_small (a_big, g_pow10[a_power], 0);
+   }
+
+
+/*****************************************************************************
+ * Private Function big_shift
+ *****************************************************************************
+ *
+ * This function shifts "a_big" left by "a_bits".
+ *
+ *****************************************************************************/
+
+static void big_shift (S_big_t* a_big, long a_bits)
+   {
+   int words = (int)(a_bits / 32);
+   int bits  = (int)(a_bits % 32);
+   int i;
+
+   if (a_big->count == 0) return;
+
+   if (bits != 0)
+      {
+      a_big->limb[a_big->count] = 0;
+      for (i = a_big->count ; i > 0 ; i--)
+         {
+         a_big->limb[i] = (a_big->limb[i] << bits) |
+                          (a_big->limb[i-1] >> (32 - bits));
+         }
+      a_big->limb[0] <<= bits;
+      if (a_big->limb[a_big->count] != 0) a_big->count++;
+      }
+
+   if (words != 0)
+      {
+      for (i = a_big->count-1 ; i >= 0 ; i--)
+         {
+         a_big->limb[i+words] = a_big->limb[i];
+         }
+      for (i = 0 ; i < words ; i++) a_big->limb[i] = 0;
+      a_big->count += words;
+      }
+   }
+
+
+/*****************************************************************************
+ * Private Function big_bits
+ *****************************************************************************/
+
+static long big_bits (const S_big_t* a_big)
+   {
+   unsigned int top;
+   long         bits;
+
+   if (a_big->count == 0) return 0;
+
+   top  = a_big->limb[a_big->count-1];
+   bits = (long)(a_big->count-1) * 32;
+   while (top != 0)
+      {
+      top >>= 1;
+      bits++;
+      }
+
+   return bits;
+   }
+
+
+/*****************************************************************************
+ * Private Function big_cmp
+ *****************************************************************************/
+
+static int big_cmp (const S_big_t* a_big1, const S_big_t* a_big2)
+   {
+   int i;
+
+   if (a_big1->count != a_big2->count)
+      {
+      return a_big1->count < a_big2->count ? -1 : 1;
+      }
+   for (i = a_big1->count-1 ; i >= 0 ; i--)
+      {
+      if (a_big1->limb[i] != a_big2->limb[i])
+         {
+         return a_big1->limb[i] < a_big2->limb[i] ? -1 : 1;
+         }
+      }
+
+   return 0;
+   }
+
+
+/*****************************************************************************
+ * Private Function big_sub
+ *****************************************************************************
+ *
+ * This function sets "a_big1" to a_big1 - a_big2; a_big1 is not less than
+ * a_big2.
+ *
+ *****************************************************************************/
+
+static void big_sub (S_big_t* a_big1, const S_big_t* a_big2)
+   {
+   T_wide_t borrow = 0;
+   T_wide_t diff;
+   int      i;
+
+   for (i = 0 ; i < a_big1->count ; i++)
+      {
+      diff = (T_wide_t)a_big1->limb[i] - borrow;
+      if (i < a_big2->count) diff -= a_big2->limb[i];
+      a_big1->limb[i] = (unsigned int)diff;
+      borrow = (diff >> 32) != 0 ? 1 : 0;
+      }
+   while ((a_big1->count > 0) && (a_big1->limb[a_big1->count-1] == 0))
+      {
+      a_big1->count--;
+      }
+   }
+
+
+/*****************************************************************************
+ * Private Function big_top
+ *****************************************************************************
+ *
+ * This function returns the 64 bits of "a_big" below bit "a_bits", its bit
+ * length; "a_sticky" is set if any of the bits below those are set.
+ *
+ *****************************************************************************/
+
+static T_wide_t big_top (const S_big_t* a_big, long a_bits, int* a_sticky)
+   {
+   T_wide_t top = 0;
+   long     bit;
+   int      i;
+
+   *a_sticky = 0;
+   for (bit = a_bits-1 ; bit >= a_bits-64 ; bit--)
+      {
+      top <<= 1;
+      if ((bit >= 0) && ((a_big->limb[bit/32] >> (bit%32)) & 1)) top |= 1;
+      }
+   for (i = 0 ; (long)i*32 < a_bits-64 ; i++)
+      {
+      unsigned int limb = a_big->limb[i];
+      if (((long)i+1)*32 > a_bits-64)
+         {
+         limb &= (1u << ((a_bits-64) % 32)) - 1;
+         }
+      if (limb != 0) *a_sticky = 1;
+      }
+
+   return top;
+   }
+
+
+/*****************************************************************************
+ * Private Function big_div
+ *****************************************************************************
+ *
+ * This function returns a_big1 / a_big2, which must be less than 2^64, and
+ * sets "a_sticky" if there is a remainder; "a_big1" is left the remainder.
+ *
+ *****************************************************************************/
+
+static T_wide_t big_div (S_big_t* a_big1, const S_big_t* a_big2, int* a_sticky)
+   {
+   S_big_t  part;
+   T_wide_t quot = 0;
+   int      bit;
+
+   for (bit = 63 ; bit >= 0 ; bit--)
+      {
+      part.count = a_big2->count;
+      (void)memcpy (part.limb, a_big2->limb, sizeof(unsigned int)*part.count);
+      big_shift (&part, bit);
+      if (big_cmp(a_big1,&part) >= 0)
+         {
+         big_sub (a_big1, &part);
+         quot |= (T_wide_t)1 << bit;
+         }
+      }
+   *a_sticky = a_big1->count != 0;
+
+   return quot;
+   }
+
+
+/*****************************************************************************
+ * Private Function real_make
+ *****************************************************************************
+ *
+ * This function rounds a_mant * 2^a_exp2, plus a little more if "a_sticky" is
+ * set, to a double; it returns -1 if that is too big for a double.
+ *
+ *****************************************************************************/
+
+static int real_make (
+                     T_wide_t a_mant,
+                     long     a_exp2,
+                     int      a_sticky,
+                     int      a_neg,
+                     double*  a_real
+                     )
+   {
+   T_wide_t bits;
+   T_wide_t rest;
+   T_wide_t half;
+   long     exp;
+   long     drop;
+
+   while ((a_mant >> 63) == 0)
+      {
+      a_mant <<= 1;
+      a_exp2  -= 1;
+      }
+   exp = a_exp2 + 63; /* of the leading 1 bit */
+
+   /*
+    * A double has 53 bits, or fewer for a denormal; round off the others.
+    */
+   drop = exp >= -1022 ? 11 : 11 + (-1022 - exp);
+   if (drop > 64)
+      {
+      bits = 0;
+      }
+   else
+      {
+      bits = drop == 64 ? 0 : a_mant >> drop;
+      rest = drop == 64 ? a_mant : a_mant & (((T_wide_t)1 << drop) - 1);
+      half = (T_wide_t)1 << (drop - 1);
+      if ((rest > half) || ((rest == half) && (a_sticky || (bits & 1)))) bits++;
+      }
+
+   /*
+    * The implicit 1 bit of a normal double adds one to the exponent field;
+    * a carry out of the mantissa adds one more, as it should.
+    */
+   if (exp >= -1022)
+      {
+      if (exp > 1023) bits = (T_wide_t)0x7FF << 52;
+      else            bits += (T_wide_t)(exp + 1022) << 52;
+      }
+   if ((bits >> 52) >= 0x7FF) bits = (T_wide_t)0x7FF << 52;
+   if (a_neg) bits |= (T_wide_t)1 << 63;
+
+   (void)memcpy (a_real, &bits, sizeof(double));
+
+   return (bits << 1) == ((T_wide_t)0x7FF << 53) ? -1 : 0;
+   }
+
+
+/*****************************************************************************
+ * Private Function real_big
+ *****************************************************************************
+ *
+ * This function converts the "a_digits" significant digits from "a_text" to
+ * "a_end", times 10^a_exp10, exactly with big integers.
+ *
+ *****************************************************************************/
+
+static int real_big (
+                    const char* a_text,
+                    const char* a_end,
+                    long        a_digits,
+                    long        a_exp10,
+                    int         a_neg,
+                    double*     a_real
+                    )
+   {
+   S_big_t      num;
+   S_big_t      den;
+   T_wide_t     mant;
+   const char*  p;
+   long         shift;
+   long         kept      = 0;
+   unsigned int chunk     = 0;
+   int          chunkLeng = 0;
+   int          sticky;
+
+   /*
+    * More than REAL_DIGITS digits can only matter as a sticky bit; the last
+    * significant digit is not a zero, so it is a 1 past the kept digits.
+    */
+   num.count = 0;
+   for (p = a_text ; (p < a_end) && (kept < a_digits) ; p++)
+      {
+      if (*p == '.') continue;
+      if ((kept == 0) && (*p == '0')) continue;
+      if (kept == REAL_DIGITS)
+         {
+         chunk     = chunk * 10 + 1;
+         chunkLeng = chunkLeng + 1;
+         a_exp10  += a_digits - (REAL_DIGITS + 1);
+         break;
+         }
+      chunk      = chunk * 10 + (*p - '0');
+      chunkLeng += 1;
+      kept      += 1;
+      if (chunkLeng == 9)
+         {
+         big_small (&num, g_pow10[9], chunk);
+         chunk     = 0;
+         chunkLeng = 0;
+         }
+      }
+   if (chunkLeng != 0) big_small (&num, g_pow10[chunkLeng], chunk);
+
+   if (a_exp10 >= 0)
+      {
+      big_pow10 (&num, a_exp10);
+      shift = big_bits (&num);
+      mant  = big_top (&num, shift, &sticky);
+      return real_make (mant, shift - 64, sticky, a_neg, a_real);
+      }
+
+   /*
+    * num / 10^-exp10, scaled by 2^shift so that the quotient has 63 or 64
+    * bits.
+    */
+   den.count   = 1;
+   den.limb[0] = 1;
+   big_pow10 (&den, -a_exp10);
+   shift = 63 - (big_bits(&num) - big_bits(&den));
+   if (shift > 0) big_shift (&num, shift);
+   else           big_shift (&den, -shift);
+   mant = big_div (&num, &den, &sticky);
+
+   return real_make (mant, -shift, sticky, a_neg, a_real);
+   }
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      E x e c u t a b l e   C o d e   (External Interface Functions)       */
+/*                                                                           */
+/* ************************************************************************* */
+
+
+/*****************************************************************************
+ * Public Function cfi_number_integer
+ *****************************************************************************
+ *
+ * This function converts the "a_leng" characters of an integer at "a_text" in
+ * base "a_base": a decimal number with an optional sign, or a hex, octal or
+ * binary number with its "0x", "0o" or "0b".
+ *
+ *****************************************************************************/
+
+const char* (cfi_number_integer) (
+                                 const char* a_text,
+                                 size_t      a_leng,
+                                 int         a_base,
+                                 int32_t*    a_num
+                                 )
+   {
+   const char*  p   = a_text;
+   const char*  end = a_text + a_leng;
+   T_wide_t     value = 0;
+   T_wide_t     limit = 0xFFFFFFFFUL;
+   unsigned int digit;
+   unsigned int bad = 0;
+   int          digits;
+   int          neg = 0;
+
+   *a_num = 0;
+
+   if (a_base == 10)
+      {
+      if ((p < end) && ((*p == '-') || (*p == '+'))) neg = *p++ == '-';
+      limit = neg ? 0x80000000UL : 0x7FFFFFFFUL;
+      }
+   else
+      {
+      if ((a_leng < 2) || (p[0] != '0')) return MSG_NUMBER;
+      p += 2;
+      }
+   if (p == end) return MSG_NUMBER;
+
+   /*
+    * Past the leading zeros, a number with more digits than 32 bits takes is
+    * out of range; the others can't overflow 64 bits, so there is one range
+    * check at the end.
+    */
+   switch (a_base)
+      {
+      case 16: digits = 8;  break;
+      case 10: digits = 10; break;
+      case 8:  digits = 11; break;
+      case 2:  digits = 32; break;
+      default: return MSG_NUMBER;
+      }
+   if (end - p > digits)
+      {
+      while ((p < end-1) && (*p == '0')) p++;
+      if (end - p > digits) return MSG_RANGE;
+      }
+
+   switch (a_base)
+      {
+      case 10:
+         for ( ; p < end ; p++)
+            {
+            digit  = (unsigned int)(*p - '0');
+            bad   |= digit > 9;
+            value  = value * 10 + digit;
+            }
+         break;
+      case 16:
+         for ( ; p < end ; p++)
+            {
+            digit  = (unsigned int)*p;
+            bad   |= ((digit - '0') > 9) & (((digit | 0x20) - 'a') > 5);
+            value  = (value << 4) | ((digit & 0x0F) + 9 * (digit >> 6));
+            }
+         break;
+      case 8:
+         for ( ; p < end ; p++)
+            {
+            digit  = (unsigned int)(*p - '0');
+            bad   |= digit > 7;
+            value  = (value << 3) | digit;
+            }
+         break;
+      case 2:
+         for ( ; p < end ; p++)
+            {
+            digit  = (unsigned int)(*p - '0');
+            bad   |= digit > 1;
+            value  = (value << 1) | digit;
+            }
+         break;
+      }
+   if (bad) return MSG_NUMBER;
+   if (value > limit) return MSG_RANGE;
+
+   /*
+    * A hex, octal or binary number is a bit pattern.
+    */
+   if (neg)
+      *a_num = value == 0x80000000UL ? -0x7FFFFFFF - 1 : -(int32_t)value;
+   else if (value > 0x7FFFFFFFUL)
+      *a_num = -(int32_t)(0xFFFFFFFFUL - value) - 1;
+   else
+      *a_num = (int32_t)value;
+
+   return NULL;
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_number_real
+ *****************************************************************************
+ *
+ * This function converts the "a_leng" characters of a real number at "a_text"
+ * to the nearest double: an optional sign, digits with an optional '.', and
+ * an optional 'e' or 'E' exponent.
+ *
+ *****************************************************************************/
+
+const char* (cfi_number_real) (
+                              const char* a_text,
+                              size_t      a_leng,
+                              double*     a_real
+                              )
+   {
+   const char* p     = a_text;
+   const char* end   = a_text + a_leng;
+   const char* start;
+   const char* stop;
+   T_wide_t    mant   = 0;
+   long        digits = 0; /* significant digits, without trailing zeros */
+   long        zeros  = 0; /* zeros after the last nonzero digit         */
+   long        point  = 0; /* significant digits before the '.'          */
+   long        exp    = 0;
+   int         expNeg = 0;
+   int         seen   = 0;
+   int         dot    = 0;
+   int         neg    = 0;
+
+   *a_real = 0.0;
+
+   if ((p < end) && ((*p == '-') || (*p == '+'))) neg = *p++ == '-';
+   start = p;
+   for ( ; p < end ; p++)
+      {
+      if (*p == '.')
+         {
+         if (dot) return MSG_NUMBER;
+         dot = 1;
+         continue;
+         }
+      if ((*p < '0') || (*p > '9')) break;
+      seen = 1;
+      if ((*p == '0') && (digits == 0))
+         {
+         if (dot) point--;
+         continue;
+         }
+      if (!dot) point++;
+      if (*p == '0')
+         {
+         zeros++;
+         continue;
+         }
+      for ( ; zeros > 0 ; zeros--)
+         {
+         if (++digits <= 19) mant = mant * 10;
+         }
+      if (++digits <= 19) mant = mant * 10 + (*p - '0');
+      }
+   stop = p;
+   if (!seen) return MSG_NUMBER;
+
+   if ((p < end) && ((*p == 'e') || (*p == 'E')))
+      {
+      p++;
+      if ((p < end) && ((*p == '-') || (*p == '+'))) expNeg = *p++ == '-';
+      if (p == end) return MSG_NUMBER;
+      for ( ; p < end ; p++)
+         {
+         if ((*p < '0') || (*p > '9')) return MSG_NUMBER;
+         if (exp < REAL_EXPONENT) exp = exp * 10 + (*p - '0');
+         }
+      if (expNeg) exp = -exp;
+      }
+   if (p != end) return MSG_NUMBER;
+
+   /*
+    * The number is 0.DIGITS * 10^(point+exp).
+    */
+   if (digits == 0)
+      {
+      if (neg) *a_real = -0.0;
+      return NULL;
+      }
+   if (point + exp > 310)
+      {
+      (void)real_make (1, 2000, 0, neg, a_real);
+      return MSG_RANGE;
+      }
+   if (point + exp < -324)
+      {
+      if (neg) *a_real = -0.0;
+      return NULL;
+      }
+   exp = point + exp - digits;
+
+#ifdef	REAL_QUICK
+   /*
+    * An integer of up to 53 bits and a power of ten up to 10^22 are both
+    * exact doubles, so one multiply or divide rounds correctly.
+    */
+   if ((digits <= 19) && ((mant >> 53) == 0) && (exp >= -22) && (exp <= 22))
+      {
+      double real = (double)(T_long_t)mant;
+      if (exp < 0) real /= g_real10[-exp];
+      else         real *= g_real10[exp];
+      *a_real = neg ? -real : real;
+      return NULL;
+      }
+#endif
+
+   if (real_big(start,stop,digits,exp,neg,a_real) != 0) return MSG_RANGE;
+
+   return NULL;
+   }
+
+
+/* end of file */
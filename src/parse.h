@@ -77,6 +77,7 @@ extern	"C"	{
 
 #include	<stdio.h>
 #include	"CFI.h"
+#include	"lex.h"
 
 
 /* ************************************************************************* */
@@ -94,7 +95,84 @@ extern	"C"	{
 /*                                                                           */
 /* ************************************************************************* */
 
-/* (none) */
+/*
+ * The text of a word or string token is not copied by the lexical analyzer;
+ * the token is a pointer to the text in the input buffer, and its length.
+ * The input buffer lasts for the whole parse.
+ */
+typedef struct S_text_t
+   {
+   const char* text; /* start of the token text, not '\0' terminated */
+   size_t      leng; /* length of the token text                    */
+   }
+   S_text_t;
+
+/*
+ * The parser builds a chain of nodes (or attributes) by appending to the end
+ * of the chain, so a chain is kept as a pointer to its first and last items.
+ */
+typedef struct S_nodes_t
+   {
+   CFI_node_t head; /* first node of the chain, or NULL */
+   CFI_node_t tail; /* last node of the chain, or NULL  */
+   }
+   S_nodes_t;
+
+typedef struct S_attrs_t
+   {
+   CFI_attr_t head; /* first attribute of the chain, or NULL */
+   CFI_attr_t tail; /* last attribute of the chain, or NULL  */
+   }
+   S_attrs_t;
+
+/*
+ * A lazy parse keeps the text of the document while any of its section bodies
+ * is still to be parsed; the text is released with the last reference to it.
+ */
+typedef struct S_source_t
+   {
+   char*  text;    /* the document text, with two '\0' bytes after it */
+   size_t leng;    /* length of the text                              */
+   size_t mapSize; /* size of the mapping, or zero if it's allocated  */
+   size_t refs;    /* references to the text                          */
+   }
+   S_source_t;
+
+typedef struct S_lazy_t
+   {
+   S_source_t* source; /* the document text             */
+   const char* body;   /* the section body, in the text */
+   size_t      leng;   /* length of the section body    */
+   }
+   S_lazy_t;
+
+/*
+ * All of the state of one parse lives in a parser context; nothing in the
+ * parse path is kept in global variables, so any number of parser contexts
+ * can be used at once by different threads.
+ */
+typedef struct S_parser_t
+   {
+   void*               scanner;      /* lexical analyzer state (yyscan_t)     */
+   CFI_yyerrorfn_t     errorfn;      /* syntax error report function, or NULL */
+   CFI_node_t          node;         /* the chain of nodes that was parsed    */
+   const CFI_events_t* events;       /* event functions, or NULL for nodes    */
+   void*               user;         /* user data for the event functions     */
+   int                 lazy;         /* top level sections are parsed later   */
+   unsigned            threads;      /* threads to parse a buffer with        */
+   S_source_t*         source;       /* the text of a lazy parse, or NULL     */
+   size_t              offset;       /* offset of the input in the document   */
+   size_t              arenaSize;    /* arena block size, zero for no arena   */
+   struct S_arena_t*   arena;        /* the arena the nodes are made from     */
+   CFI_allocator_t*    allocator;    /* allocator of the documents, or NULL   */
+   int                 line;         /* current input line number             */
+   int                 oldState;     /* lexical start state to go back to     */
+   int                 blockComment; /* block comment nesting level           */
+   int                 errors;       /* number of syntax errors found         */
+   int                 errorLine;    /* line of the first syntax error        */
+   char                message[96];  /* text of the first syntax error        */
+   }
+   S_parser_t;
 
 
 /* ************************************************************************* */
@@ -112,8 +190,21 @@ extern	"C"	{
 /*                                                                           */
 /* ************************************************************************* */
 
-extern CFI_node_t cfi_parse_file (FILE* file);
-extern CFI_node_t cfi_parse_text (const char* text);
+extern CFI_node_t cfi_parse_file (CFI_parser_t parser, FILE* file);
+extern CFI_node_t cfi_parse_text (CFI_parser_t parser, const char* text);
+extern CFI_node_t cfi_parse_buffer (CFI_parser_t parser, char* buff, size_t leng);
+extern CFI_node_t cfi_parse_source (
+                                   CFI_parser_t parser,
+                                   char*        buff,
+                                   size_t       leng,
+                                   size_t       mapSize
+                                   );
+extern void cfi_source_release (S_source_t* source);
+extern void cfi_parse_error (
+                            CFI_parser_t parser,
+                            const char*  message,
+                            const char*  offending
+                            );
 
 
 #ifdef	__cplusplus
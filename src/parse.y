@@ -97,11 +97,15 @@ CHANGE LOG
 #ifndef	WIN32
 #   include	<unistd.h> /* always first amongst POSIX header files */
 #endif
+#ifdef	_unix
+#   include	<pthread.h>
+#endif
 
 /*
  * Project Specific Header Files
  */
 #include	"CFI.h"
+#include	"arena.h"
 #include	"lex.h"
 #include	"parse.h"
 
@@ -114,33 +118,144 @@ CHANGE LOG
 
 #define   PDEBUG(x)   {x;actions_dump(#x);}
 
+/*
+ * The parser is a pure (reentrant) parser; the lexical analyzer and the error
+ * function are handed the parser context.
+ */
+#define   yylex       cfi_lex
+#define   yyerror     cfi_lex_error
+
+/*
+ * Sections nested deeper than this are an error, as they are for yyparse()
+ * when its stack is full.
+ */
+#define   BUILD_DEPTH (10000)
+
+/*
+ * A parse of a buffer with threads cuts the buffer into no more than
+ * PARSE_THREADS parts, and no part is smaller than PARSE_PART bytes.  The
+ * parts are parsed in place; a lexical analyzer that isn't bounded wants two
+ * '\0' bytes after a part, over the start of the next one, so then the parts
+ * are parsed in PARSE_WAVES waves, and no two parts next to each other are
+ * parsed at the same time.
+ */
+#define   PARSE_THREADS (64)
+#define   PARSE_PART    (1L<<20)
+#define   PARSE_WAVES   (2)
+
 
 /* ************************************************************************* */
 /*                                                                           */
-/*      P r i v a t e   G l o b a l   V a r i a b l e s                      */
+/*      D a t a   T y p e s   a n d   S t r u c t u r e s                    */
 /*                                                                           */
 /* ************************************************************************* */
 
-static CFI_node_t g_node;
+/*
+ * The state of build(); the struct is declared after the %union, because it
+ * has a YYSTYPE.
+ */
+typedef struct S_build_t S_build_t;
+
+#ifdef	_unix
+/*
+ * A part of a buffer that is parsed by its own thread.
+ */
+typedef struct S_part_t
+   {
+   char*      buff;        /* text of the part, in the buffer             */
+   size_t     leng;        /* length of the text                          */
+   size_t     offset;      /* offset of the text in the document          */
+   S_arena_t* arena;       /* the arena of the part, or NULL              */
+   CFI_node_t node;        /* the chain of nodes parsed from the part     */
+   int        errors;      /* syntax errors, or -1 if it isn't parsed     */
+   int        lines;       /* lines of the part, if it has no errors      */
+   int        errorLine;   /* line of its first error, in the part        */
+   char       message[96]; /* text of its first error                     */
+   char       ends[2];     /* what its two '\0' bytes are put over        */
+   int        thread;      /* the part is parsed by its own thread        */
+   pthread_t  id;          /* the thread                                  */
+   }
+   S_part_t;
+#endif
 
 
 /*****************************************************************************
  * Private Function Prototypes
  *****************************************************************************/
 
-static __inline__ void       actions_init (void);
-static __inline__ CFI_node_t actions_done (void);
+static __inline__ void       actions_init (CFI_parser_t parser);
+static __inline__ CFI_node_t actions_done (CFI_parser_t parser);
 static __inline__ void       actions_dump (const char* const text);
+static __inline__ void       nodes_append (S_nodes_t* nodes, CFI_node_t node);
+static __inline__ void       attrs_append (S_attrs_t* attrs, CFI_attr_t attr);
+static void                  attrs_del (CFI_attr_t attr);
+static __inline__ char*      text_dup (CFI_parser_t parser, S_text_t text);
+static __inline__ CFI_attr_t text_attribute (
+                                            CFI_parser_t parser,
+                                            S_text_t     text,
+                                            int          type
+                                            );
+static __inline__ size_t     span_offset (CFI_parser_t parser);
+static __inline__ size_t     arena_size (CFI_parser_t parser);
+static int                   build_attribute (
+                                             S_build_t*  build,
+                                             CFI_attr_t* attr
+                                             );
+static int                   build_lazy (S_build_t* build, S_lazy_t** lazy);
+static int                   build_dictionary (
+                                              S_build_t* build,
+                                              S_nodes_t* nodes,
+                                              int        depth
+                                              );
+static int                   build (CFI_parser_t parser);
+static int                   events_grow (S_build_t* build, size_t count);
+static int                   events_value (
+                                          S_build_t*   build,
+                                          CFI_value_t* value
+                                          );
+static void                  events (CFI_parser_t parser);
+#ifdef	_unix
+static void*                 part_parse (void* part);
+static void                  part_error (
+                                        CFI_parser_t parser,
+                                        S_part_t*    part,
+                                        int          lines
+                                        );
+static void                  parse_wave (
+                                        S_part_t* parts,
+                                        size_t    count,
+                                        size_t    first,
+                                        size_t    waves
+                                        );
+static int                   parse_parallel (
+                                            CFI_parser_t parser,
+                                            char*        buff,
+                                            size_t       leng
+                                            );
+#endif
+static CFI_node_t            parse (
+                                   CFI_parser_t parser,
+                                   const char*  text,
+                                   char*        buff,
+                                   size_t       leng
+                                   );
 
 
 %}
 
 
+%define api.pure
+%parse-param {CFI_parser_t a_parser}
+%lex-param   {CFI_parser_t a_parser}
+
+
 %union
    {
    CFI_node_t nptr;
    CFI_attr_t aptr;
-   char*      cptr;
+   S_nodes_t  nlst;
+   S_attrs_t  alst;
+   S_text_t   text;
    double     real;
    int32_t    num;
    }
@@ -151,19 +266,43 @@ static __inline__ void       actions_dump (const char* const text);
  * "KEYWORD" is actually not returned from the lexical analyzer.
 %token		KEYWORD
  */
-%token	<cptr>	CFIYY_WORD CFIYY_STRING
+%token	<text>	CFIYY_WORD CFIYY_STRING
 %token	<real>	CFIYY_REALNUM
 %token	<num>	CFIYY_HEXNUM CFIYY_DECNUM CFIYY_OCTNUM CFIYY_BINNUM
 
-%type	<nptr>	dictionary
+%type	<nlst>	dictionary
 %type	<nptr>	object
 %type	<aptr>	attribute
 %type	<nptr>	word
 %type	<nptr>	word_attribute
-%type	<aptr>	attribute_list
+%type	<alst>	attribute_list
 %type	<nptr>	section
 %type	<aptr>	param_option
 
+/*
+ * The values on the parser stack are freed when a syntax error makes the
+ * parser throw them away; the text of a token points into the input buffer,
+ * so it has nothing to free.
+ */
+%destructor	{ (void)cfi_delete_chain ($$);      } <nptr>
+%destructor	{ (void)cfi_delete_chain ($$.head); } <nlst>
+%destructor	{ attrs_del ($$);                   } <aptr>
+%destructor	{ attrs_del ($$.head);              } <alst>
+
+
+%code
+   {
+   struct S_build_t
+      {
+      CFI_parser_t parser; /* the parser context                  */
+      YYSTYPE      lval;   /* the value of the current token       */
+      int          token;  /* the current token                    */
+      int          error;  /* an error that isn't a syntax error   */
+      CFI_value_t* values; /* the values of an event, or NULL      */
+      size_t       size;   /* number of values that there room for */
+      };
+   }
+
 
 %%
 
@@ -178,6 +317,13 @@ static __inline__ void       actions_dump (const char* const text);
 <----------------------------------------------------------- 132 Columns ---------------------------------------------------------->
  */
 
+/*
+ * The lists (dictionary and attribute_list) are left recursive, so the parser
+ * reduces each item as soon as it is read and the parser stack depth depends
+ * only upon how deeply sections are nested, not upon how many items there are.
+ * Each list value is a chain with a tail pointer, so appending is O(1).
+ */
+
 /*
  * Here is the BNF for the grammer:
  * -------------------------------
@@ -189,9 +335,12 @@ static __inline__ void       actions_dump (const char* const text);
  * <attribute>      ::=  <word> | <number> | <string>
  */
 
-dictionary:	/* empty */	{ PDEBUG($$=NULL)                             }
-	|	object dictionary
-				{ PDEBUG($$=_cfi_node_join($1,$2)) g_node=$$; }
+document:	dictionary	{ PDEBUG(a_parser->node=$1.head) }
+	;
+
+dictionary:	/* empty */	{ PDEBUG($$.head=$$.tail=NULL) }
+	|	dictionary object
+				{ $$=$1; PDEBUG(nodes_append(&$$,$2)) }
 	;
 
 object:		word		{ PDEBUG($$=$1) }
@@ -199,18 +348,21 @@ object:		word		{ PDEBUG($$=$1) }
 	|	section		{ PDEBUG($$=$1) }
 	;
 
-word:		CFIYY_WORD ';'	{ PDEBUG($$=_cfi_node_word_new($1)) }
+word:		CFIYY_WORD ';'
+				{
+				PDEBUG($$=_cfi_node_word_new(a_parser->arena,text_dup(a_parser,$1)))
+				}
 	;
 
 word_attribute:	CFIYY_WORD '=' attribute_list ';'
 				{
-				PDEBUG($$=_cfi_node_attribute_new($1,$3))
+				PDEBUG($$=_cfi_node_attribute_new(a_parser->arena,text_dup(a_parser,$1),$3.head))
 				}
 	;
 
 section:	CFIYY_WORD param_option '{' dictionary '}'
 				{
-				PDEBUG($$=_cfi_node_section_new($1,$2,$4))
+				PDEBUG($$=_cfi_node_section_new(a_parser->arena,text_dup(a_parser,$1),$2,$4.head))
 				}
 	;
 
@@ -219,20 +371,18 @@ param_option:	/* empty */	{ PDEBUG($$=NULL) }
 				{ PDEBUG($$=$2)   }
 	;
 
-attribute_list:	attribute	{ PDEBUG($$=$1) }
-	|	attribute ',' attribute_list
-				{
-				PDEBUG($$=_cfi_attribute_join($1,$3))
-				}
+attribute_list:	attribute	{ PDEBUG($$.head=$$.tail=$1) }
+	|	attribute_list ',' attribute
+				{ $$=$1; PDEBUG(attrs_append(&$$,$3)) }
 	;
 
-attribute:	CFIYY_STRING	{ PDEBUG($$=_cfi_attribute_new($1,CFI_STRING_ATTRIBUTE)); free($1); }
-	|	CFIYY_WORD	{ PDEBUG($$=_cfi_attribute_new($1,CFI_WORD_ATTRIBUTE)); free($1);   }
-	|	CFIYY_REALNUM	{ PDEBUG($$=_cfi_attribute_new(&$1,CFI_REAL_ATTRIBUTE))             }
-	|	CFIYY_HEXNUM	{ PDEBUG($$=_cfi_attribute_new(&$1,CFI_HEX_FORMAT))                 }
-	|	CFIYY_DECNUM	{ PDEBUG($$=_cfi_attribute_new(&$1,CFI_DEC_FORMAT))                 }
-	|	CFIYY_OCTNUM	{ PDEBUG($$=_cfi_attribute_new(&$1,CFI_OCT_FORMAT))                 }
-	|	CFIYY_BINNUM	{ PDEBUG($$=_cfi_attribute_new(&$1,CFI_BIN_FORMAT))                 }
+attribute:	CFIYY_STRING	{ PDEBUG($$=text_attribute(a_parser,$1,CFI_STRING_ATTRIBUTE))           }
+	|	CFIYY_WORD	{ PDEBUG($$=text_attribute(a_parser,$1,CFI_WORD_ATTRIBUTE))             }
+	|	CFIYY_REALNUM	{ PDEBUG($$=_cfi_attribute_new(a_parser->arena,&$1,CFI_REAL_ATTRIBUTE)) }
+	|	CFIYY_HEXNUM	{ PDEBUG($$=_cfi_attribute_new(a_parser->arena,&$1,CFI_HEX_FORMAT))     }
+	|	CFIYY_DECNUM	{ PDEBUG($$=_cfi_attribute_new(a_parser->arena,&$1,CFI_DEC_FORMAT))     }
+	|	CFIYY_OCTNUM	{ PDEBUG($$=_cfi_attribute_new(a_parser->arena,&$1,CFI_OCT_FORMAT))     }
+	|	CFIYY_BINNUM	{ PDEBUG($$=_cfi_attribute_new(a_parser->arena,&$1,CFI_BIN_FORMAT))     }
 	;
 
 
@@ -257,22 +407,64 @@ attribute:	CFIYY_STRING	{ PDEBUG($$=_cfi_attribute_new($1,CFI_STRING_ATTRIBUTE))
  * Private Function actions_init
  *****************************************************************************/
 
-static __inline__ void actions_init (void)
+static __inline__ void actions_init (CFI_parser_t a_parser)
+   {
+   a_parser->node       = NULL;
+   a_parser->line       = 1;
+   a_parser->errors     = 0;
+   a_parser->errorLine  = 0;
+   a_parser->message[0] = '\0';
+   }
+
+
+/*****************************************************************************
+ * Private Function arena_size
+ *****************************************************************************
+ *
+ * This function gives the block size of the arena of each document that the
+ * parser makes, or zero for none; a document from an allocator of its own is
+ * made in an arena.
+ *
+ *****************************************************************************/
+
+static __inline__ size_t arena_size (CFI_parser_t a_parser)
    {
-   g_node = NULL;
+   if ((a_parser->arenaSize == 0) && (a_parser->allocator != NULL))
+      {
+      return CFI_ARENA_BLOCK;
+      }
+   return a_parser->arenaSize;
    }
 
 
 /*****************************************************************************
  * Private Function actions_done
+ *****************************************************************************
+ *
+ * An error from the lexical analyzer, such as a number out of range, doesn't
+ * stop the parse, but the nodes are not returned.  The arena that the parse
+ * made is handed to the nodes.
+ *
  *****************************************************************************/
 
-static __inline__ CFI_node_t actions_done (void)
+static __inline__ CFI_node_t actions_done (CFI_parser_t a_parser)
    {
    CFI_node_t node;
 
-   node   = g_node;
-   g_node = NULL;
+   node   = a_parser->node;
+   a_parser->node = NULL;
+
+   if ((a_parser->errors != 0) && (node != NULL))
+      {
+      (void)cfi_delete_chain (node);
+      node = NULL;
+      }
+
+   if ((arena_size(a_parser) != 0) && (a_parser->arena != NULL))
+      {
+      cfi_arena_done (a_parser->arena, node);
+      a_parser->arena = NULL;
+      }
 
    return node;
    }
@@ -291,6 +483,921 @@ static __inline__ void actions_dump (const char* const a_text)
    }
 
 
+/*****************************************************************************
+ * Private Function nodes_append
+ *****************************************************************************
+ *
+ * This function appends a node to the end of a chain of nodes.  A NULL node
+ * (a dynamic memory allocation failure) is not appended.
+ *
+ *****************************************************************************/
+
+static __inline__ void nodes_append (S_nodes_t* a_nodes, CFI_node_t a_node)
+   {
+   if (a_node == NULL) return;
+   if (a_nodes->tail == NULL)
+      a_nodes->head = a_node;
+   else
+      (void)_cfi_node_join (a_nodes->tail, a_node);
+   a_nodes->tail = a_node;
+   }
+
+
+/*****************************************************************************
+ * Private Function attrs_append
+ *****************************************************************************
+ *
+ * This function appends an attribute to the end of a chain of attributes.  A
+ * NULL attribute (a dynamic memory allocation failure) is not appended.
+ *
+ *****************************************************************************/
+
+static __inline__ void attrs_append (S_attrs_t* a_attrs, CFI_attr_t a_attr)
+   {
+   if (a_attr == NULL) return;
+   if (a_attrs->tail == NULL)
+      a_attrs->head = a_attr;
+   else
+      (void)_cfi_attribute_join (a_attrs->tail, a_attr);
+   a_attrs->tail = a_attr;
+   }
+
+
+/*****************************************************************************
+ * Private Function attrs_del
+ *****************************************************************************
+ *
+ * This function deletes a chain of attributes that isn't in a node.
+ *
+ *****************************************************************************/
+
+static void attrs_del (CFI_attr_t a_attr)
+   {
+   CFI_attr_t next;
+
+   while (a_attr != NULL)
+      {
+      next = cfi_attribute_next (a_attr);
+      (void)cfi_attribute_del (&a_attr);
+      a_attr = next;
+      }
+   }
+
+
+/*****************************************************************************
+ * Private Function text_dup
+ *****************************************************************************
+ *
+ * This function makes a '\0' terminated, dynamically allocated copy of the
+ * text of a token, for the word of a node; in the arena of the parse, if
+ * there is one, the word is the key from the arena's key table.
+ *
+ *****************************************************************************/
+
+static __inline__ char* text_dup (CFI_parser_t a_parser, S_text_t a_text)
+   {
+   char* text;
+
+   if (a_parser->arena != NULL)
+      return cfi_arena_key (a_parser->arena, a_text.text, a_text.leng);
+
+   text = (char*)_cfi_malloc (a_text.leng+1);
+   if (text == NULL) return NULL;
+   (void)memcpy (text, a_text.text, a_text.leng);
+   text[a_text.leng] = '\0';
+
+   return text;
+   }
+
+
+/*****************************************************************************
+ * Private Function text_attribute
+ *****************************************************************************
+ *
+ * This function makes a word or string attribute straight from the text of a
+ * token, with no copy of the token in between.
+ *
+ *****************************************************************************/
+
+static __inline__ CFI_attr_t text_attribute (
+                                            CFI_parser_t a_parser,
+                                            S_text_t     a_text,
+                                            int          a_type
+                                            )
+   {
+   return _cfi_attribute_text (
+                              a_parser->arena,
+                              a_text.text,
+                              a_text.leng,
+                              a_type
+                              );
+   }
+
+
+/*****************************************************************************
+ * Private Function span_offset
+ *****************************************************************************
+ *
+ * This function gives the offset of the current token in the document.
+ *
+ *****************************************************************************/
+
+static __inline__ size_t span_offset (CFI_parser_t a_parser)
+   {
+   return a_parser->offset + cfi_lex_offset (a_parser);
+   }
+
+
+/*****************************************************************************
+ * Private Function build_attribute
+ *****************************************************************************
+ *
+ * This function makes the attribute for the current token, as the attribute
+ * rule does, and reads the next token; it returns -1 if the current token is
+ * not an attribute.
+ *
+ *****************************************************************************/
+
+static int build_attribute (S_build_t* a_build, CFI_attr_t* a_attr)
+   {
+   YYSTYPE*     lval   = &a_build->lval;
+   CFI_parser_t parser = a_build->parser;
+   S_arena_t*   arena  = parser->arena;
+
+   switch (a_build->token)
+      {
+      case CFIYY_STRING:
+         *a_attr = text_attribute (parser, lval->text, CFI_STRING_ATTRIBUTE);
+         break;
+      case CFIYY_WORD:
+         *a_attr = text_attribute (parser, lval->text, CFI_WORD_ATTRIBUTE);
+         break;
+      case CFIYY_REALNUM:
+         *a_attr = _cfi_attribute_new (arena, &lval->real, CFI_REAL_ATTRIBUTE);
+         break;
+      case CFIYY_HEXNUM:
+         *a_attr = _cfi_attribute_new (arena, &lval->num, CFI_HEX_FORMAT);
+         break;
+      case CFIYY_DECNUM:
+         *a_attr = _cfi_attribute_new (arena, &lval->num, CFI_DEC_FORMAT);
+         break;
+      case CFIYY_OCTNUM:
+         *a_attr = _cfi_attribute_new (arena, &lval->num, CFI_OCT_FORMAT);
+         break;
+      case CFIYY_BINNUM:
+         *a_attr = _cfi_attribute_new (arena, &lval->num, CFI_BIN_FORMAT);
+         break;
+      default:
+         *a_attr = NULL;
+         return -1;
+      }
+
+   a_build->token = cfi_lex (lval, a_build->parser);
+
+   return 0;
+   }
+
+
+/*****************************************************************************
+ * Private Function build_lazy
+ *****************************************************************************
+ *
+ * This function skips the body of a section, after its '{', and keeps where
+ * the body is in the document text, to be parsed when it is first used.  It
+ * returns -1 if the body doesn't end, or if the body can't be kept; that is
+ * reported as an error of its own.
+ *
+ *****************************************************************************/
+
+static int build_lazy (S_build_t* a_build, S_lazy_t** a_lazy)
+   {
+   S_source_t* source = a_build->parser->source;
+   const char* body;
+   size_t      leng;
+
+   *a_lazy = NULL;
+
+   if (cfi_lex_skip(a_build->parser,&body,&leng) != 0) return -1;
+   if ((body < source->text) || ((body+leng) > (source->text+source->leng)))
+      {
+      cfi_lex_error (a_build->parser, "section body is not in the text");
+      a_build->error = 1;
+      return -1;
+      }
+
+   *a_lazy = (S_lazy_t*)_cfi_malloc (sizeof(S_lazy_t));
+   if (*a_lazy == NULL)
+      {
+      cfi_lex_error (a_build->parser, "can't allocate memory");
+      a_build->error = 1;
+      return -1;
+      }
+   (*a_lazy)->source = source;
+   (*a_lazy)->body   = body;
+   (*a_lazy)->leng   = leng;
+   source->refs += 1;
+
+   a_build->token = '}';
+
+   return 0;
+   }
+
+
+/*****************************************************************************
+ * Private Function build_dictionary
+ *****************************************************************************
+ *
+ * This function makes the chain of nodes of a dictionary, as the dictionary
+ * rule does, up to the first token that can't start an object.  Whatever it
+ * made is deleted if there is a syntax error.  In a lazy parse, the bodies of
+ * the top level sections are skipped.
+ *
+ * Each node gets its source span: where it starts in the document, its length
+ * up to and including its ';' or '}', and, for a section, where its body is.
+ *
+ *****************************************************************************/
+
+static int build_dictionary (
+                            S_build_t* a_build,
+                            S_nodes_t* a_nodes,
+                            int        a_depth
+                            )
+   {
+   YYSTYPE*   lval  = &a_build->lval;
+   S_arena_t* arena = a_build->parser->arena;
+   S_text_t   word;
+   S_attrs_t  attrs;
+   S_nodes_t  nodes;
+   S_lazy_t*  lazy;
+   CFI_attr_t attr;
+   CFI_node_t node;
+   size_t     start;
+   size_t     body;
+   int        stat;
+
+   a_nodes->head = NULL;
+   a_nodes->tail = NULL;
+
+   while (a_build->token == CFIYY_WORD)
+      {
+      word  = lval->text;
+      start = span_offset (a_build->parser);
+      body  = 0;
+      stat  = 0;
+      a_build->token = cfi_lex (lval, a_build->parser);
+
+      switch (a_build->token)
+         {
+         case ';':
+            node = _cfi_node_word_new (arena, text_dup(a_build->parser,word));
+            break;
+
+         case '=':
+            attrs.head = NULL;
+            attrs.tail = NULL;
+            do
+               {
+               a_build->token = cfi_lex (lval, a_build->parser);
+               stat = build_attribute (a_build, &attr);
+               attrs_append (&attrs, attr);
+               }
+            while ((stat == 0) && (a_build->token == ','));
+            node = _cfi_node_attribute_new (
+                                           arena,
+                                           text_dup (a_build->parser, word),
+                                           attrs.head
+                                           );
+            if (a_build->token != ';') stat = -1;
+            break;
+
+         case '(':
+         case '{':
+            attr = NULL;
+            lazy = NULL;
+            nodes.head = NULL;
+            if (a_build->token == '(')
+               {
+               a_build->token = cfi_lex (lval, a_build->parser);
+               stat = build_attribute (a_build, &attr);
+               if ((stat == 0) && (a_build->token == ')'))
+                  a_build->token = cfi_lex (lval, a_build->parser);
+               else
+                  stat = -1;
+               }
+            if ((stat == 0) && (a_build->token == '{') &&
+                (a_depth >= BUILD_DEPTH))
+               {
+               cfi_lex_error (a_build->parser, "sections nested too deeply");
+               a_build->error = 1;
+               stat = -1;
+               }
+            else if ((stat == 0) && (a_build->token == '{'))
+               {
+               body = span_offset (a_build->parser) + 1 - start;
+               if ((a_depth == 0) && (a_build->parser->source != NULL))
+                  {
+                  stat = build_lazy (a_build, &lazy);
+                  }
+               else
+                  {
+                  a_build->token = cfi_lex (lval, a_build->parser);
+                  stat = build_dictionary (a_build, &nodes, a_depth+1);
+                  if (a_build->token != '}') stat = -1;
+                  }
+               }
+            else
+               stat = -1;
+            if (lazy != NULL)
+               {
+               node = _cfi_node_lazy_new (
+                                         arena,
+                                         text_dup (a_build->parser, word),
+                                         attr,
+                                         lazy
+                                         );
+               }
+            else
+               {
+               node = _cfi_node_section_new (
+                                            arena,
+                                            text_dup (a_build->parser, word),
+                                            attr,
+                                            nodes.head
+                                            );
+               }
+            break;
+
+         default:
+            node = NULL;
+            stat = -1;
+            break;
+         }
+
+      nodes_append (a_nodes, node);
+      if (stat != 0)
+         {
+         (void)cfi_delete_chain (a_nodes->head);
+         a_nodes->head = NULL;
+         a_nodes->tail = NULL;
+         return -1;
+         }
+      _cfi_node_span_set (
+                         node,
+                         start,
+                         span_offset(a_build->parser) + 1 - start,
+                         body
+                         );
+      a_build->token = cfi_lex (lval, a_build->parser);
+      }
+
+   return 0;
+   }
+
+
+/*****************************************************************************
+ * Private Function build
+ *****************************************************************************
+ *
+ * This function makes the tree of nodes of the document from the tokens, with
+ * a recursive descent over the CFI grammar instead of the LALR tables, which
+ * is faster.  It stops at the first syntax error, as yyparse() does, and it
+ * reports the error at the same token, so the message is the same; then
+ * nothing is made.  It returns -1 if there is an error.
+ *
+ *****************************************************************************/
+
+static int build (CFI_parser_t a_parser)
+   {
+   S_build_t build;
+   S_nodes_t nodes;
+
+   build.parser = a_parser;
+   build.error  = 0;
+   build.token  = cfi_lex (&build.lval, a_parser);
+
+   if (build_dictionary(&build,&nodes,0) == 0)
+      {
+      if (build.token == 0)
+         {
+         a_parser->node = nodes.head;
+         return 0;
+         }
+      (void)cfi_delete_chain (nodes.head);
+      }
+
+   if (!build.error) cfi_lex_error (a_parser, "syntax error");
+
+   return -1;
+   }
+
+
+/*****************************************************************************
+ * Private Function events_grow
+ *****************************************************************************
+ *
+ * This function makes room for value number "a_count" of an event.
+ *
+ *****************************************************************************/
+
+static int events_grow (S_build_t* a_build, size_t a_count)
+   {
+   CFI_value_t* values;
+   size_t       size;
+
+   if (a_count < a_build->size) return 0;
+
+   size   = a_build->size == 0 ? 16 : a_build->size * 2;
+   values = (CFI_value_t*)_cfi_realloc (
+                                       a_build->values,
+                                       size*sizeof(CFI_value_t)
+                                       );
+   if (values == NULL)
+      {
+      cfi_parse_error (a_build->parser, "can't allocate memory", NULL);
+      return -1;
+      }
+   a_build->values = values;
+   a_build->size   = size;
+
+   return 0;
+   }
+
+
+/*****************************************************************************
+ * Private Function events_value
+ *****************************************************************************
+ *
+ * This function sets the value of the current token, as build_attribute()
+ * makes an attribute, and reads the next token; it returns -1 if the current
+ * token is not an attribute.
+ *
+ *****************************************************************************/
+
+static int events_value (S_build_t* a_build, CFI_value_t* a_value)
+   {
+   YYSTYPE* lval = &a_build->lval;
+
+   a_value->text = NULL;
+   a_value->leng = 0;
+   a_value->real = 0.0;
+   a_value->num  = 0;
+
+   switch (a_build->token)
+      {
+      case CFIYY_STRING:
+         a_value->type = CFI_STRING_ATTRIBUTE;
+         a_value->text = lval->text.text;
+         a_value->leng = lval->text.leng;
+         break;
+      case CFIYY_WORD:
+         a_value->type = CFI_WORD_ATTRIBUTE;
+         a_value->text = lval->text.text;
+         a_value->leng = lval->text.leng;
+         break;
+      case CFIYY_REALNUM:
+         a_value->type = CFI_REAL_ATTRIBUTE;
+         a_value->real = lval->real;
+         break;
+      case CFIYY_HEXNUM:
+         a_value->type = CFI_HEX_FORMAT;
+         a_value->num  = lval->num;
+         break;
+      case CFIYY_DECNUM:
+         a_value->type = CFI_DEC_FORMAT;
+         a_value->num  = lval->num;
+         break;
+      case CFIYY_OCTNUM:
+         a_value->type = CFI_OCT_FORMAT;
+         a_value->num  = lval->num;
+         break;
+      case CFIYY_BINNUM:
+         a_value->type = CFI_BIN_FORMAT;
+         a_value->num  = lval->num;
+         break;
+      default:
+         return -1;
+      }
+
+   a_build->token = cfi_lex (lval, a_build->parser);
+
+   return 0;
+   }
+
+
+/*****************************************************************************
+ * Private Function events
+ *****************************************************************************
+ *
+ * This function is the event parse: it follows the CFI grammar as build() and
+ * build_dictionary() do, but it calls the event functions instead of making
+ * nodes.  Nothing is kept but the current section nesting level and the
+ * values of the current attribute node, so the sections are not nested with
+ * recursion and can be nested as deeply as the document likes.
+ *
+ * The parse stops at the first error, or when an event function returns
+ * non-zero; the events already given are not taken back.  An error from the
+ * lexical analyzer, such as a number out of range, stops the parse before
+ * its value is given to an event function.
+ *
+ *****************************************************************************/
+
+static void events (CFI_parser_t a_parser)
+   {
+   const CFI_events_t* ev   = a_parser->events;
+   void*               user = a_parser->user;
+   S_build_t           build;
+   YYSTYPE*            lval = &build.lval;
+   S_text_t            word;
+   CFI_value_t         param;
+   CFI_value_t*        paramp;
+   size_t              count;
+   long                depth = 0;
+   int                 stop  = 0;
+   int                 stat  = 0;
+
+   build.parser = a_parser;
+   build.values = NULL;
+   build.size   = 0;
+   build.token  = cfi_lex (lval, a_parser);
+
+   while ((stop == 0) && (stat == 0))
+      {
+      if (a_parser->errors != 0)
+         {
+         stat = -1;
+         }
+      else if (build.token == CFIYY_WORD)
+         {
+         word = lval->text;
+         build.token = cfi_lex (lval, a_parser);
+
+         switch (build.token)
+            {
+            case ';':
+               if (ev->word != NULL)
+                  stop = (*ev->word) (user, word.text, word.leng);
+               break;
+
+            case '=':
+               count = 0;
+               do
+                  {
+                  build.token = cfi_lex (lval, a_parser);
+                  stat = events_grow (&build, count);
+                  if (stat == 0)
+                     stat = events_value (&build, &build.values[count++]);
+                  }
+               while ((stat == 0) && (build.token == ','));
+               if ((build.token != ';') || (a_parser->errors != 0)) stat = -1;
+               if ((stat == 0) && (ev->attribute_node != NULL))
+                  {
+                  stop = (*ev->attribute_node) (
+                                               user,
+                                               word.text,
+                                               word.leng,
+                                               build.values,
+                                               count
+                                               );
+                  }
+               break;
+
+            case '(':
+            case '{':
+               paramp = NULL;
+               if (build.token == '(')
+                  {
+                  build.token = cfi_lex (lval, a_parser);
+                  stat = events_value (&build, &param);
+                  if ((stat == 0) && (build.token == ')'))
+                     build.token = cfi_lex (lval, a_parser);
+                  else
+                     stat = -1;
+                  paramp = &param;
+                  }
+               if ((build.token != '{') || (a_parser->errors != 0)) stat = -1;
+               if (stat == 0)
+                  {
+                  depth++;
+                  if (ev->begin_section != NULL)
+                     {
+                     stop = (*ev->begin_section) (
+                                                 user,
+                                                 word.text,
+                                                 word.leng,
+                                                 paramp
+                                                 );
+                     }
+                  }
+               break;
+
+            default:
+               stat = -1;
+               break;
+            }
+         }
+      else if ((build.token == '}') && (depth > 0))
+         {
+         depth--;
+         if (ev->end_section != NULL) stop = (*ev->end_section) (user);
+         }
+      else if ((build.token == 0) && (depth == 0))
+         {
+         break;
+         }
+      else
+         {
+         stat = -1;
+         }
+
+      /*
+       * The current token was used: ';', '{' or '}'.
+       */
+      if ((stop == 0) && (stat == 0)) build.token = cfi_lex (lval, a_parser);
+      }
+
+   if ((stat != 0) && (a_parser->errors == 0))
+      {
+      cfi_lex_error (a_parser, "syntax error");
+      }
+
+   _cfi_free (build.values);
+   }
+
+
+#ifdef	_unix
+/*****************************************************************************
+ * Private Function part_parse
+ *****************************************************************************
+ *
+ * This function is a thread of parse_parallel(); it parses one part with a
+ * parser of its own, and keeps the lines of the part and its first error.
+ *
+ *****************************************************************************/
+
+static void* part_parse (void* a_part)
+   {
+   S_part_t*    part = (S_part_t*)a_part;
+   CFI_parser_t parser;
+
+   if (cfi_parser_new(&parser) != NULL) return NULL;
+
+   parser->threads = 1;
+   parser->offset  = part->offset;
+   parser->arena   = part->arena;
+   part->node      = cfi_parse_buffer (parser, part->buff, part->leng);
+   part->errors    = parser->errors;
+   part->lines     = parser->line - 1;
+   part->errorLine = parser->errorLine;
+   (void)strcpy (part->message, parser->message);
+   (void)cfi_parser_del (&parser);
+
+   return NULL;
+   }
+
+
+/*****************************************************************************
+ * Private Function part_error
+ *****************************************************************************
+ *
+ * This function reports the first error of a part as the error of the parse;
+ * "a_lines" is the number of lines before the part, so the line of the error
+ * is the same as from a parse of the whole text.  The message of the part
+ * starts with its line, "line %d:", which is put back with the line in the
+ * whole text.
+ *
+ *****************************************************************************/
+
+static void part_error (CFI_parser_t a_parser, S_part_t* a_part, int a_lines)
+   {
+   const char* text = strchr (a_part->message, ':');
+
+   if ((a_part->errors < 0) || (text == NULL))
+      {
+      cfi_parse_error (a_parser, "can't allocate memory", NULL);
+      return;
+      }
+
+   a_parser->line      = a_lines + a_part->errorLine;
+   a_parser->errors    = a_part->errors;
+   a_parser->errorLine = a_parser->line;
+   (void)sprintf (a_parser->message, "line %d%.80s", a_parser->line, text);
+   }
+
+
+/*****************************************************************************
+ * Private Function parse_wave
+ *****************************************************************************
+ *
+ * This function parses the parts "a_first", "a_first"+"a_waves" and so on at
+ * the same time; this thread parses the first of them, and any part that
+ * didn't get its own thread.  If there is more than one wave, two '\0' bytes
+ * are put after each part, over the start of the next part, which is in
+ * another wave, and the bytes are put back after the wave.  The last part
+ * ends with the buffer, which has them.
+ *
+ *****************************************************************************/
+
+static void parse_wave (
+                       S_part_t* a_parts,
+                       size_t    a_count,
+                       size_t    a_first,
+                       size_t    a_waves
+                       )
+   {
+   size_t i;
+
+   for (i = a_first ; (a_waves > 1) && (i < (a_count - 1)) ; i += a_waves)
+      {
+      a_parts[i].ends[0] = a_parts[i].buff[a_parts[i].leng];
+      a_parts[i].ends[1] = a_parts[i].buff[a_parts[i].leng+1];
+      a_parts[i].buff[a_parts[i].leng]   = '\0';
+      a_parts[i].buff[a_parts[i].leng+1] = '\0';
+      }
+
+   for (i = a_first + a_waves ; i < a_count ; i += a_waves)
+      {
+      if (pthread_create(&a_parts[i].id,NULL,part_parse,&a_parts[i]) == 0)
+         {
+         a_parts[i].thread = 1;
+         }
+      }
+   for (i = a_first ; i < a_count ; i += a_waves)
+      {
+      if (a_parts[i].thread)
+         (void)pthread_join (a_parts[i].id, NULL);
+      else
+         (void)part_parse (&a_parts[i]);
+      }
+
+   for (i = a_first ; (a_waves > 1) && (i < (a_count - 1)) ; i += a_waves)
+      {
+      a_parts[i].buff[a_parts[i].leng]   = a_parts[i].ends[0];
+      a_parts[i].buff[a_parts[i].leng+1] = a_parts[i].ends[1];
+      }
+   }
+
+
+/*****************************************************************************
+ * Private Function parse_parallel
+ *****************************************************************************
+ *
+ * This function cuts the text into parts that are lists of whole top level
+ * items, parses the parts in place at the same time with threads of their
+ * own, and joins the chains of nodes in order, so the nodes are the same as
+ * from a parse of the whole text.  Each part has an arena of its own, if the
+ * parse has one, and the arena of the parse takes them over.
+ *
+ * An error in a part is the error of the parse, with its line in the whole
+ * text: the parts before the first part with an error were parsed to their
+ * ends, so their lines are known.  It returns -1, and nothing is made, only
+ * if the text isn't cut; then the whole text is parsed the usual way.
+ *
+ *****************************************************************************/
+
+static int parse_parallel (CFI_parser_t a_parser, char* a_buff, size_t a_leng)
+   {
+   S_part_t   parts[PARSE_THREADS];
+   size_t     cuts[PARSE_THREADS];
+   S_nodes_t  nodes;
+   CFI_node_t node;
+   size_t     start = 0;
+   size_t     waves = cfi_lex_bounded() ? 1 : PARSE_WAVES;
+   size_t     count = a_parser->threads * waves;
+   size_t     i;
+   int        lines = 0;
+
+   if (count > PARSE_THREADS) count = PARSE_THREADS;
+   if (count > (a_leng / PARSE_PART)) count = a_leng / PARSE_PART;
+   if (count < 2) return -1;
+
+   count = cfi_lex_split (a_parser, a_buff, a_leng, cuts, (int)count);
+   if (count < 2) return -1;
+
+   for (i = 0 ; i < count ; i++)
+      {
+      parts[i].buff   = &a_buff[start];
+      parts[i].leng   = cuts[i] - start;
+      parts[i].offset = a_parser->offset + start;
+      parts[i].node   = NULL;
+      parts[i].errors = -1;
+      parts[i].thread = 0;
+      parts[i].arena  = NULL;
+      if (a_parser->arena != NULL)
+         {
+         parts[i].arena = cfi_arena_new (
+                                        a_parser->arena->blockSize,
+                                        &a_parser->arena->allocator
+                                        );
+         if (parts[i].arena == NULL) a_parser->arena->mixed = 1;
+         }
+      start = cuts[i];
+      }
+
+   for (i = 0 ; i < waves ; i++) parse_wave (parts, count, i, waves);
+
+   nodes.head = NULL;
+   nodes.tail = NULL;
+   for (i = 0 ; i < count ; i++)
+      {
+      if (parts[i].arena != NULL)
+         {
+         cfi_arena_adopt (a_parser->arena, parts[i].arena);
+         }
+      if ((parts[i].errors != 0) && (a_parser->errors == 0))
+         part_error (a_parser, &parts[i], lines);
+      else
+         lines += parts[i].lines;
+      if (parts[i].node == NULL) continue;
+      nodes_append (&nodes, parts[i].node);
+      for (node = parts[i].node ; cfi_node_next(node) != NULL ; )
+         {
+         node = cfi_node_next (node);
+         }
+      nodes.tail = node;
+      }
+
+   /*
+    * actions_done() deletes the nodes if there is an error.
+    */
+   if (a_parser->errors == 0) a_parser->line = 1 + lines;
+   a_parser->node = nodes.head;
+
+   return 0;
+   }
+#endif
+
+
+/*****************************************************************************
+ * Private Function parse
+ *****************************************************************************/
+
+static CFI_node_t parse (
+                        CFI_parser_t a_parser,
+                        const char*  a_text,
+                        char*        a_buff,
+                        size_t       a_leng
+                        )
+   {
+   actions_init (a_parser);
+
+   /*
+    * The event parse makes no nodes, so there is nothing to start over with.
+    */
+   if (a_parser->events != NULL)
+      {
+      if (a_buff != NULL)
+         cfi_lex_buffer (a_parser, a_buff, a_leng);
+      else
+         cfi_lex_text (a_parser, a_text);
+      events (a_parser);
+      cfi_lex_end (a_parser);
+      return NULL;
+      }
+
+   /*
+    * The nodes of the document are made from an arena of its own, unless
+    * the arena can't be made.
+    */
+   if (arena_size(a_parser) != 0)
+      {
+      a_parser->arena = cfi_arena_new (
+                                      arena_size(a_parser),
+                                      a_parser->allocator
+                                      );
+      }
+
+#ifdef	_unix
+   /*
+    * A big buffer, with threads.
+    */
+   if ((a_buff != NULL) && (a_parser->threads > 1) &&
+       (a_parser->source == NULL) && !CFI_debugLexical && !CFI_debugGrammar)
+      {
+      if (parse_parallel(a_parser,a_buff,a_leng) == 0)
+         {
+         return actions_done (a_parser);
+         }
+      }
+#endif
+
+   /*
+    * The quick way, unless the grammar is debugging; yyparse() shows what
+    * it does.  actions_done() deletes what it made after an error.
+    */
+   if (a_buff != NULL)
+      cfi_lex_buffer (a_parser, a_buff, a_leng);
+   else
+      cfi_lex_text (a_parser, a_text);
+   if (CFI_debugGrammar)
+      (void)yyparse (a_parser);
+   else
+      (void)build (a_parser);
+   cfi_lex_end (a_parser);
+
+   return actions_done (a_parser);
+   }
+
+
 /* ************************************************************************* */
 /*                                                                           */
 /*      E x e c u t a b l e   C o d e   (External Interface Functions)       */
@@ -300,21 +1407,45 @@ static __inline__ void actions_dump (const char* const a_text)
 
 /*****************************************************************************
  * Public Function cfi_parse_file
+ *****************************************************************************
+ *
+ * The tokens from the lexical analyzer point into its input buffer, so the
+ * entire stream is read into one buffer and then parsed in place.
+ *
  *****************************************************************************/
 
-CFI_node_t (cfi_parse_file) (FILE* a_file)
+CFI_node_t (cfi_parse_file) (CFI_parser_t a_parser, FILE* a_file)
    {
-   CFI_node_t node;
+   char*  buff = NULL;
+   char*  p;
+   size_t size = 0;
+   size_t leng = 0;
+   size_t n;
 
-   cfi_lex_init (a_file, NULL);
-   actions_init();
-
-   (void)yyparse();
+   for (;;)
+      {
+      if ((size - leng) < (BUFSIZ + 2))
+         {
+         size = size == 0 ? 4 * BUFSIZ : size * 2;
+         p    = (char*)_cfi_realloc (buff, size);
+         if (p == NULL)
+            {
+            _cfi_free (buff);
+            actions_init (a_parser);
+            cfi_parse_error (a_parser, "can't allocate memory", NULL);
+            return NULL;
+            }
+         buff = p;
+         }
+      n = fread (&buff[leng], 1, size-leng-2, a_file);
+      if (n == 0) break;
+      leng += n;
+      }
 
-   node = actions_done();
-   cfi_lex_done();
+   buff[leng]   = '\0';
+   buff[leng+1] = '\0';
 
-   return node;
+   return cfi_parse_source (a_parser, buff, leng, 0);
    }
 
 
@@ -322,19 +1453,365 @@ CFI_node_t (cfi_parse_file) (FILE* a_file)
  * Public Function cfi_parse_text
  *****************************************************************************/
 
-CFI_node_t (cfi_parse_text) (const char* a_text)
+CFI_node_t (cfi_parse_text) (CFI_parser_t a_parser, const char* a_text)
    {
-   CFI_node_t node;
+   return parse (a_parser, a_text, NULL, 0);
+   }
+
 
-   void* yy_scan_string (const char*);
-   void  yy_delete_buffer (void*);
-   void* bufstate;
+/*****************************************************************************
+ * Public Function cfi_parse_buffer
+ *****************************************************************************
+ *
+ * This function parses "a_leng" bytes of text in place; the buffer must have
+ * two '\0' bytes after the text, i.e., a_buff[a_leng] and a_buff[a_leng+1].
+ * The lexical analyzer may write into the buffer while parsing, but the text
+ * is the same when this function returns.
+ *
+ *****************************************************************************/
 
-   bufstate = (void*)yy_scan_string (a_text);
-   node = cfi_parse_file (NULL);
-   (void)yy_delete_buffer (bufstate);
+CFI_node_t (cfi_parse_buffer) (CFI_parser_t a_parser, char* a_buff, size_t a_leng)
+   {
+   return parse (a_parser, NULL, a_buff, a_leng);
+   }
 
-   return node;
+
+/*****************************************************************************
+ * Public Function _cfi_lazy_parse
+ *****************************************************************************
+ *
+ * This function parses the body of a lazy section, as a span of the document,
+ * and then deletes the lazy section; the sections in the body are parsed right
+ * away.  The nodes are made from "a_arena", the arena of the section, if it
+ * has one.  "a_offset" is where the body is in the document, for the source
+ * spans.  It returns NULL, or why there are no nodes.
+ *
+ *****************************************************************************/
+
+const char* (_cfi_lazy_parse) (
+                              S_arena_t*  a_arena,
+                              S_lazy_t*   a_lazy,
+                              size_t      a_offset,
+                              CFI_node_t* a_node
+                              )
+   {
+   const char* msg = _cfi_span_parse (
+                                     a_arena,
+                                     a_lazy->body,
+                                     a_lazy->leng,
+                                     a_offset,
+                                     a_node
+                                     );
+   _cfi_lazy_del (a_lazy);
+
+   return msg;
+   }
+
+
+/*****************************************************************************
+ * Public Function _cfi_span_parse
+ *****************************************************************************
+ *
+ * This function parses a span of the document text that cfi_reparse() wants
+ * parsed again; "a_offset" is where the span is in the document.  The span is
+ * a list of whole items, and it must not end in a comment or a string, or the
+ * text after it would be read differently; so it is first skipped as though
+ * it were a section body with a '}' put after it, and that '}' has to be the
+ * one that ends the body.  The nodes are made from "a_arena", the arena of
+ * the document, if it has one.  A span that a '}' already ends, such as the
+ * body of a lazy section, is read in place when the lexical analyzer is
+ * bounded; otherwise it is copied, with a '}' and two '\0' bytes after it.
+ *
+ *****************************************************************************/
+
+const char* (_cfi_span_parse) (
+                              S_arena_t*  a_arena,
+                              const char* a_text,
+                              size_t      a_leng,
+                              size_t      a_offset,
+                              CFI_node_t* a_node
+                              )
+   {
+   CFI_parser_t parser;
+   const char*  body;
+   const char*  msg  = NULL;
+   char*        buff = (char*)a_text; /* The scanner doesn't write it. */
+   size_t       leng;
+
+   *a_node = NULL;
+
+   if (!cfi_lex_bounded() || (a_text[a_leng] != '}'))
+      {
+      buff = (char*)_cfi_malloc (a_leng+3);
+      if (buff == NULL) return "can't allocate memory";
+      (void)memcpy (buff, a_text, a_leng);
+      buff[a_leng]   = '}';
+      buff[a_leng+1] = '\0';
+      buff[a_leng+2] = '\0';
+      }
+   if (cfi_parser_new(&parser) != NULL)
+      {
+      if (buff != a_text) _cfi_free (buff);
+      return "can't allocate memory";
+      }
+
+   cfi_lex_buffer (parser, buff, a_leng+1);
+   if ((cfi_lex_skip(parser,&body,&leng) != 0) ||
+       (cfi_lex_offset(parser) != a_leng))
+      {
+      msg = "syntax error";
+      }
+   cfi_lex_end (parser);
+
+   if (msg == NULL)
+      {
+      if (buff != a_text)
+         {
+         buff[a_leng]   = '\0';
+         buff[a_leng+1] = '\0';
+         }
+      parser->offset = a_offset;
+      parser->arena  = a_arena;
+      *a_node = cfi_parse_buffer (parser, buff, a_leng);
+      if (parser->errors != 0) msg = "syntax error";
+      }
+
+   (void)cfi_parser_del (&parser);
+   if (buff != a_text) _cfi_free (buff);
+
+   return msg;
+   }
+
+
+/*****************************************************************************
+ * Public Function _cfi_lazy_del
+ *****************************************************************************/
+
+void (_cfi_lazy_del) (S_lazy_t* a_lazy)
+   {
+   cfi_source_release (a_lazy->source);
+   _cfi_free (a_lazy);
+   }
+
+
+/*****************************************************************************
+ * Public Function _cfi_lazy_usage
+ *****************************************************************************
+ *
+ * This function counts a lazy section in the memory of a document, and the
+ * input text it is in, if that is not "*a_source", which it becomes; the text
+ * is shared by the lazy sections of a parse.
+ *
+ *****************************************************************************/
+
+void (_cfi_lazy_usage) (
+                       S_lazy_t*     a_lazy,
+                       CFI_memory_t* a_stats,
+                       void**        a_source
+                       )
+   {
+   S_source_t* source = a_lazy->source;
+
+   _cfi_memory_heap (a_stats, sizeof(S_lazy_t));
+   a_stats->sources     += 1;
+   a_stats->sourceBytes += sizeof(S_lazy_t);
+
+   if ((void*)source == *a_source) return;
+   *a_source = source;
+   _cfi_memory_heap (a_stats, sizeof(S_source_t));
+   a_stats->sourceBytes += sizeof(S_source_t) + source->leng + 2;
+   if (source->mapSize == 0) _cfi_memory_heap (a_stats, source->leng + 2);
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_parse_error
+ *****************************************************************************
+ *
+ * This function is used by the lexical analyzer to report a syntax error.
+ * The text of the first syntax error is kept in the parser context.
+ *
+ *****************************************************************************/
+
+void (cfi_parse_error) (
+                       CFI_parser_t a_parser,
+                       const char*  a_message,
+                       const char*  a_offending
+                       )
+   {
+   if (a_offending == NULL) a_offending = "";
+
+   if (a_parser->errors++ == 0)
+      {
+      a_parser->errorLine = a_parser->line;
+      (void)sprintf (
+                    a_parser->message,
+                    "line %d: %.32s near \"%.32s\"",
+                    a_parser->line,
+                    a_message,
+                    a_offending
+                    );
+      }
+
+   if (a_parser->errorfn != NULL)
+      {
+      (*a_parser->errorfn) (
+                           a_parser->line,
+                           (char*)a_message,
+                           (char*)a_offending
+                           );
+      }
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_parser_new
+ *****************************************************************************/
+
+const char* (cfi_parser_new) (CFI_parser_t* const a_parser)
+   {
+   S_parser_t* parser = (S_parser_t*)_cfi_calloc (1, sizeof(S_parser_t));
+
+   if (parser == NULL) return "can't allocate memory";
+
+   parser->scanner      = NULL;
+   parser->errorfn      = NULL;
+   parser->node         = NULL;
+   parser->events       = NULL;
+   parser->user         = NULL;
+   parser->lazy         = 0;
+   parser->threads      = cfi_conf_threads (0);
+   parser->source       = NULL;
+   parser->offset       = 0;
+   parser->arenaSize    = 0;
+   parser->arena        = NULL;
+   parser->allocator    = NULL;
+   parser->line         = 0;
+   parser->oldState     = 0;
+   parser->blockComment = 0;
+   parser->errors       = 0;
+   parser->errorLine    = 0;
+   parser->message[0]   = '\0';
+
+   if (cfi_lex_init(parser) != NULL)
+      {
+      _cfi_free (parser);
+      return "can't allocate memory";
+      }
+
+   *a_parser = parser;
+
+   return NULL;
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_parser_del
+ *****************************************************************************/
+
+const char* (cfi_parser_del) (CFI_parser_t* const a_parser)
+   {
+   if (*a_parser == NULL) return "there is no parser";
+
+   cfi_lex_done (*a_parser);
+   _cfi_free ((*a_parser)->allocator);
+   _cfi_free (*a_parser);
+   *a_parser = NULL;
+
+   return NULL;
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_parser_line
+ *****************************************************************************/
+
+int (cfi_parser_line) (CFI_parser_t const a_parser)
+   {
+   return a_parser->line;
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_parser_threads
+ *****************************************************************************/
+
+const char* (cfi_parser_threads) (
+                                 CFI_parser_t const a_parser,
+                                 unsigned           a_threads
+                                 )
+   {
+   if (a_threads == 0) return "no threads";
+   a_parser->threads = a_threads;
+   return NULL;
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_parser_arena
+ *****************************************************************************
+ *
+ * This function makes each document that the parser makes from then on have
+ * an arena of its own, with blocks of "a_blockSize" bytes; zero is for none.
+ *
+ *****************************************************************************/
+
+const char* (cfi_parser_arena) (
+                               CFI_parser_t const a_parser,
+                               size_t             a_blockSize
+                               )
+   {
+   a_parser->arenaSize = a_blockSize;
+   return NULL;
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_parser_allocator
+ *****************************************************************************
+ *
+ * This function makes each document that the parser makes from then on have
+ * its memory from "a_allocator", in an arena; NULL is for the allocator of
+ * libcfi.  The parser keeps a copy of the allocator.
+ *
+ *****************************************************************************/
+
+const char* (cfi_parser_allocator) (
+                                   CFI_parser_t           const a_parser,
+                                   const CFI_allocator_t* const a_allocator
+                                   )
+   {
+   CFI_allocator_t* allocator = NULL;
+
+   if (a_allocator != NULL)
+      {
+      if ((a_allocator->malloc_hook == NULL) ||
+          (a_allocator->calloc_hook == NULL) ||
+          (a_allocator->realloc_hook == NULL) ||
+          (a_allocator->free_hook == NULL))
+         {
+         return "missing allocator function";
+         }
+      allocator = (CFI_allocator_t*)_cfi_malloc (sizeof(CFI_allocator_t));
+      if (allocator == NULL) return "can't allocate memory";
+      *allocator = *a_allocator;
+      }
+
+   _cfi_free (a_parser->allocator);
+   a_parser->allocator = allocator;
+
+   return NULL;
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_parser_lazy
+ *****************************************************************************/
+
+const char* (cfi_parser_lazy) (CFI_parser_t const a_parser, int a_lazy)
+   {
+   a_parser->lazy = a_lazy != 0;
+   return NULL;
    }
 
 
@@ -0,0 +1,1127 @@
+/*
+ * This file is part of the CFI software.
+ * The license which this software falls under is as follows:
+ *
+ * Copyright (C) 1999-2005 Douglas Jerome <douglas@ttylinux.org>
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or (at
+ * your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+/* *****************************************************************************
+
+FILE NAME
+
+	Name:     scan.c
+	Revision: 1.0
+
+PROGRAM INFORMATION
+
+	Developed by:	CFI project
+
+FILE DESCRIPTION
+
+	Configuration File Interface: Hand Written Lexical Analyzer
+
+	This file implements the same lexical analyzer as "lex.l", without
+	flex; use "make SCANNER=hand" to build the library with this file
+	instead of "lex.l".  It gives the parser the same tokens as "lex.l".
+
+	The input is scanned in place.  Whitespace, comments and strings are
+	skipped in tight loops, and word and string tokens are a pointer into
+	the input and a length; nothing is allocated or copied per token.
+
+	A line comment ends with a newline, as the "$" of the comment rules
+	in "lex.l" says; at the end of the input, without a newline, its
+	characters are tokens, just as they are from flex.
+
+	The scan stops at the end of the input, and it never writes into the
+	input, so a part of a buffer or a section body can be scanned where
+	it is, and a file can be mapped read only.  The character after the
+	input always ends a token: it is a '\0', or the ';' or '}' that ends
+	a part or a body.  So looking one character ahead within a token never
+	needs a bounds check; an embedded '\0' is garbage, like any other
+	character that is not part of the CFI syntax.
+
+	Define CFI_SCAN_INDEX to scan in two stages.  The first stage, in
+	"index.c", finds the structural characters, the strings and the runs
+	of other characters in a window of the input with SIMD compares,
+	skipping whitespace, comments and string interiors; the second stage,
+	here, makes tokens from those marks, and only looks at the characters
+	of the tokens.  The scan is direct, one character at a time, when
+	CFI_SCAN_INDEX is not defined or there isn't memory for the index.
+	The direct scan is the default: the tokens of a configuration file
+	are short and dense, and the index pays for itself only on inputs
+	that are mostly long strings and comments.
+
+***************************************************************************** */
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      F e a t u r e   S w i t c h e s                                      */
+/*                                                                           */
+/* ************************************************************************* */
+
+/*
+ * Select these feature by moving them from the `if UNDEF' into the `else'
+ * section.
+ */
+#ifdef	UNDEF
+#   define	_BSD_SOURCE	1	/* 4.3+bsd subsystems           */
+#   define	_POSIX_SOURCE	1	/* posix.1                      */
+#   define	_POSIX_C_SOURCE	199309L	/* posix.1 and posix.4          */
+#   define	_POSIX_C_SOURCE	199506L	/* posix.1 and posix.4 and MORE */
+#else
+#   define	_POSIX_C_SOURCE	200112L	/* posix.1 and posix.4 and MORE */
+#   undef	_REENTRANT
+#   define	_REENTRANT		/* thread-safe for glibc        */
+#endif
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      I n c l u d e d   F i l e s                                          */
+/*                                                                           */
+/* ************************************************************************* */
+
+/*
+ * OS Specific Header Files
+ */
+#ifdef	WIN32
+#   include	"stdafx.h"
+#endif
+
+/*
+ * Standard C (ANSI) Header Files
+ */
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+
+/*
+ * Posix Header Files
+ */
+#ifndef	WIN32
+#   include	<unistd.h> /* always first amongst POSIX header files */
+#endif
+
+/*
+ * Project Specific Header Files
+ */
+#include	"CFI.h"
+#include	"lex.h"
+#include	"index.h"
+#include	"parse.h"
+#include	"y.tab.h"
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      C o n s t a n t s                                                    */
+/*                                                                           */
+/* ************************************************************************* */
+
+#define	IS_DIGIT(c)	(((c) >= '0') && ((c) <= '9'))
+#define	IS_ALPHA(c)	((((c) >= 'A') && ((c) <= 'Z')) || \
+			 (((c) >= 'a') && ((c) <= 'z')))
+#define	IS_ALNUM(c)	(IS_ALPHA(c) || IS_DIGIT(c))
+#define	IS_XDIGIT(c)	(IS_DIGIT(c) || \
+			 (((c) >= 'A') && ((c) <= 'F')) || \
+			 (((c) >= 'a') && ((c) <= 'f')))
+#define	IS_ODIGIT(c)	(((c) >= '0') && ((c) <= '7'))
+#define	IS_BDIGIT(c)	(((c) == '0') || ((c) == '1'))
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      E x t e r n a l   R e f e r e n c e s                                */
+/*                                                                           */
+/* ************************************************************************* */
+
+/* (none) */
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      D a t a   T y p e s   a n d   S t r u c t u r e s                    */
+/*                                                                           */
+/* ************************************************************************* */
+
+typedef struct S_scan_t
+   {
+   CFI_parser_t parser;  /* the parser, to report number errors     */
+   const char*  text;    /* start of the input text                */
+   const char*  next;    /* next character to scan                 */
+   const char*  end;     /* end of the input text                  */
+   const char*  token;   /* text of the last token, for errors     */
+   size_t       leng;    /* length of the text of the last token   */
+   int          debug;   /* CFI_debugLexical when the scan started */
+   int          indexed; /* the scan uses the index                */
+   int          run;     /* "next" is in a run of the index        */
+   size_t       mark;    /* next mark of the index                 */
+   S_index_t    index;   /* the structural index                   */
+   }
+   S_scan_t;
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      P u b l i c   G l o b a l   V a r i a b l e s                        */
+/*                                                                           */
+/* ************************************************************************* */
+
+/* (none) */
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      P r i v a t e   G l o b a l   V a r i a b l e s                      */
+/*                                                                           */
+/* ************************************************************************* */
+
+/* (none) */
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      E x e c u t a b l e   C o d e   (Locally Used Functions)             */
+/*                                                                           */
+/* ************************************************************************* */
+
+
+/*****************************************************************************
+ * Private Function Prototypes
+ *****************************************************************************/
+
+static __inline__ size_t radix_leng (const char* text, int x, int base);
+static int number_make (S_scan_t* scan, YYSTYPE* lval, const char* text);
+static void token_debug (int token, YYSTYPE* lval);
+static int string_make (
+                       S_scan_t*   scan,
+                       YYSTYPE*    lval,
+                       const char* text,
+                       const char* end
+                       );
+static int token_make (S_scan_t* scan, YYSTYPE* lval, const char* text);
+static __inline__ int run_end (const S_scan_t* scan, const char* text);
+static __inline__ const char* comment_end (
+                                          CFI_parser_t    parser,
+                                          const S_scan_t* scan,
+                                          const char*     text
+                                          );
+static __inline__ const char* string_end (
+                                         CFI_parser_t    parser,
+                                         const S_scan_t* scan,
+                                         const char*     text
+                                         );
+static int lex_index (CFI_parser_t parser, S_scan_t* scan, YYSTYPE* lval);
+static int lex_direct (CFI_parser_t parser, S_scan_t* scan, YYSTYPE* lval);
+static void scan_start (CFI_parser_t parser, const char* text, size_t leng);
+
+
+/*****************************************************************************
+ * Private Function radix_leng
+ *****************************************************************************
+ *
+ * This function returns the length of a "0x", "0o" or "0b" number at "a_text"
+ * or zero if there isn't one; "a_x" is the lower case radix letter.
+ *
+ *****************************************************************************/
+
+static __inline__ size_t radix_leng (const char* a_text, int a_x, int a_base)
+   {
+   const char* p = a_text + 2;
+
+   if ((a_text[0] != '0') || ((a_text[1] | 0x20) != a_x)) return 0;
+
+   switch (a_base)
+      {
+      case 16: while (IS_XDIGIT(*p)) p++; break;
+      case 8:  while (IS_ODIGIT(*p)) p++; break;
+      default: while (IS_BDIGIT(*p)) p++; break;
+      }
+
+   return p == a_text + 2 ? 0 : (size_t)(p - a_text);
+   }
+
+
+/*****************************************************************************
+ * Private Function number_make
+ *****************************************************************************
+ *
+ * This function scans a number, as the flex rules in "lex.l" do: the longest
+ * of the number patterns wins, and the first pattern in "lex.l" wins a tie.
+ * A '+', '-' or '.' that does not start a number is a symbol.
+ *
+ *****************************************************************************/
+
+static int number_make (S_scan_t* a_scan, YYSTYPE* a_lval, const char* a_text)
+   {
+   const char* p = a_text;
+   const char* digits;
+   const char* msg;
+   size_t      expLeng = 0;
+   size_t      numLeng = 0;
+   size_t      leng;
+   int         token;
+
+   if ((*p == '-') || (*p == '+')) p++;
+   digits = p;
+   while (IS_DIGIT(*p)) p++;
+   if (p != digits) numLeng = p - a_text;
+
+   if ((p[0] == '.') && IS_DIGIT(p[1]))
+      {
+      const char* e;
+      for (p += 2 ; IS_DIGIT(*p) ; p++) ;
+      e = p + 1;
+      if ((*e == '-') || (*e == '+')) e++;
+      if (((*p == 'e') || (*p == 'E')) && IS_DIGIT(*e))
+         {
+         for (p = e + 1 ; IS_DIGIT(*p) ; p++) ;
+         }
+      expLeng = p - a_text;
+      }
+
+   token = CFIYY_REALNUM;
+   leng  = expLeng;
+   if (radix_leng(a_text,'x',16) > leng)
+      {
+      token = CFIYY_HEXNUM;
+      leng  = radix_leng (a_text, 'x', 16);
+      }
+   if (numLeng > leng)
+      {
+      token = CFIYY_DECNUM;
+      leng  = numLeng;
+      }
+   if (radix_leng(a_text,'o',8) > leng)
+      {
+      token = CFIYY_OCTNUM;
+      leng  = radix_leng (a_text, 'o', 8);
+      }
+   if (radix_leng(a_text,'b',2) > leng)
+      {
+      token = CFIYY_BINNUM;
+      leng  = radix_leng (a_text, 'b', 2);
+      }
+
+   if (leng == 0) return 0; /* It's a symbol. */
+
+   a_scan->token = a_text;
+   a_scan->leng  = leng;
+   a_scan->next  = a_text + leng;
+
+   switch (token)
+      {
+      case CFIYY_REALNUM:
+         msg = cfi_number_real (a_text, leng, &a_lval->real);
+         break;
+      case CFIYY_HEXNUM:
+         msg = cfi_number_integer (a_text, leng, 16, &a_lval->num);
+         break;
+      case CFIYY_DECNUM:
+         msg = cfi_number_integer (a_text, leng, 10, &a_lval->num);
+         break;
+      case CFIYY_OCTNUM:
+         msg = cfi_number_integer (a_text, leng, 8, &a_lval->num);
+         break;
+      default:
+         msg = cfi_number_integer (a_text, leng, 2, &a_lval->num);
+         break;
+      }
+   if (msg != NULL) cfi_lex_error (a_scan->parser, msg);
+
+   return token;
+   }
+
+
+/*****************************************************************************
+ * Private Function token_debug
+ *****************************************************************************
+ *
+ * This function prints a token just as the flex scanner in "lex.l" does.
+ *
+ *****************************************************************************/
+
+static void token_debug (int a_token, YYSTYPE* a_lval)
+   {
+   char buff[36];
+
+   switch (a_token)
+      {
+      default:
+         printf ("<LEX symbol>: \"%c\"\n", (char)a_token);
+         break;
+      case CFIYY_STRING:
+         printf (
+                "<LEX>CFIYY_STRING: \"%.*s\"\n",
+                (int)a_lval->text.leng,
+                a_lval->text.text
+                );
+         break;
+      case CFIYY_WORD:
+         printf (
+                "<LEX>CFIYY_WORD: \"%.*s\"\n",
+                (int)a_lval->text.leng,
+                a_lval->text.text
+                );
+         break;
+      case CFIYY_REALNUM:
+         printf ("<LEX>CFIYY_REALNUM: %+12.6E\n", a_lval->real);
+         break;
+      case CFIYY_HEXNUM:
+         printf ("<LEX>CFIYY_HEXNUM: 0x%08lx\n", (unsigned long)a_lval->num);
+         break;
+      case CFIYY_DECNUM:
+         printf ("<LEX>CFIYY_DECNUM: %ld\n", (long)a_lval->num);
+         break;
+      case CFIYY_OCTNUM:
+         printf (
+                "<LEX>CFIYY_OCTNUM: %s\n",
+                cfi_string_octal (buff, a_lval->num)
+                );
+         break;
+      case CFIYY_BINNUM:
+         printf (
+                "<LEX>CFIYY_BINNUM: %s\n",
+                cfi_string_binary (buff, a_lval->num)
+                );
+         break;
+      }
+   }
+
+
+/*****************************************************************************
+ * Private Function string_make
+ *****************************************************************************
+ *
+ * This function makes the string token for the text from "a_text" up to the
+ * closing '"' at "a_end".
+ *
+ *****************************************************************************/
+
+static int string_make (
+                       S_scan_t*   a_scan,
+                       YYSTYPE*    a_lval,
+                       const char* a_text,
+                       const char* a_end
+                       )
+   {
+   a_lval->text.text = a_text;
+   a_lval->text.leng = a_end - a_text;
+   a_scan->token = a_text;
+   a_scan->leng  = a_end + 1 - a_text;
+   a_scan->next  = a_end + 1;
+   if (a_scan->debug) token_debug (CFIYY_STRING, a_lval);
+   return CFIYY_STRING;
+   }
+
+
+/*****************************************************************************
+ * Private Function token_make
+ *****************************************************************************
+ *
+ * This function makes the word, number or symbol token at "a_text", or skips
+ * one character of garbage and returns zero.
+ *
+ *****************************************************************************/
+
+static int token_make (S_scan_t* a_scan, YYSTYPE* a_lval, const char* a_text)
+   {
+   const char* p = a_text;
+   int         token;
+
+   /*
+    * Words.
+    */
+   if (IS_ALPHA(*p))
+      {
+      for (p++ ; ; )
+         {
+         if (IS_ALNUM(*p))
+            p++;
+         else if ((p[0] == '_') && IS_ALNUM(p[1]))
+            p += 2;
+         else
+            break;
+         }
+      a_lval->text.text = a_text;
+      a_lval->text.leng = p - a_text;
+      a_scan->token = a_text;
+      a_scan->leng  = p - a_text;
+      a_scan->next  = p;
+      if (a_scan->debug) token_debug (CFIYY_WORD, a_lval);
+      return CFIYY_WORD;
+      }
+
+   /*
+    * Numbers, then symbols.
+    */
+   if (IS_DIGIT(*p) || (*p == '-') || (*p == '+') || (*p == '.'))
+      {
+      token = number_make (a_scan, a_lval, p);
+      if (token != 0)
+         {
+         if (a_scan->debug) token_debug (token, a_lval);
+         return token;
+         }
+      }
+
+   switch (*p)
+      {
+      case '!': case '@': case '#': case '$': case '%': case '^':
+      case '&': case '*': case '(': case ')': case '_': case '+':
+      case '|': case '~': case '-': case '=': case '\\': case '`':
+      case '{': case '}': case '[': case ']': case ':': case '"':
+      case ';': case '\'': case '<': case '>': case '?': case ',':
+      case '.': case '/':
+         token = (unsigned char)*p;
+         a_lval->num   = token;
+         a_scan->token = p;
+         a_scan->leng  = 1;
+         a_scan->next  = p + 1;
+         if (a_scan->debug) token_debug (token, a_lval);
+         return token;
+      }
+
+   if (a_scan->debug)
+      {
+      printf ("<Lexical TRASH -->");
+      printf ("%c", *p);
+      printf ("<-- Lexical TRASH>");
+      }
+   a_scan->next = p + 1;
+
+   return 0;
+   }
+
+
+/*****************************************************************************
+ * Private Function run_end
+ *****************************************************************************
+ *
+ * This function tells whether a run of the index ends at "a_text": a run ends
+ * at whitespace, at a structural character, '"' or comment, or at the end of
+ * the input.
+ *
+ *****************************************************************************/
+
+static __inline__ int run_end (const S_scan_t* a_scan, const char* a_text)
+   {
+   if (a_text >= a_scan->end) return 1;
+
+   switch (*a_text)
+      {
+      case ' ': case '\t': case '\f': case '\n': case '"': case '#':
+      case '{': case '}': case '(': case ')': case '=': case ',': case ';':
+         return 1;
+      case '-':
+         return a_text[1] == '-';
+      case '/':
+         return (a_text[1] == '/') || (a_text[1] == '*');
+      }
+   return 0;
+   }
+
+
+/*****************************************************************************
+ * Private Function comment_end
+ *****************************************************************************
+ *
+ * This function returns the end of the block comment that starts at "a_text";
+ * block comments nest, so the comment ends where its nesting level is zero.
+ *
+ *****************************************************************************/
+
+static __inline__ const char* comment_end (
+                                          CFI_parser_t    a_parser,
+                                          const S_scan_t* a_scan,
+                                          const char*     a_text
+                                          )
+   {
+   const char* p    = a_text;
+   int         nest = 1;
+
+   for (p += 2 ; (p < a_scan->end) && (nest > 0) ; )
+      {
+      if (*p == '\n')
+         {
+         a_parser->line++;
+         p++;
+         }
+      else if ((p[0] == '/') && (p[1] == '*'))
+         {
+         nest++;
+         p += 2;
+         }
+      else if ((p[0] == '*') && (p[1] == '/'))
+         {
+         nest--;
+         p += 2;
+         }
+      else
+         p++;
+      }
+
+   return p;
+   }
+
+
+/*****************************************************************************
+ * Private Function string_end
+ *****************************************************************************
+ *
+ * This function returns the '"' that ends the string whose text starts at
+ * "a_text", or NULL if the string doesn't end; the string ends at the first
+ * '"' that is not right after a '\'.  The newlines in the string are counted
+ * in the same pass, so a string full of escaped quotes or of lines, like a
+ * certificate, is looked at once.
+ *
+ *****************************************************************************/
+
+static __inline__ const char* string_end (
+                                         CFI_parser_t    a_parser,
+                                         const S_scan_t* a_scan,
+                                         const char*     a_text
+                                         )
+   {
+   const char* p;
+   int         lines = 0;
+
+   for (p = a_text ; p < a_scan->end ; p++)
+      {
+      if (*p == '\n')
+         lines++;
+      else if ((*p == '"') && ((p == a_text) || (p[-1] != '\\')))
+         {
+         a_parser->line += lines;
+         return p;
+         }
+      }
+
+   return NULL;
+   }
+
+
+/*****************************************************************************
+ * Private Function lex_index
+ *****************************************************************************
+ *
+ * This function makes the next token from the marks of the index.  A string
+ * is its two '"' marks, a structural character is a symbol, and the tokens of
+ * a run are made one after the other until the run ends.  The line is one
+ * more than the newlines before the mark.
+ *
+ *****************************************************************************/
+
+static int lex_index (CFI_parser_t a_parser, S_scan_t* a_scan, YYSTYPE* a_lval)
+   {
+   S_index_t*      index = &a_scan->index;
+   const S_mark_t* mark;
+   const char*     p;
+   int             token;
+
+   for (;;)
+      {
+      if (a_scan->run)
+         {
+         while (!run_end(a_scan,a_scan->next))
+            {
+            token = token_make (a_scan, a_lval, a_scan->next);
+            if (token != 0) return token;
+            }
+         a_scan->run = 0;
+         }
+
+      if (a_scan->mark == index->count)
+         {
+         if (cfi_index_next(index) == 0)
+            {
+            if (index->state != STATE_LINE) break;
+            a_parser->line  = 1 + index->total;
+            a_scan->next    = index->text + index->comment;
+            a_scan->indexed = 0;
+            return lex_direct (a_parser, a_scan, a_lval);
+            }
+         a_scan->mark = 0;
+         }
+      mark = &index->marks[a_scan->mark++];
+      p    = index->text + index->base + mark->offset;
+      a_parser->line = 1 + index->lines + mark->lines;
+
+      switch (*p)
+         {
+         case '"':
+            if (a_scan->mark == index->count)
+               {
+               if (cfi_index_next(index) == 0) break; /* The string doesn't */
+               a_scan->mark = 0;                      /* end.               */
+               }
+            mark = &index->marks[a_scan->mark++];
+            a_parser->line = 1 + index->lines + mark->lines;
+            return string_make (
+                               a_scan,
+                               a_lval,
+                               p + 1,
+                               index->text + index->base + mark->offset
+                               );
+         case '{': case '}': case '(': case ')': case '=': case ',': case ';':
+            return token_make (a_scan, a_lval, p);
+         default:
+            a_scan->next = p;
+            a_scan->run  = 1;
+            continue;
+         }
+
+      break;
+      }
+
+   a_parser->line = 1 + index->total;
+   a_scan->next  = a_scan->end;
+   a_scan->token = a_scan->end;
+   a_scan->leng  = 0;
+
+   return 0;
+   }
+
+
+/*****************************************************************************
+ * Private Function lex_direct
+ *****************************************************************************
+ *
+ * This function makes the next token by scanning the input one character at
+ * a time.
+ *
+ *****************************************************************************/
+
+static int lex_direct (CFI_parser_t a_parser, S_scan_t* a_scan, YYSTYPE* a_lval)
+   {
+   const char* p = a_scan->next;
+   const char* q;
+   int         token;
+
+   for (;;)
+      {
+
+      /*
+       * End of input.
+       */
+      if (p >= a_scan->end)
+         {
+         a_scan->next  = p;
+         a_scan->token = p;
+         a_scan->leng  = 0;
+         return 0;
+         }
+
+      switch (*p)
+         {
+
+         /*
+          * Whitespace and line comments.
+          */
+         case '\n':
+            a_parser->line++;
+            p++;
+            continue;
+
+         case ' ': case '\t': case '\f':
+            do p++; while ((*p == ' ') || (*p == '\t') || (*p == '\f'));
+            continue;
+
+         case '-':
+            if (p[1] != '-') break;
+            /* fall through */
+         case '#':
+         line_comment:
+            q = (const char*)memchr (p, '\n', a_scan->end - p);
+            if (q == NULL) break; /* No newline, so not a comment. */
+            p = q;
+            continue;
+
+         case '/':
+            if (p[1] == '/') goto line_comment;
+            if (p[1] == '*')
+               {
+               p = comment_end (a_parser, a_scan, p);
+               continue;
+               }
+            break;
+
+         /*
+          * Strings.
+          */
+         case '"':
+            q = string_end (a_parser, a_scan, p + 1);
+            if (q == NULL)
+               {
+               a_scan->next  = a_scan->end; /* The string doesn't end; */
+               a_scan->token = a_scan->end; /* that is the end of the  */
+               a_scan->leng  = 0;           /* input.                  */
+               return 0;
+               }
+            return string_make (a_scan, a_lval, p + 1, q);
+         }
+
+      /*
+       * Words, numbers and symbols, or garbage.
+       */
+      token = token_make (a_scan, a_lval, p);
+      if (token != 0) return token;
+      p = a_scan->next;
+      }
+   }
+
+
+/*****************************************************************************
+ * Private Function scan_start
+ *****************************************************************************/
+
+static void scan_start (
+                       CFI_parser_t a_parser,
+                       const char*  a_text,
+                       size_t       a_leng
+                       )
+   {
+   S_scan_t* scan = (S_scan_t*)a_parser->scanner;
+
+   scan->text    = a_text;
+   scan->next    = a_text;
+   scan->end     = a_text + a_leng;
+   scan->token   = a_text;
+   scan->leng    = 0;
+   scan->debug   = CFI_debugLexical;
+   scan->indexed = scan->index.marks != NULL;
+   scan->run     = 0;
+   scan->mark    = 0;
+   if (scan->indexed) cfi_index_start (&scan->index, a_text, a_leng);
+   a_parser->blockComment = 0;
+   }
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      E x e c u t a b l e   C o d e   (External Interface Functions)       */
+/*                                                                           */
+/* ************************************************************************* */
+
+
+/*****************************************************************************
+ * Public Function cfi_lex
+ *****************************************************************************/
+
+int (cfi_lex) (void* a_lval, CFI_parser_t a_parser)
+   {
+   S_scan_t* scan = (S_scan_t*)a_parser->scanner;
+
+   if (scan->indexed) return lex_index (a_parser, scan, (YYSTYPE*)a_lval);
+   return lex_direct (a_parser, scan, (YYSTYPE*)a_lval);
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_lex_error
+ *****************************************************************************/
+
+void (cfi_lex_error) (CFI_parser_t a_parser, const char* a_message)
+   {
+   S_scan_t* scan = (S_scan_t*)a_parser->scanner;
+   char      buff[36];
+   size_t    leng = scan->leng < 32 ? scan->leng : 32;
+
+   (void)memcpy (buff, scan->token, leng);
+   buff[leng] = '\0';
+   cfi_parse_error (a_parser, a_message, buff);
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_lex_skip
+ *****************************************************************************
+ *
+ * The direct scan skips the body with the comment and string rules of
+ * lex_direct(), without making any tokens: outside of comments and strings,
+ * every '{' and '}' is a token.
+ *
+ *****************************************************************************/
+
+int (cfi_lex_skip) (CFI_parser_t a_parser, const char** a_body, size_t* a_leng)
+   {
+   S_scan_t*   scan = (S_scan_t*)a_parser->scanner;
+   const char* p    = scan->next;
+   const char* q;
+   YYSTYPE     lval;
+   long        nest = 1;
+   int         token;
+
+   *a_body = p;
+
+   if (scan->indexed)
+      {
+      while ((token = lex_index (a_parser, scan, &lval)) != 0)
+         {
+         if (token == '{') nest++;
+         if ((token == '}') && (--nest == 0))
+            {
+            *a_leng = scan->token - *a_body;
+            return 0;
+            }
+         }
+      return -1;
+      }
+
+   while (p < scan->end)
+      {
+      switch (*p)
+         {
+         default:
+            p++;
+            continue;
+
+         case '\n':
+            a_parser->line++;
+            p++;
+            continue;
+
+         case '{':
+            nest++;
+            p++;
+            continue;
+
+         case '}':
+            if (--nest == 0)
+               {
+               scan->next  = p + 1;
+               scan->token = p;
+               scan->leng  = 1;
+               *a_leng     = p - *a_body;
+               return 0;
+               }
+            p++;
+            continue;
+
+         case '-':
+            if (p[1] != '-')
+               {
+               p++;
+               continue;
+               }
+            /* fall through */
+         case '#':
+         line_comment:
+            q = (const char*)memchr (p, '\n', scan->end - p);
+            p = q == NULL ? scan->end : q;
+            continue;
+
+         case '/':
+            if (p[1] == '/') goto line_comment;
+            p = p[1] == '*' ? comment_end (a_parser, scan, p) : p + 1;
+            continue;
+
+         case '"':
+            q = string_end (a_parser, scan, p + 1);
+            p = q == NULL ? scan->end : q + 1;
+            continue;
+         }
+      }
+
+   scan->next  = scan->end;
+   scan->token = scan->end;
+   scan->leng  = 0;
+
+   return -1;
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_lex_split
+ *****************************************************************************
+ *
+ * The text is scanned as cfi_lex_skip() scans a body, and it is cut after the
+ * first top level ';' or '}' at or past each a_count'th part of the text.
+ *
+ *****************************************************************************/
+
+int (cfi_lex_split) (
+                    CFI_parser_t a_parser,
+                    char*        a_buff,
+                    size_t       a_leng,
+                    size_t*      a_cuts,
+                    int          a_count
+                    )
+   {
+   S_scan_t*   scan  = (S_scan_t*)a_parser->scanner;
+   const char* p     = a_buff;
+   const char* q;
+   size_t      part  = a_leng / a_count;
+   size_t      next  = part;
+   long        nest  = 0;
+   int         count = 0;
+
+   scan->end = a_buff + a_leng;
+
+   while ((p < scan->end) && (count < (a_count-1)))
+      {
+      switch (*p++)
+         {
+         default:
+            continue;
+
+         case '{':
+            nest++;
+            continue;
+
+         case '}':
+            if (--nest > 0) continue;
+            nest = 0;
+            break;
+
+         case ';':
+            if (nest > 0) continue;
+            break;
+
+         case '-':
+            if (*p != '-') continue;
+            /* fall through */
+         case '#':
+         line_comment:
+            q = (const char*)memchr (p, '\n', scan->end - p);
+            p = q == NULL ? scan->end : q;
+            continue;
+
+         case '/':
+            if (*p == '/') goto line_comment;
+            if (*p == '*') p = comment_end (a_parser, scan, p - 1);
+            continue;
+
+         case '"':
+            q = string_end (a_parser, scan, p);
+            p = q == NULL ? scan->end : q + 1;
+            continue;
+         }
+
+      /*
+       * The end of a top level item.
+       */
+      if ((size_t)(p - a_buff) >= next)
+         {
+         a_cuts[count++] = p - a_buff;
+         next = p - a_buff + part;
+         }
+      }
+
+   a_cuts[count++] = a_leng;
+   scan->end = NULL;
+
+   return count;
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_lex_offset
+ *****************************************************************************/
+
+size_t (cfi_lex_offset) (CFI_parser_t a_parser)
+   {
+   S_scan_t* scan = (S_scan_t*)a_parser->scanner;
+   return scan->token - scan->text;
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_lex_bounded
+ *****************************************************************************/
+
+int (cfi_lex_bounded) (void)
+   {
+   return 1;
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_lex_init
+ *****************************************************************************/
+
+const char* (cfi_lex_init) (CFI_parser_t a_parser)
+   {
+   S_scan_t* scan = (S_scan_t*)_cfi_calloc (1, sizeof(S_scan_t));
+
+   a_parser->scanner = scan;
+   if (scan == NULL) return "can't allocate memory";
+   scan->parser = a_parser;
+
+#ifdef	CFI_SCAN_INDEX
+   (void)cfi_index_init (&scan->index); /* Without it, the scan is direct. */
+#endif
+
+   return NULL;
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_lex_done
+ *****************************************************************************/
+
+void (cfi_lex_done) (CFI_parser_t a_parser)
+   {
+   S_scan_t* scan = (S_scan_t*)a_parser->scanner;
+
+   if (scan != NULL) cfi_index_done (&scan->index);
+   _cfi_free (scan);
+   a_parser->scanner = NULL;
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_lex_text
+ *****************************************************************************/
+
+void (cfi_lex_text) (CFI_parser_t a_parser, const char* a_text)
+   {
+   scan_start (a_parser, a_text, strlen(a_text));
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_lex_buffer
+ *****************************************************************************/
+
+void (cfi_lex_buffer) (CFI_parser_t a_parser, char* a_buff, size_t a_leng)
+   {
+   scan_start (a_parser, a_buff, a_leng);
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_lex_end
+ *****************************************************************************/
+
+void (cfi_lex_end) (CFI_parser_t a_parser)
+   {
+   S_scan_t* scan = (S_scan_t*)a_parser->scanner;
+
+   scan->text    = NULL;
+   scan->next    = NULL;
+   scan->end     = NULL;
+   scan->token   = NULL;
+   scan->leng    = 0;
+   scan->indexed = 0;
+   scan->run     = 0;
+   }
+
+
+/* end of file */
@@ -182,45 +182,27 @@ CHANGE LOG
 
 
 /*****************************************************************************
- * Public Function cfi_string_decode
+ * Public Function _cfi_string_escape
+ *****************************************************************************
+ *
+ * This function writes the "a_leng" bytes of text at "a_text" into "a_buff"
+ * as they would be written in a document, with '\' escapes, and returns the
+ * number of bytes written; "a_buff" must have room for 4 * "a_leng" bytes.
+ * Nothing is allocated, and no '\0' is added.
+ *
  *****************************************************************************/
 
-char* (cfi_string_decode) (const char* a_text, size_t a_leng)
+size_t (_cfi_string_escape) (const char* a_text, size_t a_leng, char* a_buff)
    {
 #define	INRANGE(ch,min,max)	((ch)>=(min) && (ch)<=(max))
 #define	ESC_CHAR(ch)	(INRANGE(ch,07,015) || ((ch)=='"') || ((ch)=='\\'))
 #define	ESC_NUM(ch)	(((ch)<=06) || INRANGE(ch,016,037) || ((ch)>0176))
 
-         char*  newtext = NULL;
-         char*  dst;
-   const char*  src;
-         size_t size;
-
-   if (a_text == NULL) return NULL;
+         char* dst = a_buff;
+   const char* src = a_text;
+   const char* end = a_text + a_leng;
 
-   /*
-    * This code seems to account for when a_text is only '\0' (the string ""),
-    * and a_leng is (correctly) 1.
-    */
-
-   {
-   size_t i; /* This is just a counter; count for a_leng-1 because a_leng is */
-             /* the size of a_text including its terminating '\0'.           */
-   for (i=1, src=a_text, size=1 ; i < a_leng ; i++, src++, size++)
-      if (ESC_CHAR(*src))
-         size += 1;
-      else
-         if (ESC_NUM(*src))
-            size += 3;
-   }
-
-   newtext = (char*)calloc (1, size+1);
-   if (newtext == NULL) return NULL;
-
-   dst = newtext;
-   src = a_text;
-
-   while (--a_leng > 0)
+   while (src < end)
       {
       if (ESC_CHAR(*src) || (*src == '\0'))
          {
@@ -254,6 +236,52 @@ char* (cfi_string_decode) (const char* a_text, size_t a_leng)
          }
       }
 
+   return dst - a_buff;
+
+#undef	INRANGE
+#undef	ESC_CHAR
+#undef	ESC_NUM
+   }
+
+
+/*****************************************************************************
+ * Public Function cfi_string_decode
+ *****************************************************************************/
+
+char* (cfi_string_decode) (const char* a_text, size_t a_leng)
+   {
+#define	INRANGE(ch,min,max)	((ch)>=(min) && (ch)<=(max))
+#define	ESC_CHAR(ch)	(INRANGE(ch,07,015) || ((ch)=='"') || ((ch)=='\\'))
+#define	ESC_NUM(ch)	(((ch)<=06) || INRANGE(ch,016,037) || ((ch)>0176))
+
+         char*  newtext = NULL;
+         char*  dst;
+   const char*  src;
+         size_t size;
+
+   if (a_text == NULL) return NULL;
+
+   /*
+    * This code seems to account for when a_text is only '\0' (the string ""),
+    * and a_leng is (correctly) 1.
+    */
+
+   {
+   size_t i; /* This is just a counter; count for a_leng-1 because a_leng is */
+             /* the size of a_text including its terminating '\0'.           */
+   for (i=1, src=a_text, size=1 ; i < a_leng ; i++, src++, size++)
+      if (ESC_CHAR(*src))
+         size += 1;
+      else
+         if (ESC_NUM(*src))
+            size += 3;
+   }
+
+   newtext = (char*)_cfi_caller_calloc (1, size+1);
+   if (newtext == NULL) return NULL;
+
+   if (a_leng > 0) a_leng -= 1; /* leave out the '\0' */
+   dst = newtext + _cfi_string_escape (a_text, a_leng, newtext);
    *dst = '\0';
 
    return newtext;
@@ -265,67 +293,91 @@ char* (cfi_string_decode) (const char* a_text, size_t a_leng)
 
 
 /*****************************************************************************
- * Public Function cfi_string_encode
+ * Public Function _cfi_string_encode
+ *****************************************************************************
+ *
+ * This function converts the "a_leng" bytes of text at "a_text", which need
+ * not be '\0' terminated, in one pass into one allocation; the text never
+ * grows, so the allocation is "a_leng" + 1 bytes.  The text is converted into
+ * "a_buff" instead, if it isn't NULL, which must have room for that many.  A
+ * '\' at the very end of the text has nothing to escape, and is dropped.
+ *
  *****************************************************************************/
 
-char* (cfi_string_encode) (const char* a_text, size_t* a_leng)
+char* (_cfi_string_encode) (
+                           const char* a_text,
+                           size_t      a_leng,
+                           char*       a_buff,
+                           size_t*     a_newLeng
+                           )
    {
-         char* newtext = NULL;
+         char* newtext = a_buff;
          char* dst;
-   const char* src;
-
-   if (a_text == NULL) return NULL;
+   const char* src = a_text;
+   const char* end = a_text + a_leng;
 
-   newtext = (char*)calloc (1, strlen(a_text)+1);
+   if (newtext == NULL) newtext = (char*)_cfi_malloc (a_leng+1);
    if (newtext == NULL) return NULL;
 
    dst = newtext;
-   src = a_text;
 
-   while (*src != '\0')
+   while (src < end)
       {
       if (*src != '\\') *dst++ = *src++;
-      else
+      else if (++src == end) break;
+      else if ((*src >= '0') && (*src <= '2'))
          {
-         src++;
-         if ((*src >= '0') && (*src <= '2'))
+         unsigned char byte = 0;
+         byte += (*src++ & 07);
+         if ((src < end) && (*src >= '0') && (*src <= '7'))
             {
-            unsigned char byte = 0;
-            byte += (*src++ & 07);
-            if ((*src >= '0') && (*src <= '7'))
-               {
+            byte = (byte << 3) + (*src++ & 07);
+            if ((src < end) && (*src >= '0') && (*src <= '7'))
                byte = (byte << 3) + (*src++ & 07);
-               if ((*src >= '0') && (*src <= '7'))
-                  byte = (byte << 3) + (*src++ & 07);
-               }
-            *dst++ = byte;
             }
-         else
+         *dst++ = byte;
+         }
+      else
+         {
+         switch (*src)
             {
-            switch (*src)
-               {
-               default:    *dst++ = *src;  break;
-               case  '0':  *dst++ = '\0';  break;
-               case  'a':  *dst++ = '\a';  break;
-               case  'b':  *dst++ = '\b';  break;
-               case  'f':  *dst++ = '\f';  break;
-               case  'n':  *dst++ = '\n';  break;
-               case  'r':  *dst++ = '\r';  break;
-               case  't':  *dst++ = '\t';  break;
-               case  'v':  *dst++ = '\v';  break;
-               }
-            src++;
+            default:    *dst++ = *src;  break;
+            case  'a':  *dst++ = '\a';  break;
+            case  'b':  *dst++ = '\b';  break;
+            case  'f':  *dst++ = '\f';  break;
+            case  'n':  *dst++ = '\n';  break;
+            case  'r':  *dst++ = '\r';  break;
+            case  't':  *dst++ = '\t';  break;
+            case  'v':  *dst++ = '\v';  break;
             }
+         src++;
          }
       }
 
    *dst++ = '\0';
-   if (a_leng != NULL) *a_leng = dst - newtext;
+   if (a_newLeng != NULL) *a_newLeng = dst - newtext;
 
    return newtext;
    }
 
 
+/*****************************************************************************
+ * Public Function cfi_string_encode
+ *****************************************************************************/
+
+char* (cfi_string_encode) (const char* a_text, size_t* a_leng)
+   {
+   char*  text;
+   size_t leng;
+
+   if (a_text == NULL) return NULL;
+   leng = strlen (a_text);
+   text = (char*)_cfi_caller_calloc (1, leng+1);
+   if (text == NULL) return NULL;
+   return _cfi_string_encode (a_text, leng, text, a_leng);
+   }
+
+
 /*****************************************************************************
  * Public Function cfi_string_octal
  *****************************************************************************/
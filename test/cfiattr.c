@@ -0,0 +1,239 @@
+/*
+ * This file is completely free, public domain software.
+ */
+
+
+/* *****************************************************************************
+
+FILE NAME
+
+	$RCSfile:$
+	$Revision:$
+	$Date:$
+
+PROGRAM INFORMATION
+
+	Developed by:	libcfi project
+
+FILE DESCRIPTION
+
+	This is a libcfi attribute list benchmark main program.  This main
+	program must be linked with libcfi.
+
+	For ATTR_SIZES lists of ATTR_COUNT attributes, doubling each time,
+	this program times making the list of a section node one attribute
+	at a time with cfi_node_attribute_insert() at the end of the list,
+	and then taking the attributes out one at a time from the end with
+	cfi_node_attribute_remove().  The time for each attribute should be
+	about the same for every size; it grows with the size if the list is
+	copied by each insert or remove.  Each list is checked as well.
+
+	Return Values
+
+		0  Nothing to report.
+		1  An attribute can't be made, put in, or taken out.
+		3  Bad test result; a list is not the right attributes.
+
+***************************************************************************** */
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      F e a t u r e   S w i t c h e s                                      */
+/*                                                                           */
+/* ************************************************************************* */
+
+/*
+ * Select these feature by moving them from the `if UNDEF' into the `else'
+ * section.
+ */
+#ifdef	UNDEF
+#   define	_BSD_SOURCE	1	/* 4.3+bsd subsystems           */
+#   define	_POSIX_SOURCE	1	/* posix.1                      */
+#   define	_POSIX_C_SOURCE	199309L	/* posix.1 and posix.4          */
+#   define	_POSIX_C_SOURCE	199506L	/* posix.1 and posix.4 and MORE */
+#else
+#   define	_POSIX_C_SOURCE	200112L	/* posix.1 and posix.4 and MORE */
+#   ifndef	_REENTRANT
+#      define	_REENTRANT		/* thread-safe for glibc        */
+#   endif
+#endif
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      I n c l u d e d   F i l e s                                          */
+/*                                                                           */
+/* ************************************************************************* */
+
+/*
+ * Standard C (ANSI) Header Files
+ */
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<time.h>
+
+/*
+ * Posix Header Files
+ */
+#include	<unistd.h> /* always first amongst POSIX header files */
+
+/*
+ * Project Specific Header Files
+ */
+#include	"CFI.h"
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      M a n i f e s t   C o n s t a n t s                                  */
+/*                                                                           */
+/* ************************************************************************* */
+
+#define	ATTR_COUNT	(12500L) /* attributes in the first list */
+#define	ATTR_SIZES	(5)      /* lists, each twice as long    */
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      E x e c u t a b l e   C o d e   (Locally Used Functions)             */
+/*                                                                           */
+/* ************************************************************************* */
+
+
+/*****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static double seconds (void);
+static int list_check (CFI_node_t node, long count);
+static int main2 (long count);
+
+
+/*****************************************************************************
+ * Private Function seconds
+ ****************************************************************************/
+
+static double seconds (void)
+   {
+   struct timespec now;
+   (void)clock_gettime (CLOCK_MONOTONIC, &now);
+   return (double)now.tv_sec + (double)now.tv_nsec / 1.0e9;
+   }
+
+
+/*****************************************************************************
+ * Private Function list_check
+ *****************************************************************************
+ *
+ * The list must be the attributes 0 to "a_count"-1, in order.
+ *
+ ****************************************************************************/
+
+static int list_check (CFI_node_t a_node, long a_count)
+   {
+   CFI_attr_t attr = cfi_node_attribute (a_node);
+   long       i;
+
+   for (i = 0 ; attr != NULL ; i++, attr = cfi_attribute_next(attr))
+      {
+      if (cfi_attribute_int_get(attr) != (int32_t)i) return -1;
+      }
+
+   if ((i != a_count) || (cfi_node_attribute_count(a_node) != (size_t)i))
+      {
+      return -1;
+      }
+
+   return 0;
+   }
+
+
+/*****************************************************************************
+ * Private Function main2
+ ****************************************************************************/
+
+static int main2 (long a_count)
+   {
+   CFI_node_t node;
+   CFI_attr_t attr;
+   double     build;
+   double     remove;
+   int32_t    value;
+   long       i;
+   int        errNum = 0;
+
+   if ((cfi_node_new(&node) != NULL) ||
+       (cfi_node_type_set(node,CFI_SECTION) != NULL))
+      {
+      printf ("cfiattr: can't make a section node\n");
+      return 1;
+      }
+
+   build = seconds ();
+   for (i = 0 ; i < a_count ; i++)
+      {
+      value = (int32_t)i;
+      if ((cfi_attribute_new(&attr,&value,CFI_DEC_FORMAT) != NULL) ||
+          (cfi_node_attribute_insert(node,(size_t)i,attr) != NULL))
+         {
+         printf ("cfiattr: can't put in attribute %ld\n", i);
+         return 1;
+         }
+      }
+   build = seconds () - build;
+   if (list_check(node,a_count) != 0) errNum = 3;
+
+   remove = seconds ();
+   for (i = a_count ; i > 0 ; i--)
+      {
+      if (cfi_node_attribute_remove(node,(size_t)i-1,&attr) != NULL)
+         {
+         printf ("cfiattr: can't take out attribute %ld\n", i-1);
+         return 1;
+         }
+      if (cfi_attribute_int_get(attr) != (int32_t)(i-1)) errNum = 3;
+      (void)cfi_attribute_del (&attr);
+      }
+   remove = seconds () - remove;
+   if (list_check(node,0) != 0) errNum = 3;
+
+   printf (
+          "cfiattr: %7ld attributes  insert %6.1f ns  remove %6.1f ns\n",
+          a_count,
+          build * 1.0e9 / a_count,
+          remove * 1.0e9 / a_count
+          );
+   if (errNum != 0) printf ("cfiattr: the list is not right\n");
+
+   (void)cfi_delete (node);
+
+   return errNum;
+   }
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      E x e c u t a b l e   C o d e   (MAIN PROGRAM)                       */
+/*                                                                           */
+/* ************************************************************************* */
+
+int   main (void)
+   {
+   long count  = ATTR_COUNT;
+   int  errNum = 0;
+   int  result;
+   int  i;
+
+   for (i = 0 ; i < ATTR_SIZES ; i++, count *= 2)
+      {
+      result = main2 (count);
+      if (result != 0) errNum = result;
+      if (result == 1) break;
+      }
+
+   return errNum;
+   }
+
+
+/* end of file */
@@ -161,73 +161,49 @@ static char* g_find;
  * Private Function Prototypes
  ****************************************************************************/
 
-static int find_word (CFI_node_t cfi);
-static int find_attributes (CFI_node_t cfi);
-static int find_section (CFI_node_t cfi);
+static int find_name (CFI_node_t cfi);
 static void help_print (void);
 static int main2 (char*);
 
 
 /*****************************************************************************
- * Private Function find_word
+ * Private Function find_name
+ *****************************************************************************
+ *
+ * One search for the name, of any type, tells which types it is found as.
+ *
  ****************************************************************************/
 
-static int find_word (CFI_node_t a_cfi)
+static int find_name (CFI_node_t a_cfi)
    {
-   int found = 0;
-   CFI_node_t node = NULL;
+   CFI_cursor_t cursor;
+   CFI_node_t   node;
+   unsigned     found = 0;
 
-   node = cfi_search (a_cfi, g_find, CFI_WORD);
-   if (node != NULL)
+   if (cfi_search_begin(a_cfi,g_find,CFI_ANY_MASK,-1,&cursor) != NULL)
       {
-      found = 1;
-      printf ("cfi_search: \"%s\" is a CFI_WORD.\n", g_find);
-      cfi_release (node);
+      return 0;
       }
-
-   return found;
-   }
-
-
-/*****************************************************************************
- * Private Function find_attributes
- ****************************************************************************/
-
-static int find_attributes (CFI_node_t a_cfi)
-   {
-   int found = 0;
-   CFI_node_t node = NULL;
-
-   node = cfi_search (a_cfi, g_find, CFI_ATTRIBUTES);
-   if (node != NULL)
+   while ((found != CFI_ANY_MASK) &&
+          ((node = cfi_search_next(cursor)) != NULL))
       {
-      found = 1;
-      printf ("cfi_search: \"%s\" is a CFI_ATTRIBUTES.\n", g_find);
-      cfi_release (node);
+      switch (cfi_node_type_get(node))
+         {
+         case CFI_WORD:       found |= CFI_WORD_MASK;       break;
+         case CFI_ATTRIBUTES: found |= CFI_ATTRIBUTES_MASK; break;
+         case CFI_SECTION:    found |= CFI_SECTION_MASK;    break;
+         }
       }
+   (void)cfi_search_end (&cursor);
 
-   return found;
-   }
-
-
-/*****************************************************************************
- * Private Function find_section
- ****************************************************************************/
-
-static int find_section (CFI_node_t a_cfi)
-   {
-   int found = 0;
-   CFI_node_t node = NULL;
-
-   node = cfi_search (a_cfi, g_find, CFI_SECTION);
-   if (node != NULL)
-      {
-      found = 1;
+   if (found & CFI_WORD_MASK)
+      printf ("cfi_search: \"%s\" is a CFI_WORD.\n", g_find);
+   if (found & CFI_ATTRIBUTES_MASK)
+      printf ("cfi_search: \"%s\" is a CFI_ATTRIBUTES.\n", g_find);
+   if (found & CFI_SECTION_MASK)
       printf ("cfi_search: \"%s\" is a CFI_SECTION.\n", g_find);
-      cfi_release (node);
-      }
 
-   return found;
+   return found != 0;
    }
 
 
@@ -273,8 +249,7 @@ static int main2 (char* a_fileName)
 
    if (g_debug)
       {
-      cfi_conf_debug (CFI_DEBUG_LEXICAL);
-      cfi_conf_debug (CFI_DEBUG_GRAMMAR);
+      cfi_conf_debug (CFI_DEBUG_LEXICAL | CFI_DEBUG_GRAMMAR);
       }
 
    msg = cfi_get (fd, &cfi);
@@ -286,11 +261,7 @@ static int main2 (char* a_fileName)
 
    if (g_find != NULL)
       {
-      int found = 0;
-      found |= find_word (cfi);
-      found |= find_attributes (cfi);
-      found |= find_section (cfi);
-      if (!found)
+      if (!find_name(cfi))
          {
          printf ("cfi_search: \"%s\" is not found.\n", g_find);
          }
@@ -0,0 +1,285 @@
+/*
+ * This file is completely free, public domain software.
+ */
+
+
+/* *****************************************************************************
+
+FILE NAME
+
+	$RCSfile:$
+	$Revision:$
+	$Date:$
+
+PROGRAM INFORMATION
+
+	Developed by:	libcfi project
+
+FILE DESCRIPTION
+
+	This is a libcfi section index benchmark main program.  This main
+	program must be linked with libcfi.
+
+	For INDEX_SIZES sections of INDEX_COUNT entries, doubling each
+	time, this program times cfi_search_flat() of SEARCHES entries all
+	over the section, first from the second node of the section, which
+	walks the section node by node, and then from the first node, which
+	uses the index of the section.  The index is made by a search from
+	the first node for the last entry before them, which is timed by
+	itself.  The time of a search from the index
+	should be about the same for every size; the time of a walk grows
+	with the size.  Each search is checked as well.
+
+	Return Values
+
+		0  Nothing to report.
+		1  A section can't be made.
+		3  Bad test result; a search gives the wrong entry.
+
+***************************************************************************** */
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      F e a t u r e   S w i t c h e s                                      */
+/*                                                                           */
+/* ************************************************************************* */
+
+/*
+ * Select these feature by moving them from the `if UNDEF' into the `else'
+ * section.
+ */
+#ifdef	UNDEF
+#   define	_BSD_SOURCE	1	/* 4.3+bsd subsystems           */
+#   define	_POSIX_SOURCE	1	/* posix.1                      */
+#   define	_POSIX_C_SOURCE	199309L	/* posix.1 and posix.4          */
+#   define	_POSIX_C_SOURCE	199506L	/* posix.1 and posix.4 and MORE */
+#else
+#   define	_POSIX_C_SOURCE	200112L	/* posix.1 and posix.4 and MORE */
+#   ifndef	_REENTRANT
+#      define	_REENTRANT		/* thread-safe for glibc        */
+#   endif
+#endif
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      I n c l u d e d   F i l e s                                          */
+/*                                                                           */
+/* ************************************************************************* */
+
+/*
+ * Standard C (ANSI) Header Files
+ */
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<time.h>
+
+/*
+ * Posix Header Files
+ */
+#include	<unistd.h> /* always first amongst POSIX header files */
+
+/*
+ * Project Specific Header Files
+ */
+#include	"CFI.h"
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      M a n i f e s t   C o n s t a n t s                                  */
+/*                                                                           */
+/* ************************************************************************* */
+
+#define	INDEX_COUNT	(1000L) /* entries in the first section */
+#define	INDEX_SIZES	(7)     /* sections, each twice as long */
+#define	SEARCHES	(2000L) /* searches of each section     */
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      E x e c u t a b l e   C o d e   (Locally Used Functions)             */
+/*                                                                           */
+/* ************************************************************************* */
+
+
+/*****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static double seconds (void);
+static CFI_node_t section_make (long count);
+static int searches (CFI_node_t node, long count, long searches);
+static int search (CFI_node_t node, long entry);
+static int main2 (long count);
+
+
+/*****************************************************************************
+ * Private Function seconds
+ ****************************************************************************/
+
+static double seconds (void)
+   {
+   struct timespec now;
+   (void)clock_gettime (CLOCK_MONOTONIC, &now);
+   return (double)now.tv_sec + (double)now.tv_nsec / 1.0e9;
+   }
+
+
+/*****************************************************************************
+ * Private Function section_make
+ *****************************************************************************
+ *
+ * The section is "hosts { host0 = 0; ... }", of "a_count" entries.
+ *
+ ****************************************************************************/
+
+static CFI_node_t section_make (long a_count)
+   {
+   CFI_node_t  cfi = NULL;
+   FILE*       input;
+   const char* msg;
+   long        i;
+
+   input = tmpfile ();
+   if (input == NULL) return NULL;
+   fprintf (input, "hosts {\n");
+   for (i = 0 ; i < a_count ; i++) fprintf (input, "host%ld = %ld;\n", i, i);
+   fprintf (input, "}\n");
+   rewind (input);
+
+   msg = cfi_get (fileno(input), &cfi);
+   if (msg != NULL) printf ("cfiindex: %s\n", msg);
+   fclose (input);
+
+   return cfi;
+   }
+
+
+/*****************************************************************************
+ * Private Function search
+ *****************************************************************************
+ *
+ * This searches from "a_node" for an entry, which must be found.
+ *
+ ****************************************************************************/
+
+static int search (CFI_node_t a_node, long a_entry)
+   {
+   CFI_node_t node;
+   char       word[32];
+   int        errNum = 0;
+
+   sprintf (word, "host%ld", a_entry);
+   node = cfi_search_flat (a_node, word, CFI_ATTRIBUTES);
+   if ((node == NULL) ||
+       (cfi_attribute_int_get(cfi_node_attribute(node)) != a_entry))
+      {
+      errNum = 3;
+      }
+   if (node != NULL) (void)cfi_release (node);
+
+   return errNum;
+   }
+
+
+/*****************************************************************************
+ * Private Function searches
+ *****************************************************************************
+ *
+ * This does "a_searches" searches from "a_node" of entries all over the
+ * section, none of them the first.
+ *
+ ****************************************************************************/
+
+static int searches (CFI_node_t a_node, long a_count, long a_searches)
+   {
+   long i;
+   int  errNum = 0;
+
+   for (i = 0 ; i < a_searches ; i++)
+      {
+      if (search(a_node,1+(i*7919L)%(a_count-1)) != 0) errNum = 3;
+      }
+
+   return errNum;
+   }
+
+
+/*****************************************************************************
+ * Private Function main2
+ ****************************************************************************/
+
+static int main2 (long a_count)
+   {
+   CFI_node_t cfi;
+   CFI_node_t first;
+   double     walk;
+   double     make;
+   double     index;
+   int        errNum = 0;
+
+   cfi = section_make (a_count);
+   if (cfi == NULL)
+      {
+      printf ("cfiindex: can't make a section\n");
+      return 1;
+      }
+   first = cfi_node_section (cfi);
+
+   walk = seconds ();
+   if (searches(cfi_node_next(first),a_count,SEARCHES) != 0) errNum = 3;
+   walk = seconds () - walk;
+
+   make = seconds ();
+   if (search(first,a_count-1) != 0) errNum = 3;
+   make = seconds () - make;
+
+   index = seconds ();
+   if (searches(first,a_count,SEARCHES) != 0) errNum = 3;
+   index = seconds () - index;
+
+   printf (
+          "cfiindex: %7ld entries  walk %9.0f ns  index %4.0f ns"
+          "  make %6.0f us\n",
+          a_count,
+          walk * 1.0e9 / SEARCHES,
+          index * 1.0e9 / SEARCHES,
+          make * 1.0e6
+          );
+   if (errNum != 0) printf ("cfiindex: a search is not right\n");
+
+   (void)cfi_delete_chain (cfi);
+
+   return errNum;
+   }
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      E x e c u t a b l e   C o d e   (MAIN PROGRAM)                       */
+/*                                                                           */
+/* ************************************************************************* */
+
+int   main (void)
+   {
+   long count  = INDEX_COUNT;
+   int  errNum = 0;
+   int  result;
+   int  i;
+
+   (void)cfi_init ();
+
+   for (i = 0 ; i < INDEX_SIZES ; i++, count *= 2)
+      {
+      result = main2 (count);
+      if (result != 0) errNum = result;
+      if (result == 1) break;
+      }
+
+   return errNum;
+   }
+
+
+/* end of file */
@@ -0,0 +1,351 @@
+/*
+ * This file is completely free, public domain software.
+ */
+
+
+/* *****************************************************************************
+
+FILE NAME
+
+	$RCSfile:$
+	$Revision:$
+	$Date:$
+
+PROGRAM INFORMATION
+
+	Developed by:	libcfi project
+
+FILE DESCRIPTION
+
+	This is a libcfi lexical analyzer test main program.  This main program
+	must be linked with the static libcfi archive, because it uses the
+	lexical analyzer interface that is internal to libcfi.
+
+	This program reads each of the files specified on the command line and
+	prints its tokens, one per line, with the line number; the output of a
+	libcfi built with the flex scanner is compared to that of one built
+	with the hand written scanner by the "scanners" script.  With the -b
+	option, this program times the lexical analyzer instead and reports
+	tokens per second.
+
+	Return Values
+
+		0  Nothing to report.
+		1  Bad command line option.
+		2  No input file specified on the command line.
+		3  Bad test result; an input file can't be read.
+
+***************************************************************************** */
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      F e a t u r e   S w i t c h e s                                      */
+/*                                                                           */
+/* ************************************************************************* */
+
+/*
+ * Select these feature by moving them from the `if UNDEF' into the `else'
+ * section.
+ */
+#ifdef	UNDEF
+#   define	_BSD_SOURCE	1	/* 4.3+bsd subsystems           */
+#   define	_POSIX_SOURCE	1	/* posix.1                      */
+#   define	_POSIX_C_SOURCE	199309L	/* posix.1 and posix.4          */
+#   define	_POSIX_C_SOURCE	199506L	/* posix.1 and posix.4 and MORE */
+#else
+#   define	_POSIX_C_SOURCE	200112L	/* posix.1 and posix.4 and MORE */
+#   ifndef	_REENTRANT
+#      define	_REENTRANT		/* thread-safe for glibc        */
+#   endif
+#endif
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      I n c l u d e d   F i l e s                                          */
+/*                                                                           */
+/* ************************************************************************* */
+
+/*
+ * Standard C (ANSI) Header Files
+ */
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+#include	<time.h>
+
+/*
+ * Posix Header Files
+ */
+#include	<unistd.h> /* always first amongst POSIX header files */
+
+/*
+ * Project Specific Header Files
+ */
+#include	"getopt.h"
+#include	"CFI.h"
+#include	"lex.h"
+#include	"parse.h"
+#include	"y.tab.h"
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      M a n i f e s t   C o n s t a n t s                                  */
+/*                                                                           */
+/* ************************************************************************* */
+
+#define	BENCH_SECONDS	(1.0) /* minimum time to scan a file with -b */
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      P r i v a t e   G l o b a l   V a r i a b l e s                      */
+/*                                                                           */
+/* ************************************************************************* */
+
+static int g_bench;
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      E x e c u t a b l e   C o d e   (Locally Used Functions)             */
+/*                                                                           */
+/* ************************************************************************* */
+
+
+/*****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static char* file_read (const char* fileName, size_t* leng);
+static double seconds (void);
+static void token_print (CFI_parser_t parser, int token, YYSTYPE* lval);
+static int main2 (CFI_parser_t parser, char* fileName);
+
+
+/*****************************************************************************
+ * Private Function file_read
+ *****************************************************************************
+ *
+ * This function reads a file into a buffer with the two '\0' bytes after the
+ * text that the lexical analyzer wants.
+ *
+ ****************************************************************************/
+
+static char* file_read (const char* a_fileName, size_t* a_leng)
+   {
+   FILE*  file = fopen (a_fileName, "rb");
+   char*  buff;
+   long   size;
+
+   if (file == NULL) return NULL;
+
+   if ((fseek(file,0,SEEK_END) != 0) || ((size=ftell(file)) < 0))
+      {
+      fclose (file);
+      return NULL;
+      }
+   rewind (file);
+
+   buff = (char*)malloc (size+2);
+   if ((buff != NULL) && (fread(buff,1,size,file) != (size_t)size))
+      {
+      free (buff);
+      buff = NULL;
+      }
+   fclose (file);
+
+   if (buff != NULL)
+      {
+      buff[size]   = '\0';
+      buff[size+1] = '\0';
+      *a_leng = size;
+      }
+
+   return buff;
+   }
+
+
+/*****************************************************************************
+ * Private Function seconds
+ ****************************************************************************/
+
+static double seconds (void)
+   {
+   struct timespec now;
+   (void)clock_gettime (CLOCK_MONOTONIC, &now);
+   return (double)now.tv_sec + (double)now.tv_nsec / 1.0e9;
+   }
+
+
+/*****************************************************************************
+ * Private Function token_print
+ ****************************************************************************/
+
+static void token_print (CFI_parser_t a_parser, int a_token, YYSTYPE* a_lval)
+   {
+   printf ("%d ", cfi_parser_line(a_parser));
+
+   switch (a_token)
+      {
+      default:
+         printf ("SYMBOL %c\n", (char)a_token);
+         break;
+      case CFIYY_STRING:
+      case CFIYY_WORD:
+         printf (
+                "%s \"%.*s\"\n",
+                a_token == CFIYY_WORD ? "WORD" : "STRING",
+                (int)a_lval->text.leng,
+                a_lval->text.text
+                );
+         break;
+      case CFIYY_REALNUM:
+         printf ("REALNUM %.17g\n", a_lval->real);
+         break;
+      case CFIYY_HEXNUM:
+         printf ("HEXNUM %ld\n", (long)a_lval->num);
+         break;
+      case CFIYY_DECNUM:
+         printf ("DECNUM %ld\n", (long)a_lval->num);
+         break;
+      case CFIYY_OCTNUM:
+         printf ("OCTNUM %ld\n", (long)a_lval->num);
+         break;
+      case CFIYY_BINNUM:
+         printf ("BINNUM %ld\n", (long)a_lval->num);
+         break;
+      }
+   }
+
+
+/*****************************************************************************
+ * Private Function main2
+ ****************************************************************************/
+
+static int main2 (CFI_parser_t a_parser, char* a_fileName)
+   {
+   YYSTYPE       lval;
+   char*         text;
+   char*         buff;
+   size_t        leng;
+   unsigned long tokens = 0;
+   unsigned long passes = 0;
+   double        elapsed = 0.0;
+   double        start;
+   int           token;
+
+   text = file_read (a_fileName, &leng);
+   if (text == NULL) return -1;
+
+   if (!g_bench)
+      {
+      printf ("%s:\n", a_fileName);
+      a_parser->line = 1;
+      cfi_lex_buffer (a_parser, text, leng);
+      while ((token=cfi_lex(&lval,a_parser)) != 0)
+         {
+         token_print (a_parser, token, &lval);
+         }
+      printf ("%d EOF\n", cfi_parser_line(a_parser));
+      cfi_lex_end (a_parser);
+      free (text);
+      return 0;
+      }
+
+   /*
+    * The lexical analyzer may write into its buffer, so each pass scans a
+    * fresh copy of the file.
+    */
+   buff = (char*)malloc (leng+2);
+   if (buff == NULL)
+      {
+      free (text);
+      return -1;
+      }
+   while ((elapsed < BENCH_SECONDS) || (passes < 3))
+      {
+      (void)memcpy (buff, text, leng+2);
+      start = seconds ();
+      a_parser->line = 1;
+      cfi_lex_buffer (a_parser, buff, leng);
+      while (cfi_lex(&lval,a_parser) != 0) tokens++;
+      cfi_lex_end (a_parser);
+      elapsed += seconds () - start;
+      passes  += 1;
+      }
+   printf (
+          "%s: %lu tokens in %lu passes, %.2f Mtokens/s, %.1f MB/s\n",
+          a_fileName,
+          tokens / passes,
+          passes,
+          (double)tokens / elapsed / 1.0e6,
+          (double)leng * passes / elapsed / (1024.0 * 1024.0)
+          );
+
+   free (buff);
+   free (text);
+
+   return 0;
+   }
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      E x e c u t a b l e   C o d e   (MAIN PROGRAM)                       */
+/*                                                                           */
+/* ************************************************************************* */
+
+int   main (int argc, char** argv)
+   {
+   CFI_parser_t parser;
+   int          errNum = 0;
+   int          optval;
+
+   g_bench = 0;
+
+   while ((optval=getopt(argc,argv,"b")) != EOF)
+      {
+      switch (optval)
+         {
+         default:   fprintf (stderr, "Usage: cfilex [-b] file ...\n");
+                    exit (1);
+
+         case 'b':  g_bench = 1;
+                    break;
+         }
+      }
+
+   if (optind >= argc)
+      {
+      fprintf (stderr, "cfilex: no input file.\n");
+      exit (2);
+      }
+
+   (void)cfi_init ();
+   if (cfi_parser_new(&parser) != NULL)
+      {
+      fprintf (stderr, "cfilex: can't make a parser.\n");
+      exit (3);
+      }
+
+   while (optind < argc)
+      {
+      if (main2(parser,argv[optind]) != 0)
+         {
+         fprintf (stderr, "cfilex: can't read \"%s\".\n", argv[optind]);
+         errNum = 3;
+         }
+      optind++;
+      }
+
+   (void)cfi_parser_del (&parser);
+   (void)cfi_done ();
+
+   return errNum;
+   }
+
+
+/* end of file */
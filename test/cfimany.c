@@ -0,0 +1,294 @@
+/*
+ * This file is completely free, public domain software.
+ */
+
+
+/* *****************************************************************************
+
+FILE NAME
+
+	$RCSfile:$
+	$Revision:$
+	$Date:$
+
+PROGRAM INFORMATION
+
+	Developed by:	libcfi project
+
+FILE DESCRIPTION
+
+	This is a libcfi batch lookup benchmark main program.  This main
+	program must be linked with libcfi.
+
+	For a document of MANY_SECTIONS sections of MANY_ENTRIES entries,
+	more than 500,000 nodes, this program times MANY_KEYS cfi_search()
+	calls, one for each of MANY_KEYS entries all over the document, and
+	then one cfi_lookup_many() of all of them.  Each cfi_search() walks
+	the document from its root to the entry; cfi_lookup_many() walks
+	it once for all of them.  Each node found is checked as well.
+
+	Return Values
+
+		0  Nothing to report.
+		1  The document can't be made.
+		3  Bad test result; a lookup gives the wrong entry.
+
+***************************************************************************** */
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      F e a t u r e   S w i t c h e s                                      */
+/*                                                                           */
+/* ************************************************************************* */
+
+/*
+ * Select these feature by moving them from the `if UNDEF' into the `else'
+ * section.
+ */
+#ifdef	UNDEF
+#   define	_BSD_SOURCE	1	/* 4.3+bsd subsystems           */
+#   define	_POSIX_SOURCE	1	/* posix.1                      */
+#   define	_POSIX_C_SOURCE	199309L	/* posix.1 and posix.4          */
+#   define	_POSIX_C_SOURCE	199506L	/* posix.1 and posix.4 and MORE */
+#else
+#   define	_POSIX_C_SOURCE	200112L	/* posix.1 and posix.4 and MORE */
+#   ifndef	_REENTRANT
+#      define	_REENTRANT		/* thread-safe for glibc        */
+#   endif
+#endif
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      I n c l u d e d   F i l e s                                          */
+/*                                                                           */
+/* ************************************************************************* */
+
+/*
+ * Standard C (ANSI) Header Files
+ */
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<time.h>
+
+/*
+ * Posix Header Files
+ */
+#include	<unistd.h> /* always first amongst POSIX header files */
+
+/*
+ * Project Specific Header Files
+ */
+#include	"CFI.h"
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      I n c l u d e d   F i l e s                                          */
+/*                                                                           */
+/* ************************************************************************* */
+
+/*
+ * Standard C (ANSI) Header Files
+ */
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<time.h>
+
+/*
+ * Posix Header Files
+ */
+#include	<unistd.h> /* always first amongst POSIX header files */
+
+/*
+ * Project Specific Header Files
+ */
+#include	"CFI.h"
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      M a n i f e s t   C o n s t a n t s                                  */
+/*                                                                           */
+/* ************************************************************************* */
+
+#define	MANY_SECTIONS	(5000L) /* sections of the document    */
+#define	MANY_ENTRIES	(100L)  /* entries of each section     */
+#define	MANY_KEYS	(1000L) /* entries that are looked up  */
+#define	MANY_WORD	(32)    /* bytes of the word of a key  */
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      E x e c u t a b l e   C o d e   (Locally Used Functions)             */
+/*                                                                           */
+/* ************************************************************************* */
+
+
+/*****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static double seconds (void);
+static CFI_node_t document_make (void);
+static int result_check (CFI_node_t node, long key);
+static int main2 (void);
+
+
+/*****************************************************************************
+ * Private Function seconds
+ ****************************************************************************/
+
+static double seconds (void)
+   {
+   struct timespec now;
+   (void)clock_gettime (CLOCK_MONOTONIC, &now);
+   return (double)now.tv_sec + (double)now.tv_nsec / 1.0e9;
+   }
+
+
+/*****************************************************************************
+ * Private Function document_make
+ *****************************************************************************
+ *
+ * The document is "s0 { e0_0 = 0; ... } ... ", of MANY_SECTIONS sections of
+ * MANY_ENTRIES entries; each entry's value is its number in its section.
+ *
+ ****************************************************************************/
+
+static CFI_node_t document_make (void)
+   {
+   CFI_node_t  cfi = NULL;
+   FILE*       input;
+   const char* msg;
+   long        i;
+   long        j;
+
+   input = tmpfile ();
+   if (input == NULL) return NULL;
+   for (i = 0 ; i < MANY_SECTIONS ; i++)
+      {
+      fprintf (input, "s%ld {\n", i);
+      for (j = 0 ; j < MANY_ENTRIES ; j++)
+         fprintf (input, "e%ld_%ld = %ld;\n", i, j, j);
+      fprintf (input, "}\n");
+      }
+   rewind (input);
+
+   msg = cfi_get (fileno(input), &cfi);
+   if (msg != NULL) printf ("cfimany: %s\n", msg);
+   fclose (input);
+
+   return cfi;
+   }
+
+
+/*****************************************************************************
+ * Private Function result_check
+ *****************************************************************************
+ *
+ * The node for key "a_key" must be its entry; it is released.
+ *
+ ****************************************************************************/
+
+static int result_check (CFI_node_t a_node, long a_key)
+   {
+   int errNum = 0;
+
+   if ((a_node == NULL) ||
+       (cfi_attribute_int_get(cfi_node_attribute(a_node)) !=
+        a_key % MANY_ENTRIES))
+      {
+      errNum = 3;
+      }
+   if (a_node != NULL) (void)cfi_release (a_node);
+
+   return errNum;
+   }
+
+
+/*****************************************************************************
+ * Private Function main2
+ ****************************************************************************/
+
+static int main2 (void)
+   {
+   static char        words[MANY_KEYS][MANY_WORD];
+   static const char* keys[MANY_KEYS];
+   static int         types[MANY_KEYS];
+   static CFI_node_t  results[MANY_KEYS];
+   CFI_node_t         cfi;
+   double             search;
+   double             many;
+   long               i;
+   int                errNum = 0;
+
+   cfi = document_make ();
+   if (cfi == NULL)
+      {
+      printf ("cfimany: can't make the document\n");
+      return 1;
+      }
+
+   for (i = 0 ; i < MANY_KEYS ; i++)
+      {
+      sprintf (
+              words[i],
+              "e%ld_%ld",
+              (i*7919L) % MANY_SECTIONS,
+              i % MANY_ENTRIES
+              );
+      keys[i]  = words[i];
+      types[i] = CFI_ATTRIBUTES;
+      }
+
+   search = seconds ();
+   for (i = 0 ; i < MANY_KEYS ; i++)
+      {
+      results[i] = cfi_search (cfi, keys[i], types[i]);
+      }
+   search = seconds () - search;
+   for (i = 0 ; i < MANY_KEYS ; i++)
+      {
+      if (result_check(results[i],i) != 0) errNum = 3;
+      }
+
+   many = seconds ();
+   if (cfi_lookup_many(cfi,keys,types,MANY_KEYS,results) != NULL) errNum = 3;
+   many = seconds () - many;
+   for (i = 0 ; i < MANY_KEYS ; i++)
+      {
+      if (result_check(results[i],i) != 0) errNum = 3;
+      }
+
+   printf (
+          "cfimany: %ld nodes  %ld keys  cfi_search %8.1f ms"
+          "  cfi_lookup_many %6.1f ms\n",
+          MANY_SECTIONS * (MANY_ENTRIES + 1),
+          MANY_KEYS,
+          search * 1.0e3,
+          many * 1.0e3
+          );
+   if (errNum != 0) printf ("cfimany: a lookup is not right\n");
+
+   (void)cfi_delete_chain (cfi);
+
+   return errNum;
+   }
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      E x e c u t a b l e   C o d e   (MAIN PROGRAM)                       */
+/*                                                                           */
+/* ************************************************************************* */
+
+int   main (void)
+   {
+   (void)cfi_init ();
+   return main2 ();
+   }
+
+
+/* end of file */
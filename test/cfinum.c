@@ -0,0 +1,409 @@
+/*
+ * This file is completely free, public domain software.
+ */
+
+
+/* *****************************************************************************
+
+FILE NAME
+
+	$RCSfile:$
+	$Revision:$
+	$Date:$
+
+PROGRAM INFORMATION
+
+	Developed by:	libcfi project
+
+FILE DESCRIPTION
+
+	This is a libcfi number conversion benchmark main program.  This main
+	program must be linked with libcfi.
+
+	For each kind of CFI number, this program makes NUM_COUNT numbers like
+	those in configuration files and times converting them with libcfi's
+	cfi_number_integer() and cfi_number_real(), and with the C library
+	functions that the lexical analyzers used before: atof(), sscanf()
+	with "%x", atoi(), and a loop for octal and binary.  Every value from
+	libcfi is checked against the C library's value as well.
+
+	Return Values
+
+		0  Nothing to report.
+		3  Bad test result; a value differs from the C library's.
+
+***************************************************************************** */
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      F e a t u r e   S w i t c h e s                                      */
+/*                                                                           */
+/* ************************************************************************* */
+
+/*
+ * Select these feature by moving them from the `if UNDEF' into the `else'
+ * section.
+ */
+#ifdef	UNDEF
+#   define	_BSD_SOURCE	1	/* 4.3+bsd subsystems           */
+#   define	_POSIX_SOURCE	1	/* posix.1                      */
+#   define	_POSIX_C_SOURCE	199309L	/* posix.1 and posix.4          */
+#   define	_POSIX_C_SOURCE	199506L	/* posix.1 and posix.4 and MORE */
+#else
+#   define	_POSIX_C_SOURCE	200112L	/* posix.1 and posix.4 and MORE */
+#   ifndef	_REENTRANT
+#      define	_REENTRANT		/* thread-safe for glibc        */
+#   endif
+#endif
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      I n c l u d e d   F i l e s                                          */
+/*                                                                           */
+/* ************************************************************************* */
+
+/*
+ * Standard C (ANSI) Header Files
+ */
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+#include	<time.h>
+
+/*
+ * Posix Header Files
+ */
+#include	<unistd.h> /* always first amongst POSIX header files */
+
+/*
+ * Project Specific Header Files
+ */
+#include	"CFI.h"
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      M a n i f e s t   C o n s t a n t s                                  */
+/*                                                                           */
+/* ************************************************************************* */
+
+#define	NUM_COUNT	(200000) /* numbers of each kind            */
+#define	NUM_SIZE	(32)     /* the longest number, with a '\0' */
+#define	NUM_PASSES	(5)      /* the best pass is reported       */
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      D a t a   T y p e s   a n d   S t r u c t u r e s                    */
+/*                                                                           */
+/* ************************************************************************* */
+
+typedef struct S_kind_t
+   {
+   const char* name;
+   int         base; /* 0 for a real number */
+   }
+   S_kind_t;
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      P r i v a t e   G l o b a l   V a r i a b l e s                      */
+/*                                                                           */
+/* ************************************************************************* */
+
+static const S_kind_t g_kinds[] =
+   {
+   { "real", 0  },
+   { "hex",  16 },
+   { "dec",  10 },
+   { "oct",  8  },
+   { "bin",  2  },
+   { NULL,   0  }
+   };
+
+static char    g_text[NUM_COUNT][NUM_SIZE];
+static size_t  g_leng[NUM_COUNT];
+static double  g_real[NUM_COUNT];    /* from the C library */
+static long    g_num[NUM_COUNT];
+static double  g_cfiReal[NUM_COUNT]; /* from libcfi        */
+static int32_t g_cfiNum[NUM_COUNT];
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      E x e c u t a b l e   C o d e   (Locally Used Functions)             */
+/*                                                                           */
+/* ************************************************************************* */
+
+
+/*****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static double seconds (void);
+static void numbers_make (int base);
+static void libc_convert (int base);
+static int cfi_convert (int base);
+static int cfi_check (int base);
+static int main2 (const S_kind_t* kind);
+
+
+/*****************************************************************************
+ * Private Function seconds
+ ****************************************************************************/
+
+static double seconds (void)
+   {
+   struct timespec now;
+   (void)clock_gettime (CLOCK_MONOTONIC, &now);
+   return (double)now.tv_sec + (double)now.tv_nsec / 1.0e9;
+   }
+
+
+/*****************************************************************************
+ * Private Function numbers_make
+ *****************************************************************************
+ *
+ * Real numbers are weights and thresholds: a few digits, sometimes with an
+ * exponent.  Hex numbers are masks, and decimal numbers are counts.
+ *
+ ****************************************************************************/
+
+static void numbers_make (int a_base)
+   {
+   unsigned long value;
+   long          i;
+   int           j;
+
+   srand (1);
+   for (i = 0 ; i < NUM_COUNT ; i++)
+      {
+      value = ((unsigned long)rand() << 16) ^ (unsigned long)rand();
+      switch (a_base)
+         {
+         case 0:
+            if ((i % 4) == 0)
+               {
+               sprintf (
+                       g_text[i],
+                       "%lu.%lue-%lu",
+                       value % 10,
+                       value % 1000,
+                       value % 9
+                       );
+               }
+            else
+               {
+               sprintf (
+                       g_text[i],
+                       "%s%lu.%lu",
+                       (i % 3) == 0 ? "-" : "",
+                       value % 100,
+                       value % 10000
+                       );
+               }
+            break;
+         case 16:
+            sprintf (g_text[i], "0x%08lX", value & 0xFFFFFFFFUL);
+            break;
+         case 10:
+            sprintf (g_text[i], "%ld", (long)(value % 2000000) - 1000000);
+            break;
+         default:
+            g_text[i][0] = '0';
+            g_text[i][1] = a_base == 8 ? 'o' : 'b';
+            for (j = 2 ; j < (a_base == 8 ? 12 : 26) ; j++)
+               {
+               g_text[i][j] = '0' + (char)(value % a_base);
+               value /= a_base;
+               }
+            g_text[i][j] = '\0';
+            break;
+         }
+      g_leng[i] = strlen (g_text[i]);
+      }
+   }
+
+
+/*****************************************************************************
+ * Private Function libc_convert
+ *****************************************************************************
+ *
+ * This function converts the numbers the way the lexical analyzers did.
+ *
+ ****************************************************************************/
+
+static void libc_convert (int a_base)
+   {
+   const char* p;
+   long        i;
+   int         num;
+
+   for (i = 0 ; i < NUM_COUNT ; i++)
+      {
+      switch (a_base)
+         {
+         case 0:
+            g_real[i] = atof (g_text[i]);
+            break;
+         case 16:
+            (void)sscanf (g_text[i], "%x", (unsigned int*)&num);
+            g_num[i] = num;
+            break;
+         case 10:
+            g_num[i] = atoi (g_text[i]);
+            break;
+         default:
+            num = 0;
+            for (p = &g_text[i][2] ; *p != '\0' ; p++)
+               {
+               num = num * a_base + (*p - '0');
+               }
+            g_num[i] = num;
+            break;
+         }
+      }
+   }
+
+
+/*****************************************************************************
+ * Private Function cfi_convert
+ *****************************************************************************
+ *
+ * This function converts the numbers with libcfi, as the lexical analyzers
+ * do now; it returns the number of conversion errors.
+ *
+ ****************************************************************************/
+
+static int cfi_convert (int a_base)
+   {
+   long i;
+   int  bad = 0;
+
+   for (i = 0 ; i < NUM_COUNT ; i++)
+      {
+      if (a_base == 0)
+         {
+         if (cfi_number_real(g_text[i],g_leng[i],&g_cfiReal[i]) != NULL) bad++;
+         }
+      else
+         {
+         if (cfi_number_integer(
+                               g_text[i],
+                               g_leng[i],
+                               a_base,
+                               &g_cfiNum[i]
+                               ) != NULL)
+            {
+            bad++;
+            }
+         }
+      }
+
+   return bad;
+   }
+
+
+/*****************************************************************************
+ * Private Function cfi_check
+ *****************************************************************************
+ *
+ * This function counts the numbers from libcfi that are not the same as the
+ * numbers from the C library.
+ *
+ ****************************************************************************/
+
+static int cfi_check (int a_base)
+   {
+   long i;
+   int  bad = 0;
+
+   for (i = 0 ; i < NUM_COUNT ; i++)
+      {
+      if (a_base == 0)
+         {
+         if (g_cfiReal[i] != g_real[i]) bad++;
+         }
+      else
+         {
+         if (g_cfiNum[i] != g_num[i]) bad++;
+         }
+      }
+
+   return bad;
+   }
+
+
+/*****************************************************************************
+ * Private Function main2
+ ****************************************************************************/
+
+static int main2 (const S_kind_t* a_kind)
+   {
+   double libcTime = 1.0e9;
+   double cfiTime  = 1.0e9;
+   double start;
+   int    bad = 0;
+   int    i;
+
+   numbers_make (a_kind->base);
+
+   for (i = 0 ; i < NUM_PASSES ; i++)
+      {
+      start = seconds ();
+      libc_convert (a_kind->base);
+      start = seconds () - start;
+      if (start < libcTime) libcTime = start;
+
+      start = seconds ();
+      bad   = cfi_convert (a_kind->base);
+      start = seconds () - start;
+      if (start < cfiTime) cfiTime = start;
+      }
+   bad += cfi_check (a_kind->base);
+
+   printf (
+          "cfinum: %-4s  libc %6.1f ns  libcfi %6.1f ns  %5.2fx  (e.g. %s)\n",
+          a_kind->name,
+          libcTime * 1.0e9 / NUM_COUNT,
+          cfiTime * 1.0e9 / NUM_COUNT,
+          libcTime / cfiTime,
+          g_text[0]
+          );
+   if (bad != 0)
+      {
+      printf (
+             "cfinum: %s: %d values differ from the C library\n",
+             a_kind->name,
+             bad
+             );
+      }
+
+   return bad;
+   }
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      E x e c u t a b l e   C o d e   (MAIN PROGRAM)                       */
+/*                                                                           */
+/* ************************************************************************* */
+
+int   main (void)
+   {
+   int errNum = 0;
+   int i;
+
+   for (i = 0 ; g_kinds[i].name != NULL ; i++)
+      {
+      if (main2(&g_kinds[i]) != 0) errNum = 3;
+      }
+
+   return errNum;
+   }
+
+
+/* end of file */
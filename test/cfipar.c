@@ -0,0 +1,317 @@
+/*
+ * This file is completely free, public domain software.
+ */
+
+
+/* *****************************************************************************
+
+FILE NAME
+
+	$RCSfile:$
+	$Revision:$
+	$Date:$
+
+PROGRAM INFORMATION
+
+	Developed by:	libcfi project
+
+FILE DESCRIPTION
+
+	This is a libcfi parallel parse benchmark main program.  This main
+	program must be linked with libcfi.
+
+	This program makes a configuration file of many top level sections
+	and entries, DOC_SIZE megabytes by default or as many as the first
+	argument says, and times parsing it with cfi_parser_get() and 1, 2,
+	4, ... threads, up to DOC_THREADS or the second argument.  The tree
+	from each parse is checked against the tree from the parse with one
+	thread.
+
+	Usage
+
+		cfipar [megabytes [threads]]
+
+	Return Values
+
+		0  Nothing to report.
+		1  Bad command line, or the file can't be made or parsed.
+		3  Bad test result; a tree differs from the one thread tree.
+
+***************************************************************************** */
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      F e a t u r e   S w i t c h e s                                      */
+/*                                                                           */
+/* ************************************************************************* */
+
+/*
+ * Select these feature by moving them from the `if UNDEF' into the `else'
+ * section.
+ */
+#ifdef	UNDEF
+#   define	_BSD_SOURCE	1	/* 4.3+bsd subsystems           */
+#   define	_POSIX_SOURCE	1	/* posix.1                      */
+#   define	_POSIX_C_SOURCE	199309L	/* posix.1 and posix.4          */
+#   define	_POSIX_C_SOURCE	199506L	/* posix.1 and posix.4 and MORE */
+#else
+#   define	_POSIX_C_SOURCE	200112L	/* posix.1 and posix.4 and MORE */
+#   ifndef	_REENTRANT
+#      define	_REENTRANT		/* thread-safe for glibc        */
+#   endif
+#endif
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      I n c l u d e d   F i l e s                                          */
+/*                                                                           */
+/* ************************************************************************* */
+
+/*
+ * Standard C (ANSI) Header Files
+ */
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+#include	<time.h>
+#include	<fcntl.h>
+
+/*
+ * Posix Header Files
+ */
+#include	<unistd.h> /* always first amongst POSIX header files */
+
+/*
+ * Project Specific Header Files
+ */
+#include	"CFI.h"
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      M a n i f e s t   C o n s t a n t s                                  */
+/*                                                                           */
+/* ************************************************************************* */
+
+#define	DOC_SIZE	(64)  /* default megabytes of the file       */
+#define	DOC_THREADS	(32)  /* default most threads                */
+#define	DOC_PASSES	(3)   /* the best pass is reported           */
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      E x e c u t a b l e   C o d e   (Locally Used Functions)             */
+/*                                                                           */
+/* ************************************************************************* */
+
+
+/*****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static double seconds (void);
+static FILE* doc_make (long size);
+static unsigned long tree_hash (CFI_node_t node, unsigned long hash);
+static int doc_parse (
+                     int            fd,
+                     unsigned       threads,
+                     double*        time,
+                     unsigned long* hash
+                     );
+
+
+/*****************************************************************************
+ * Private Function seconds
+ ****************************************************************************/
+
+static double seconds (void)
+   {
+   struct timespec now;
+   (void)clock_gettime (CLOCK_MONOTONIC, &now);
+   return (double)now.tv_sec + (double)now.tv_nsec / 1.0e9;
+   }
+
+
+/*****************************************************************************
+ * Private Function doc_make
+ *****************************************************************************
+ *
+ * The file is a list of server sections, like a generated service file, with
+ * a flat entry now and then; it is at least "a_size" bytes.
+ *
+ ****************************************************************************/
+
+static FILE* doc_make (long a_size)
+   {
+   FILE* doc = tmpfile ();
+   long  i;
+
+   if (doc == NULL) return NULL;
+
+   for (i = 0 ; ftell(doc) < a_size ; i++)
+      {
+      fprintf (doc, "server (\"web%ld\") {\n", i);
+      fprintf (
+              doc,
+              "   listen = \"10.%ld.%ld.1\", %ld;\n",
+              i / 256 % 256,
+              i % 256,
+              8000 + i % 1000
+              );
+      fprintf (doc, "   weight = %ld.%02ld; -- relative\n", i%10, i%100);
+      fprintf (doc, "   enabled;\n");
+      fprintf (doc, "   limits { rate = %ld; burst = 0x%lX; }\n", i%5000, i%64);
+      fprintf (doc, "}\n");
+      if ((i % 8) == 0) fprintf (doc, "generation = %ld;\n", i);
+      }
+
+   if ((fflush(doc) != 0) || (ferror(doc)))
+      {
+      fclose (doc);
+      return NULL;
+      }
+
+   return doc;
+   }
+
+
+/*****************************************************************************
+ * Private Function tree_hash
+ ****************************************************************************/
+
+static unsigned long tree_hash (CFI_node_t a_node, unsigned long a_hash)
+   {
+   CFI_attr_t  attr;
+   const char* p;
+
+   for ( ; a_node != NULL ; a_node = cfi_node_next(a_node))
+      {
+      a_hash = a_hash * 31 + cfi_node_type_get (a_node);
+      for (p = cfi_node_word(a_node) ; *p != '\0' ; p++)
+         {
+         a_hash = a_hash * 31 + (unsigned char)*p;
+         }
+      attr = cfi_node_attribute (a_node);
+      for ( ; attr != NULL ; attr = cfi_attribute_next(attr))
+         {
+         a_hash = a_hash * 31 + cfi_attribute_type_get (attr);
+         }
+      a_hash = tree_hash (cfi_node_section(a_node), a_hash * 31 + '{');
+      }
+
+   return a_hash;
+   }
+
+
+/*****************************************************************************
+ * Private Function doc_parse
+ ****************************************************************************/
+
+static int doc_parse (
+                     int            a_fd,
+                     unsigned       a_threads,
+                     double*        a_time,
+                     unsigned long* a_hash
+                     )
+   {
+   CFI_parser_t parser;
+   CFI_node_t   cfi;
+   const char*  msg;
+   double       start;
+   int          i;
+
+   if (cfi_parser_new(&parser) != NULL) return -1;
+   (void)cfi_parser_threads (parser, a_threads);
+
+   *a_time = 1.0e9;
+   for (i = 0 ; i < DOC_PASSES ; i++)
+      {
+      (void)lseek (a_fd, 0, SEEK_SET);
+      start = seconds ();
+      msg   = cfi_parser_get (parser, a_fd, &cfi);
+      start = seconds () - start;
+      if (msg != NULL)
+         {
+         printf ("cfipar: %s\n", msg);
+         (void)cfi_parser_del (&parser);
+         return -1;
+         }
+      if (start < *a_time) *a_time = start;
+      if (i == 0) *a_hash = tree_hash (cfi, 0);
+      (void)cfi_delete_chain (cfi);
+      }
+
+   (void)cfi_parser_del (&parser);
+
+   return 0;
+   }
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      E x e c u t a b l e   C o d e   (MAIN PROGRAM)                       */
+/*                                                                           */
+/* ************************************************************************* */
+
+int   main (int argc, char* argv[])
+   {
+   FILE*         doc;
+   double        mb;
+   long          size    = DOC_SIZE;
+   unsigned      most    = DOC_THREADS;
+   unsigned      threads;
+   unsigned long hash;
+   unsigned long oneHash = 0;
+   double        time;
+   double        oneTime = 0.0;
+   int           errNum  = 0;
+
+   if (argc > 1) size = atol (argv[1]);
+   if (argc > 2) most = (unsigned)atoi (argv[2]);
+   if ((argc > 3) || (size <= 0) || (most == 0))
+      {
+      fprintf (stderr, "usage: cfipar [megabytes [threads]]\n");
+      return 1;
+      }
+
+   doc = doc_make (size << 20);
+   if (doc == NULL)
+      {
+      fprintf (stderr, "cfipar: can't make the file.\n");
+      return 1;
+      }
+   mb = (double)ftell (doc) / (1 << 20);
+   printf ("cfipar: %.1f MB\n", mb);
+
+   for (threads = 1 ; threads <= most ; threads *= 2)
+      {
+      if (doc_parse(fileno(doc),threads,&time,&hash) != 0)
+         {
+         errNum = 1;
+         break;
+         }
+      if (threads == 1)
+         {
+         oneTime = time;
+         oneHash = hash;
+         }
+      printf (
+             "cfipar: %2u threads %9.1f ms %8.1f MB/s %6.2fx%s\n",
+             threads,
+             time * 1.0e3,
+             mb / time,
+             oneTime / time,
+             hash == oneHash ? "" : "  (tree differs)"
+             );
+      if (hash != oneHash) errNum = 3;
+      }
+
+   fclose (doc);
+
+   return errNum;
+   }
+
+
+/* end of file */
@@ -0,0 +1,3581 @@
+/*
+ * This file is completely free, public domain software.
+ */
+
+
+/* *****************************************************************************
+
+FILE NAME
+
+	$RCSfile:$
+	$Revision:$
+	$Date:$
+
+PROGRAM INFORMATION
+
+	Developed by:	libcfi project
+
+FILE DESCRIPTION
+
+	This is a libcfi regression test main program.  This main program must
+	be linked with libcfi.
+
+	Each test makes its own input, sucks it through the CFI grammer with
+	cfi_get(), or cfi_parse_events(), and checks the resulting opaque
+	libcfi structure, or events.  The name
+	of each test and its result are reported as the tests are run; a test
+	name on the command line runs only that test.
+
+	Return Values
+
+		0  All of the tests passed.
+		1  Bad command line; there is no such test.
+		3  Bad test result; at least one test failed.
+
+***************************************************************************** */
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      F e a t u r e   S w i t c h e s                                      */
+/*                                                                           */
+/* ************************************************************************* */
+
+/*
+ * Select these feature by moving them from the `if UNDEF' into the `else'
+ * section.
+ */
+#ifdef	UNDEF
+#   define	_BSD_SOURCE	1	/* 4.3+bsd subsystems           */
+#   define	_POSIX_SOURCE	1	/* posix.1                      */
+#   define	_POSIX_C_SOURCE	199309L	/* posix.1 and posix.4          */
+#   define	_POSIX_C_SOURCE	199506L	/* posix.1 and posix.4 and MORE */
+#else
+#   define	_POSIX_C_SOURCE	200112L	/* posix.1 and posix.4 and MORE */
+#   ifndef	_REENTRANT
+#      define	_REENTRANT		/* thread-safe for glibc        */
+#   endif
+#endif
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      I n c l u d e d   F i l e s                                          */
+/*                                                                           */
+/* ************************************************************************* */
+
+/*
+ * Standard C (ANSI) Header Files
+ */
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	<string.h>
+
+/*
+ * Posix Header Files
+ */
+#include	<unistd.h> /* always first amongst POSIX header files */
+#include	<sys/wait.h>
+
+/*
+ * Project Specific Header Files
+ */
+#include	"CFI.h"
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      M a n i f e s t   C o n s t a n t s                                  */
+/*                                                                           */
+/* ************************************************************************* */
+
+#define	FLAT_ENTRIES	(2000000L) /* entries in the flat file test       */
+#define	LIST_ENTRIES	(500000L)  /* attributes in the long list test    */
+#define	NEST_DEPTH	(200)      /* sections in the nested section test */
+#define	DEEP_DEPTH	(10000)    /* the deepest sections that can be parsed */
+#define	EVENTS_SIZE	(512)      /* text of the events in the event test */
+#define	STRING_SIZE	(10L<<20)  /* bytes of the long string test        */
+#define	STRING_QUOTES	(31)       /* escaped quotes on each of its lines   */
+#define	VALUE_SIZE	(40)       /* longest value of the values test      */
+#define	INDEX_ENTRIES	(200)      /* entries of the section index test     */
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      D a t a   T y p e s   a n d   S t r u c t u r e s                    */
+/*                                                                           */
+/* ************************************************************************* */
+
+typedef int (*T_test_t) (void);
+
+typedef struct S_test_t
+   {
+   const char* name;
+   T_test_t    test;
+   }
+   S_test_t;
+
+typedef struct S_count_t
+   {
+   long allocs; /* allocations that are not freed */
+   long calls;  /* calls of the allocator         */
+   }
+   S_count_t;
+
+typedef struct S_record_t
+   {
+   char text[EVENTS_SIZE]; /* the events, as text                 */
+   int  count;             /* number of events                    */
+   int  stop;              /* event that stops the parse, or zero */
+   }
+   S_record_t;
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      E x e c u t a b l e   C o d e   (Locally Used Functions)             */
+/*                                                                           */
+/* ************************************************************************* */
+
+
+/*****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static FILE* input_new (void);
+static int input_get (FILE* input, CFI_node_t* cfi);
+static int test_flat (void);
+static int test_list (void);
+static int test_nest (void);
+static int test_numbers (void);
+static int record (S_record_t* record, const char* text, size_t leng);
+static int record_value (S_record_t* record, const CFI_value_t* value);
+static int record_begin (
+                        void*              user,
+                        const char*        word,
+                        size_t             leng,
+                        const CFI_value_t* param
+                        );
+static int record_word (void* user, const char* word, size_t leng);
+static int record_attribute (
+                            void*              user,
+                            const char*        word,
+                            size_t             leng,
+                            const CFI_value_t* values,
+                            size_t             count
+                            );
+static int record_end (void* user);
+static int test_events (void);
+static int attr_same (CFI_attr_t attr1, CFI_attr_t attr2);
+static int tree_same (CFI_node_t tree1, CFI_node_t tree2);
+static int test_lazy (void);
+static int parallel_get (FILE* input, unsigned threads, CFI_node_t* cfi);
+static int test_parallel (void);
+static int text_get (const char* text, int lazy, CFI_node_t* cfi);
+static int reparse_edit (
+                        CFI_node_t* cfi,
+                        char*       text,
+                        const char* from,
+                        const char* to,
+                        int         good
+                        );
+static int test_reparse (void);
+static int test_strings (void);
+static int arena_get (
+                     FILE*       input,
+                     size_t      blockSize,
+                     unsigned    threads,
+                     CFI_node_t* cfi
+                     );
+static size_t node_count (CFI_node_t node);
+static int arena_check (CFI_node_t cfi, const char* what);
+static int test_arena (void);
+static void value_make (char* text, int leng, int type);
+static int value_check (CFI_node_t cfi, const char* what);
+static int test_values (void);
+static int test_keys (void);
+static int attrs_check (
+                       CFI_node_t     node,
+                       const int32_t* values,
+                       size_t         count,
+                       const char*    what
+                       );
+static int test_attributes (void);
+static int freeze_check (
+                        CFI_node_t  cfi,
+                        CFI_node_t  frozen,
+                        const char* what
+                        );
+static int test_freeze (void);
+static void* count_malloc (void* user, size_t size);
+static void* count_calloc (void* user, size_t count, size_t size);
+static void* count_realloc (void* user, void* ptr, size_t size);
+static void count_free (void* user, void* ptr);
+static int test_allocator (void);
+static int test_memory (void);
+static int test_peek (void);
+static int index_value (CFI_node_t contents, const char* word);
+static int test_index (void);
+static int lookup_value (CFI_node_t cfi, const char* path);
+static int test_lookup (void);
+static int test_pin (void);
+static const char* cursor_types (
+                                CFI_node_t  cfi,
+                                const char* word,
+                                unsigned    types,
+                                int         depth
+                                );
+static int test_cursor (void);
+static int test_many (void);
+static int test_errors (void);
+static int test_stream (void);
+
+
+/*****************************************************************************
+ * Private Function input_new
+ ****************************************************************************/
+
+static FILE* input_new (void)
+   {
+   FILE* input = tmpfile ();
+   if (input == NULL) fprintf (stderr, "cfitest: can't make a temp file.\n");
+   return input;
+   }
+
+
+/*****************************************************************************
+ * Private Function input_get
+ *****************************************************************************
+ *
+ * This function parses what was written to the input temp file, and then
+ * closes it.
+ *
+ ****************************************************************************/
+
+static int input_get (FILE* a_input, CFI_node_t* a_cfi)
+   {
+   const char* msg;
+
+   *a_cfi = NULL;
+
+   if ((fflush(a_input) != 0) || (lseek(fileno(a_input),0,SEEK_SET) != 0))
+      {
+      fclose (a_input);
+      printf ("   can't write the input\n");
+      return -1;
+      }
+
+   msg = cfi_get (fileno(a_input), a_cfi);
+   fclose (a_input);
+   if (msg != NULL)
+      {
+      printf ("   cfi_get: %s\n", msg);
+      return -1;
+      }
+
+   return 0;
+   }
+
+
+/*****************************************************************************
+ * Private Function test_flat
+ *****************************************************************************
+ *
+ * A flat file of FLAT_ENTRIES entries; the entries must come back in order.
+ *
+ ****************************************************************************/
+
+static int test_flat (void)
+   {
+   FILE*      input = input_new ();
+   CFI_node_t cfi;
+   CFI_node_t node;
+   long       i;
+   char       word[32];
+
+   if (input == NULL) return -1;
+
+   for (i = 0 ; i < FLAT_ENTRIES ; i++)
+      {
+      if ((i % 16) == 0)
+         fprintf (input, "a%ld = %ld, \"s%ld\";\n", i, i, i);
+      else
+         fprintf (input, "w%ld;\n", i);
+      }
+
+   if (input_get(input,&cfi) != 0) return -1;
+
+   for (node = cfi, i = 0 ; node != NULL ; node = cfi_node_next(node), i++)
+      {
+      sprintf (word, "%c%ld", (i % 16) == 0 ? 'a' : 'w', i);
+      if (strcmp(cfi_node_word(node),word) != 0)
+         {
+         printf ("   entry %ld is \"%s\"\n", i, cfi_node_word(node));
+         break;
+         }
+      if (((i % 16) == 0) &&
+          ((cfi_node_type_get(node) != CFI_ATTRIBUTES) ||
+           (cfi_node_attribute_count(node) != 2) ||
+           (cfi_attribute_int_get(cfi_node_attribute(node)) != i)))
+         {
+         printf ("   entry %ld has the wrong attributes\n", i);
+         break;
+         }
+      }
+
+   if (node == NULL && i != FLAT_ENTRIES)
+      {
+      printf ("   %ld entries, not %ld\n", i, FLAT_ENTRIES);
+      }
+
+   (void)cfi_delete_chain (cfi);
+
+   return ((node == NULL) && (i == FLAT_ENTRIES)) ? 0 : -1;
+   }
+
+
+/*****************************************************************************
+ * Private Function test_list
+ *****************************************************************************
+ *
+ * One entry with a list of LIST_ENTRIES attributes, in a section.
+ *
+ ****************************************************************************/
+
+static int test_list (void)
+   {
+   FILE*      input = input_new ();
+   CFI_node_t cfi;
+   CFI_node_t node;
+   CFI_attr_t attr;
+   long       i;
+
+   if (input == NULL) return -1;
+
+   fprintf (input, "list {\nlist = 0");
+   for (i = 1 ; i < LIST_ENTRIES ; i++) fprintf (input, ", %ld", i);
+   fprintf (input, ";\n}\n");
+
+   if (input_get(input,&cfi) != 0) return -1;
+
+   node = cfi_search (cfi, "list", CFI_ATTRIBUTES);
+   if (node == NULL)
+      {
+      printf ("   can't find the list\n");
+      (void)cfi_delete_chain (cfi);
+      return -1;
+      }
+   (void)cfi_release (node);
+
+   if (cfi_node_attribute_count(node) != LIST_ENTRIES)
+      {
+      printf (
+             "   %lu attributes, not %ld\n",
+             (unsigned long)cfi_node_attribute_count(node),
+             LIST_ENTRIES
+             );
+      }
+
+   attr = cfi_node_attribute (node);
+   for (i = 0 ; attr != NULL ; attr = cfi_attribute_next(attr), i++)
+      {
+      if (cfi_attribute_int_get(attr) != i)
+         {
+         printf ("   attribute %ld is %ld\n", i, (long)cfi_attribute_int_get(attr));
+         break;
+         }
+      }
+
+   (void)cfi_delete_chain (cfi);
+
+   return ((attr == NULL) && (i == LIST_ENTRIES)) ? 0 : -1;
+   }
+
+
+/*****************************************************************************
+ * Private Function test_nest
+ *****************************************************************************
+ *
+ * NEST_DEPTH nested sections, each with an entry before and after the inner
+ * section; deleting the tree must delete every level.
+ *
+ ****************************************************************************/
+
+static int test_nest (void)
+   {
+   FILE*      input = input_new ();
+   CFI_node_t cfi;
+   CFI_node_t node;
+   int        i;
+
+   if (input == NULL) return -1;
+
+   for (i = 0 ; i < NEST_DEPTH ; i++) fprintf (input, "s%d { b%d;\n", i, i);
+   for (i = NEST_DEPTH-1 ; i >= 0 ; i--) fprintf (input, "e%d = %d; }\n", i, i);
+
+   if (input_get(input,&cfi) != 0) return -1;
+
+   node = cfi;
+   for (i = 0 ; (node != NULL) && (i < NEST_DEPTH) ; i++)
+      {
+      CFI_node_t first;
+      CFI_node_t last;
+      char       word[16];
+      sprintf (word, "s%d", i);
+      if ((cfi_node_type_get(node) != CFI_SECTION) ||
+          (strcmp(cfi_node_word(node),word) != 0))
+         {
+         printf ("   section %d is \"%s\"\n", i, cfi_node_word(node));
+         break;
+         }
+      first = cfi_node_section (node);
+      node  = i < NEST_DEPTH-1 ? cfi_node_next (first) : NULL;
+      last  = cfi_node_next (node == NULL ? first : node);
+      if ((last == NULL) || (cfi_node_type_get(last) != CFI_ATTRIBUTES) ||
+          (cfi_attribute_int_get(cfi_node_attribute(last)) != i))
+         {
+         printf ("   section %d has the wrong contents\n", i);
+         break;
+         }
+      }
+   if (i != NEST_DEPTH) i = -1;
+
+   (void)cfi_delete_chain (cfi);
+
+   return i == NEST_DEPTH ? 0 : -1;
+   }
+
+
+/*****************************************************************************
+ * Private Function test_numbers
+ *****************************************************************************
+ *
+ * Numbers of each kind at the ends of their ranges must convert exactly, and
+ * a number out of range must be an error.
+ *
+ ****************************************************************************/
+
+static int test_numbers (void)
+   {
+   static const char* const ranges[] =
+      {
+      "n = 2147483648;",
+      "n = -2147483649;",
+      "n = 0x100000000;",
+      "n = 0o40000000000;",
+      "n = 0b111111111111111111111111111111111;",
+      "n = 1.0e309;",
+      NULL
+      };
+   static const int32_t ints[] =
+      {
+      2147483647, -2147483647-1, -1, 15, 5
+      };
+   static const double reals[] =
+      {
+      0.1, -1.5e-3, 2.2250738585072011e-308, 1.7976931348623157e308
+      };
+   FILE*        input = input_new ();
+   CFI_parser_t parser;
+   CFI_node_t   cfi;
+   CFI_attr_t   attr;
+   const char*  msg;
+   int          errNum = 0;
+   int          i;
+
+   if (input == NULL) return -1;
+
+   fprintf (input, "n = 2147483647, -2147483648, 0xFFFFFFFF, 0o17, 0b101");
+   fprintf (input, ", 0.1, -1.5e-3, 2.2250738585072011e-308");
+   fprintf (input, ", 1.7976931348623157e308;\n");
+
+   if (input_get(input,&cfi) != 0) return -1;
+
+   attr = cfi_node_attribute (cfi);
+   for (i = 0 ; i < 9 ; i++, attr = cfi_attribute_next(attr))
+      {
+      if (attr == NULL)
+         {
+         printf ("   %d attributes, not 9\n", i);
+         errNum = -1;
+         break;
+         }
+      if ((i < 5) && (cfi_attribute_int_get(attr) != ints[i]))
+         {
+         printf ("   number %d is %ld\n", i, (long)cfi_attribute_int_get(attr));
+         errNum = -1;
+         }
+      if ((i >= 5) && (cfi_attribute_real_get(attr) != reals[i-5]))
+         {
+         printf ("   number %d is %.17g\n", i, cfi_attribute_real_get(attr));
+         errNum = -1;
+         }
+      }
+   (void)cfi_delete_chain (cfi);
+
+   /*
+    * cfi_get() says only "syntax error", so these use a parser to see why.
+    */
+   if (cfi_parser_new(&parser) != NULL) return -1;
+   for (i = 0 ; ranges[i] != NULL ; i++)
+      {
+      input = input_new ();
+      if (input == NULL) break;
+      fputs (ranges[i], input);
+      (void)fflush (input);
+      (void)lseek (fileno(input), 0, SEEK_SET);
+      msg = cfi_parser_get (parser, fileno(input), &cfi);
+      fclose (input);
+      if ((msg == NULL) || (strstr(msg,"out of range") == NULL) ||
+          (cfi != NULL))
+         {
+         printf ("   \"%s\" is not out of range\n", ranges[i]);
+         (void)cfi_delete_chain (cfi);
+         errNum = -1;
+         }
+      }
+   (void)cfi_parser_del (&parser);
+
+   return errNum;
+   }
+
+
+/*****************************************************************************
+ * Private Function record
+ *****************************************************************************
+ *
+ * The event functions append each event to the text of a record; an event
+ * is counted when it starts, and the event numbered "stop" stops the parse.
+ *
+ ****************************************************************************/
+
+static int record (S_record_t* a_record, const char* a_text, size_t a_leng)
+   {
+   size_t used = strlen (a_record->text);
+
+   if ((used + a_leng) < EVENTS_SIZE)
+      {
+      (void)memcpy (&a_record->text[used], a_text, a_leng);
+      a_record->text[used+a_leng] = '\0';
+      }
+
+   return 0;
+   }
+
+
+/*****************************************************************************
+ * Private Function record_value
+ ****************************************************************************/
+
+static int record_value (S_record_t* a_record, const CFI_value_t* a_value)
+   {
+   char buff[32];
+
+   switch (a_value->type)
+      {
+      case CFI_WORD_ATTRIBUTE:
+      case CFI_STRING_ATTRIBUTE:
+         (void)record (a_record, " ", 1);
+         return record (a_record, a_value->text, a_value->leng);
+      case CFI_REAL_ATTRIBUTE:
+         sprintf (buff, " %g", a_value->real);
+         break;
+      default:
+         sprintf (buff, " %ld", (long)a_value->num);
+         break;
+      }
+
+   return record (a_record, buff, strlen(buff));
+   }
+
+
+/*****************************************************************************
+ * Private Function record_begin
+ ****************************************************************************/
+
+static int record_begin (
+                        void*              a_user,
+                        const char*        a_word,
+                        size_t             a_leng,
+                        const CFI_value_t* a_param
+                        )
+   {
+   S_record_t* rec = (S_record_t*)a_user;
+
+   (void)record (rec, "B ", 2);
+   (void)record (rec, a_word, a_leng);
+   if (a_param != NULL) (void)record_value (rec, a_param);
+   (void)record (rec, "|", 1);
+
+   return ++rec->count == rec->stop;
+   }
+
+
+/*****************************************************************************
+ * Private Function record_word
+ ****************************************************************************/
+
+static int record_word (void* a_user, const char* a_word, size_t a_leng)
+   {
+   S_record_t* rec = (S_record_t*)a_user;
+
+   (void)record (rec, "W ", 2);
+   (void)record (rec, a_word, a_leng);
+   (void)record (rec, "|", 1);
+
+   return ++rec->count == rec->stop;
+   }
+
+
+/*****************************************************************************
+ * Private Function record_attribute
+ ****************************************************************************/
+
+static int record_attribute (
+                            void*              a_user,
+                            const char*        a_word,
+                            size_t             a_leng,
+                            const CFI_value_t* a_values,
+                            size_t             a_count
+                            )
+   {
+   S_record_t* rec = (S_record_t*)a_user;
+   size_t      i;
+
+   (void)record (rec, "A ", 2);
+   (void)record (rec, a_word, a_leng);
+   for (i = 0 ; i < a_count ; i++) (void)record_value (rec, &a_values[i]);
+   (void)record (rec, "|", 1);
+
+   return ++rec->count == rec->stop;
+   }
+
+
+/*****************************************************************************
+ * Private Function record_end
+ ****************************************************************************/
+
+static int record_end (void* a_user)
+   {
+   S_record_t* rec = (S_record_t*)a_user;
+
+   (void)record (rec, "E|", 2);
+
+   return ++rec->count == rec->stop;
+   }
+
+
+/*****************************************************************************
+ * Private Function test_events
+ *****************************************************************************
+ *
+ * The event parse of a file must give the events of the document in order,
+ * with the values as they are in the input; an event function must be able
+ * to stop the parse, and a syntax error must be reported; an error that isn't
+ * a syntax error must not be reported as one.
+ *
+ ****************************************************************************/
+
+static int test_events (void)
+   {
+   static const CFI_events_t events =
+      {
+      record_begin, record_word, record_attribute, record_end
+      };
+   static const char text[] =
+      "top;\n"
+      "a = 1, 0x1F, 2.5, word, \"s\\\"q\";\n"
+      "sec (\"p\") {\n"
+      "   inner { b; }\n"
+      "   -- c;\n"
+      "}\n"
+      "last = -3;\n";
+   static const char* const want =
+      "W top|A a 1 31 2.5 word s\\\"q|B sec p|B inner|W b|E|E|A last -3|";
+   FILE*       input = input_new ();
+   S_record_t  rec;
+   const char* msg;
+   int         errNum = 0;
+
+   if (input == NULL) return -1;
+
+   fputs (text, input);
+   (void)fflush (input);
+   (void)lseek (fileno(input), 0, SEEK_SET);
+   rec.text[0] = '\0';
+   rec.count   = 0;
+   rec.stop    = 0;
+   msg = cfi_parse_events (fileno(input), &events, &rec);
+   fclose (input);
+   if ((msg != NULL) || (strcmp(rec.text,want) != 0))
+      {
+      printf ("   events \"%s\"%s\n", rec.text, msg == NULL ? "" : " (error)");
+      errNum = -1;
+      }
+
+   /*
+    * Stop at the second section.
+    */
+   rec.text[0] = '\0';
+   rec.count   = 0;
+   rec.stop    = 4;
+   msg = cfi_parse_events_text (text, &events, &rec);
+   if ((msg != NULL) || (strcmp(rec.text,"W top|A a 1 31 2.5 word s\\\"q|"
+                                         "B sec p|B inner|") != 0))
+      {
+      printf ("   stopped events \"%s\"\n", rec.text);
+      errNum = -1;
+      }
+
+   rec.text[0] = '\0';
+   rec.count   = 0;
+   rec.stop    = 0;
+   msg = cfi_parse_events_text ("s { a; } }", &events, &rec);
+   if ((msg == NULL) || (strcmp(rec.text,"B s|W a|E|") != 0))
+      {
+      printf ("   syntax error events \"%s\"\n", rec.text);
+      errNum = -1;
+      }
+
+   input = input_new ();
+   if (input == NULL) return -1;
+   fputs ("s { a; } }", input);
+   (void)fflush (input);
+   (void)lseek (fileno(input), 0, SEEK_SET);
+   msg = cfi_parse_events (fileno(input), &events, &rec);
+   fclose (input);
+   if ((msg == NULL) || (strcmp(msg,"syntax error") != 0))
+      {
+      printf ("   a syntax error event parse gives \"%s\"\n", msg);
+      errNum = -1;
+      }
+
+   msg = cfi_parse_events (-1, &events, &rec);
+   if ((msg == NULL) || (strcmp(msg,"can't get status on input") != 0))
+      {
+      printf ("   a bad descriptor event parse gives \"%s\"\n", msg);
+      errNum = -1;
+      }
+
+   return errNum;
+   }
+
+
+/*****************************************************************************
+ * Private Function attr_same
+ ****************************************************************************/
+
+static int attr_same (CFI_attr_t a_attr1, CFI_attr_t a_attr2)
+   {
+   char* text1;
+   char* text2;
+   int   same;
+
+   if (cfi_attribute_type_get(a_attr1) != cfi_attribute_type_get(a_attr2))
+      {
+      return 0;
+      }
+
+   switch (cfi_attribute_type_get(a_attr1))
+      {
+      case CFI_WORD_ATTRIBUTE:
+         text1 = cfi_attribute_word_get (a_attr1);
+         text2 = cfi_attribute_word_get (a_attr2);
+         break;
+      case CFI_STRING_ATTRIBUTE:
+         text1 = cfi_attribute_string_get (a_attr1);
+         text2 = cfi_attribute_string_get (a_attr2);
+         break;
+      case CFI_REAL_ATTRIBUTE:
+         return cfi_attribute_real_get(a_attr1) ==
+                cfi_attribute_real_get(a_attr2);
+      default:
+         return cfi_attribute_int_get(a_attr1) ==
+                cfi_attribute_int_get(a_attr2);
+      }
+
+   same = (text1 != NULL) && (text2 != NULL) && (strcmp(text1,text2) == 0);
+   free (text1);
+   free (text2);
+
+   return same;
+   }
+
+
+/*****************************************************************************
+ * Private Function tree_same
+ *****************************************************************************
+ *
+ * This function tells whether two trees have the same nodes, with the same
+ * attributes; it walks the trees with cfi_node_section().
+ *
+ ****************************************************************************/
+
+static int tree_same (CFI_node_t a_tree1, CFI_node_t a_tree2)
+   {
+   CFI_attr_t attr1;
+   CFI_attr_t attr2;
+
+   for ( ; (a_tree1 != NULL) && (a_tree2 != NULL) ; )
+      {
+      if ((cfi_node_type_get(a_tree1) != cfi_node_type_get(a_tree2)) ||
+          (strcmp(cfi_node_word(a_tree1),cfi_node_word(a_tree2)) != 0))
+         {
+         return 0;
+         }
+      attr1 = cfi_node_attribute (a_tree1);
+      attr2 = cfi_node_attribute (a_tree2);
+      for ( ; (attr1 != NULL) && (attr2 != NULL) ; )
+         {
+         if (!attr_same(attr1,attr2)) return 0;
+         attr1 = cfi_attribute_next (attr1);
+         attr2 = cfi_attribute_next (attr2);
+         }
+      if ((attr1 != attr2) ||
+          !tree_same(cfi_node_section(a_tree1),cfi_node_section(a_tree2)))
+         {
+         return 0;
+         }
+      a_tree1 = cfi_node_next (a_tree1);
+      a_tree2 = cfi_node_next (a_tree2);
+      }
+
+   return a_tree1 == a_tree2;
+   }
+
+
+/*****************************************************************************
+ * Private Function test_lazy
+ *****************************************************************************
+ *
+ * A lazy parse must make the same tree as cfi_get(), with braces in strings
+ * and comments in the skipped section bodies, and a search must find a node
+ * in a section body that was not parsed yet.  A syntax error in a body that
+ * is found when it is parsed must leave the section empty, with the error.
+ *
+ ****************************************************************************/
+
+static int test_lazy (void)
+   {
+   static const char text[] =
+      "a = 1;\n"
+      "s1 (\"p\") {\n"
+      "   x = \"}{\", 2;  # }\n"
+      "   -- {\n"
+      "   // }\n"
+      "   /* { /* } */ } */\n"
+      "   inner { y; z = \"\\\"}\"; }\n"
+      "}\n"
+      "s2 { deep { deeper { key = 42, w; } } }\n"
+      "s3 { }\n"
+      "b;\n";
+   FILE*        input;
+   CFI_parser_t parser;
+   CFI_node_t   cfi;
+   CFI_node_t   lazy;
+   CFI_node_t   node;
+   const char*  msg;
+   int          errNum = 0;
+
+   input = input_new ();
+   if (input == NULL) return -1;
+   fputs (text, input);
+   if (input_get(input,&cfi) != 0) return -1;
+
+   if (cfi_parser_new(&parser) != NULL) return -1;
+   (void)cfi_parser_lazy (parser, 1);
+
+   input = input_new ();
+   if (input == NULL) return -1;
+   fputs (text, input);
+   (void)fflush (input);
+   (void)lseek (fileno(input), 0, SEEK_SET);
+   msg = cfi_parser_get (parser, fileno(input), &lazy);
+   fclose (input);
+   if (msg != NULL)
+      {
+      printf ("   cfi_parser_get: %s\n", msg);
+      errNum = -1;
+      }
+
+   node = cfi_search (lazy, "key", CFI_ATTRIBUTES);
+   if ((node == NULL) ||
+       (cfi_attribute_int_get(cfi_node_attribute(node)) != 42))
+      {
+      printf ("   can't find the key in a lazy section\n");
+      errNum = -1;
+      }
+   if (node != NULL) (void)cfi_release (node);
+
+   if (!tree_same(cfi,lazy))
+      {
+      printf ("   the lazy tree is not the same\n");
+      errNum = -1;
+      }
+
+   (void)cfi_delete_chain (lazy);
+   (void)cfi_delete_chain (cfi);
+
+   /*
+    * A section that doesn't end is still a syntax error.
+    */
+   input = input_new ();
+   if (input == NULL) return -1;
+   fputs ("s { a; \"}\" ", input);
+   (void)fflush (input);
+   (void)lseek (fileno(input), 0, SEEK_SET);
+   msg = cfi_parser_get (parser, fileno(input), &lazy);
+   fclose (input);
+   if ((msg == NULL) || (lazy != NULL))
+      {
+      printf ("   a section that doesn't end is not an error\n");
+      (void)cfi_delete_chain (lazy);
+      errNum = -1;
+      }
+
+   input = input_new ();
+   if (input == NULL) return -1;
+   fputs ("s { a = ; b; }\nt { c; }\n", input);
+   (void)fflush (input);
+   (void)lseek (fileno(input), 0, SEEK_SET);
+   msg = cfi_parser_get (parser, fileno(input), &lazy);
+   fclose (input);
+   if (msg != NULL)
+      {
+      printf ("   a bad lazy body is an error before it is parsed\n");
+      errNum = -1;
+      }
+   else
+      {
+      if (cfi_node_lazy_error(lazy) != NULL)
+         {
+         printf ("   a lazy body that isn't parsed has an error\n");
+         errNum = -1;
+         }
+      node = cfi_search (lazy, "b", CFI_WORD);
+      if ((node != NULL) || (cfi_node_lazy_error(lazy) == NULL) ||
+          (cfi_node_section(lazy) != NULL))
+         {
+         printf ("   the syntax error in a lazy body is not kept\n");
+         errNum = -1;
+         }
+      if (node != NULL) (void)cfi_release (node);
+      node = cfi_search (lazy, "c", CFI_WORD);
+      if ((node == NULL) ||
+          (cfi_node_lazy_error(cfi_node_next(lazy)) != NULL))
+         {
+         printf ("   a syntax error in a lazy body breaks the next one\n");
+         errNum = -1;
+         }
+      if (node != NULL) (void)cfi_release (node);
+      (void)cfi_delete_chain (lazy);
+      }
+
+   (void)cfi_parser_del (&parser);
+
+   return errNum;
+   }
+
+
+/*****************************************************************************
+ * Private Function parallel_get
+ ****************************************************************************/
+
+static int parallel_get (FILE* a_input, unsigned a_threads, CFI_node_t* a_cfi)
+   {
+   CFI_parser_t parser;
+   const char*  msg;
+
+   if (cfi_parser_new(&parser) != NULL) return -1;
+   (void)cfi_parser_threads (parser, a_threads);
+
+   (void)fflush (a_input);
+   (void)lseek (fileno(a_input), 0, SEEK_SET);
+   msg = cfi_parser_get (parser, fileno(a_input), a_cfi);
+   if (msg != NULL)
+      {
+      printf ("   %u threads: %s\n", a_threads, msg);
+      (void)cfi_parser_del (&parser);
+      return -1;
+      }
+   (void)cfi_parser_del (&parser);
+
+   return 0;
+   }
+
+
+/*****************************************************************************
+ * Private Function test_parallel
+ *****************************************************************************
+ *
+ * A parse with four threads must make the same tree as a parse with one,
+ * with braces and semicolons in the strings and comments near the cuts, and
+ * an error near the end must still be reported.  Errors in the middle of the
+ * text must be reported from the parts, just as from one thread.
+ *
+ ****************************************************************************/
+
+static int test_parallel (void)
+   {
+   FILE*        input;
+   CFI_parser_t parser;
+   CFI_node_t   cfi;
+   CFI_node_t   par;
+   const char*  msg;
+   char         messages[2][80];
+   long         i;
+   int          t;
+   int          errNum = 0;
+
+   input = input_new ();
+   if (input == NULL) return -1;
+   for (i = 0 ; ftell(input) < (6L << 20) ; i++)
+      {
+      fprintf (input, "s%ld (\"p;}\") {\n", i);
+      fprintf (input, "   x = \"};{\", %ld;  # };\n", i);
+      fprintf (input, "   /* }; /* { */ ; */ y = 0x%lX, 1.5;\n", i);
+      fprintf (input, "   inner { w; z = \"\\\";}\"; }\n");
+      fprintf (input, "}\n");
+      fprintf (input, "a%ld = %ld; b; -- ; }\n", i, i % 7);
+      }
+
+   if (parallel_get(input,1,&cfi) != 0)
+      {
+      fclose (input);
+      return -1;
+      }
+   if (parallel_get(input,4,&par) != 0)
+      errNum = -1;
+   else if (!tree_same(cfi,par))
+      {
+      printf ("   the parallel tree is not the same\n");
+      errNum = -1;
+      }
+   (void)cfi_delete_chain (par);
+   (void)cfi_delete_chain (cfi);
+
+   /*
+    * An error in the last part is found, on the right line.
+    */
+   (void)fseek (input, 0, SEEK_END);
+   fprintf (input, "oops = ;\n");
+   printf ("   expect a syntax error on line %ld:\n", i * 6 + 1);
+   if (parallel_get(input,4,&par) == 0)
+      {
+      printf ("   the error is not reported\n");
+      (void)cfi_delete_chain (par);
+      errNum = -1;
+      }
+   fclose (input);
+
+   /*
+    * With errors in two middle parts, the first is reported, with the same
+    * message and line as from one thread.
+    */
+   input = input_new ();
+   if (input == NULL) return -1;
+   for (i = 0 ; ftell(input) < (6L << 20) ; i++)
+      {
+      fprintf (input, "s%ld { x = \"};{\", %ld; inner { w; } }\n", i, i);
+      fprintf (input, "a%ld = %ld; b; -- ; }\n", i, i % 7);
+      if ((i % 40000) == 30000) fprintf (input, "oops%ld (;\n", i);
+      }
+   (void)fflush (input);
+   for (t = 0 ; t < 2 ; t++)
+      {
+      messages[t][0] = '\0';
+      if (cfi_parser_new(&parser) != NULL)
+         {
+         fclose (input);
+         return -1;
+         }
+      (void)cfi_parser_threads (parser, t == 0 ? 1 : 4);
+      (void)lseek (fileno(input), 0, SEEK_SET);
+      par = NULL;
+      msg = cfi_parser_get (parser, fileno(input), &par);
+      if (msg != NULL) (void)sprintf (messages[t], "%.79s", msg);
+      (void)cfi_parser_del (&parser);
+      (void)cfi_delete_chain (par);
+      }
+   fclose (input);
+   if ((messages[0][0] == '\0') || (strcmp(messages[0],messages[1]) != 0))
+      {
+      printf (
+             "   1 thread: \"%s\", 4 threads: \"%s\"\n",
+             messages[0],
+             messages[1]
+             );
+      errNum = -1;
+      }
+
+   return errNum;
+   }
+
+
+/*****************************************************************************
+ * Private Function text_get
+ ****************************************************************************/
+
+static int text_get (const char* a_text, int a_lazy, CFI_node_t* a_cfi)
+   {
+   FILE*        input;
+   CFI_parser_t parser;
+   const char*  msg;
+
+   *a_cfi = NULL;
+
+   input = input_new ();
+   if (input == NULL) return -1;
+   fputs (a_text, input);
+   (void)fflush (input);
+   (void)lseek (fileno(input), 0, SEEK_SET);
+
+   if (cfi_parser_new(&parser) != NULL)
+      {
+      fclose (input);
+      return -1;
+      }
+   (void)cfi_parser_lazy (parser, a_lazy);
+   msg = cfi_parser_get (parser, fileno(input), a_cfi);
+   (void)cfi_parser_del (&parser);
+   fclose (input);
+   if (msg != NULL)
+      {
+      printf ("   cfi_parser_get: %s\n", msg);
+      return -1;
+      }
+
+   return 0;
+   }
+
+
+/*****************************************************************************
+ * Private Function reparse_edit
+ *****************************************************************************
+ *
+ * This function replaces the first "a_from" in the text with "a_to", and
+ * re-parses the edit; the tree must then be the same as a parse of the new
+ * text.  If the edit is not "a_good", cfi_reparse() must fail, and the tree
+ * and the text must be as they were.
+ *
+ ****************************************************************************/
+
+static int reparse_edit (
+                        CFI_node_t* a_cfi,
+                        char*       a_text,
+                        const char* a_from,
+                        const char* a_to,
+                        int         a_good
+                        )
+   {
+   char        text[1024];
+   const char* p = strstr (a_text, a_from);
+   const char* msg;
+   CFI_edit_t  edit;
+   CFI_node_t  cfi;
+   int         errNum = 0;
+
+   if (p == NULL) return -1;
+   edit.offset  = p - a_text;
+   edit.oldLeng = strlen (a_from);
+   edit.newLeng = strlen (a_to);
+   (void)memcpy (text, a_text, edit.offset);
+   (void)strcpy (&text[edit.offset], a_to);
+   (void)strcat (text, p + edit.oldLeng);
+
+   msg = cfi_reparse (a_cfi, a_text, text, &edit);
+   if (a_good && (msg != NULL))
+      {
+      printf ("   \"%s\" to \"%s\": %s\n", a_from, a_to, msg);
+      return -1;
+      }
+   if (!a_good && (msg == NULL))
+      {
+      printf ("   \"%s\" to \"%s\" is not an error\n", a_from, a_to);
+      errNum = -1;
+      }
+   if (a_good) (void)strcpy (a_text, text);
+
+   if (text_get(a_text,0,&cfi) != 0) return -1;
+   if (!tree_same(*a_cfi,cfi))
+      {
+      printf ("   \"%s\" to \"%s\": the tree is not the same\n", a_from, a_to);
+      errNum = -1;
+      }
+   (void)cfi_delete_chain (cfi);
+
+   return errNum;
+   }
+
+
+/*****************************************************************************
+ * Private Function test_reparse
+ *****************************************************************************
+ *
+ * A run of edits, re-parsed one at a time, in a tree from a parse and in one
+ * from a lazy parse.  The nodes that an edit doesn't touch must be the same
+ * nodes, and the source spans must follow the edits.
+ *
+ ****************************************************************************/
+
+static int test_reparse (void)
+   {
+   static const char start[] =
+      "a = 1;\n"
+      "s1 (\"p\") {\n"
+      "   x = \"}{\", 2;  # c\n"
+      "   inner { y; z = 3; }\n"
+      "}\n"
+      "s2 { deep { key = 42; } }\n"
+      "b;\n";
+   char        text[1024];
+   CFI_node_t  cfi;
+   CFI_node_t  y;
+   CFI_node_t  key;
+   CFI_node_t  node;
+   const char* word;
+   size_t      offset;
+   size_t      leng;
+   int         lazy;
+   int         errNum = 0;
+
+   for (lazy = 0 ; lazy < 2 ; lazy++)
+      {
+      (void)strcpy (text, start);
+      if (text_get(text,lazy,&cfi) != 0) return -1;
+
+      y   = cfi_search (cfi, "y", CFI_WORD);
+      key = cfi_search (cfi, "key", CFI_ATTRIBUTES);
+      if ((y == NULL) || (key == NULL))
+         {
+         printf ("   can't find the nodes\n");
+         (void)cfi_delete_chain (cfi);
+         return -1;
+         }
+
+      if ((reparse_edit(&cfi,text,"42","43",1) != 0) ||
+          (reparse_edit(&cfi,text,"z = 3;","z = 3; w = 7;",1) != 0) ||
+          (reparse_edit(&cfi,text,"b;\n","",1) != 0) ||
+          (reparse_edit(&cfi,text,"a = 1","c; a = 1",1) != 0) ||
+          (reparse_edit(&cfi,text,"# c","/* c",0) != 0) ||
+          (reparse_edit(&cfi,text,"deep {","deep { }",0) != 0) ||
+          (reparse_edit(&cfi,text,"s2 {","t { u; }\ns2 {",1) != 0))
+         {
+         errNum = -1;
+         }
+
+      /*
+       * "y" wasn't touched, but "key" was, and is kept until it's released.
+       */
+      node = cfi_search (cfi, "y", CFI_WORD);
+      if ((node != y) || cfi_node_is_deleted(y))
+         {
+         printf ("   an untouched node is not the same node\n");
+         errNum = -1;
+         }
+      if (node != NULL) (void)cfi_release (node);
+      if (!cfi_node_is_deleted(key))
+         {
+         printf ("   a touched node is not deleted\n");
+         errNum = -1;
+         }
+      (void)cfi_release (key);
+      (void)cfi_release (y);
+
+      /*
+       * A span is where its node is in the new text.
+       */
+      word = "key = 43;";
+      node = cfi_search (cfi, "key", CFI_ATTRIBUTES);
+      if ((node == NULL) ||
+          (cfi_node_span(node,&offset,&leng) != NULL) ||
+          (leng != strlen(word)) ||
+          (strncmp(&text[offset],word,leng) != 0))
+         {
+         printf ("   the span of \"key\" is not right\n");
+         errNum = -1;
+         }
+      if (node != NULL) (void)cfi_release (node);
+
+      (void)cfi_delete_chain (cfi);
+      }
+
+   return errNum;
+   }
+
+
+/*****************************************************************************
+ * Private Function test_strings
+ *****************************************************************************
+ *
+ * A string of STRING_SIZE bytes, of lines of escaped quotes like a quoted
+ * JSON blob; it must come back the same, escaped again by string_get, and an
+ * error after it must be on the right line.
+ *
+ ****************************************************************************/
+
+static int test_strings (void)
+   {
+   FILE*        input;
+   CFI_parser_t parser;
+   CFI_node_t   cfi;
+   CFI_node_t   node;
+   const char*  text;
+   const char*  msg;
+   char         line[32];
+   long         lines;
+   long         leng;
+   long         i;
+   int          errNum = 0;
+
+   input = input_new ();
+   if (input == NULL) return -1;
+   fputs ("pem = \"", input);
+   for (lines = 0 ; ftell(input) < STRING_SIZE ; lines++)
+      {
+      for (i = 0 ; i < STRING_QUOTES ; i++) fputs ("\\\"", input);
+      fputs ("\n", input);
+      }
+   fputs ("\";\nafter = 1;\n", input);
+
+   if (parallel_get(input,1,&cfi) != 0)
+      {
+      fclose (input);
+      return -1;
+      }
+
+   node = cfi_search (cfi, "pem", CFI_ATTRIBUTES);
+   text = node == NULL ? NULL :
+          cfi_attribute_string_get (cfi_node_attribute(node));
+   leng = 2 * (STRING_QUOTES + 1);
+   if ((text == NULL) || (strlen(text) != (size_t)(lines * leng)))
+      {
+      printf ("   the string is not the right length\n");
+      errNum = -1;
+      }
+   else
+      {
+      for (i = 0 ; i < lines ; i++)
+         {
+         if (strncmp(&text[i*leng],&text[0],leng) != 0) break;
+         }
+      if ((i < lines) ||
+          (text[0] != '\\') || (text[1] != '"') ||
+          (text[leng-2] != '\\') || (text[leng-1] != 'n'))
+         {
+         printf ("   the string is not right\n");
+         errNum = -1;
+         }
+      }
+   free ((char*)text);
+   if (node != NULL) (void)cfi_release (node);
+   (void)cfi_delete_chain (cfi);
+
+   /*
+    * The lines of the string are counted.
+    */
+   (void)fseek (input, 0, SEEK_END);
+   fputs ("oops = ;\n", input);
+   (void)fflush (input);
+   (void)lseek (fileno(input), 0, SEEK_SET);
+   if (cfi_parser_new(&parser) != NULL)
+      {
+      fclose (input);
+      return -1;
+      }
+   msg = cfi_parser_get (parser, fileno(input), &cfi);
+   (void)sprintf (line, "line %ld:", lines + 3);
+   if ((msg == NULL) || (strncmp(msg,line,strlen(line)) != 0))
+      {
+      printf ("   the error is not on line %ld: %s\n", lines + 3, msg);
+      errNum = -1;
+      }
+   (void)cfi_delete_chain (cfi);
+   (void)cfi_parser_del (&parser);
+   fclose (input);
+
+   return errNum;
+   }
+
+/*****************************************************************************
+ * Private Function arena_get
+ ****************************************************************************/
+
+static int arena_get (
+                     FILE*       a_input,
+                     size_t      a_blockSize,
+                     unsigned    a_threads,
+                     CFI_node_t* a_cfi
+                     )
+   {
+   CFI_parser_t parser;
+   const char*  msg;
+
+   if (cfi_parser_new(&parser) != NULL) return -1;
+   (void)cfi_parser_arena (parser, a_blockSize);
+   (void)cfi_parser_threads (parser, a_threads);
+
+   (void)fflush (a_input);
+   (void)lseek (fileno(a_input), 0, SEEK_SET);
+   msg = cfi_parser_get (parser, fileno(a_input), a_cfi);
+   if (msg != NULL)
+      {
+      printf ("   %lu byte blocks: %s\n", (unsigned long)a_blockSize, msg);
+      (void)cfi_parser_del (&parser);
+      return -1;
+      }
+   (void)cfi_parser_del (&parser);
+
+   return 0;
+   }
+
+
+/*****************************************************************************
+ * Private Function node_count
+ ****************************************************************************/
+
+static size_t node_count (CFI_node_t a_node)
+   {
+   size_t count = 0;
+
+   for ( ; a_node != NULL ; a_node = cfi_node_next(a_node))
+      {
+      count += 1;
+      if (cfi_node_type_get(a_node) == CFI_SECTION)
+         {
+         count += node_count (cfi_node_section(a_node));
+         }
+      }
+
+   return count;
+   }
+
+
+/*****************************************************************************
+ * Private Function arena_check
+ *****************************************************************************
+ *
+ * The arena of a document must count all of its nodes, and can't have used
+ * more than it has.
+ *
+ ****************************************************************************/
+
+static int arena_check (CFI_node_t a_cfi, const char* a_what)
+   {
+   CFI_arena_stats_t stats;
+   const char*       msg = cfi_arena_stats (a_cfi, &stats);
+
+   if (msg != NULL)
+      {
+      printf ("   %s: %s\n", a_what, msg);
+      return -1;
+      }
+   if ((stats.blocks == 0) || (stats.used > stats.size) ||
+       (stats.nodes != node_count(a_cfi)))
+      {
+      printf (
+             "   %s: %lu blocks, %lu of %lu bytes used, %lu nodes\n",
+             a_what,
+             (unsigned long)stats.blocks,
+             (unsigned long)stats.used,
+             (unsigned long)stats.size,
+             (unsigned long)stats.nodes
+             );
+      return -1;
+      }
+
+   return 0;
+   }
+
+
+/*****************************************************************************
+ * Private Function test_arena
+ *****************************************************************************
+ *
+ * A parse into an arena must make the same tree as a parse from the heap,
+ * with blocks smaller than some of the strings, and with threads.  Retained
+ * nodes, an attribute taken out of its node and re-parsed edits must all
+ * work in an arena.
+ *
+ ****************************************************************************/
+
+static int test_arena (void)
+   {
+   static const char text[] =
+      "a = 1;\n"
+      "s1 (\"p\") {\n"
+      "   x = \"a string longer than the blocks of the arena\", 2, 1.5;\n"
+      "   inner { y; z = \"\\\"}\"; }\n"
+      "}\n"
+      "b = w1, w2, w3;\n";
+   char              edit[1024];
+   FILE*             input;
+   CFI_node_t        cfi;
+   CFI_node_t        heap;
+   CFI_node_t        node;
+   CFI_attr_t        attr = NULL;
+   CFI_arena_stats_t stats;
+   char*             word;
+   size_t            nodes;
+   long              i;
+   int               errNum = 0;
+
+   input = input_new ();
+   if (input == NULL) return -1;
+   fputs (text, input);
+   if (arena_get(input,32,1,&cfi) != 0)
+      {
+      fclose (input);
+      return -1;
+      }
+   fclose (input);
+   if (text_get(text,0,&heap) != 0) return -1;
+   if (!tree_same(cfi,heap))
+      {
+      printf ("   the tree in the arena is not the same\n");
+      errNum = -1;
+      }
+   if (arena_check(cfi,"small blocks") != 0) errNum = -1;
+   if (cfi_arena_stats(heap,&stats) == NULL)
+      {
+      printf ("   a tree from the heap has an arena\n");
+      errNum = -1;
+      }
+   (void)cfi_delete_chain (heap);
+
+   /*
+    * A retained section outlasts the delete of the section it is in.
+    */
+   nodes = node_count (cfi);
+   node  = cfi_search (cfi, "inner", CFI_SECTION);
+   (void)cfi_delete (cfi_node_next(cfi));
+   if ((node == NULL) ||
+       (strcmp(cfi_node_word(cfi_node_section(node)),"y") != 0))
+      {
+      printf ("   a retained section is gone\n");
+      errNum = -1;
+      }
+   if (node != NULL) (void)cfi_release (node);
+   if ((cfi_arena_stats(cfi,&stats) != NULL) || (stats.nodes != (nodes - 3)))
+      {
+      printf ("   the released nodes are not deallocated\n");
+      errNum = -1;
+      }
+
+   /*
+    * An attribute taken out of its node outlasts the document.
+    */
+   node = cfi_search_flat (cfi, "b", CFI_ATTRIBUTES);
+   if ((node == NULL) || (cfi_node_attribute_remove(node,1,&attr) != NULL))
+      {
+      printf ("   can't take out an attribute\n");
+      errNum = -1;
+      }
+   if (node != NULL) (void)cfi_release (node);
+   (void)cfi_delete_chain (cfi);
+   if (attr != NULL)
+      {
+      word = cfi_attribute_word_get (attr);
+      if ((word == NULL) || (strcmp(word,"w2") != 0))
+         {
+         printf ("   the attribute taken out is not \"w2\"\n");
+         errNum = -1;
+         }
+      free (word);
+      (void)cfi_attribute_del (&attr);
+      }
+
+   /*
+    * Re-parsed edits, one of them of the first node.
+    */
+   (void)strcpy (edit, text);
+   input = input_new ();
+   if (input == NULL) return -1;
+   fputs (edit, input);
+   if (arena_get(input,4096,1,&cfi) != 0)
+      {
+      fclose (input);
+      return -1;
+      }
+   fclose (input);
+   if (reparse_edit(&cfi,edit,"w2","w4, w5",1) != 0) errNum = -1;
+   if (reparse_edit(&cfi,edit,"a = 1;","c; d = 2;",1) != 0) errNum = -1;
+   if (reparse_edit(&cfi,edit,"y;","",1) != 0) errNum = -1;
+   if (arena_check(cfi,"re-parsed") != 0) errNum = -1;
+   (void)cfi_delete_chain (cfi);
+
+   /*
+    * Threads, each with an arena of its own.
+    */
+   input = input_new ();
+   if (input == NULL) return -1;
+   for (i = 0 ; ftell(input) < (3L << 20) ; i++)
+      {
+      fprintf (input, "s%ld (\"p\") {\n", i);
+      fprintf (input, "   x = \"%ld\", %ld, 0x%lX, 1.5;\n", i, i, i);
+      fprintf (input, "   inner { w; z = \"\\\";}\"; }\n");
+      fprintf (input, "}\n");
+      fprintf (input, "a%ld = %ld; b;\n", i, i % 7);
+      }
+   if (parallel_get(input,1,&heap) != 0)
+      {
+      fclose (input);
+      return -1;
+      }
+   if (arena_get(input,1L<<16,4,&cfi) != 0)
+      errNum = -1;
+   else
+      {
+      if (!tree_same(cfi,heap))
+         {
+         printf ("   the parallel tree in the arena is not the same\n");
+         errNum = -1;
+         }
+      if (arena_check(cfi,"threads") != 0) errNum = -1;
+      (void)cfi_delete_chain (cfi);
+      }
+   (void)cfi_delete_chain (heap);
+   fclose (input);
+
+   return errNum;
+   }
+
+
+/*****************************************************************************
+ * Private Function value_make
+ *****************************************************************************
+ *
+ * This function makes the text of a value of "a_leng" bytes, as it is in the
+ * input: a word, or a string that ends with an escape.
+ *
+ ****************************************************************************/
+
+static void value_make (char* a_text, int a_leng, int a_type)
+   {
+   int i;
+
+   for (i = 0 ; i < a_leng ; i++) a_text[i] = 'a' + (char)(i % 26);
+   if ((a_type == CFI_STRING_ATTRIBUTE) && (a_leng >= 2))
+      {
+      a_text[a_leng-2] = '\\';
+      a_text[a_leng-1] = 't';
+      }
+   a_text[a_leng] = '\0';
+   }
+
+
+/*****************************************************************************
+ * Private Function value_check
+ *****************************************************************************
+ *
+ * The words and strings "wN" and "sN" of the values test must come back as
+ * they were in the input.
+ *
+ ****************************************************************************/
+
+static int value_check (CFI_node_t a_cfi, const char* a_what)
+   {
+   CFI_node_t node;
+   char       name[16];
+   char       text[VALUE_SIZE+1];
+   char*      value;
+   int        type;
+   int        leng;
+   int        i;
+   int        errNum = 0;
+
+   for (leng = 1 ; leng <= VALUE_SIZE ; leng++)
+      {
+      for (i = 0 ; i < 2 ; i++)
+         {
+         type = i == 0 ? CFI_WORD_ATTRIBUTE : CFI_STRING_ATTRIBUTE;
+         (void)sprintf (name, "%c%d", i == 0 ? 'w' : 's', leng);
+         value_make (text, leng, type);
+         node  = cfi_search (a_cfi, name, CFI_ATTRIBUTES);
+         value = node == NULL ? NULL :
+                 type == CFI_WORD_ATTRIBUTE ?
+                 cfi_attribute_word_get (cfi_node_attribute(node)) :
+                 cfi_attribute_string_get (cfi_node_attribute(node));
+         if ((value == NULL) || (strcmp(value,text) != 0))
+            {
+            printf ("   %s: %s is \"%s\"\n", a_what, name, value);
+            errNum = -1;
+            }
+         free (value);
+         if (node != NULL) (void)cfi_release (node);
+         }
+      }
+
+   return errNum;
+   }
+
+
+/*****************************************************************************
+ * Private Function test_values
+ *****************************************************************************
+ *
+ * Words and strings of every length up to VALUE_SIZE, short enough to be kept
+ * in their attributes and too long for that, must come back the same from the
+ * heap, from an arena, and from cfi_attribute_new().
+ *
+ ****************************************************************************/
+
+static int test_values (void)
+   {
+   FILE*      input = input_new ();
+   CFI_node_t cfi;
+   CFI_attr_t attr;
+   char       text[VALUE_SIZE+1];
+   char*      value;
+   int        leng;
+   int        errNum = 0;
+
+   if (input == NULL) return -1;
+   for (leng = 1 ; leng <= VALUE_SIZE ; leng++)
+      {
+      value_make (text, leng, CFI_WORD_ATTRIBUTE);
+      fprintf (input, "w%d = %s;\n", leng, text);
+      value_make (text, leng, CFI_STRING_ATTRIBUTE);
+      fprintf (input, "s%d = \"%s\";\n", leng, text);
+      }
+
+   if (arena_get(input,64,1,&cfi) != 0)
+      {
+      fclose (input);
+      return -1;
+      }
+   if (value_check(cfi,"arena") != 0) errNum = -1;
+   (void)cfi_delete_chain (cfi);
+
+   if (input_get(input,&cfi) != 0) return -1;
+   if (value_check(cfi,"heap") != 0) errNum = -1;
+   (void)cfi_delete_chain (cfi);
+
+   for (leng = 1 ; leng <= VALUE_SIZE ; leng++)
+      {
+      value_make (text, leng, CFI_WORD_ATTRIBUTE);
+      if (cfi_attribute_new(&attr,text,CFI_WORD_ATTRIBUTE) != NULL)
+         {
+         printf ("   can't make a word of %d bytes\n", leng);
+         return -1;
+         }
+      value = cfi_attribute_word_get (attr);
+      if ((value == NULL) || (strcmp(value,text) != 0))
+         {
+         printf ("   the new word \"%s\" is \"%s\"\n", text, value);
+         errNum = -1;
+         }
+      free (value);
+      (void)cfi_attribute_del (&attr);
+      }
+
+   return errNum;
+   }
+
+
+/*****************************************************************************
+ * Private Function test_keys
+ *****************************************************************************
+ *
+ * The nodes of a document in an arena share their words, parsed with threads
+ * or not.  cfi_search() and cfi_search_flat() must find the words of all of
+ * the parts, words that a re-parse adds, and a word set from the heap.
+ *
+ ****************************************************************************/
+
+static int test_keys (void)
+   {
+   FILE*      input = input_new ();
+   CFI_node_t cfi;
+   CFI_node_t node;
+   CFI_node_t port;
+   char       edit[64];
+   char*      word;
+   long       sections;
+   long       found = 0;
+   int        errNum = 0;
+
+   if (input == NULL) return -1;
+   for (sections = 0 ; ftell(input) < (2L << 20) ; sections++)
+      {
+      fprintf (
+              input,
+              "s%ld { host = h%ld; port = %ld; }\n",
+              sections,
+              sections,
+              sections % 1000
+              );
+      }
+   fputs ("last = 1;\n", input);
+   if (arena_get(input,1L<<16,4,&cfi) != 0)
+      {
+      fclose (input);
+      return -1;
+      }
+   fclose (input);
+
+   for (node = cfi ; node != NULL ; node = cfi_node_next(node))
+      {
+      if (cfi_node_type_get(node) != CFI_SECTION) continue;
+      port = cfi_search_flat (cfi_node_section(node), "port", CFI_ATTRIBUTES);
+      if (port != NULL)
+         {
+         found += 1;
+         (void)cfi_release (port);
+         }
+      }
+   if (found != sections)
+      {
+      printf ("   \"port\" is found in %ld of %ld sections\n", found, sections);
+      errNum = -1;
+      }
+   if (cfi_node_word(cfi_node_next(cfi_node_section(cfi))) !=
+       cfi_node_word(cfi_node_next(cfi_node_section(cfi_node_next(cfi)))))
+      {
+      printf ("   the two words \"port\" are not the same key\n");
+      errNum = -1;
+      }
+   if (cfi_search(cfi,"nothing",CFI_ATTRIBUTES) != NULL)
+      {
+      printf ("   a word that isn't in the document is found\n");
+      errNum = -1;
+      }
+
+   /*
+    * A word from the heap in place of a key.
+    */
+   node = cfi_search (cfi, "last", CFI_ATTRIBUTES);
+   word = (char*)malloc (sizeof("renamed"));
+   if ((node == NULL) || (word == NULL))
+      {
+      printf ("   can't find \"last\"\n");
+      (void)cfi_delete_chain (cfi);
+      free (word);
+      return -1;
+      }
+   (void)strcpy (word, "renamed");
+   (void)cfi_node_word_del (node);
+   (void)cfi_node_word_set (node, word);
+   (void)cfi_release (node);
+   node = cfi_search (cfi, "renamed", CFI_ATTRIBUTES);
+   if ((node == NULL) || (cfi_search(cfi,"last",CFI_ATTRIBUTES) != NULL))
+      {
+      printf ("   the renamed word is not found\n");
+      errNum = -1;
+      }
+   if (node != NULL) (void)cfi_release (node);
+   (void)cfi_delete_chain (cfi);
+
+   /*
+    * A word that is added by a re-parse.
+    */
+   (void)strcpy (edit, "a { port = 1; }\nb = 2;\n");
+   input = input_new ();
+   if (input == NULL) return -1;
+   fputs (edit, input);
+   if (arena_get(input,4096,1,&cfi) != 0)
+      {
+      fclose (input);
+      return -1;
+      }
+   fclose (input);
+   if (reparse_edit(&cfi,edit,"b = 2;","b = 2; fresh = 3;",1) != 0)
+      errNum = -1;
+   node = cfi_search (cfi, "fresh", CFI_ATTRIBUTES);
+   if ((node == NULL) || (cfi_attribute_int_get(cfi_node_attribute(node)) != 3))
+      {
+      printf ("   the re-parsed word is not found\n");
+      errNum = -1;
+      }
+   if (node != NULL) (void)cfi_release (node);
+   (void)cfi_delete_chain (cfi);
+
+   return errNum;
+   }
+
+
+/*****************************************************************************
+ * Private Function attrs_check
+ *****************************************************************************
+ *
+ * The attributes of a node must be the numbers "a_values", in order, and the
+ * count must be right.
+ *
+ ****************************************************************************/
+
+static int attrs_check (
+                       CFI_node_t     a_node,
+                       const int32_t* a_values,
+                       size_t         a_count,
+                       const char*    a_what
+                       )
+   {
+   CFI_attr_t attr = cfi_node_attribute (a_node);
+   size_t     i;
+
+   for (i = 0 ; (attr != NULL) && (i < a_count) ; i++)
+      {
+      if (cfi_attribute_int_get(attr) != a_values[i]) break;
+      attr = cfi_attribute_next (attr);
+      }
+   if ((attr != NULL) || (i != a_count) ||
+       (cfi_node_attribute_count(a_node) != a_count))
+      {
+      printf ("   %s: the attributes are not right\n", a_what);
+      return -1;
+      }
+
+   return 0;
+   }
+
+
+/*****************************************************************************
+ * Private Function test_attributes
+ *****************************************************************************
+ *
+ * Attributes put in at the front, the middle and the end of a list, and taken
+ * out again, one at a time, in a node from the heap and in a node from an
+ * arena; more than the first array of links from the heap holds.
+ *
+ ****************************************************************************/
+
+static int test_attributes (void)
+   {
+   static const char    text[] = "x = 1, 2, 3;\n";
+   static const int32_t added[] = { 0, 1, 2, 9, 3, 4, 5, 6, 7 };
+   static const int32_t taken[] = { 1, 2, 3, 4, 5, 6 };
+   FILE*      input;
+   CFI_node_t cfi;
+   CFI_attr_t attr;
+   int32_t    value;
+   int        arena;
+   int        errNum = 0;
+
+   for (arena = 0 ; arena < 2 ; arena++)
+      {
+      if (arena == 0)
+         {
+         if (text_get(text,0,&cfi) != 0) return -1;
+         }
+      else
+         {
+         input = input_new ();
+         if (input == NULL) return -1;
+         fputs (text, input);
+         if (arena_get(input,4096,1,&cfi) != 0)
+            {
+            fclose (input);
+            return -1;
+            }
+         fclose (input);
+         }
+
+      value = 0;
+      (void)cfi_attribute_new (&attr, &value, CFI_DEC_FORMAT);
+      (void)cfi_node_attribute_insert (cfi, 0, attr);
+      for (value = 4 ; value < 8 ; value++)
+         {
+         (void)cfi_attribute_new (&attr, &value, CFI_DEC_FORMAT);
+         (void)cfi_node_attribute_insert (cfi, (size_t)value, attr);
+         }
+      value = 9;
+      (void)cfi_attribute_new (&attr, &value, CFI_DEC_FORMAT);
+      (void)cfi_node_attribute_insert (cfi, 3, attr);
+      if (attrs_check(cfi,added,9,arena ? "arena" : "heap") != 0) errNum = -1;
+
+      (void)cfi_node_attribute_remove (cfi, 3, &attr);
+      if ((cfi_attribute_int_get(attr) != 9) ||
+          (cfi_attribute_next(attr) != NULL))
+         {
+         printf ("   the attribute taken out is not by itself\n");
+         errNum = -1;
+         }
+      (void)cfi_attribute_del (&attr);
+      (void)cfi_node_attribute_remove (cfi, 0, &attr);
+      (void)cfi_attribute_del (&attr);
+      (void)cfi_node_attribute_remove (cfi, 6, &attr);
+      (void)cfi_attribute_del (&attr);
+      if (attrs_check(cfi,taken,6,arena ? "arena" : "heap") != 0) errNum = -1;
+      if (cfi_node_attribute_insert(cfi,7,attr) == NULL)
+         {
+         printf ("   an attribute is put in past the end\n");
+         errNum = -1;
+         }
+
+      (void)cfi_delete_chain (cfi);
+      }
+
+   return errNum;
+   }
+
+
+/*****************************************************************************
+ * Private Function freeze_check
+ *****************************************************************************
+ *
+ * A frozen copy of a document must be the same tree, in one block of its own
+ * arena, and must refuse to be changed.
+ *
+ ****************************************************************************/
+
+static int freeze_check (
+                        CFI_node_t  a_cfi,
+                        CFI_node_t  a_frozen,
+                        const char* a_what
+                        )
+   {
+   CFI_arena_stats_t stats;
+   CFI_node_t        node;
+   CFI_attr_t        attr;
+   int               errNum = 0;
+
+   if (!tree_same(a_cfi,a_frozen))
+      {
+      printf ("   %s: the frozen tree is not the same\n", a_what);
+      errNum = -1;
+      }
+   if ((cfi_arena_stats(a_frozen,&stats) != NULL) || (stats.blocks != 1) ||
+       (stats.used > stats.size) || (stats.nodes != node_count(a_frozen)))
+      {
+      printf ("   %s: the frozen tree is not in one block\n", a_what);
+      errNum = -1;
+      }
+
+   node = cfi_search (a_frozen, "port", CFI_ATTRIBUTES);
+   if ((node == NULL) || !cfi_node_is_frozen(node) ||
+       cfi_node_is_frozen(a_cfi))
+      {
+      printf ("   %s: \"port\" is not found, frozen\n", a_what);
+      return -1;
+      }
+   (void)cfi_release (node);
+   if ((cfi_node_word_del(node) == NULL) ||
+       (cfi_node_attribute_remove(node,0,&attr) == NULL) ||
+       (cfi_node_type_set(node,CFI_SECTION) == NULL) ||
+       (cfi_delete(node) == NULL) ||
+       (cfi_node_break(a_frozen) != NULL) ||
+       (cfi_delete_chain(cfi_node_next(a_frozen)) == NULL) ||
+       (cfi_node_is_deleted(node)))
+      {
+      printf ("   %s: the frozen tree is changed\n", a_what);
+      errNum = -1;
+      }
+
+   return errNum;
+   }
+
+
+/*****************************************************************************
+ * Private Function test_freeze
+ *****************************************************************************
+ *
+ * A document that was edited, from the heap and from an arena that was made
+ * by threads and that has lazy sections, must be frozen into the same tree;
+ * the frozen tree must outlive the document it was copied from.  A node that
+ * is deleted but still retained must not be copied.
+ *
+ ****************************************************************************/
+
+static int test_freeze (void)
+   {
+   static const char text[] =
+      "host = \"a string that is longer than the attribute\", 8080, 1.5;\n"
+      "a { port = 1; b { port = 2, word; c; } d = \"x\"; }\n"
+      "e { port = 3; }\n"
+      "f;\n";
+   FILE*      input;
+   CFI_node_t cfi;
+   CFI_node_t frozen;
+   CFI_node_t node;
+   CFI_attr_t attr;
+   int32_t    value = 7;
+   long       i;
+   int        errNum = 0;
+
+   if (text_get(text,1,&cfi) != 0) return -1;
+   (void)cfi_attribute_new (&attr, &value, CFI_DEC_FORMAT);
+   (void)cfi_node_attribute_insert (cfi_node_next(cfi), 0, attr);
+   if (cfi_freeze(cfi,&frozen) != NULL)
+      {
+      printf ("   cfi_freeze failed\n");
+      (void)cfi_delete_chain (cfi);
+      return -1;
+      }
+   if (freeze_check(cfi,frozen,"heap") != 0) errNum = -1;
+   (void)cfi_delete_chain (cfi);
+   if (cfi_attribute_int_get(cfi_node_attribute(cfi_node_next(frozen))) != 7)
+      {
+      printf ("   the frozen tree is lost with its source\n");
+      errNum = -1;
+      }
+   if (cfi_delete_chain(frozen) != NULL)
+      {
+      printf ("   the frozen tree is not deleted\n");
+      errNum = -1;
+      }
+
+   if (text_get("a; b; c;\n",0,&cfi) != 0) return -1;
+   node = cfi_search (cfi, "b", CFI_WORD);
+   (void)cfi_delete (node);
+   if (cfi_freeze(cfi,&frozen) != NULL)
+      {
+      printf ("   cfi_freeze failed\n");
+      (void)cfi_release (node);
+      (void)cfi_delete_chain (cfi);
+      return -1;
+      }
+   if ((node_count(frozen) != 2) ||
+       (cfi_search(frozen,"b",CFI_WORD) != NULL) ||
+       (cfi_search(frozen,"c",CFI_WORD) != cfi_node_next(frozen)))
+      {
+      printf ("   a deleted node is in the frozen tree\n");
+      errNum = -1;
+      }
+   (void)cfi_release (node);
+   (void)cfi_delete_chain (cfi);
+   (void)cfi_delete_chain (frozen);
+
+   input = input_new ();
+   if (input == NULL) return -1;
+   for (i = 0 ; i < 20000 ; i++)
+      {
+      fprintf (input, "s%ld { port = %ld; t { u = \"%ld\"; } }\n", i, i, i);
+      }
+   if (arena_get(input,4096,4,&cfi) != 0)
+      {
+      fclose (input);
+      return -1;
+      }
+   fclose (input);
+   if (cfi_freeze(cfi,&frozen) != NULL)
+      {
+      printf ("   cfi_freeze failed\n");
+      (void)cfi_delete_chain (cfi);
+      return -1;
+      }
+   if (freeze_check(cfi,frozen,"arena") != 0) errNum = -1;
+   (void)cfi_delete_chain (cfi);
+   (void)cfi_delete_chain (frozen);
+
+   return errNum;
+   }
+
+
+/*****************************************************************************
+ * Private Functions count_malloc, count_calloc, count_realloc, count_free
+ *****************************************************************************
+ *
+ * An allocator that counts its calls, and the allocations that are not freed,
+ * in the S_count_t that is its user pointer.
+ *
+ ****************************************************************************/
+
+static void* count_malloc (void* a_user, size_t a_size)
+   {
+   void* p = malloc (a_size);
+   ((S_count_t*)a_user)->calls += 1;
+   if (p != NULL) ((S_count_t*)a_user)->allocs += 1;
+   return p;
+   }
+
+static void* count_calloc (void* a_user, size_t a_count, size_t a_size)
+   {
+   void* p = calloc (a_count, a_size);
+   ((S_count_t*)a_user)->calls += 1;
+   if (p != NULL) ((S_count_t*)a_user)->allocs += 1;
+   return p;
+   }
+
+static void* count_realloc (void* a_user, void* a_ptr, size_t a_size)
+   {
+   void* p = realloc (a_ptr, a_size);
+   ((S_count_t*)a_user)->calls += 1;
+   if ((p != NULL) && (a_ptr == NULL)) ((S_count_t*)a_user)->allocs += 1;
+   return p;
+   }
+
+static void count_free (void* a_user, void* a_ptr)
+   {
+   ((S_count_t*)a_user)->calls += 1;
+   if (a_ptr != NULL) ((S_count_t*)a_user)->allocs -= 1;
+   free (a_ptr);
+   }
+
+
+/*****************************************************************************
+ * Private Function test_allocator
+ *****************************************************************************
+ *
+ * All of the memory of libcfi must come from the allocator that is set, and
+ * go back to it; the memory of a document from a parser with an allocator of
+ * its own must come from that allocator, even with threads.
+ *
+ ****************************************************************************/
+
+static int test_allocator (void)
+   {
+   static const char text[] =
+      "host = \"a string that is longer than the attribute\", 8080;\n"
+      "a { port = 1; b { port = 2, word; c; } }\n";
+   CFI_allocator_t all = { count_malloc, count_calloc, count_realloc,
+                           count_free, NULL };
+   CFI_allocator_t doc = { count_malloc, count_calloc, count_realloc,
+                           count_free, NULL };
+   S_count_t       allCount = { 0, 0 };
+   S_count_t       docCount = { 0, 0 };
+   CFI_parser_t    parser;
+   CFI_node_t      cfi;
+   CFI_node_t      node;
+   CFI_attr_t      attr;
+   FILE*           input;
+   int32_t         value = 7;
+   long            i;
+   int             lazy;
+   int             errNum = 0;
+
+   all.user = &allCount;
+   doc.user = &docCount;
+   all.free_hook = NULL;
+   if (cfi_set_allocator(&all) == NULL)
+      {
+      printf ("   an allocator without a free function is set\n");
+      (void)cfi_set_allocator (NULL);
+      return -1;
+      }
+   all.free_hook = count_free;
+   (void)cfi_set_allocator (&all);
+
+   for (lazy = 0 ; lazy < 2 ; lazy++)
+      {
+      if (text_get(text,lazy,&cfi) != 0)
+         {
+         (void)cfi_set_allocator (NULL);
+         return -1;
+         }
+      (void)cfi_attribute_new (&attr, &value, CFI_DEC_FORMAT);
+      (void)cfi_node_attribute_insert (cfi, 0, attr);
+      node = cfi_search (cfi, "c", CFI_WORD);
+      if (node != NULL) (void)cfi_release (node);
+      (void)cfi_delete_chain (cfi);
+      }
+   if ((allCount.calls == 0) || (allCount.allocs != 0))
+      {
+      printf (
+             "   %ld allocator calls, %ld allocations left\n",
+             allCount.calls,
+             allCount.allocs
+             );
+      errNum = -1;
+      }
+
+   /*
+    * A document with an allocator of its own, parsed by threads.
+    */
+   input = input_new ();
+   if ((input == NULL) || (cfi_parser_new(&parser) != NULL))
+      {
+      if (input != NULL) fclose (input);
+      (void)cfi_set_allocator (NULL);
+      return -1;
+      }
+   for (i = 0 ; i < 20000 ; i++)
+      {
+      fprintf (input, "s%ld { port = %ld; t { u = \"%ld\"; } }\n", i, i, i);
+      }
+   (void)fflush (input);
+   (void)lseek (fileno(input), 0, SEEK_SET);
+   (void)cfi_parser_allocator (parser, &doc);
+   (void)cfi_parser_threads (parser, 4);
+   if (cfi_parser_get(parser,fileno(input),&cfi) != NULL)
+      {
+      printf ("   cfi_parser_get failed\n");
+      errNum = -1;
+      cfi = NULL;
+      }
+   fclose (input);
+   (void)cfi_parser_del (&parser);
+   if ((cfi != NULL) &&
+       ((docCount.allocs == 0) || (arena_check(cfi,"threads") != 0)))
+      {
+      printf ("   the document is not from its allocator\n");
+      errNum = -1;
+      }
+   (void)cfi_delete_chain (cfi);
+
+   /*
+    * The bodies of a lazy document are parsed into its arena too.
+    */
+   input = input_new ();
+   if ((input == NULL) || (cfi_parser_new(&parser) != NULL))
+      {
+      if (input != NULL) fclose (input);
+      (void)cfi_set_allocator (NULL);
+      return -1;
+      }
+   fputs (text, input);
+   (void)fflush (input);
+   (void)lseek (fileno(input), 0, SEEK_SET);
+   (void)cfi_parser_allocator (parser, &doc);
+   (void)cfi_parser_lazy (parser, 1);
+   if (cfi_parser_get(parser,fileno(input),&cfi) != NULL)
+      {
+      printf ("   the lazy cfi_parser_get failed\n");
+      errNum = -1;
+      cfi = NULL;
+      }
+   fclose (input);
+   (void)cfi_parser_del (&parser);
+   node = cfi_search (cfi, "c", CFI_WORD);
+   if ((cfi != NULL) && ((node == NULL) || (arena_check(cfi,"lazy") != 0)))
+      {
+      printf ("   the lazy sections are not from the document's allocator\n");
+      errNum = -1;
+      }
+   if (node != NULL) (void)cfi_release (node);
+   (void)cfi_delete_chain (cfi);
+   if ((docCount.allocs != 0) || (allCount.allocs != 0))
+      {
+      printf (
+             "   %ld and %ld allocations left\n",
+             docCount.allocs,
+             allCount.allocs
+             );
+      errNum = -1;
+      }
+
+   (void)cfi_set_allocator (NULL);
+
+   return errNum;
+   }
+
+
+/*****************************************************************************
+ * Private Function test_memory
+ *****************************************************************************
+ *
+ * The memory of a document must count all of its objects, from the heap, from
+ * an arena and lazily parsed, without parsing it; all of the live memory must
+ * be freed with the documents.  The memory that libcfi hands to the caller,
+ * or the caller hands to libcfi, is the caller's, and isn't counted.
+ *
+ ****************************************************************************/
+
+static int test_memory (void)
+   {
+   static const char text[] =
+      "host = \"a string that is longer than the attribute\", 8080;\n"
+      "a { port = 1; b { port = 2, word; c; } }\n"
+      "d { port = 3; }\n";
+   CFI_memory_t      stats;
+   CFI_arena_stats_t arena;
+   CFI_live_t        live0;
+   CFI_live_t        live1;
+   CFI_node_t        cfi;
+   CFI_node_t        node;
+   FILE*             input;
+   char*             encoded;
+   char*             decoded;
+   char*             word;
+   int               errNum = 0;
+
+   cfi_memory_live (&live0);
+
+   if (text_get(text,0,&cfi) != 0) return -1;
+   (void)cfi_memory_usage (cfi, &stats);
+   if ((stats.nodes != 8) || (stats.attributes != 6) || (stats.texts != 1) ||
+       (stats.words != 8) || (stats.links != 4) ||
+       (stats.allocations != 27) || (stats.overhead == 0) ||
+       (stats.total != stats.nodeBytes + stats.attributeBytes +
+                       stats.textBytes + stats.wordBytes + stats.linkBytes +
+                       stats.overhead))
+      {
+      printf ("   heap: the memory is not counted right\n");
+      errNum = -1;
+      }
+   (void)cfi_delete_chain (cfi);
+
+   input = input_new ();
+   if (input == NULL) return -1;
+   fputs (text, input);
+   if (arena_get(input,4096,1,&cfi) != 0)
+      {
+      fclose (input);
+      return -1;
+      }
+   fclose (input);
+   (void)cfi_memory_usage (cfi, &stats);
+   (void)cfi_arena_stats (cfi, &arena);
+   if ((stats.nodes != 8) || (stats.words != 6) || (stats.allocations != 0) ||
+       (stats.total < arena.size))
+      {
+      printf ("   arena: the memory is not counted right\n");
+      errNum = -1;
+      }
+   (void)cfi_delete_chain (cfi);
+
+   if (text_get(text,1,&cfi) != 0) return -1;
+   (void)cfi_memory_usage (cfi, &stats);
+   if ((stats.nodes != 3) || (stats.sources != 2) ||
+       (stats.sourceBytes < sizeof(text)) || (node_count(cfi) != 8))
+      {
+      printf ("   lazy: the memory is not counted right\n");
+      errNum = -1;
+      }
+   (void)cfi_delete_chain (cfi);
+
+   encoded = cfi_string_encode ("a\\tb", NULL);
+   decoded = cfi_string_decode ("a\tb", 4);
+   cfi_memory_live (&live1);
+   if ((encoded == NULL) || (decoded == NULL) ||
+       (live1.allocations != live0.allocations))
+      {
+      printf ("   the strings of the caller are counted\n");
+      errNum = -1;
+      }
+   free (encoded);
+   free (decoded);
+
+   word = (char*)malloc (5);
+   if ((word == NULL) || (cfi_node_new(&node) != NULL)) return -1;
+   strcpy (word, "word");
+   (void)cfi_node_word_set (node, word);
+   (void)cfi_node_word_del (node);
+   (void)cfi_node_del (&node);
+
+   cfi_memory_live (&live1);
+   if ((live1.allocations != live0.allocations) ||
+       (live1.arenas != live0.arenas) ||
+       (live1.arenaBytes != live0.arenaBytes) ||
+       (live1.nodes != live0.nodes) ||
+       (live1.attributes != live0.attributes))
+      {
+      printf ("   the live memory is not freed\n");
+      errNum = -1;
+      }
+
+   return errNum;
+   }
+
+
+/*****************************************************************************
+ * Private Function test_peek
+ *****************************************************************************
+ *
+ * The text of word and string attributes must be lent as it is kept, with
+ * its length, and copied into a buffer, without calling the allocator.
+ *
+ ****************************************************************************/
+
+static int test_peek (void)
+   {
+   static const char text[] = "name = word, \"a\\tb\\000c\", 7;\n";
+   CFI_allocator_t all = { count_malloc, count_calloc, count_realloc,
+                           count_free, NULL };
+   S_count_t       allCount = { 0, 0 };
+   long            calls;
+   CFI_node_t      cfi;
+   CFI_attr_t      word;
+   CFI_attr_t      string;
+   const char*     peek;
+   const char*     msg;
+   char            buff[8];
+   size_t          leng;
+   int             errNum = 0;
+
+   all.user = &allCount;
+   (void)cfi_set_allocator (&all);
+   if (text_get(text,0,&cfi) != 0)
+      {
+      (void)cfi_set_allocator (NULL);
+      return -1;
+      }
+   word   = cfi_node_attribute (cfi);
+   string = cfi_attribute_next (word);
+
+   calls = allCount.calls;
+
+   peek = cfi_attribute_word_peek (word, &leng);
+   if ((peek == NULL) || (leng != 4) || (strcmp(peek,"word") != 0))
+      {
+      printf ("   the word is not lent right\n");
+      errNum = -1;
+      }
+   peek = cfi_attribute_string_peek (string, &leng);
+   if ((peek == NULL) || (leng != 5) || (memcmp(peek,"a\tb\0c",6) != 0))
+      {
+      printf ("   the string is not lent right\n");
+      errNum = -1;
+      }
+   if ((cfi_attribute_string_peek(word,&leng) != NULL) ||
+       (cfi_attribute_word_peek(cfi_attribute_next(string),NULL) != NULL))
+      {
+      printf ("   the wrong type of attribute is lent\n");
+      errNum = -1;
+      }
+
+   msg = cfi_attribute_text_copy (string, buff, 5, &leng);
+   if ((msg == NULL) || (leng != 5))
+      {
+      printf ("   the string is copied into too small a buffer\n");
+      errNum = -1;
+      }
+   msg = cfi_attribute_text_copy (string, buff, 6, &leng);
+   if ((msg != NULL) || (leng != 5) || (memcmp(buff,"a\tb\0c",6) != 0))
+      {
+      printf ("   the string is not copied right\n");
+      errNum = -1;
+      }
+   msg = cfi_attribute_text_copy (cfi_attribute_next(string), buff, 8, NULL);
+   if (msg == NULL)
+      {
+      printf ("   a number is copied as text\n");
+      errNum = -1;
+      }
+
+   if (allCount.calls != calls)
+      {
+      printf ("   the text is not lent without the allocator\n");
+      errNum = -1;
+      }
+
+   (void)cfi_delete_chain (cfi);
+   (void)cfi_set_allocator (NULL);
+   return errNum;
+   }
+
+/*****************************************************************************
+ * Private Function index_value
+ *****************************************************************************
+ *
+ * This is the value of the entry with the word in the contents of a section,
+ * from cfi_search_flat(), or -1 if there is none.
+ *
+ ****************************************************************************/
+
+static int index_value (CFI_node_t a_contents, const char* a_word)
+   {
+   CFI_node_t node = cfi_search_flat (a_contents, a_word, CFI_ATTRIBUTES);
+   int        value;
+
+   if (node == NULL) return -1;
+   value = (int)cfi_attribute_int_get (cfi_node_attribute(node));
+   (void)cfi_release (node);
+   return value;
+   }
+
+
+/*****************************************************************************
+ * Private Function test_index
+ *****************************************************************************
+ *
+ * A search of a long section must give the same node from its index as from
+ * a walk of it: the first with the word and the type that isn't deleted, and
+ * after the words, types and nodes of the section are changed.  The index is
+ * freed with its document, from the heap or from an arena.
+ *
+ ****************************************************************************/
+
+static int test_index (void)
+   {
+   char*        text;
+   char*        word;
+   CFI_live_t   live0;
+   CFI_live_t   live1;
+   CFI_memory_t stats;
+   CFI_node_t   cfi;
+   CFI_node_t   contents;
+   CFI_node_t   node;
+   CFI_node_t   dup;
+   FILE*        input;
+   long         i;
+   int          errNum = 0;
+
+   text = (char*)malloc (INDEX_ENTRIES * 24 + 64);
+   if (text == NULL) return -1;
+   strcpy (text, "acl { h5; dup = 1; ");
+   for (i = 0 ; i < INDEX_ENTRIES ; i++)
+      sprintf (text + strlen(text), "h%ld = %ld; ", i, i);
+   strcat (text, "dup = 2; }\n");
+
+   cfi_memory_live (&live0);
+
+   if (text_get(text,0,&cfi) != 0)
+      {
+      free (text);
+      return -1;
+      }
+   free (text);
+   contents = cfi_node_section (cfi);
+
+   if ((index_value(contents,"h150") != 150) ||
+       (cfi_memory_usage(cfi,&stats) != NULL) || (stats.indexes != 1))
+      {
+      printf ("   a long search doesn't make the index\n");
+      errNum = -1;
+      }
+   if ((index_value(contents,"h5") != 5) ||
+       (index_value(contents,"dup") != 1) ||
+       (index_value(contents,"h200") != -1))
+      {
+      printf ("   the index doesn't find the first entry of a word\n");
+      errNum = -1;
+      }
+   node = cfi_search_flat (contents, "h5", CFI_WORD);
+   if ((node == NULL) || (cfi_node_type_get(node) != CFI_WORD))
+      {
+      printf ("   the index doesn't find a word by its type\n");
+      errNum = -1;
+      }
+   if (node != NULL) (void)cfi_release (node);
+
+   /*
+    * A new word.
+    */
+   node = cfi_search_flat (contents, "h150", CFI_ATTRIBUTES);
+   word = (char*)malloc (8);
+   if ((node == NULL) || (word == NULL)) return -1;
+   strcpy (word, "renamed");
+   (void)cfi_release (node);
+   (void)cfi_node_word_del (node);
+   (void)cfi_node_word_set (node, word);
+   (void)cfi_memory_usage (cfi, &stats);
+   if ((stats.indexes != 0) ||
+       (index_value(contents,"renamed") != 150) ||
+       (index_value(contents,"h150") != -1))
+      {
+      printf ("   the index is not dropped with a new word\n");
+      errNum = -1;
+      }
+
+   /*
+    * A new node at the end, and a deleted node that is retained.
+    */
+   (void)cfi_memory_usage (cfi, &stats);
+   word = (char*)malloc (6);
+   if ((stats.indexes != 1) || (word == NULL) || (cfi_node_new(&node) != NULL))
+      {
+      printf ("   the index is not made again\n");
+      return -1;
+      }
+   strcpy (word, "added");
+   (void)cfi_node_word_set (node, word);
+   for (dup = contents ; cfi_node_next(dup) != NULL ; dup = cfi_node_next(dup))
+      ;
+   (void)cfi_node_join (dup, node);
+   node = cfi_search_flat (contents, "added", CFI_WORD);
+   if (node == NULL)
+      {
+      printf ("   the index doesn't find a node joined to the section\n");
+      errNum = -1;
+      }
+   else
+      (void)cfi_release (node);
+
+   (void)index_value (contents, "h199");
+   dup = cfi_search_flat (contents, "dup", CFI_ATTRIBUTES);
+   if (dup == NULL) return -1;
+   (void)cfi_delete (dup);
+   if (index_value(contents,"dup") != 2)
+      {
+      printf ("   the index finds a deleted node\n");
+      errNum = -1;
+      }
+   (void)cfi_release (dup);
+   if ((index_value(contents,"dup") != 2) ||
+       (index_value(contents,"h199") != 199))
+      {
+      printf ("   the index is not right after a node is deleted\n");
+      errNum = -1;
+      }
+
+   (void)cfi_delete_chain (cfi);
+
+   cfi_memory_live (&live1);
+   if (live1.allocations != live0.allocations)
+      {
+      printf ("   the index is not freed\n");
+      errNum = -1;
+      }
+
+   /*
+    * The index of a document in an arena is freed with the document.
+    */
+   input = tmpfile ();
+   if (input == NULL) return -1;
+   fprintf (input, "acl { ");
+   for (i = 0 ; i < INDEX_ENTRIES ; i++) fprintf (input, "h%ld = %ld; ", i, i);
+   fprintf (input, "}\n");
+   if (arena_get(input,65536,1,&cfi) != 0)
+      {
+      fclose (input);
+      return -1;
+      }
+   fclose (input);
+   if ((index_value(cfi_node_section(cfi),"h150") != 150) ||
+       (cfi_memory_usage(cfi,&stats) != NULL) || (stats.indexes != 1))
+      {
+      printf ("   a long search of an arena doesn't make the index\n");
+      errNum = -1;
+      }
+   (void)cfi_delete_chain (cfi);
+
+   cfi_memory_live (&live1);
+   if (live1.allocations != live0.allocations)
+      {
+      printf ("   the index of an arena is not freed\n");
+      errNum = -1;
+      }
+
+   return errNum;
+   }
+
+/*****************************************************************************
+ * Private Function lookup_value
+ *****************************************************************************
+ *
+ * This is the value of the entry at the path, from cfi_lookup(), or -1 if
+ * there is none.
+ *
+ ****************************************************************************/
+
+static int lookup_value (CFI_node_t a_cfi, const char* a_path)
+   {
+   CFI_node_t node = cfi_lookup (a_cfi, a_path, CFI_ATTRIBUTES);
+   int        value;
+
+   if (node == NULL) return -1;
+   value = (int)cfi_attribute_int_get (cfi_node_attribute(node));
+   (void)cfi_release (node);
+   return value;
+   }
+
+
+/*****************************************************************************
+ * Private Function test_lookup
+ *****************************************************************************
+ *
+ * A path must find the entry it names, through sections, lazy or not, and
+ * their parameters; a compiled path must find it in any document.
+ *
+ ****************************************************************************/
+
+static int test_lookup (void)
+   {
+   static const char text[] =
+      "port = 7;\n"
+      "cluster { port = 8; frontend { listen { port = 80; } }\n"
+      "          backend { port = 81; } }\n"
+      "server (\"web01\") { port = 1; }\n"
+      "server (\"web02\") { port = 2; }\n"
+      "server (web03) { port = 3; }\n";
+   static const char* bad[] =
+      { "", ".", "a.", ".a", "a..b", "a(", "a()", "a(\"b)", "a(b", "a(b)c" };
+   CFI_node_t  cfi;
+   CFI_node_t  node;
+   CFI_path_t  path;
+   const char* what;
+   size_t      i;
+   int         lazy;
+   int         errNum = 0;
+
+   if (cfi_path_compile("server(\"web02\").port",&path) != NULL) return -1;
+
+   for (lazy = 0 ; lazy <= 1 ; lazy++)
+      {
+      what = lazy ? "lazy" : "flat";
+      if (text_get(text,lazy,&cfi) != 0) return -1;
+      if ((lookup_value(cfi,"port") != 7) ||
+          (lookup_value(cfi,"cluster.port") != 8) ||
+          (lookup_value(cfi,"cluster.frontend.listen.port") != 80) ||
+          (lookup_value(cfi,"cluster.backend.port") != 81) ||
+          (lookup_value(cfi,"cluster.frontend.port") != -1) ||
+          (lookup_value(cfi,"cluster.listen.port") != -1))
+         {
+         printf ("   %s: a path is not found right\n", what);
+         errNum = -1;
+         }
+      if ((lookup_value(cfi,"server.port") != 1) ||
+          (lookup_value(cfi,"server(\"web02\").port") != 2) ||
+          (lookup_value(cfi,"server(web02).port") != 2) ||
+          (lookup_value(cfi,"server(web03).port") != 3) ||
+          (lookup_value(cfi,"server(\"web04\").port") != -1))
+         {
+         printf ("   %s: a predicate is not found right\n", what);
+         errNum = -1;
+         }
+
+      node = cfi_lookup (cfi, "cluster.frontend", CFI_SECTION);
+      if ((node == NULL) || (cfi_node_type_get(node) != CFI_SECTION))
+         {
+         printf ("   %s: a section is not found\n", what);
+         errNum = -1;
+         }
+      if (node != NULL) (void)cfi_release (node);
+
+      node = cfi_path_lookup (cfi, path, CFI_ATTRIBUTES);
+      if ((node == NULL) ||
+          (cfi_attribute_int_get(cfi_node_attribute(node)) != 2))
+         {
+         printf ("   %s: a compiled path is not found\n", what);
+         errNum = -1;
+         }
+      if (node != NULL) (void)cfi_release (node);
+
+      (void)cfi_delete_chain (cfi);
+      }
+   (void)cfi_path_del (&path);
+
+   for (i = 0 ; i < sizeof(bad)/sizeof(bad[0]) ; i++)
+      {
+      if (cfi_path_compile(bad[i],&path) == NULL)
+         {
+         printf ("   the path '%s' is taken\n", bad[i]);
+         (void)cfi_path_del (&path);
+         errNum = -1;
+         }
+      }
+
+   return errNum;
+   }
+
+
+/*****************************************************************************
+ * Private Function test_pin
+ *****************************************************************************
+ *
+ * A lookup that lends its node must find what the retaining one does without
+ * retaining it or making an index, or parsing a lazy section, and a node
+ * deleted while the document is pinned must stay, marked deleted, until the
+ * last pin is taken off; the pins of one document must not keep the nodes of
+ * another.
+ *
+ ****************************************************************************/
+
+static int test_pin (void)
+   {
+   char*        text;
+   FILE*        input;
+   CFI_live_t   live0;
+   CFI_live_t   live1;
+   CFI_live_t   live2;
+   CFI_memory_t stats;
+   CFI_node_t   cfi;
+   CFI_node_t   other;
+   CFI_node_t   cluster;
+   CFI_node_t   backend;
+   CFI_node_t   node;
+   CFI_path_t   path;
+   long         i;
+   int          errNum = 0;
+
+   text = (char*)malloc (INDEX_ENTRIES * 24 + 64);
+   if (text == NULL) return -1;
+   strcpy (text, "cluster { backend { port = 81; } ");
+   for (i = 0 ; i < INDEX_ENTRIES ; i++)
+      sprintf (text + strlen(text), "h%ld = %ld; ", i, i);
+   strcat (text, "}\nport = 7;\n");
+
+   cfi_memory_live (&live0);
+
+   if (text_get(text,0,&cfi) != 0)
+      {
+      free (text);
+      return -1;
+      }
+
+   /*
+    * The lookups that lend their node.
+    */
+   cluster = cfi_search_peek (cfi, "cluster", CFI_SECTION);
+   if (cluster == NULL) return -1;
+   node = cfi_search_flat_peek (cfi_node_section(cluster), "h150",
+                                CFI_ATTRIBUTES);
+   if ((node == NULL) ||
+       (cfi_attribute_int_get(cfi_node_attribute(node)) != 150) ||
+       (cfi_memory_usage(cfi,&stats) != NULL) || (stats.indexes != 0))
+      {
+      printf ("   a flat search that lends its node is not right\n");
+      errNum = -1;
+      }
+   node = cfi_lookup_peek (cfi, "cluster.backend.port", CFI_ATTRIBUTES);
+   if ((node == NULL) ||
+       (cfi_attribute_int_get(cfi_node_attribute(node)) != 81))
+      {
+      printf ("   a lookup that lends its node is not right\n");
+      errNum = -1;
+      }
+   if (cfi_path_compile("cluster.h5",&path) != NULL) return -1;
+   node = cfi_path_lookup_peek (cfi, path, CFI_ATTRIBUTES);
+   if ((node == NULL) ||
+       (cfi_attribute_int_get(cfi_node_attribute(node)) != 5))
+      {
+      printf ("   a compiled lookup that lends its node is not right\n");
+      errNum = -1;
+      }
+   (void)cfi_path_del (&path);
+
+   /*
+    * A lent section is not retained, so it is freed when it is deleted, but
+    * not before the last pin is taken off.
+    */
+   backend = cfi_search_peek (cfi, "backend", CFI_SECTION);
+   if (backend == NULL) return -1;
+   cfi_memory_live (&live1);
+   (void)cfi_pin (cfi);
+   (void)cfi_pin (cfi);
+   (void)cfi_delete (backend);
+   node = cfi_node_section (backend);
+   cfi_memory_live (&live2);
+   if (!cfi_node_is_deleted(backend) || (live2.nodes != live1.nodes) ||
+       (cfi_attribute_int_get(cfi_node_attribute(node)) != 81) ||
+       (cfi_lookup_peek(cfi,"cluster.backend.port",CFI_ATTRIBUTES) != NULL))
+      {
+      printf ("   a section deleted while pinned is not kept\n");
+      errNum = -1;
+      }
+   (void)cfi_unpin (cfi);
+   cfi_memory_live (&live2);
+   if (live2.nodes != live1.nodes)
+      {
+      printf ("   a section is freed before the last pin is taken off\n");
+      errNum = -1;
+      }
+   (void)cfi_unpin (cfi);
+   cfi_memory_live (&live2);
+   if (live2.nodes != live1.nodes - 2)
+      {
+      printf ("   a deleted section is not freed with the last pin\n");
+      errNum = -1;
+      }
+   if (cfi_unpin(cfi) == NULL)
+      {
+      printf ("   a pin is taken off that was never put on\n");
+      errNum = -1;
+      }
+
+   /*
+    * Whole documents, from the heap and from an arena.
+    */
+   (void)cfi_pin (cfi);
+   (void)cfi_delete_chain (cfi);
+   cfi_memory_live (&live1);
+   if ((live1.nodes != live2.nodes) ||
+       (cfi_attribute_int_get(cfi_node_attribute(cfi_node_next(cluster))) != 7))
+      {
+      printf ("   a document deleted while pinned is not kept\n");
+      errNum = -1;
+      }
+   (void)cfi_unpin (cfi);
+
+   input = input_new ();
+   if (input == NULL) return -1;
+   fputs (text, input);
+   free (text);
+   if (arena_get(input,4096,1,&cfi) != 0)
+      {
+      fclose (input);
+      return -1;
+      }
+   fclose (input);
+   (void)cfi_pin (cfi);
+   (void)cfi_delete_chain (cfi);
+   cfi_memory_live (&live1);
+   if ((live1.arenas != live0.arenas + 1) ||
+       (cfi_lookup_peek(cfi,"port",CFI_ATTRIBUTES) == NULL))
+      {
+      printf ("   a document in an arena deleted while pinned is not kept\n");
+      errNum = -1;
+      }
+   (void)cfi_unpin (cfi);
+
+   cfi_memory_live (&live1);
+   if ((live1.arenas != live0.arenas) || (live1.nodes != live0.nodes) ||
+       (live1.allocations != live0.allocations))
+      {
+      printf ("   a document deleted while pinned is not freed\n");
+      errNum = -1;
+      }
+
+   /*
+    * The pins are of one document.
+    */
+   if (text_get("a; b;\n",0,&cfi) != 0) return -1;
+   if (text_get("c; d;\n",0,&other) != 0) return -1;
+   (void)cfi_pin (cfi);
+   cfi_memory_live (&live1);
+   (void)cfi_delete (cfi_node_next(other));
+   (void)cfi_delete (cfi_node_next(cfi));
+   cfi_memory_live (&live2);
+   if ((live2.nodes != live1.nodes - 1) || (cfi_unpin(other) == NULL))
+      {
+      printf ("   the pins of a document keep the nodes of another\n");
+      errNum = -1;
+      }
+   (void)cfi_unpin (cfi);
+   cfi_memory_live (&live2);
+   if (live2.nodes != live1.nodes - 2)
+      {
+      printf ("   a node is not freed with the last pin of its document\n");
+      errNum = -1;
+      }
+   (void)cfi_delete_chain (other);
+   (void)cfi_delete_chain (cfi);
+
+   /*
+    * A lookup that lends its node doesn't parse a lazy section.
+    */
+   if (text_get("s { a = 1; t { b = 2; } }\n",1,&cfi) != 0) return -1;
+   if (cfi_path_compile("s.t.b",&path) != NULL) return -1;
+   if ((cfi_search_peek(cfi,"a",CFI_ATTRIBUTES) != NULL) ||
+       (cfi_lookup_peek(cfi,"s.a",CFI_ATTRIBUTES) != NULL) ||
+       (cfi_path_lookup_peek(cfi,path,CFI_ATTRIBUTES) != NULL) ||
+       (cfi_memory_usage(cfi,&stats) != NULL) || (stats.sources != 1))
+      {
+      printf ("   a lookup that lends its node parses a lazy section\n");
+      errNum = -1;
+      }
+   (void)cfi_node_section (cfi);
+   if ((cfi_search_peek(cfi,"a",CFI_ATTRIBUTES) == NULL) ||
+       (cfi_lookup_peek(cfi,"s.a",CFI_ATTRIBUTES) == NULL) ||
+       (cfi_path_lookup_peek(cfi,path,CFI_ATTRIBUTES) == NULL))
+      {
+      printf ("   a lookup that lends its node misses a parsed section\n");
+      errNum = -1;
+      }
+   (void)cfi_path_del (&path);
+   (void)cfi_delete_chain (cfi);
+
+   return errNum;
+   }
+
+/*****************************************************************************
+ * Private Function cursor_types
+ *****************************************************************************
+ *
+ * These are the types of the nodes that a search with a cursor finds, in
+ * order, one letter for each: 'W', 'A' or 'S'.
+ *
+ ****************************************************************************/
+
+static const char* cursor_types (
+                                CFI_node_t  a_cfi,
+                                const char* a_word,
+                                unsigned    a_types,
+                                int         a_depth
+                                )
+   {
+   static char  types[32];
+   CFI_cursor_t cursor;
+   CFI_node_t   node;
+   size_t       i = 0;
+
+   if (cfi_search_begin(a_cfi,a_word,a_types,a_depth,&cursor) != NULL)
+      {
+      return "error";
+      }
+   while (((node = cfi_search_next(cursor)) != NULL) && (i+1 < sizeof(types)))
+      {
+      switch (cfi_node_type_get(node))
+         {
+         case CFI_WORD:       types[i++] = 'W'; break;
+         case CFI_ATTRIBUTES: types[i++] = 'A'; break;
+         case CFI_SECTION:    types[i++] = 'S'; break;
+         }
+      }
+   types[i] = '\0';
+   if (cfi_search_end(&cursor) != NULL) return "error";
+
+   return types;
+   }
+
+
+/*****************************************************************************
+ * Private Function test_cursor
+ *****************************************************************************
+ *
+ * A cursor must find every node with the word and one of the types, in the
+ * order of a walk of the tree, down to its depth, and pass over the deleted
+ * ones.
+ *
+ ****************************************************************************/
+
+static int test_cursor (void)
+   {
+   static const char text[] =
+      "backend { port = 1; backend { port = 2; } }\n"
+      "port;\n"
+      "frontend { backend = 3; listen { backend { port = 4; } } }\n"
+      "backend = 5;\n";
+   CFI_live_t   live0;
+   CFI_live_t   live1;
+   CFI_cursor_t cursor;
+   CFI_node_t   cfi;
+   CFI_node_t   node;
+   const char*  what;
+   int          lazy;
+   int          errNum = 0;
+
+   cfi_memory_live (&live0);
+
+   for (lazy = 0 ; lazy <= 1 ; lazy++)
+      {
+      what = lazy ? "lazy" : "flat";
+      if (text_get(text,lazy,&cfi) != 0) return -1;
+
+      if ((strcmp(cursor_types(cfi,"backend",CFI_ANY_MASK,-1),"SSASA") != 0) ||
+          (strcmp(cursor_types(cfi,"backend",CFI_SECTION_MASK,-1),"SSS") != 0))
+         {
+         printf ("   %s: a cursor doesn't find every node\n", what);
+         errNum = -1;
+         }
+      if ((strcmp(cursor_types(cfi,"backend",CFI_ANY_MASK,0),"SA") != 0) ||
+          (strcmp(cursor_types(cfi,"backend",CFI_ANY_MASK,1),"SSAA") != 0))
+         {
+         printf ("   %s: a cursor goes below its depth\n", what);
+         errNum = -1;
+         }
+      if ((strcmp(cursor_types(cfi,NULL,CFI_WORD_MASK,-1),"W") != 0) ||
+          (strcmp(cursor_types(cfi,NULL,CFI_ATTRIBUTES_MASK,-1),"AAAAA") != 0))
+         {
+         printf ("   %s: a cursor for any word is not right\n", what);
+         errNum = -1;
+         }
+
+      if (cfi_search_begin(cfi,"backend",CFI_SECTION_MASK,-1,&cursor) != NULL)
+         return -1;
+      node = cfi_search_next (cursor);
+      if ((node == NULL) || (cfi_search_next(cursor) == node) ||
+          (strcmp(cfi_node_word(node),"backend") != 0))
+         {
+         printf ("   %s: a cursor doesn't go on from a node\n", what);
+         errNum = -1;
+         }
+      (void)cfi_search_end (&cursor);
+
+      node = cfi_search_peek (cfi, "frontend", CFI_SECTION);
+      if (node == NULL) return -1;
+      (void)cfi_delete (node);
+      if (strcmp(cursor_types(cfi,"backend",CFI_ANY_MASK,-1),"SSA") != 0)
+         {
+         printf ("   %s: a cursor finds a deleted node\n", what);
+         errNum = -1;
+         }
+
+      (void)cfi_delete_chain (cfi);
+      }
+
+   if (cfi_search_begin(NULL,"backend",0,-1,&cursor) == NULL)
+      {
+      printf ("   a cursor is made for no types\n");
+      (void)cfi_search_end (&cursor);
+      errNum = -1;
+      }
+
+   cfi_memory_live (&live1);
+   if (live1.allocations != live0.allocations)
+      {
+      printf ("   a cursor is not freed\n");
+      errNum = -1;
+      }
+
+   return errNum;
+   }
+
+/*****************************************************************************
+ * Private Function test_many
+ *****************************************************************************
+ *
+ * A batch lookup must give each key the node that cfi_search() gives it,
+ * retained, or NULL.
+ *
+ ****************************************************************************/
+
+static int test_many (void)
+   {
+   static const char text[] =
+      "name = top;\n"
+      "port = 7;\n"
+      "cluster { port = 8; name; backend { port = 81; name = b; } }\n"
+      "backend { port = 82; }\n";
+   static const char* keys[] =
+      { "port", "name", "name", "backend", "port", "listen", NULL, "name" };
+   static const int types[] =
+      { CFI_ATTRIBUTES, CFI_WORD, CFI_ATTRIBUTES, CFI_SECTION,
+        CFI_ATTRIBUTES, CFI_ATTRIBUTES, CFI_WORD, CFI_SECTION };
+   CFI_node_t  results[sizeof(keys)/sizeof(keys[0])];
+   CFI_node_t  cfi;
+   CFI_node_t  node;
+   CFI_node_t  port;
+   size_t      n = sizeof(keys) / sizeof(keys[0]);
+   size_t      i;
+   const char* what;
+   int         lazy;
+   int         errNum = 0;
+
+   for (lazy = 0 ; lazy <= 1 ; lazy++)
+      {
+      what = lazy ? "lazy" : "flat";
+      if (text_get(text,lazy,&cfi) != 0) return -1;
+
+      /*
+       * The first port is deleted, and the next one is found.
+       */
+      port = cfi_search_peek (cfi, "port", CFI_ATTRIBUTES);
+      if (port == NULL) return -1;
+      (void)cfi_delete (port);
+
+      if (cfi_lookup_many(cfi,keys,types,n,results) != NULL) return -1;
+      for (i = 0 ; i < n ; i++)
+         {
+         node = keys[i] != NULL ? cfi_search (cfi, keys[i], types[i]) : NULL;
+         if (results[i] != node)
+            {
+            printf ("   %s: key %lu is not found right\n",
+                    what, (unsigned long)i);
+            errNum = -1;
+            }
+         if (node != NULL) (void)cfi_release (node);
+         if (results[i] != NULL) (void)cfi_release (results[i]);
+         }
+      if ((results[0] == NULL) ||
+          (cfi_attribute_int_get(cfi_node_attribute(results[0])) != 8) ||
+          (results[5] != NULL) || (results[6] != NULL) ||
+          (results[7] != NULL) || (results[1] == NULL))
+         {
+         printf ("   %s: the keys are not found\n", what);
+         errNum = -1;
+         }
+      if (cfi_release(results[1]) == NULL)
+         {
+         printf ("   %s: a node found is retained twice\n", what);
+         errNum = -1;
+         }
+
+      (void)cfi_delete_chain (cfi);
+      }
+
+   return errNum;
+   }
+
+
+
+/*****************************************************************************
+ * Private Function test_errors
+ *****************************************************************************
+ *
+ * A syntax error after a big prefix, at the top level and deep in a section,
+ * must give no nodes and leave no live memory behind, from the heap and from
+ * an arena, with one thread and with four; run this under LeakSanitizer to
+ * see where any leak is.  An error that isn't a syntax error must not be
+ * reported as one.  Sections nested too deeply are an error of their own,
+ * reported at the '{' that is too deep.
+ *
+ ****************************************************************************/
+
+static int test_errors (void)
+   {
+   static const char* const tails[] =
+      {
+      "oops = ;\n",
+      "last (1) { in { a = \"a string that is longer\", 2; b = 1, ; } }\n",
+      "}\n"
+      };
+   static const size_t blockSizes[] = { 0, 4096 };
+   static const unsigned threads[]  = { 1, 4 };
+   CFI_parser_t parser;
+   CFI_live_t   live0;
+   CFI_live_t   live1;
+   CFI_node_t   cfi;
+   FILE*        input;
+   const char*  msg;
+   size_t       t;
+   size_t       b;
+   size_t       n;
+   long         i;
+   char         text[80];
+   int          errNum = 0;
+
+   msg = cfi_get (-1, &cfi);
+   if ((msg == NULL) || (strcmp(msg,"can't get status on input") != 0))
+      {
+      printf ("   a bad descriptor is reported as \"%s\"\n", msg);
+      errNum = -1;
+      }
+
+   input = input_new ();
+   if (input == NULL) return -1;
+   for (i = 0 ; i < 2*DEEP_DEPTH ; i++) fputs ("s {\n", input);
+   for (i = 0 ; i < 2*DEEP_DEPTH ; i++) fputs ("}\n", input);
+   (void)fflush (input);
+   (void)lseek (fileno(input), 0, SEEK_SET);
+   cfi_memory_live (&live0);
+   if (cfi_parser_new(&parser) != NULL)
+      {
+      fclose (input);
+      return -1;
+      }
+   cfi = NULL;
+   msg = cfi_parser_get (parser, fileno(input), &cfi);
+   sprintf (text, "line %d: sections nested too deeply near \"{\"",
+            DEEP_DEPTH+1);
+   if ((msg == NULL) || (strcmp(msg,text) != 0) || (cfi != NULL))
+      {
+      printf ("   deep sections give \"%s\"\n", msg);
+      (void)cfi_delete_chain (cfi);
+      errNum = -1;
+      }
+   (void)cfi_parser_del (&parser);
+   fclose (input);
+   cfi_memory_live (&live1);
+   if ((live1.allocations != live0.allocations) ||
+       (live1.nodes != live0.nodes))
+      {
+      printf ("   the deep sections are not freed\n");
+      errNum = -1;
+      }
+
+   for (t = 0 ; t < sizeof(tails)/sizeof(tails[0]) ; t++)
+      {
+      input = input_new ();
+      if (input == NULL) return -1;
+      for (i = 0 ; ftell(input) < (3L << 20) ; i++)
+         {
+         fprintf (input, "s%ld (%ld) {\n", i, i);
+         fprintf (input, "   x = \"a string that is longer than %ld\", %ld;\n",
+                  i, i);
+         fprintf (input, "   w; t { y = 1.5, word; }\n");
+         fprintf (input, "}\n");
+         fprintf (input, "a%ld = %ld;\n", i, i % 7);
+         }
+      fputs (tails[t], input);
+      (void)fflush (input);
+
+      for (b = 0 ; b < sizeof(blockSizes)/sizeof(blockSizes[0]) ; b++)
+         {
+         for (n = 0 ; n < sizeof(threads)/sizeof(threads[0]) ; n++)
+            {
+            cfi_memory_live (&live0);
+            if (cfi_parser_new(&parser) != NULL)
+               {
+               fclose (input);
+               return -1;
+               }
+            (void)cfi_parser_arena (parser, blockSizes[b]);
+            (void)cfi_parser_threads (parser, threads[n]);
+            (void)lseek (fileno(input), 0, SEEK_SET);
+            cfi = NULL;
+            msg = cfi_parser_get (parser, fileno(input), &cfi);
+            (void)cfi_parser_del (&parser);
+            if ((msg == NULL) || (cfi != NULL))
+               {
+               printf ("   tail %lu, %lu byte blocks, %u threads: "
+                       "the error is not reported\n",
+                       (unsigned long)t, (unsigned long)blockSizes[b],
+                       threads[n]);
+               (void)cfi_delete_chain (cfi);
+               errNum = -1;
+               continue;
+               }
+            cfi_memory_live (&live1);
+            if ((live1.allocations != live0.allocations) ||
+                (live1.arenas != live0.arenas) ||
+                (live1.arenaBytes != live0.arenaBytes) ||
+                (live1.nodes != live0.nodes) ||
+                (live1.attributes != live0.attributes))
+               {
+               printf ("   tail %lu, %lu byte blocks, %u threads: "
+                       "the nodes made before the error are not freed\n",
+                       (unsigned long)t, (unsigned long)blockSizes[b],
+                       threads[n]);
+               errNum = -1;
+               }
+            }
+         }
+      fclose (input);
+      }
+
+   return errNum;
+   }
+
+
+
+/*****************************************************************************
+ * Private Function test_stream
+ *****************************************************************************
+ *
+ * A pipe is read through a stream, in many reads, into one buffer; the tree
+ * must be the same as from a file, with tokens across the reads.  A line
+ * comment is a comment only when it ends with a newline, as the flex rules
+ * say, so one at the very end of the input is a syntax error.
+ *
+ ****************************************************************************/
+
+static int test_stream (void)
+   {
+   FILE*       input;
+   CFI_node_t  cfi;
+   CFI_node_t  str;
+   const char* msg;
+   char*       text;
+   size_t      leng = 0;
+   size_t      size = 1L << 20;
+   int         fds[2];
+   int         errNum = 0;
+   long        i;
+   pid_t       pid;
+
+   text = (char*)malloc (size);
+   if (text == NULL) return -1;
+   for (i = 0 ; leng < (size - 256) ; i++)
+      {
+      leng += sprintf (
+                      &text[leng],
+                      "s%ld { x = \"%ld;}\", %ld; # }\n   w%ld; -- {\n}\n",
+                      i,
+                      i,
+                      i,
+                      i
+                      );
+      }
+
+   input = input_new ();
+   if (input == NULL)
+      {
+      free (text);
+      return -1;
+      }
+   (void)fwrite (text, 1, leng, input);
+   if (input_get(input,&cfi) != 0)
+      {
+      free (text);
+      return -1;
+      }
+
+   if (pipe(fds) != 0)
+      {
+      free (text);
+      (void)cfi_delete_chain (cfi);
+      return -1;
+      }
+   pid = fork ();
+   if (pid == 0)
+      {
+      (void)close (fds[0]);
+      (void)write (fds[1], text, leng);
+      _exit (0);
+      }
+   (void)close (fds[1]);
+   str = NULL;
+   msg = pid < 0 ? "can't fork" : cfi_get (fds[0], &str);
+   (void)close (fds[0]);
+   if (pid > 0) (void)waitpid (pid, NULL, 0);
+   if (msg != NULL)
+      {
+      printf ("   pipe: %s\n", msg);
+      errNum = -1;
+      }
+   else if (!tree_same(cfi,str))
+      {
+      printf ("   the tree from a pipe is not the same\n");
+      errNum = -1;
+      }
+   (void)cfi_delete_chain (str);
+   (void)cfi_delete_chain (cfi);
+   free (text);
+
+   input = input_new ();
+   if (input == NULL) return -1;
+   fputs ("a;\n# a comment without a newline", input);
+   if ((fflush(input) == 0) && (lseek(fileno(input),0,SEEK_SET) == 0))
+      {
+      cfi = NULL;
+      if (cfi_get(fileno(input),&cfi) == NULL)
+         {
+         printf ("   a line comment without a newline is a comment\n");
+         (void)cfi_delete_chain (cfi);
+         errNum = -1;
+         }
+      }
+   fclose (input);
+
+   return errNum;
+   }
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      P r i v a t e   G l o b a l   V a r i a b l e s                      */
+/*                                                                           */
+/* ************************************************************************* */
+
+static const S_test_t g_tests[] =
+   {
+   { "flat",       test_flat       },
+   { "list",       test_list       },
+   { "nest",       test_nest       },
+   { "numbers",    test_numbers    },
+   { "events",     test_events     },
+   { "lazy",       test_lazy       },
+   { "parallel",   test_parallel   },
+   { "reparse",    test_reparse    },
+   { "strings",    test_strings    },
+   { "arena",      test_arena      },
+   { "values",     test_values     },
+   { "keys",       test_keys       },
+   { "attributes", test_attributes },
+   { "freeze",     test_freeze     },
+   { "allocator",  test_allocator  },
+   { "memory",     test_memory     },
+   { "peek",       test_peek       },
+   { "index",      test_index      },
+   { "lookup",     test_lookup     },
+   { "pin",        test_pin        },
+   { "cursor",     test_cursor     },
+   { "many",       test_many       },
+   { "errors",     test_errors     },
+   { "stream",     test_stream     },
+   { NULL,         NULL            }
+   };
+
+
+/* ************************************************************************* */
+/*                                                                           */
+/*      E x e c u t a b l e   C o d e   (MAIN PROGRAM)                       */
+/*                                                                           */
+/* ************************************************************************* */
+
+int   main (int argc, char** argv)
+   {
+   int errNum = 0;
+   int ran    = 0;
+   int i;
+
+   (void)cfi_init ();
+
+   for (i = 0 ; g_tests[i].name != NULL ; i++)
+      {
+      if ((argc > 1) && (strcmp(argv[1],g_tests[i].name) != 0)) continue;
+      printf ("cfitest: %s\n", g_tests[i].name);
+      fflush (stdout);
+      ran += 1;
+      if ((*g_tests[i].test)() != 0)
+         {
+         printf ("cfitest: %s FAILED\n", g_tests[i].name);
+         errNum = 3;
+         }
+      }
+
+   (void)cfi_done ();
+
+   if (ran == 0)
+      {
+      fprintf (stderr, "cfitest: no such test \"%s\".\n", argv[1]);
+      errNum = 1;
+      }
+
+   if (errNum == 0) printf ("cfitest: all tests passed\n");
+
+   return errNum;
+   }
+
+
+/* end of file */